@@ -0,0 +1,54 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "camera_interface.h"
+#include <cmath>
+#include <simd/simd.h>
+
+//
+// Walk-through camera driven by stick input
+//
+// update() advances one frame from the state the previous frame ended with.
+// relatch() evaluates the same frame again from the same starting state with a
+// newer input sample, so the view can be refreshed just before the frame is
+// submitted without moving the camera twice.
+//
+class CameraController
+{
+  public:
+    struct State
+    {
+        simd::float3 eye;
+        simd::float3 target;
+        simd::float3 up;
+    };
+    // stick values in -1..1
+    struct Input
+    {
+        float moveX; // strafe
+        float moveY; // forward
+        float turn;  // yaw
+    };
+
+    static constexpr float MoveSpeed = 0.2f;
+    static constexpr float TurnSpeed = float(M_PI) / 200.0f;
+
+    explicit CameraController(const State& state);
+
+    // one frame of movement from `from` (no side effects)
+    [[nodiscard]] static State step(const State& from, const Input& input);
+
+    // start a new frame: the previous result becomes the starting state
+    const State& update(const Input& input);
+    // evaluate the current frame again with a newer input
+    const State& relatch(const Input& input);
+
+    [[nodiscard]] const State& getState() const { return state_; }
+    void                       apply(CameraInterface& camera) const;
+
+  private:
+    State base_;
+    State state_;
+};
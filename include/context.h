@@ -5,8 +5,12 @@
 
 #include "camera_interface.h"
 #include <cinttypes>
+#include <cstdarg>
+#include <cstddef>
+#include <simd/matrix_types.h>
 #include <simd/vector_types.h>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 //
@@ -16,19 +20,42 @@ class Context
 {
 
   public:
+    using GeometryHandle = uint32_t;
+
     Context()          = default;
     virtual ~Context() = default;
 
+    // context for the calling thread: worker threads draw through it without locks
+    // and must be done before the frame's update returns. The recorded calls are merged
+    // at the end of the frame ordered by sortKey, then by thread, then by call order;
+    // each thread starts with a white draw color and an identity transform.
+    // Retained geometry can't be created or edited through it (DrawGeometry works).
+    // At most 64 threads can use it in one frame, the next one aborts.
+    virtual Context& GetThreadContext(uint32_t sortKey = 0) = 0;
     // get 3d camera control
     virtual CameraInterface& GetCamera() = 0;
     // set draw color
     virtual void SetDrawColor(float r, float g, float b, float a = 1.0f) = 0;
     // display message on screen
-    virtual void Print(float x, float y, std::string msg) = 0;
+    // the message is interned: repeated messages are not copied after the first frame, and a message is
+    // kept until it has not been printed for about 120 frames. Use Printf for text that changes every frame.
+    virtual void Print(float x, float y, std::string_view msg) = 0;
+    // formatted message, written straight into per-frame memory
+    virtual void PrintV(float x, float y, const char* fmt, va_list args) = 0;
+    //
+    void Printf(float x, float y, const char* fmt, ...) __attribute__((format(printf, 4, 5)))
+    {
+        va_list args;
+        va_start(args, fmt);
+        PrintV(x, y, fmt, args);
+        va_end(args);
+    }
     //
     virtual void DrawLine2D(simd::float2 from, simd::float2 to) = 0;
     //
     virtual void DrawRect2D(simd::float2 pos, simd::float2 size) = 0;
+    // filled rectangle (drawn behind lines and text)
+    virtual void FillRect2D(simd::float2 pos, simd::float2 size) = 0;
     //
     virtual void DrawLine3D(simd::float3 from, simd::float3 to) = 0;
     //
@@ -37,4 +64,49 @@ class Context
     virtual void DrawTriangle3D(simd::float3 v0, simd::float3 v1, simd::float3 v2) = 0;
     //
     virtual void DrawPlane3D(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3) = 0;
+
+    // bulk drawing: colors is per point (nullptr uses the draw color)
+    // line list: count points, 2 per line
+    virtual void DrawLines3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) = 0;
+    // triangle list: count points, 3 per triangle
+    virtual void DrawTriangles3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) = 0;
+    // connected lines
+    virtual void DrawLineStrip2D(const simd::float2* points, size_t count, const simd::float4* colors = nullptr) = 0;
+    virtual void DrawLineStrip3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) = 0;
+    // count rectangles
+    virtual void DrawRects2D(const simd::float2* pos, const simd::float2* size, size_t count) = 0;
+
+    // 3D transform stack: the current matrix is applied to all following 3D drawing
+    // push multiplies onto the current matrix (current * transform)
+    virtual void PushTransform(const simd::float4x4& transform) = 0;
+    //
+    virtual void PopTransform() = 0;
+    // replace the current matrix
+    virtual void SetTransform(const simd::float4x4& transform) = 0;
+    // draw translucent 3D triangles and debug shapes (alpha < 1) back to front, after opaque ones
+    virtual void SetTranslucentSort3D(bool enable) = 0;
+
+    // debug shapes (instanced unit meshes, drawn as lines in the draw color)
+    // axis aligned box
+    virtual void DrawBox3D(simd::float3 center, simd::float3 size) = 0;
+    //
+    virtual void DrawSphere3D(simd::float3 center, float radius) = 0;
+    //
+    virtual void DrawArrow3D(simd::float3 from, simd::float3 to) = 0;
+    // grid on the XZ plane
+    virtual void DrawGrid3D(simd::float3 center, float size, int divisions) = 0;
+    // X/Y/Z axes in red/green/blue
+    virtual void DrawAxes3D(const simd::float4x4& transform, float length = 1.0f) = 0;
+
+    // retained geometry: draw calls between Begin/End are recorded into the handle
+    // and uploaded once, DrawGeometry then costs no per-vertex work (0 is invalid)
+    virtual GeometryHandle CreateGeometry() = 0;
+    //
+    virtual bool BeginGeometry(GeometryHandle handle) = 0;
+    //
+    virtual void EndGeometry() = 0;
+    //
+    virtual void DrawGeometry(GeometryHandle handle, const simd::float4x4& transform) = 0;
+    //
+    virtual void DestroyGeometry(GeometryHandle handle) = 0;
 };
@@ -3,8 +3,6 @@
 //
 #pragma once
 
-#include "Metal/MTLArgument.hpp"
-
 namespace GamePad
 {
 
@@ -55,7 +53,14 @@ struct PadState
     float  triggerR;
 };
 
-//
+// once per frame: the state since the previous call
 bool GetPadState(int idx, PadState& state);
+// newest state without consuming presses for the next GetPadState (for late latching)
+bool GetLatestPadState(int idx, PadState& state);
+
+// sample pad 0 on its own thread at `hz`: GetPadState(0) then reports presses shorter
+// than a frame and interpolates the sticks between timestamped samples
+bool StartSampler(int hz = 1000);
+void StopSampler();
 
 }; // namespace GamePad
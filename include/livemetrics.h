@@ -0,0 +1,103 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+
+//
+// Live metrics shared memory layout (POSIX shm_open/mmap)
+//
+// The renderer creates the segment and publishes one snapshot per frame, external
+// tools map it read-only. The header is written once, magic last, so a reader that
+// sees the right magic and version can trust the rest of the header.
+// The payload is guarded by a seqlock: the writer makes the sequence odd, copies the
+// payload and makes it even again; a reader retries until it sees the same even
+// sequence before and after its copy. The writer never waits for readers.
+//
+namespace LiveMetrics
+{
+
+constexpr const char* DefaultName = "/metaltest.metrics";
+constexpr uint32_t    Magic       = 0x4d544c4d; // "MLTM"
+constexpr uint32_t    Version     = 1;
+
+constexpr size_t MaxCounters = 16;
+constexpr size_t NameLength  = 24;
+// Renderer::draw duration histogram: BucketCount buckets of bucketWidthUs, the last one
+// also counts everything longer
+constexpr size_t BucketCount = 64;
+
+// all fields are 64 bit so the layout is the same for every compiler
+struct Payload
+{
+    uint64_t frameIndex;
+    uint64_t timestampNs; // steady clock of the writer
+    uint64_t cpuUs;       // last frame, without the wait
+    uint64_t waitUs;      // last frame, waiting for a free frame in flight
+    uint64_t drawUs;      // last frame, whole Renderer::draw
+    uint64_t counters[MaxCounters];
+    uint64_t histogram[BucketCount]; // since the writer started
+};
+
+//
+struct Segment
+{
+    std::atomic<uint32_t> magic;
+    uint32_t              version;
+    uint32_t              size; // sizeof(Segment) of the writer
+    uint32_t              counterCount;
+    uint32_t              bucketCount;
+    uint32_t              bucketWidthUs;
+    uint64_t              writerPid;
+    char                  counterNames[MaxCounters][NameLength];
+
+    alignas(64) std::atomic<uint32_t> sequence;
+    alignas(64) Payload payload;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the seqlock is shared between processes");
+
+// writer side (single writer)
+inline void
+write(Segment& segment, const Payload& payload)
+{
+    const uint32_t seq = segment.sequence.load(std::memory_order_relaxed);
+    segment.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&segment.payload, &payload, sizeof(Payload));
+    segment.sequence.store(seq + 2, std::memory_order_release);
+}
+
+// reader side: false if the writer kept updating for maxRetry attempts
+inline bool
+read(const Segment& segment, Payload& out, int maxRetry = 1000)
+{
+    for (int i = 0; i < maxRetry; i++)
+    {
+        const uint32_t before = segment.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+        std::memcpy(&out, &segment.payload, sizeof(Payload));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment.sequence.load(std::memory_order_relaxed) == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// header check for readers
+inline bool
+isValid(const Segment& segment)
+{
+    return segment.magic.load(std::memory_order_acquire) == Magic && segment.version == Version &&
+           segment.size == sizeof(Segment) && segment.counterCount <= MaxCounters && segment.bucketCount == BucketCount;
+}
+
+} // namespace LiveMetrics
@@ -80,6 +80,25 @@ makeScale(const simd::float3& v)
     return simd_matrix((float4){v.x, 0, 0, 0}, (float4){0, v.y, 0, 0}, (float4){0, 0, v.z, 0}, (float4){0, 0, 0, 1.0});
 }
 
+// makeXRotate/makeYRotate/makeZRotate と同じ回転の quaternion
+inline simd_quatf
+makeXRotateQuat(float angleRadians)
+{
+    return simd_quaternion(-angleRadians, simd_make_float3(1.0f, 0.0f, 0.0f));
+}
+
+inline simd_quatf
+makeYRotateQuat(float angleRadians)
+{
+    return simd_quaternion(angleRadians, simd_make_float3(0.0f, 1.0f, 0.0f));
+}
+
+inline simd_quatf
+makeZRotateQuat(float angleRadians)
+{
+    return simd_quaternion(-angleRadians, simd_make_float3(0.0f, 0.0f, 1.0f));
+}
+
 inline simd::float3x3
 discardTranslation(const simd::float4x4& m)
 {
@@ -14,4 +14,11 @@ namespace TestLoop
 //
 void Update(Context& context);
 
+//
+// Called right before the frame is submitted, on the thread that ran Update.
+// Samples the pad again and re-evaluates this frame's camera from the same
+// starting state; returns true if the camera was set.
+//
+bool LateLatch(CameraInterface& camera);
+
 }; // namespace TestLoop
@@ -16,6 +16,19 @@ struct VertexData
     float2 texcoord;
 };
 
+struct CompactVertexData
+{
+    ushort4 position;
+    short2 normal;
+    half2 texcoord;
+};
+
+struct MeshBounds
+{
+    float3 origin;
+    float3 extent;
+};
+
 struct InstanceData
 {
     float4x4 instanceTransform;
@@ -23,6 +36,23 @@ struct InstanceData
     float4 instanceColor;
 };
 
+struct CompactInstanceData
+{
+    short4 rotation;
+    packed_float3 translation;
+    packed_half3 scale;
+    ushort padding;
+    uint color;
+};
+
+// 展開後のインスタンス
+struct InstanceTransform
+{
+    float4x4 transform;
+    float3x3 normalTransform;
+    half3 color;
+};
+
 struct CameraData
 {
     float4x4 perspectiveTransform;
@@ -30,30 +60,114 @@ struct CameraData
     float3x3 worldNormalTransform;
 };
 
-v2f vertex vertexMain( device const VertexData* vertexData [[buffer(0)]],
-                       device const InstanceData* instanceData [[buffer(1)]],
-                       device const CameraData& cameraData [[buffer(2)]],
-                       uint vertexId [[vertex_id]],
-                       uint instanceId [[instance_id]] )
+float3 decodeOctNormal( short2 e )
+{
+    float2 f = max( float2( e ) / 32767.0, -1.0 );
+    float3 n = float3( f, 1.0 - abs( f.x ) - abs( f.y ) );
+    float t = saturate( -n.z );
+    n.xy += select( float2( t ), float2( -t ), n.xy >= 0.0 );
+    return normalize( n );
+}
+
+InstanceTransform fetchInstance( device const InstanceData& instance )
+{
+    InstanceTransform o;
+    o.transform = instance.instanceTransform;
+    o.normalTransform = instance.instanceNormalTransform;
+    o.color = half3( instance.instanceColor.rgb );
+    return o;
+}
+
+InstanceTransform fetchInstance( device const CompactInstanceData& instance )
+{
+    float4 q = normalize( max( float4( instance.rotation ) / 32767.0, -1.0 ) );
+    float3 s = float3( half3( instance.scale ) );
+
+    float3x3 r = float3x3( float3( 1.0 - 2.0 * ( q.y * q.y + q.z * q.z ), 2.0 * ( q.x * q.y + q.z * q.w ), 2.0 * ( q.x * q.z - q.y * q.w ) ),
+                           float3( 2.0 * ( q.x * q.y - q.z * q.w ), 1.0 - 2.0 * ( q.x * q.x + q.z * q.z ), 2.0 * ( q.y * q.z + q.x * q.w ) ),
+                           float3( 2.0 * ( q.x * q.z + q.y * q.w ), 2.0 * ( q.y * q.z - q.x * q.w ), 1.0 - 2.0 * ( q.x * q.x + q.y * q.y ) ) );
+
+    InstanceTransform o;
+    o.transform = float4x4( float4( r[0] * s.x, 0.0 ), float4( r[1] * s.y, 0.0 ), float4( r[2] * s.z, 0.0 ),
+                            float4( float3( instance.translation ), 1.0 ) );
+    o.normalTransform = float3x3( r[0] / s.x, r[1] / s.y, r[2] / s.z );
+    o.color = half3( unpack_unorm4x8_to_float( instance.color ).rgb );
+    return o;
+}
+
+v2f transformVertex( float3 position, float3 normal, float2 texcoord,
+                     InstanceTransform instance,
+                     device const CameraData& cameraData )
 {
     v2f o;
 
-    const device VertexData& vd = vertexData[ vertexId ];
-    float4 pos = float4( vd.position, 1.0 );
-    pos = instanceData[ instanceId ].instanceTransform * pos;
+    float4 pos = float4( position, 1.0 );
+    pos = instance.transform * pos;
     pos = cameraData.perspectiveTransform * cameraData.worldTransform * pos;
     o.position = pos;
 
-    float3 normal = instanceData[ instanceId ].instanceNormalTransform * vd.normal;
+    normal = instance.normalTransform * normal;
     normal = cameraData.worldNormalTransform * normal;
     o.normal = normal;
 
-    o.texcoord = vd.texcoord.xy;
+    o.texcoord = texcoord;
 
-    o.color = half3( instanceData[ instanceId ].instanceColor.rgb );
+    o.color = instance.color;
     return o;
 }
 
+float3 decodePosition( device const CompactVertexData& vd, constant MeshBounds& bounds )
+{
+    return bounds.origin + float3( vd.position.xyz ) / 65535.0 * bounds.extent;
+}
+
+v2f vertex vertexMain( device const VertexData* vertexData [[buffer(0)]],
+                       device const InstanceData* instanceData [[buffer(1)]],
+                       device const CameraData& cameraData [[buffer(2)]],
+                       uint vertexId [[vertex_id]],
+                       uint instanceId [[instance_id]] )
+{
+    const device VertexData& vd = vertexData[ vertexId ];
+    return transformVertex( vd.position, vd.normal, vd.texcoord.xy, fetchInstance( instanceData[ instanceId ] ), cameraData );
+}
+
+// Vertex::Format::Compact 用
+v2f vertex vertexMainCompact( device const CompactVertexData* vertexData [[buffer(0)]],
+                              device const InstanceData* instanceData [[buffer(1)]],
+                              device const CameraData& cameraData [[buffer(2)]],
+                              constant MeshBounds& bounds [[buffer(3)]],
+                              uint vertexId [[vertex_id]],
+                              uint instanceId [[instance_id]] )
+{
+    const device CompactVertexData& vd = vertexData[ vertexId ];
+    return transformVertex( decodePosition( vd, bounds ), decodeOctNormal( vd.normal ), float2( vd.texcoord ),
+                            fetchInstance( instanceData[ instanceId ] ), cameraData );
+}
+
+// CompactInstanceData 用
+v2f vertex vertexMainCompactInstance( device const VertexData* vertexData [[buffer(0)]],
+                                      device const CompactInstanceData* instanceData [[buffer(1)]],
+                                      device const CameraData& cameraData [[buffer(2)]],
+                                      uint vertexId [[vertex_id]],
+                                      uint instanceId [[instance_id]] )
+{
+    const device VertexData& vd = vertexData[ vertexId ];
+    return transformVertex( vd.position, vd.normal, vd.texcoord.xy, fetchInstance( instanceData[ instanceId ] ), cameraData );
+}
+
+// 頂点もインスタンスも Compact
+v2f vertex vertexMainCompactAll( device const CompactVertexData* vertexData [[buffer(0)]],
+                                 device const CompactInstanceData* instanceData [[buffer(1)]],
+                                 device const CameraData& cameraData [[buffer(2)]],
+                                 constant MeshBounds& bounds [[buffer(3)]],
+                                 uint vertexId [[vertex_id]],
+                                 uint instanceId [[instance_id]] )
+{
+    const device CompactVertexData& vd = vertexData[ vertexId ];
+    return transformVertex( decodePosition( vd, bounds ), decodeOctNormal( vd.normal ), float2( vd.texcoord ),
+                            fetchInstance( instanceData[ instanceId ] ), cameraData );
+}
+
 half4 fragment fragmentMain( v2f in [[stage_in]], texture2d< half, access::sample > tex [[texture(0)]] )
 {
     constexpr sampler s( address::repeat, filter::linear );
@@ -1,10 +1,11 @@
 #include <metal_stdlib>
 using namespace metal;
 
+// 12 bytes: packed position + RGBA8
 struct VertexData2D
 {
-    float2 position;
-    float4 color;    
+    packed_float2 position;
+    uint color;
 };
 
 struct ScreenData
@@ -27,7 +28,7 @@ vertex p2f vert2d(const device VertexData2D* vertexArray [[buffer(0)]],const dev
 
     p2f out;
     out.pos      = float4(pos / screenData->size * 2.0 - 1.0, 0.0, 1.0);
-    out.color    = half4(vd2d.color.rgba);
+    out.color    = half4(unpack_unorm4x8_to_float(vd2d.color));
 
     return out;
 }
@@ -1,10 +1,20 @@
 #include <metal_stdlib>
 using namespace metal;
 
+// 16 bytes: packed position + RGBA8
 struct VertexData
 {
-  float3 position;
-  float4 color;
+  packed_float3 position;
+  uint color;
+};
+
+// 52 bytes: 3x4 affine rows + RGBA8 (DebugShape::Instance)
+struct ShapeInstance
+{
+  packed_float4 row0;
+  packed_float4 row1;
+  packed_float4 row2;
+  uint color;
 };
 
 struct CameraData
@@ -34,7 +44,46 @@ vertex v2f primVert3d( device const VertexData* vertexData [[buffer(0)]],
     pos = cameraData.perspectiveTransform * cameraData.worldTransform * pos;
     o.position = pos;
 
-    o.color = half4(vd.color);
+    o.color = half4(unpack_unorm4x8_to_float(vd.color));
+
+    return o;
+}
+
+//
+// 保持ジオメトリ用(モデル行列付き)
+//
+vertex v2f primVert3dModel( device const VertexData* vertexData [[buffer(0)]],
+                            device const CameraData& cameraData [[ buffer(2)]],
+                            constant float4x4& model [[buffer(3)]],
+                            uint vID [[vertex_id]])
+{
+    v2f o;
+
+    const device VertexData& vd = vertexData[ vID ];
+    float4 pos = model * float4( vd.position, 1.0 );
+    o.position = cameraData.perspectiveTransform * cameraData.worldTransform * pos;
+    o.color = half4(unpack_unorm4x8_to_float(vd.color));
+
+    return o;
+}
+
+//
+// デバッグ形状(単位形状 x インスタンス)
+//
+vertex v2f primVert3dInstanced( device const VertexData* vertexData [[buffer(0)]],
+                                device const ShapeInstance* instances [[buffer(1)]],
+                                device const CameraData& cameraData [[ buffer(2)]],
+                                uint vID [[vertex_id]],
+                                uint iID [[instance_id]])
+{
+    v2f o;
+
+    const device VertexData& vd = vertexData[ vID ];
+    const device ShapeInstance& inst = instances[ iID ];
+    float4 local = float4( vd.position, 1.0 );
+    float4 pos = float4( dot(float4(inst.row0), local), dot(float4(inst.row1), local), dot(float4(inst.row2), local), 1.0 );
+    o.position = cameraData.perspectiveTransform * cameraData.worldTransform * pos;
+    o.color = half4(unpack_unorm4x8_to_float(vd.color) * unpack_unorm4x8_to_float(inst.color));
 
     return o;
 }
@@ -8,6 +8,14 @@ struct VertexData2D
     float4 color;    
 };
 
+// 16 bytes: packed position + half UV + RGBA8 (SpriteBatch::Vertex)
+struct SpriteVertex
+{
+    packed_float2 position;
+    half2 texcoord;
+    uint color;
+};
+
 struct ScreenData
 {
     float2 size;
@@ -35,6 +43,21 @@ vertex p2f vert2d(const device VertexData2D* vertexArray [[buffer(0)]],const dev
     return out;
 }
 
+vertex p2f vertSprite(const device SpriteVertex* vertexArray [[buffer(0)]],const device ScreenData* screenData [[buffer(1)]], unsigned int vID [[vertex_id]])
+{
+    const device SpriteVertex& sv = vertexArray[vID];
+
+    float negy = screenData->size.y - sv.position.y;
+    float2 pos = float2(sv.position.x, negy);
+
+    p2f out;
+    out.pos      = float4(pos / screenData->size * 2.0 - 1.0, 0.0, 1.0);
+    out.color    = half4(unpack_unorm4x8_to_float(sv.color));
+    out.texcoord = float2(sv.texcoord);
+
+    return out;
+}
+
 fragment half4 frag2d(p2f in [[stage_in]], texture2d<half, access::sample> tex [[texture(0)]] )
 {
     constexpr sampler s( address::repeat, filter::linear );
@@ -0,0 +1,66 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include <cameracontroller.h>
+#include <simd/geometry.h>
+#include <simd/quaternion.h>
+
+//
+//
+//
+CameraController::CameraController(const State& state) : base_(state), state_(state) {}
+
+//
+// 上方向を軸に向きを回してから、横と前に進める(注視点までの距離は変えない)
+//
+CameraController::State
+CameraController::step(const State& from, const Input& input)
+{
+    auto tvec = from.target - from.eye;
+    auto len  = simd_length(tvec);
+    tvec      = simd_normalize(tvec);
+
+    auto rotY = simd_quaternion(input.turn * TurnSpeed, from.up);
+    tvec      = simd_act(rotY, tvec);
+
+    const auto sideV = simd_normalize(simd::cross(from.up, tvec));
+
+    State to = from;
+    to.eye -= sideV * input.moveX * MoveSpeed;
+    to.eye += tvec * input.moveY * MoveSpeed;
+    to.target = to.eye + tvec * len;
+    return to;
+}
+
+//
+//
+//
+const CameraController::State&
+CameraController::update(const Input& input)
+{
+    base_  = state_;
+    state_ = step(base_, input);
+    return state_;
+}
+
+//
+// base_ はそのままなので、何度呼んでも 1 フレーム分しか動かない
+//
+const CameraController::State&
+CameraController::relatch(const Input& input)
+{
+    state_ = step(base_, input);
+    return state_;
+}
+
+//
+//
+//
+void
+CameraController::apply(CameraInterface& camera) const
+{
+    camera.setEyePosition(state_.eye);
+    camera.setTargetPosition(state_.target);
+}
+
+//
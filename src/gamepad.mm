@@ -2,60 +2,186 @@
 // Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
 //
 #import "gamepad.h"
+#import "metalapp/inputrecord.h"
+#import "metalapp/inputsampler.h"
 #import <Foundation/Foundation.h>
 #import <GameController/GCKeyboard.h>
 #include <GameController/GameController.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 namespace GamePad
 {
+namespace
+{
 //
-//
+// GCController の今の状態を読む
 //
 bool
-GetPadState(int idx, PadState& state)
+readController(int idx, PadSample& sample)
 {
+    sample        = PadSample{};
+    sample.timeNs = InputSampler::now();
+
     NSArray<GCController*>* const padArray = [GCController controllers];
     if (idx < 0 || idx >= padArray.count)
     {
-        state.enabled_ = false;
         return false;
     }
     auto pad   = padArray[idx];
     auto input = [pad extendedGamepad];
     if (input == nullptr)
     {
-        state.enabled_ = false;
         return false;
     }
 
-    state.enabled_   = true;
-    auto setupButton = [&](PadState::Button& btn, GCControllerButtonInput* src)
+    sample.connected = true;
+    auto setupButton = [&](PadSample::Button button, GCControllerButtonInput* src)
+    {
+        sample.setButton(button, src.isPressed);
+    };
+    setupButton(PadSample::Menu, input.buttonMenu);
+    setupButton(PadSample::Options, input.buttonOptions);
+    setupButton(PadSample::A, input.buttonA);
+    setupButton(PadSample::B, input.buttonB);
+    setupButton(PadSample::C, input.buttonX);
+    setupButton(PadSample::D, input.buttonY);
+    setupButton(PadSample::ShoulderL, input.leftShoulder);
+    setupButton(PadSample::ShoulderR, input.rightShoulder);
+    setupButton(PadSample::Up, input.dpad.up);
+    setupButton(PadSample::Down, input.dpad.down);
+    setupButton(PadSample::Left, input.dpad.left);
+    setupButton(PadSample::Right, input.dpad.right);
+    auto lStick                      = input.leftThumbstick;
+    auto rStick                      = input.rightThumbstick;
+    sample.axes[PadSample::LeftX]    = lStick.xAxis.value;
+    sample.axes[PadSample::LeftY]    = lStick.yAxis.value;
+    sample.axes[PadSample::RightX]   = rStick.xAxis.value;
+    sample.axes[PadSample::RightY]   = rStick.yAxis.value;
+    sample.axes[PadSample::TriggerL] = input.leftTrigger.analog ? input.leftTrigger.value : 0.0f;
+    sample.axes[PadSample::TriggerR] = input.rightTrigger.analog ? input.rightTrigger.value : 0.0f;
+    return true;
+}
+
+//
+// 一定の間隔で 0 番のパッドを読む(GameController はイベントを待てないので)
+//
+class GameControllerInput : public InputBackend
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration   period_;
+    Clock::time_point next_;
+
+  public:
+    explicit GameControllerInput(int hz) : period_(std::chrono::nanoseconds(1000000000 / hz)), next_(Clock::now()) {}
+
+    bool read(PadSample& sample, int timeoutMs) override
     {
-        const PadState::Button newState{src.isPressed, btn.On()};
-        btn = newState;
+        // 遅れた分は取り戻さない
+        next_ = std::max(next_ + period_, Clock::now());
+        std::this_thread::sleep_until(next_);
+        @autoreleasepool
+        {
+            readController(0, sample);
+        }
+        return true;
+    }
+};
+
+InputSampler sampler;
+uint64_t     sampleDelayNs = 0; // 補間する時刻を今からサンプル間隔だけ戻す
+
+//
+uint32_t
+getButtons(const PadState& state)
+{
+    const PadState::Button* buttons[PadSample::ButtonCount] = {
+        &state.buttonUp, &state.buttonDown, &state.buttonLeft, &state.buttonRight, &state.buttonA,    &state.buttonB,
+        &state.buttonC,  &state.buttonD,    &state.shoulderL,  &state.shoulderR,   &state.buttonMenu, &state.buttonOptions,
     };
-    setupButton(state.buttonMenu, input.buttonMenu);
-    setupButton(state.buttonOptions, input.buttonOptions);
-    setupButton(state.buttonA, input.buttonA);
-    setupButton(state.buttonB, input.buttonB);
-    setupButton(state.buttonC, input.buttonX);
-    setupButton(state.buttonD, input.buttonY);
-    setupButton(state.shoulderL, input.leftShoulder);
-    setupButton(state.shoulderR, input.rightShoulder);
-    setupButton(state.buttonUp, input.dpad.up);
-    setupButton(state.buttonDown, input.dpad.down);
-    setupButton(state.buttonLeft, input.dpad.left);
-    setupButton(state.buttonRight, input.dpad.right);
-    auto lStick    = input.leftThumbstick;
-    auto rStick    = input.rightThumbstick;
-    state.leftX    = lStick.xAxis.value;
-    state.leftY    = lStick.yAxis.value;
-    state.rightX   = rStick.xAxis.value;
-    state.rightY   = rStick.yAxis.value;
-    state.triggerL = input.leftTrigger.analog ? input.leftTrigger.value : 0.0f;
-    state.triggerR = input.rightTrigger.analog ? input.rightTrigger.value : 0.0f;
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < PadSample::ButtonCount; i++)
+    {
+        bits |= buttons[i]->Pressed() ? 1u << i : 0u;
+    }
+    return bits;
+}
+
+//
+// サンプラーが動いていなければその場で読む(前の押下は state に残っている値から)
+//
+bool
+readPadState(int idx, PadState& state, bool latest)
+{
+    if (idx == 0 && sampler.isRunning())
+    {
+        const auto timeNs = InputSampler::now() - sampleDelayNs;
+        return latest ? sampler.peek(state, timeNs) : sampler.update(state, timeNs);
+    }
+    PadSample sample;
+    readController(idx, sample);
+    InputSampler::makePadState(sample, sample.buttons, getButtons(state), state);
+    return sample.connected;
+}
+
+} // namespace
 
+//
+//
+//
+bool
+StartSampler(int hz)
+{
+    if (hz <= 0)
+    {
+        return false;
+    }
+    sampleDelayNs = 1000000000ull / uint64_t(hz);
+    sampler.start(std::make_unique<GameControllerInput>(hz), sampleDelayNs);
     return true;
 }
 
+//
+//
+//
+void
+StopSampler()
+{
+    sampler.stop();
+}
+
+//
+// 再生中は記録した結果を返し、記録中は結果を書く
+//
+bool
+GetPadState(int idx, PadState& state)
+{
+    bool result = false;
+    if (InputRecord::replay(InputRecord::Call::Pad, idx, state, result))
+    {
+        return result;
+    }
+    result = readPadState(idx, state, false);
+    InputRecord::record(InputRecord::Call::Pad, idx, state, result);
+    return result;
+}
+
+//
+//
+//
+bool
+GetLatestPadState(int idx, PadState& state)
+{
+    bool result = false;
+    if (InputRecord::replay(InputRecord::Call::LatestPad, idx, state, result))
+    {
+        return result;
+    }
+    result = readPadState(idx, state, true);
+    InputRecord::record(InputRecord::Call::LatestPad, idx, state, result);
+    return result;
+}
+
 } // namespace GamePad
@@ -21,36 +21,123 @@
 
 #include "metalapp/app.h"
 #include "metalapp/camera.h"
+#include "metalapp/framearena.h"
+#include "metalapp/framepacer.h"
+#include "metalapp/geometrypool.h"
+#include "metalapp/gputrack.h"
+#include "metalapp/inputrecord.h"
+#include "metalapp/instancepack.h"
+#include "metalapp/memtrack.h"
+#include "metalapp/metricspublisher.h"
+#include "metalapp/perfhud.h"
+#include "metalapp/perfstats.h"
+#include "metalapp/primitivemesh.h"
+#include "metalapp/rendergraph.h"
+#include "metalapp/renderqueue.h"
 #include "metalapp/shaderset.h"
+#include "metalapp/simpipeline.h"
 #include "metalapp/simple2d.h"
 #include "metalapp/simple3d.h"
+#include "metalapp/stringtable.h"
 #include "metalapp/textdraw.h"
 #include "metalapp/texture.h"
+#include "metalapp/threadrecorders.h"
 #include "metalapp/vertex.h"
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <context.h>
+#include <gamepad.h>
 #include <iostream>
-#include <list>
 #include <matrix.h>
 #include <memory>
 #include <simd/simd.h>
 #include <simd/vector_types.h>
 #include <testloop.h>
+#include <vector>
 
 static constexpr size_t kInstanceRows      = 10;
 static constexpr size_t kInstanceColumns   = 10;
 static constexpr size_t kInstanceDepth     = 10;
 static constexpr size_t kNumInstances      = (kInstanceRows * kInstanceColumns * kInstanceDepth);
-static constexpr size_t kMaxFramesInFlight = 3;
+static constexpr int    kFramesInFlight    = 3; // --frames-in-flight で変えられる
 static constexpr float  ScreenWidth        = 1600.0f;
 static constexpr float  ScreenHeight       = 1000.0f;
+static constexpr int    kLODLevels         = 4;
+static constexpr float  kLODScreenSize     = 0.08f;
+static constexpr float  kLODMaxError       = 0.1f; // 法線、UV の差を含めた許容誤差
+static constexpr size_t kPoolVertices      = 16384;
+static constexpr size_t kPoolIndices       = 65536;
+static constexpr bool   kCompactVertex     = false;
+static constexpr bool   kCompactInstance   = false;
+static constexpr bool   kPerfHud           = true;
+static constexpr bool   kLiveMetrics       = true;
+static constexpr bool   kLateLatch         = true;
+static constexpr int    kInputSampleHz     = 1000; // 0 ならフレーム毎に直接読む
+
+// RenderQueue のキーに使う番号
+enum RenderLayer : uint8_t
+{
+    LayerWorld,
+    LayerOverlay,
+    LayerText,
+};
+enum RenderPipeline : uint32_t
+{
+    PipelineNone,
+    PipelineMesh,
+    PipelinePrim3D,
+    PipelineGeometry3D,
+    PipelineShape3D,
+    PipelinePrim2D,
+    PipelineSprite,
+    PipelineSpriteAdd,
+    PipelineText,
+};
+
+// 描画単位のシェーダ
+RenderPipeline
+getPipeline(const Simple3D::DrawItem& item)
+{
+    switch (item.kind)
+    {
+    case Simple3D::DrawKind::Geometry:
+        return PipelineGeometry3D;
+    case Simple3D::DrawKind::Shape:
+        return PipelineShape3D;
+    default:
+        return PipelinePrim3D;
+    }
+}
 
 //
+RenderPipeline
+getPipeline(const Simple2D::DrawItem& item)
+{
+    if (item.kind == Simple2D::DrawKind::Lines)
+    {
+        return PipelinePrim2D;
+    }
+    return item.blend == Simple2D::Blend::Add ? PipelineSpriteAdd : PipelineSprite;
+}
+
+namespace shader_types
+{
+struct InstanceData
+{
+    simd::float4x4 instanceTransform;
+    simd::float3x3 instanceNormalTransform;
+    simd::float4   instanceColor;
+};
+} // namespace shader_types
+
+// message は StringTable か FrameArena の中を指す(NUL 終端)
 struct TextBuffer
 {
-    std::string  message;
-    simd::float2 pos;
-    simd::float4 color;
+    std::string_view message;
+    simd::float2     pos;
+    simd::float4     color;
 };
 
 //
@@ -58,11 +145,15 @@ struct TextBuffer
 //
 class ContextImpl : public Context
 {
-    Camera&               camera_;
-    Simple2D&             render2d_;
-    Simple3D&             render3d_;
-    std::list<TextBuffer> textBuffer_;
-    simd::float4          drawColor_;
+    Camera&                   camera_;
+    Simple2D&                 render2d_;
+    Simple3D&                 render3d_;
+    FrameArena*               arena_ = nullptr;
+    StringTable               strings_;
+    std::vector<TextBuffer>   textBuffer_;
+    std::vector<simd::float4> rectBuffer_;
+    simd::float4              drawColor_;
+    ThreadRecorders           threads_; // ジオメトリのハンドルはそのまま渡す
 
   public:
     ContextImpl(Camera& cam, Simple2D& r2d, Simple3D& r3d) : camera_(cam), render2d_(r2d), render3d_(r3d)
@@ -71,18 +162,37 @@ class ContextImpl : public Context
     }
     ~ContextImpl() override = default;
 
+    // フレームの始めに呼ぶ(arena はこのフレーム用、前の内容は捨てる)
+    void beginFrame(FrameArena& arena)
+    {
+        arena_ = &arena;
+        arena_->reset();
+        drawColor_ = simd_make_float4(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    // GetThreadContext で記録した分を流す(記録するスレッドが全て終わってから)
+    void mergeThreads()
+    {
+        threads_.replay(*this);
+        threads_.clear();
+    }
+
+    //
+    Context& GetThreadContext(uint32_t sortKey) override { return threads_.get(sortKey); }
     //
     CameraInterface& GetCamera() override { return camera_; }
     //
     void SetDrawColor(float r, float g, float b, float a = 1.0f) override { drawColor_ = simd_make_float4(r, g, b, a); }
     //
-    void Print(float x, float y, std::string msg) override
+    // 固定の文字列は StringTable に登録して、次のフレームからはコピーしない(しばらく使わなければ捨てる)
+    void Print(float x, float y, std::string_view msg) override
+    {
+        textBuffer_.push_back({strings_.intern(msg), simd_make_float2(x, y), drawColor_});
+    }
+    // 書式付きの文字列は毎回変わるので FrameArena に直接書く
+    void PrintV(float x, float y, const char* fmt, va_list args) override
     {
-        TextBuffer buff;
-        buff.message = msg;
-        buff.pos     = simd_make_float2(x, y);
-        buff.color   = drawColor_;
-        textBuffer_.emplace_back(buff);
+        textBuffer_.push_back({arena_->vformat(fmt, args), simd_make_float2(x, y), drawColor_});
     }
     //
     void DrawLine2D(simd::float2 from, simd::float2 to) override
@@ -100,6 +210,13 @@ class ContextImpl : public Context
         render2d_.drawRect(pos[0], pos[1], size[0], size[1]);
     }
     //
+    void FillRect2D(simd::float2 pos, simd::float2 size) override
+    {
+        auto end = pos + size;
+        render2d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render2d_.fillRect(pos[0], pos[1], end[0], end[1]);
+    }
+    //
     void DrawLine3D(simd::float3 from, simd::float3 to) override
     {
         render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
@@ -123,6 +240,93 @@ class ContextImpl : public Context
         render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
         render3d_.drawPlane(v0, v1, v2, v3);
     }
+    //
+    void DrawLines3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawLines(points, count, colors);
+    }
+    //
+    void DrawTriangles3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawTriangles(points, count, colors);
+    }
+    //
+    void DrawLineStrip2D(const simd::float2* points, size_t count, const simd::float4* colors) override
+    {
+        render2d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render2d_.drawLineStrip(points, count, colors);
+    }
+    //
+    void DrawLineStrip3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawLineStrip(points, count, colors);
+    }
+    //
+    void DrawRects2D(const simd::float2* pos, const simd::float2* size, size_t count) override
+    {
+        // DrawRect2D と同じ座標に変換してからまとめて追加
+        rectBuffer_.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            auto sz = size[i];
+            sz[0] += sz[0] < 0 ? 1 : -1;
+            sz[1] += sz[1] < 0 ? 1 : -1;
+            sz += pos[i];
+            rectBuffer_[i] = simd_make_float4(pos[i], sz);
+        }
+        render2d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render2d_.drawRects(rectBuffer_.data(), count);
+    }
+    //
+    void PushTransform(const simd::float4x4& transform) override { render3d_.pushTransform(transform); }
+    // 一番下(単位行列)は残す
+    void PopTransform() override { render3d_.popTransform(); }
+    //
+    void SetTransform(const simd::float4x4& transform) override { render3d_.setTransform(transform); }
+    //
+    void SetTranslucentSort3D(bool enable) override { render3d_.setSortTranslucent(enable); }
+    //
+    void DrawBox3D(simd::float3 center, simd::float3 size) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawBox(center, size);
+    }
+    //
+    void DrawSphere3D(simd::float3 center, float radius) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawSphere(center, radius);
+    }
+    //
+    void DrawArrow3D(simd::float3 from, simd::float3 to) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawArrow(from, to);
+    }
+    //
+    void DrawGrid3D(simd::float3 center, float size, int divisions) override
+    {
+        render3d_.setDrawColor(drawColor_[0], drawColor_[1], drawColor_[2], drawColor_[3]);
+        render3d_.drawGrid(center, size, divisions);
+    }
+    //
+    void DrawAxes3D(const simd::float4x4& transform, float length) override { render3d_.drawAxes(transform, length); }
+    //
+    GeometryHandle CreateGeometry() override { return render3d_.createGeometry(); }
+    //
+    bool BeginGeometry(GeometryHandle handle) override { return render3d_.beginGeometry(handle); }
+    //
+    void EndGeometry() override { render3d_.endGeometry(); }
+    //
+    void DrawGeometry(GeometryHandle handle, const simd::float4x4& transform) override
+    {
+        render3d_.drawGeometry(handle, transform);
+    }
+    //
+    void DestroyGeometry(GeometryHandle handle) override { render3d_.destroyGeometry(handle); }
 
     //
     void draw2d(TextDraw& textDraw)
@@ -130,22 +334,44 @@ class ContextImpl : public Context
         for (const auto& td : textBuffer_)
         {
             textDraw.setColor(td.color[0], td.color[1], td.color[2], td.color[3]);
-            textDraw.print(td.pos[0], td.pos[1], td.message.c_str());
+            textDraw.print(td.pos[0], td.pos[1], td.message);
         }
         textBuffer_.clear();
+        strings_.endFrame();
     }
 };
 
+//
+// 入力の記録、再生のフレームの区切りを Update と同じスレッドで付ける
+//
+void
+updateFrame(Context& context)
+{
+    InputRecord::beginFrame();
+    TestLoop::Update(context);
+}
+
 //
 //
 //
 class Renderer : public DelegateLoop
 {
   public:
-    Renderer() = default;
+    Renderer(int framesInFlight, bool pipelined) : _pacer(framesInFlight), _pipelined(pipelined) {}
     ~Renderer() override { finalize(); };
     void buildDepthStencilStates();
     void buildBuffers();
+    int  selectLOD(simd::float3 center, float radius) const;
+    void submitDraws();
+
+    // RenderGraph から呼ばれる(context はコマンドバッファ)
+    static void executeMainPass(void* user, void* context);
+
+    // RenderQueue から呼ばれる(context はエンコーダ)
+    static void executeMesh(void* user, void* context, uint32_t lod);
+    static void executePrim3D(void* user, void* context, uint32_t param);
+    static void executePrim2D(void* user, void* context, uint32_t param);
+    static void executeText(void* user, void* context, uint32_t param);
 
     const char* getTitle() const override { return "Metal Draw Test"; }
     void        initialize(MTL::Device* dev) override;
@@ -155,39 +381,62 @@ class Renderer : public DelegateLoop
     float       getScreenHeight() const override { return ScreenHeight; }
 
   private:
-    MTL::Device*            _pDevice;
-    MTL::CommandQueue*      _pCommandQueue;
-    MTL::DepthStencilState* _pDepthStencilState;
-    MTL::Buffer*            _pInstanceDataBuffer[kMaxFramesInFlight];
-    Texture                 _texture;
-    ShaderSet               _shaderSet;
-    Vertex                  _vertex;
-    Camera                  _camera;
-    TextDraw                _textdraw;
-    Simple2D                _render2d;
-    Simple3D                _render3d;
-    float                   _angle = 0.0f;
-    int                     _frame = 0;
-    dispatch_semaphore_t    _semaphore;
-    static const int        kMaxFramesInFlight;
+    MTL::Device*                            _pDevice;
+    MTL::CommandQueue*                      _pCommandQueue;
+    MTL::DepthStencilState*                 _pDepthStencilState;
+    MTL::Buffer*                            _pInstanceDataBuffer[FramePacer::MaxFramesInFlight]{};
+    std::vector<shader_types::InstanceData> _instanceScratch;
+    std::vector<uint8_t>                    _instanceLOD;
+    std::vector<uint32_t>                   _instanceOrder;
+    std::vector<simd_quatf>                 _instanceRotation;
+    std::vector<simd::float3>               _instanceTranslation;
+    std::vector<simd::float3>               _instanceScale;
+    std::vector<simd::float4>               _instanceColor;
+    Texture                                 _texture;
+    ShaderSet                               _shaderSet;
+    Vertex                                  _vertex;
+    GeometryPool                            _geometryPool;
+    GeometryPool::Handle                    _lodMesh[kLODLevels]{};
+    int                                     _lodLevels = 0;
+    Camera                                  _camera;
+    TextDraw                                _textdraw;
+    Simple2D                                _render2d;
+    Simple3D                                _render3d;
+    ContextImpl                             _context{_camera, _render2d, _render3d};
+    FrameArena                              _frameArena[FramePacer::MaxFramesInFlight];
+    RenderQueue                             _renderQueue;
+    RenderGraph                             _renderGraph;
+    PerfHud                                 _perfHud;
+    MetricsPublisher                        _metrics;
+    MTK::View*                              _pFrameView           = nullptr;
+    MTL::Buffer*                            _pFrameInstanceBuffer = nullptr;
+    std::array<size_t, kLODLevels>          _lodCount{};
+    std::array<size_t, kLODLevels>          _lodBase{};
+    RenderPipeline                          _boundPipeline = PipelineNone;
+    float                                   _angle         = 0.0f;
+    int                                     _frame = 0;
+    FramePacer                              _pacer;
+    SimPipeline                             _simPipeline;
+    bool                                    _pipelined  = false;
+    bool                                    _replayDone = false;
 };
 
-const int Renderer::kMaxFramesInFlight = 3;
-
 void
 Renderer::initialize(MTL::Device* dev)
 {
     _pDevice = dev;
 
     _pCommandQueue = _pDevice->newCommandQueue();
-    _shaderSet.load(_pDevice, "shader/default.metal", "vertexMain", "fragmentMain", false);
+    const char* vsMain = kCompactVertex ? (kCompactInstance ? "vertexMainCompactAll" : "vertexMainCompact")
+                                        : (kCompactInstance ? "vertexMainCompactInstance" : "vertexMain");
+    _shaderSet.load(_pDevice, "shader/default.metal", vsMain, "fragmentMain", false);
 
     buildDepthStencilStates();
 
     _texture.loadFromJPG(_pDevice, "res/lake.jpg", 256, 256);
 
     buildBuffers();
-    _camera.initialize(_pDevice, Renderer::kMaxFramesInFlight);
+    _camera.initialize(_pDevice, _pacer.getFramesInFlight());
     auto aspect = ScreenWidth / ScreenHeight;
     _camera.setViewport(45.0f, aspect, 0.03f, 500.0f);
 
@@ -195,37 +444,46 @@ Renderer::initialize(MTL::Device* dev)
     _render2d.initialize(_pDevice, ScreenWidth, ScreenHeight);
     _render3d.initialize(_pDevice);
 
-    _semaphore = dispatch_semaphore_create(Renderer::kMaxFramesInFlight);
+    if (kLiveMetrics)
+    {
+        _metrics.open();
+    }
+    if (kInputSampleHz > 0 && InputRecord::getMode() != InputRecord::Mode::Replay)
+    {
+        GamePad::StartSampler(kInputSampleHz);
+    }
+    if (_pipelined)
+    {
+        _simPipeline.start(updateFrame);
+    }
 }
 
 void
 Renderer::finalize()
 {
+    // GPU が使い終わるまで待ってから解放する
+    _simPipeline.stop();
+    GamePad::StopSampler();
+    InputRecord::stop();
+    _pacer.waitIdle();
     _pDepthStencilState->release();
-    for (int i = 0; i < kMaxFramesInFlight; ++i)
+    for (int i = 0; i < _pacer.getFramesInFlight(); ++i)
     {
-        _pInstanceDataBuffer[i]->release();
+        GpuTrack::release(_pInstanceDataBuffer[i], MemTrack::Category::Instance);
+        _pInstanceDataBuffer[i] = nullptr;
     }
     _pCommandQueue->release();
     _camera.release();
     _vertex.release();
+    _geometryPool.finalize();
     _texture.release();
     _shaderSet.release();
     _render2d.finalize();
     _render3d.finalize();
+    _metrics.close();
     _pDevice->release();
 }
 
-namespace shader_types
-{
-struct InstanceData
-{
-    simd::float4x4 instanceTransform;
-    simd::float3x3 instanceNormalTransform;
-    simd::float4   instanceColor;
-};
-} // namespace shader_types
-
 void
 Renderer::buildDepthStencilStates()
 {
@@ -241,45 +499,63 @@ Renderer::buildDepthStencilStates()
 void
 Renderer::buildBuffers()
 {
-    const float s = 0.5f;
-    _vertex.reserve(6 * 4);
-    _vertex.pushPoint(-s, -s, s, 0.0f, 1.0f);
-    _vertex.pushPoint(s, -s, s, 1.0f, 1.0f);
-    _vertex.pushPoint(s, s, s, 1.0f, 0.0f);
-    _vertex.pushPoint(-s, s, s, 0.0f, 0.0f);
-    _vertex.pushSqure(0, 1, 2, 3);
-    _vertex.pushPoint(s, -s, s, 0.0f, 1.0f);
-    _vertex.pushPoint(s, -s, -s, 1.0f, 1.0f);
-    _vertex.pushPoint(s, s, -s, 1.0f, 0.0f);
-    _vertex.pushPoint(s, s, s, 0.0f, 0.0f);
-    _vertex.pushSqure(4, 5, 6, 7);
-    _vertex.pushPoint(s, -s, -s, 0.0f, 1.0f);
-    _vertex.pushPoint(-s, -s, -s, 1.0f, 1.0f);
-    _vertex.pushPoint(-s, s, -s, 1.0f, 0.0f);
-    _vertex.pushPoint(s, s, -s, 0.0f, 0.0f);
-    _vertex.pushSqure(8, 9, 10, 11);
-    _vertex.pushPoint(-s, -s, -s, 0.0f, 1.0f);
-    _vertex.pushPoint(-s, -s, s, 1.0f, 1.0f);
-    _vertex.pushPoint(-s, s, s, 1.0f, 0.0f);
-    _vertex.pushPoint(-s, s, -s, 0.0f, 0.0f);
-    _vertex.pushSqure(12, 13, 14, 15);
-    _vertex.pushPoint(-s, s, s, 0.0f, 1.0f);
-    _vertex.pushPoint(s, s, s, 1.0f, 1.0f);
-    _vertex.pushPoint(s, s, -s, 1.0f, 0.0f);
-    _vertex.pushPoint(-s, s, -s, 0.0f, 0.0f);
-    _vertex.pushSqure(16, 17, 18, 19);
-    _vertex.pushPoint(-s, -s, -s, 0.0f, 1.0f);
-    _vertex.pushPoint(s, -s, -s, 1.0f, 1.0f);
-    _vertex.pushPoint(s, -s, s, 1.0f, 0.0f);
-    _vertex.pushPoint(-s, -s, s, 0.0f, 0.0f);
-    _vertex.pushSqure(20, 21, 22, 23);
-    _vertex.build(_pDevice);
-
-    const size_t instanceDataSize = kMaxFramesInFlight * kNumInstances * sizeof(shader_types::InstanceData);
-    for (size_t i = 0; i < kMaxFramesInFlight; ++i)
-    {
-        _pInstanceDataBuffer[i] = _pDevice->newBuffer(instanceDataSize, MTL::ResourceStorageModeManaged);
+    // 立方体は減らせる頂点が無いので、LOD が作れる球を並べる
+    static const auto sphere = PrimitiveMesh::makeSphere<64, 32>();
+    _vertex.assign(sphere);
+    _vertex.buildLOD(kLODLevels, 0.5f, kLODMaxError);
+    // LOD 毎に使う頂点だけを1つのプールへ格納する
+    const auto format = kCompactVertex ? Vertex::Format::Compact : Vertex::Format::Standard;
+    _geometryPool.initialize(_pDevice, Vertex::getStride(format), kPoolVertices, kPoolIndices);
+    _lodLevels = 0;
+    for (int lod = 0; lod < _vertex.getLODCount(); lod++)
+    {
+        auto handle = _vertex.store(_geometryPool, lod);
+        if (handle == GeometryPool::InvalidHandle)
+        {
+            std::cerr << "geometry pool overflow: LOD " << lod << std::endl;
+            break;
+        }
+        _lodMesh[lod] = handle;
+        _lodLevels    = lod + 1;
+    }
+    if (kCompactVertex)
+    {
+        const auto& info = _vertex.getPackInfo();
+        std::cout << "compact vertex: " << _geometryPool.getUsedVertices() * _geometryPool.getVertexStride()
+                  << " bytes, position error " << info.maxPositionError
+                  << ", normal error " << info.maxNormalError << " deg, texcoord error " << info.maxTexcoordError << std::endl;
+    }
+
+    _instanceScratch.resize(kNumInstances);
+    _instanceLOD.resize(kNumInstances);
+    _instanceOrder.resize(kNumInstances);
+    _instanceRotation.resize(kNumInstances);
+    _instanceTranslation.resize(kNumInstances);
+    _instanceScale.resize(kNumInstances);
+    _instanceColor.resize(kNumInstances);
+
+    const size_t instanceDataSize = kNumInstances * sizeof(shader_types::InstanceData);
+    for (int i = 0; i < _pacer.getFramesInFlight(); ++i)
+    {
+        _pInstanceDataBuffer[i] =
+            GpuTrack::newBuffer(_pDevice, instanceDataSize, MTL::ResourceStorageModeManaged, MemTrack::Category::Instance);
+    }
+}
+
+// 投影サイズが半分になる毎にLODを1段下げる
+int
+Renderer::selectLOD(simd::float3 center, float radius) const
+{
+    const int lodCount  = _lodLevels;
+    float     size      = _camera.getProjectedSize(center, radius);
+    float     threshold = kLODScreenSize;
+    int       lod       = 0;
+    while (lod + 1 < lodCount && size < threshold)
+    {
+        threshold *= 0.5f;
+        lod++;
     }
+    return lod;
 }
 
 void
@@ -289,22 +565,30 @@ Renderer::draw(MTK::View* pView)
     using simd::float4;
     using simd::float4x4;
 
-    auto* pPool = NS::AutoreleasePool::alloc()->init();
+    using Clock = std::chrono::steady_clock;
+    using Ms    = std::chrono::duration<float, std::milli>;
+
+    auto* pPool      = NS::AutoreleasePool::alloc()->init();
+    auto  frameStart = Clock::now();
+    MemTrack::beginFrame();
 
-    _frame                           = (_frame + 1) % Renderer::kMaxFramesInFlight;
+    // 空きを待ってから、このフレームの入力を読んでコマンドバッファを作る(待つ間に入力が古くならない)
+    _frame                           = _pacer.acquire();
+    const float  waitMs              = _pacer.getWaitMs();
     MTL::Buffer* pInstanceDataBuffer = _pInstanceDataBuffer[_frame];
 
-    auto* pCmd = _pCommandQueue->commandBuffer();
-    dispatch_semaphore_wait(_semaphore, DISPATCH_TIME_FOREVER);
-    Renderer* pRenderer = this;
-    pCmd->addCompletedHandler(^void(MTL::CommandBuffer* pCmd) {
-      dispatch_semaphore_signal(pRenderer->_semaphore);
+    auto*       pCmd   = _pCommandQueue->commandBuffer();
+    FramePacer* pPacer = &_pacer;
+    const int   slot   = _frame;
+    pCmd->addCompletedHandler(^void(MTL::CommandBuffer*) {
+      pPacer->complete(slot);
     });
 
     _angle += 0.001f;
 
     const float scl           = 0.5f;
-    auto*       pInstanceData = reinterpret_cast<shader_types::InstanceData*>(pInstanceDataBuffer->contents());
+    const float radius        = _vertex.getBoundingRadius() * scl;
+    auto*       pInstanceData = _instanceScratch.data();
 
     float3 objectPosition = {0.f, 0.f, -10.f};
 
@@ -313,6 +597,7 @@ Renderer::draw(MTK::View* pView)
     float4x4 rr0           = math::makeXRotate(_angle * 0.5);
     float4x4 rtInv         = math::makeTranslate({-objectPosition.x, -objectPosition.y, -objectPosition.z});
     float4x4 fullObjectRot = rt * rr1 * rr0 * rtInv;
+    auto     objectRot     = simd_mul(math::makeYRotateQuat(-_angle), math::makeXRotateQuat(_angle * 0.5f));
 
     size_t ix = 0;
     size_t iy = 0;
@@ -330,73 +615,302 @@ Renderer::draw(MTK::View* pView)
             iz += 1;
         }
 
-        float4x4 scale = math::makeScale((float3){scl, scl, scl});
-        float4x4 zrot  = math::makeZRotate(_angle * sinf((float)ix));
-        float4x4 yrot  = math::makeYRotate(_angle * cosf((float)iy));
+        float x = ((float)ix - (float)kInstanceRows / 3.f) * (3.f * scl) + scl;
+        float y = ((float)iy - (float)kInstanceColumns / 3.f) * (3.f * scl) + scl;
+        float z = ((float)iz - (float)kInstanceDepth / 3.f) * (3.f * scl);
 
-        float    x         = ((float)ix - (float)kInstanceRows / 3.f) * (3.f * scl) + scl;
-        float    y         = ((float)iy - (float)kInstanceColumns / 3.f) * (3.f * scl) + scl;
-        float    z         = ((float)iz - (float)kInstanceDepth / 3.f) * (3.f * scl);
-        float4x4 translate = math::makeTranslate(math::add(objectPosition, {x, y, z}));
+        float iDivNumInstances = i / (float)kNumInstances;
+        float r                = iDivNumInstances;
+        float g                = 1.0f - r;
+        float b                = sinf(M_PI * 2.0f * iDivNumInstances);
+
+        if (kCompactInstance)
+        {
+            // 行列を作らず回転/移動/拡大のまま渡す
+            auto zrot               = math::makeZRotateQuat(_angle * sinf((float)ix));
+            auto yrot               = math::makeYRotateQuat(_angle * cosf((float)iy));
+            _instanceRotation[i]    = simd_mul(objectRot, simd_mul(yrot, zrot));
+            _instanceTranslation[i] = objectPosition + simd_act(objectRot, (float3){x, y, z});
+            _instanceScale[i]       = (float3){scl, scl, scl};
+            _instanceColor[i]       = (float4){r, g, b, 1.0f};
+            _instanceLOD[i]         = selectLOD(_instanceTranslation[i], radius);
+        }
+        else
+        {
+            float4x4 scale     = math::makeScale((float3){scl, scl, scl});
+            float4x4 zrot      = math::makeZRotate(_angle * sinf((float)ix));
+            float4x4 yrot      = math::makeYRotate(_angle * cosf((float)iy));
+            float4x4 translate = math::makeTranslate(math::add(objectPosition, {x, y, z}));
 
-        pInstanceData[i].instanceTransform       = fullObjectRot * translate * yrot * zrot * scale;
-        pInstanceData[i].instanceNormalTransform = math::discardTranslation(pInstanceData[i].instanceTransform);
+            pInstanceData[i].instanceTransform       = fullObjectRot * translate * yrot * zrot * scale;
+            pInstanceData[i].instanceNormalTransform = math::discardTranslation(pInstanceData[i].instanceTransform);
+            pInstanceData[i].instanceColor           = (float4){r, g, b, 1.0f};
 
-        float iDivNumInstances         = i / (float)kNumInstances;
-        float r                        = iDivNumInstances;
-        float g                        = 1.0f - r;
-        float b                        = sinf(M_PI * 2.0f * iDivNumInstances);
-        pInstanceData[i].instanceColor = (float4){r, g, b, 1.0f};
+            _instanceLOD[i] = selectLOD(pInstanceData[i].instanceTransform.columns[3].xyz, radius);
+        }
 
         ix += 1;
     }
-    pInstanceDataBuffer->didModifyRange(NS::Range::Make(0, pInstanceDataBuffer->length()));
 
-    ContextImpl ctx{_camera, _render2d, _render3d};
-    TestLoop::Update(ctx);
+    // LOD毎にインスタンスをまとめて書き込む
+    auto& lodCount = _lodCount;
+    auto& lodBase  = _lodBase;
+    lodCount.fill(0);
+    lodBase.fill(0);
+    for (auto lod : _instanceLOD)
+    {
+        lodCount[lod]++;
+    }
+    for (size_t lod = 1; lod < kLODLevels; lod++)
+    {
+        lodBase[lod] = lodBase[lod - 1] + lodCount[lod - 1];
+    }
+    {
+        auto slot = lodBase;
+        for (size_t i = 0; i < kNumInstances; ++i)
+        {
+            _instanceOrder[slot[_instanceLOD[i]]++] = i;
+        }
+    }
+    size_t instanceBytes = 0;
+    if (kCompactInstance)
+    {
+        auto* pDst = reinterpret_cast<CompactInstanceData*>(pInstanceDataBuffer->contents());
+        InstancePack::pack(_instanceRotation.data(), _instanceTranslation.data(), _instanceScale.data(), _instanceColor.data(),
+                           _instanceOrder.data(), kNumInstances, pDst);
+        instanceBytes = kNumInstances * sizeof(CompactInstanceData);
+    }
+    else
+    {
+        auto* pDst = reinterpret_cast<shader_types::InstanceData*>(pInstanceDataBuffer->contents());
+        for (size_t i = 0; i < kNumInstances; ++i)
+        {
+            pDst[i] = pInstanceData[_instanceOrder[i]];
+        }
+        instanceBytes = kNumInstances * sizeof(shader_types::InstanceData);
+    }
+    pInstanceDataBuffer->didModifyRange(NS::Range::Make(0, instanceBytes));
+
+    auto& ctx = _context;
+    ctx.beginFrame(_frameArena[_frame]);
+    if (_pipelined)
+    {
+        // 記録スレッドが作ったフレームを再生する(次のフレームの記録はこの後の描画と並行に進む)
+        _simPipeline.acquire().replay(ctx);
+    }
+    else
+    {
+        updateFrame(ctx);
+        ctx.mergeThreads();
+    }
 
     // Update camera state:
-    _camera.update(_frame);
+    {
+        MemTrack::Scope scope(MemTrack::Category::Camera);
+        _camera.update(_frame);
+        _render3d.setViewMatrix(_camera.getViewMatrix());
+    }
+
+    _pFrameInstanceBuffer = pInstanceDataBuffer;
+    _pFrameView           = pView;
+    {
+        MemTrack::Scope scope(MemTrack::Category::Text);
+        _textdraw.setSize(32.0f);
+        ctx.draw2d(_textdraw);
+        if (kPerfHud)
+        {
+            _perfHud.draw(_render2d, _textdraw);
+        }
+    }
+    submitDraws();
+    _renderQueue.sort();
+
+    // パスを宣言して実行(今は画面に描く1パスだけ)
+    _renderGraph.clear();
+    auto drawable = _renderGraph.importResource("drawable");
+    auto mainPass = _renderGraph.addPass("main", executeMainPass, this);
+    _renderGraph.write(mainPass, drawable);
+    _renderGraph.compile();
+    _renderGraph.execute(pCmd);
+    PerfStats::add(PerfStats::Counter::UploadBytes, instanceBytes + _render2d.getUploadBytes() + _render3d.getUploadBytes());
 
-    // Begin render pass:
+    _textdraw.clear();
+    _render2d.clearDraw();
+    _render3d.clearDraw();
 
-    MTL::RenderPassDescriptor* pRpd = pView->currentRenderPassDescriptor();
-    MTL::RenderCommandEncoder* pEnc = pCmd->renderCommandEncoder(pRpd);
+    // commit の直前に入力を読み直してカメラのバッファを書き換える
+    // 積んだコマンドはバッファを指しているだけなので積み直さなくて良い(LOD と半透明の並びは前の行列のまま)
+    // パイプライン時は Update が記録スレッドで先に進んでいるので使わない
+    if (kLateLatch && !_pipelined && TestLoop::LateLatch(_camera))
+    {
+        MemTrack::Scope scope(MemTrack::Category::Camera);
+        _camera.update(_frame);
+    }
+    pCmd->presentDrawable(pView->currentDrawable());
+    _pacer.submit(_frame);
+    pCmd->commit();
+    if (_pipelined)
+    {
+        // 積み終わってから返す(記録側を1フレーム先までに抑えて、入力の遅延を増やさない)
+        _simPipeline.release();
+    }
+
+    pPool->release();
+    const float drawMs = Ms(Clock::now() - frameStart).count();
+    PerfStats::endFrame(drawMs - waitMs, waitMs, _pacer.getLatencyMs());
+    _metrics.publish(drawMs);
+
+    // 再生し終わったら結果を出して終わる(同じ記録なら毎回同じ動きなので比べられる)
+    if (InputRecord::isFinished() && !_replayDone)
+    {
+        _replayDone        = true;
+        const auto summary = PerfStats::getSummary();
+        const auto frames  = InputRecord::getFrameCount();
+        std::cout << "replayed " << frames << " frames, cpu over the last " << summary.frameCount << ": avg " << summary.cpuAvg
+                  << " ms p50 " << summary.cpuP50 << " p95 " << summary.cpuP95 << " p99 " << summary.cpuP99 << " max "
+                  << summary.cpuMax << " (recorded frame avg "
+                  << (frames > 0 ? InputRecord::getRecordedMs() / double(frames) : 0.0) << " ms)" << std::endl;
+        NS::Application::sharedApplication()->terminate(nullptr);
+    }
+}
+
+//
+// このフレームの描画を全てキー付きで積む
+//
+void
+Renderer::submitDraws()
+{
+    _renderQueue.clear();
+    for (int lod = 0; lod < _lodLevels; lod++)
+    {
+        if (_lodCount[lod] > 0)
+        {
+            // 詳細な LOD ほど手前にあるので先に描く
+            float depth = float(lod) / float(kLODLevels);
+            _renderQueue.submit(RenderQueue::makeKey(LayerWorld, PipelineMesh, 1, depth), executeMesh, this, lod);
+        }
+    }
+    // 3D は描画単位毎に、ビュー空間の距離を遠方クリップ面で [0, 1] にして積む
+    const float farZ = _camera.getFarZ();
+    _render3d.prepare();
+    const auto& draws3d = _render3d.getDrawItems();
+    for (uint32_t i = 0; i < draws3d.size(); i++)
+    {
+        const auto& item = draws3d[i];
+        const auto  key  = RenderQueue::makeKey(LayerWorld, getPipeline(item), 0, item.depth / farZ, item.translucent);
+        _renderQueue.submit(key, executePrim3D, this, i);
+    }
+    // 2D は重ねる順が決まっているので、半透明として積んだ順に奥から並ぶ深度を振る
+    _render2d.prepare();
+    const auto& draws2d = _render2d.getDrawItems();
+    for (uint32_t i = 0; i < draws2d.size(); i++)
+    {
+        const auto& item  = draws2d[i];
+        const float depth = 1.0f - float(i) / float(draws2d.size());
+        const auto  key   = RenderQueue::makeKey(LayerOverlay, getPipeline(item), item.texture, depth, true);
+        _renderQueue.submit(key, executePrim2D, this, i);
+    }
+    _renderQueue.submit(RenderQueue::makeKey(LayerText, PipelineText, 0, 0.0f), executeText, this);
+}
+
+//
+// 画面へのパス: RenderQueue に積んだ描画を全て実行する(context はコマンドバッファ)
+//
+void
+Renderer::executeMainPass(void* user, void* context)
+{
+    auto* self = static_cast<Renderer*>(user);
+    auto* pCmd = static_cast<MTL::CommandBuffer*>(context);
 
-    pEnc->setRenderPipelineState(_shaderSet.getRenderPipelineState());
-    pEnc->setDepthStencilState(_pDepthStencilState);
+    MTL::RenderPassDescriptor* pRpd = self->_pFrameView->currentRenderPassDescriptor();
+    MTL::RenderCommandEncoder* pEnc = pCmd->renderCommandEncoder(pRpd);
 
+    constexpr NS::UInteger CameraId = 2;
+    pEnc->setDepthStencilState(self->_pDepthStencilState);
     pEnc->setCullMode(MTL::CullModeBack);
     pEnc->setFrontFacingWinding(MTL::Winding::WindingCounterClockwise);
+    pEnc->setVertexBuffer(self->_camera.getCameraBuffer(), 0, CameraId);
+
+    self->_boundPipeline = PipelineNone;
+    self->_renderQueue.execute(pEnc);
+    pEnc->endEncoding();
+}
+
+//
+// インスタンス描画(続けて呼ばれた時は状態を設定し直さない)
+//
+void
+Renderer::executeMesh(void* user, void* context, uint32_t lod)
+{
+    auto* self = static_cast<Renderer*>(user);
+    auto* pEnc = static_cast<MTL::RenderCommandEncoder*>(context);
 
     constexpr NS::UInteger VertexId   = 0;
     constexpr NS::UInteger InstanceId = 1;
-    constexpr NS::UInteger CameraId   = 2;
+    constexpr NS::UInteger BoundsId   = 3;
     constexpr NS::UInteger offset     = 0;
     constexpr NS::UInteger TextureId0 = 0;
-    pEnc->setVertexBuffer(_vertex.getVertexBuffer(), offset, VertexId);
-    pEnc->setVertexBuffer(pInstanceDataBuffer, offset, InstanceId);
-    pEnc->setVertexBuffer(_camera.getCameraBuffer(), offset, CameraId);
-    pEnc->setFragmentTexture(_texture.get(), TextureId0);
-    pEnc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, _vertex.getIndexCount(),
-                                MTL::IndexType::IndexTypeUInt16, _vertex.getIndexBuffer(), 0, kNumInstances);
-    _render3d.render(pEnc);
-
-    _render2d.setupRender(pEnc);
-    _textdraw.setSize(32.0f);
-    ctx.draw2d(_textdraw);
-    _textdraw.render(pEnc);
-    _render2d.render(pEnc);
+    if (self->_boundPipeline != PipelineMesh)
+    {
+        self->_boundPipeline = PipelineMesh;
+        pEnc->setRenderPipelineState(self->_shaderSet.getRenderPipelineState());
+        pEnc->setVertexBuffer(self->_geometryPool.getVertexBuffer(), offset, VertexId);
+        pEnc->setVertexBuffer(self->_pFrameInstanceBuffer, offset, InstanceId);
+        if (self->_vertex.getFormat() == Vertex::Format::Compact)
+        {
+            pEnc->setVertexBytes(&self->_vertex.getBounds(), sizeof(Vertex::Bounds), BoundsId);
+        }
+        pEnc->setFragmentTexture(self->_texture.get(), TextureId0);
+    }
+    auto&       pool   = self->_geometryPool;
+    const auto  handle = self->_lodMesh[lod];
+    const auto& mesh   = pool.getMesh(handle);
+    pEnc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, mesh.indexCount, MTL::IndexType::IndexTypeUInt16,
+                                pool.getIndexBuffer(), pool.getIndexBufferOffset(handle), self->_lodCount[lod], mesh.baseVertex,
+                                self->_lodBase[lod]);
+    PerfStats::addDraw(mesh.indexCount, mesh.indexCount, self->_lodCount[lod]);
+}
 
-    _textdraw.clear();
-    _render2d.clearDraw();
-    _render3d.clearDraw();
+//
+//
+//
+void
+Renderer::executePrim3D(void* user, void* context, uint32_t param)
+{
+    MemTrack::Scope scope(MemTrack::Category::Vertex);
+    auto*           self     = static_cast<Renderer*>(user);
+    const auto      pipeline = getPipeline(self->_render3d.getDrawItems()[param]);
+    const bool      setup    = self->_boundPipeline != pipeline;
+    self->_boundPipeline     = pipeline;
+    self->_render3d.draw(static_cast<MTL::RenderCommandEncoder*>(context), param, setup);
+}
 
-    pEnc->endEncoding();
-    pCmd->presentDrawable(pView->currentDrawable());
-    pCmd->commit();
+//
+//
+//
+void
+Renderer::executePrim2D(void* user, void* context, uint32_t param)
+{
+    MemTrack::Scope scope(MemTrack::Category::Vertex);
+    auto*           self     = static_cast<Renderer*>(user);
+    const auto      pipeline = getPipeline(self->_render2d.getDrawItems()[param]);
+    const bool      setup    = self->_boundPipeline != pipeline;
+    self->_boundPipeline     = pipeline;
+    self->_render2d.draw(static_cast<MTL::RenderCommandEncoder*>(context), param, setup);
+}
 
-    pPool->release();
+//
+//
+//
+void
+Renderer::executeText(void* user, void* context, uint32_t)
+{
+    MemTrack::Scope scope(MemTrack::Category::Text);
+    auto*           self = static_cast<Renderer*>(user);
+    auto*           pEnc = static_cast<MTL::RenderCommandEncoder*>(context);
+    self->_boundPipeline = PipelineText;
+    self->_render2d.setupRender(pEnc);
+    self->_textdraw.render(pEnc);
 }
 
 //
@@ -405,7 +919,53 @@ Renderer::draw(MTK::View* pView)
 int
 main(int argc, char* argv[])
 {
-    Launch(std::make_shared<Renderer>());
+    int         framesInFlight = kFramesInFlight;
+    bool        pipelined      = false;
+    const char* recordPath     = nullptr;
+    const char* replayPath     = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+        if ((arg == "--frames-in-flight" || arg == "--record" || arg == "--replay") && i + 1 >= argc)
+        {
+            std::cerr << arg << " needs a value" << std::endl;
+            return 1;
+        }
+        if (arg == "--pipelined")
+        {
+            pipelined = true;
+        }
+        else if (arg == "--frames-in-flight")
+        {
+            framesInFlight = std::atoi(argv[++i]);
+            if (framesInFlight < FramePacer::MinFramesInFlight || framesInFlight > FramePacer::MaxFramesInFlight)
+            {
+                std::cerr << "frames in flight must be " << FramePacer::MinFramesInFlight << "-" << FramePacer::MaxFramesInFlight
+                          << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--record")
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay")
+        {
+            replayPath = argv[++i];
+        }
+    }
+    // 入力を記録するか、記録した入力で動かす(両方は指定できない)
+    if (recordPath != nullptr && replayPath != nullptr)
+    {
+        std::cerr << "--record and --replay can't be used together" << std::endl;
+        return 1;
+    }
+    if ((recordPath != nullptr && !InputRecord::startRecording(recordPath)) ||
+        (replayPath != nullptr && !InputRecord::startReplay(replayPath)))
+    {
+        return 1;
+    }
+    Launch(std::make_shared<Renderer>(framesInFlight, pipelined));
     return 0;
 }
 
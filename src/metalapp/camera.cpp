@@ -9,6 +9,7 @@
 
 #include "Metal/MTLBuffer.hpp"
 #include "camera.h"
+#include "gputrack.h"
 #include <algorithm>
 #include <iostream>
 #include <matrix.h>
@@ -42,6 +43,7 @@ struct Camera::Impl
     simd::float4x4            perspective_;
     simd::float4x4            view_;
     MTL::Buffer*              readBuffer_;
+    float                     farZ_ = 1.0f;
 
     simd::float3 eyePosition_;
     simd::float3 targetPosition_;
@@ -63,7 +65,7 @@ Camera::initialize(MTL::Device* dev, int keepFrame)
     impl_->buffers_.resize(keepFrame);
     for (auto& buff : impl_->buffers_)
     {
-        buff = dev->newBuffer(sizeof(CameraData), MTL::ResourceStorageModeManaged);
+        buff = GpuTrack::newBuffer(dev, sizeof(CameraData), MTL::ResourceStorageModeManaged, MemTrack::Category::Camera);
     }
     impl_->view_           = math::makeIdentity();
     impl_->eyePosition_    = simd_make_float3(0.0f, 4.0f, 20.0f);
@@ -99,6 +101,8 @@ Camera::update(int frameIndex)
     camera->worldTransform       = viewMtx;
     camera->worldNormalTransform = math::discardTranslation(camera->worldTransform);
 
+    impl_->view_ = viewMtx;
+
     buffer->didModifyRange(NS::Range::Make(0, sizeof(CameraData)));
 
     impl_->readBuffer_ = buffer;
@@ -110,11 +114,8 @@ Camera::release()
 {
     for (auto& buff : impl_->buffers_)
     {
-        if (buff)
-        {
-            buff->release();
-            buff = nullptr;
-        }
+        GpuTrack::release(buff, MemTrack::Category::Camera);
+        buff = nullptr;
     }
 }
 
@@ -150,6 +151,7 @@ void
 Camera::setViewport(float fovy, float aspect, float znear, float zfar)
 {
     impl_->perspective_ = math::makePerspective(fovy, aspect, znear, zfar);
+    impl_->farZ_        = zfar;
 }
 
 //
@@ -160,3 +162,26 @@ Camera::getCameraBuffer()
 }
 
 //
+const simd::float4x4&
+Camera::getViewMatrix() const
+{
+    return impl_->view_;
+}
+
+//
+float
+Camera::getFarZ() const
+{
+    return impl_->farZ_;
+}
+
+//
+float
+Camera::getProjectedSize(simd::float3 center, float radius) const
+{
+    auto dist = simd_distance(center, impl_->eyePosition_);
+    auto ys   = impl_->perspective_.columns[1][1];
+    return radius * ys / std::max(dist, 1.0e-4f);
+}
+
+//
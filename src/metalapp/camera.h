@@ -38,6 +38,13 @@ class Camera : public CameraInterface
     void setViewport(float fovy, float aspect, float znear, float zfar) override;
 
     MTL::Buffer* getCameraBuffer();
+    // 直前の update で作ったビュー行列
+    [[nodiscard]] const simd::float4x4& getViewMatrix() const;
+    // setViewport の zfar
+    [[nodiscard]] float getFarZ() const;
+
+    // 画面高さに対する球の投影サイズ(LOD選択用)
+    [[nodiscard]] float getProjectedSize(simd::float3 center, float radius) const;
 };
 
 //
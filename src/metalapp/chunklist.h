@@ -0,0 +1,181 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//
+// 固定サイズのチャンクを繋いだ追記専用リスト
+// 追加で再確保/コピーが起きない。clear() したチャンクは手元のプールに戻して再利用し、
+// 使用量が続けて少ない時だけ最大使用量(high-water)を下げて解放する
+//
+template <class T, size_t ChunkSize>
+class ChunkList
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(ChunkSize > 0);
+
+    using Chunk = std::unique_ptr<T[]>;
+
+    std::vector<Chunk> used_;
+    std::vector<Chunk> free_;
+    T*                 cur_       = nullptr;
+    T*                 end_       = nullptr;
+    size_t             highWater_ = 0; // 保持するチャンク数
+    size_t             windowMax_ = 0; // 縮小判定中の最大使用チャンク数
+    size_t             lowCount_  = 0; // 使用量が high-water の半分以下だった clear() の連続回数
+
+    //
+    void nextChunk()
+    {
+        if (free_.empty())
+        {
+            free_.emplace_back(new T[ChunkSize]);
+        }
+        used_.emplace_back(std::move(free_.back()));
+        free_.pop_back();
+        cur_ = used_.back().get();
+        end_ = cur_ + ChunkSize;
+    }
+
+  public:
+    static constexpr size_t chunkSize = ChunkSize;
+    // この回数続けて使用量が半分以下なら high-water を下げる
+    static constexpr size_t shrinkDelay = 120;
+
+    ChunkList()                            = default;
+    ChunkList(const ChunkList&)            = delete;
+    ChunkList& operator=(const ChunkList&) = delete;
+
+    //
+    void push_back(const T& value)
+    {
+        if (cur_ == end_)
+        {
+            nextChunk();
+        }
+        *cur_++ = value;
+    }
+
+    // 連続した最大 count 個の領域を返す(返した数は got)
+    T* append(size_t count, size_t& got)
+    {
+        if (cur_ == end_)
+        {
+            nextChunk();
+        }
+        got   = std::min(count, size_t(end_ - cur_));
+        cur_ += got;
+        return cur_ - got;
+    }
+
+    //
+    [[nodiscard]] size_t size() const
+    {
+        return used_.empty() ? 0 : (used_.size() - 1) * ChunkSize + size_t(cur_ - used_.back().get());
+    }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    // 要素 idx の参照(チャンクを跨いでも良い)
+    T&       operator[](size_t idx) { return used_[idx / ChunkSize][idx % ChunkSize]; }
+    const T& operator[](size_t idx) const { return used_[idx / ChunkSize][idx % ChunkSize]; }
+
+    // 先頭からチャンク毎に fn(const T* data, size_t count)
+    template <class Fn>
+    void forEachChunk(Fn&& fn) const
+    {
+        for (size_t i = 0; i < used_.size(); i++)
+        {
+            const T* data  = used_[i].get();
+            size_t   count = i + 1 < used_.size() ? ChunkSize : size_t(cur_ - data);
+            if (count > 0)
+            {
+                fn(data, count);
+            }
+        }
+    }
+
+    // [first, last) の範囲をチャンク毎に fn(T* data, size_t count)
+    template <class Fn>
+    void forEachRange(size_t first, size_t last, Fn&& fn)
+    {
+        while (first < last)
+        {
+            const size_t offset = first % ChunkSize;
+            const size_t count  = std::min(ChunkSize - offset, last - first);
+            fn(used_[first / ChunkSize].get() + offset, count);
+            first += count;
+        }
+    }
+
+    // dst に size() 個を詰めてコピー
+    void copyTo(T* dst) const
+    {
+        forEachChunk(
+            [&dst](const T* data, size_t count)
+            {
+                std::memcpy(dst, data, count * sizeof(T));
+                dst += count;
+            });
+    }
+
+    // 少なくとも count 個分のチャンクをプールに用意する
+    void reserve(size_t count)
+    {
+        const size_t chunks = (count + ChunkSize - 1) / ChunkSize;
+        while (used_.size() + free_.size() < chunks)
+        {
+            free_.emplace_back(new T[ChunkSize]);
+        }
+        highWater_ = std::max(highWater_, chunks);
+    }
+
+    // 全要素を捨ててチャンクをプールへ戻す
+    void clear()
+    {
+        const size_t inUse = used_.size();
+        for (auto& c : used_)
+        {
+            free_.emplace_back(std::move(c));
+        }
+        used_.clear();
+        cur_ = end_ = nullptr;
+
+        if (inUse > highWater_)
+        {
+            highWater_ = inUse;
+            lowCount_  = 0;
+            windowMax_ = 0;
+        }
+        else if (inUse * 2 <= highWater_)
+        {
+            windowMax_ = std::max(windowMax_, inUse);
+            if (++lowCount_ >= shrinkDelay)
+            {
+                // 直近の最大使用量まで下げる
+                highWater_ = windowMax_;
+                lowCount_  = 0;
+                windowMax_ = 0;
+            }
+        }
+        else
+        {
+            lowCount_  = 0;
+            windowMax_ = 0;
+        }
+        if (free_.size() > highWater_)
+        {
+            free_.resize(highWater_);
+        }
+    }
+
+    // 確保済みのチャンク数(使用中 + プール)
+    [[nodiscard]] size_t getChunkCount() const { return used_.size() + free_.size(); }
+    [[nodiscard]] size_t getHighWater() const { return highWater_; }
+};
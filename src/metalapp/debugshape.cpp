@@ -0,0 +1,219 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "debugshape.h"
+#include <cmath>
+
+namespace DebugShape
+{
+namespace
+{
+constexpr uint32_t White        = 0xffffffff;
+constexpr int      SphereSlices = 32;
+
+//
+class MeshBuilder
+{
+    std::vector<Vertex>&   vertices_;
+    std::vector<uint32_t>& indices_;
+
+  public:
+    MeshBuilder(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) : vertices_(vertices), indices_(indices) {}
+
+    uint32_t vertex(float x, float y, float z, uint32_t color = White)
+    {
+        vertices_.push_back({{x, y, z}, color});
+        return uint32_t(vertices_.size() - 1);
+    }
+    void line(uint32_t a, uint32_t b)
+    {
+        indices_.push_back(a);
+        indices_.push_back(b);
+    }
+    [[nodiscard]] uint32_t indexCount() const { return uint32_t(indices_.size()); }
+};
+
+//
+void
+buildBox(MeshBuilder& mb)
+{
+    uint32_t v[8];
+    for (int i = 0; i < 8; i++)
+    {
+        v[i] = mb.vertex(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+    }
+    // 各軸方向の4本ずつ
+    for (int axis = 1; axis < 8; axis <<= 1)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            if ((i & axis) == 0)
+            {
+                mb.line(v[i], v[i | axis]);
+            }
+        }
+    }
+}
+
+//
+void
+buildSphere(MeshBuilder& mb)
+{
+    for (int plane = 0; plane < 3; plane++)
+    {
+        uint32_t first = 0;
+        for (int i = 0; i < SphereSlices; i++)
+        {
+            const float rad = float(i) / SphereSlices * float(M_PI) * 2.0f;
+            const float s   = std::sin(rad);
+            const float c   = std::cos(rad);
+            uint32_t    idx = plane == 0 ? mb.vertex(c, s, 0.0f) : plane == 1 ? mb.vertex(0.0f, c, s) : mb.vertex(s, 0.0f, c);
+            if (i == 0)
+            {
+                first = idx;
+            }
+            else
+            {
+                mb.line(idx - 1, idx);
+            }
+        }
+        mb.line(first + SphereSlices - 1, first);
+    }
+}
+
+//
+void
+buildArrow(MeshBuilder& mb)
+{
+    const uint32_t root = mb.vertex(0.0f, 0.0f, 0.0f);
+    const uint32_t tip  = mb.vertex(0.0f, 0.0f, 1.0f);
+    mb.line(root, tip);
+    const float head = 0.15f;
+    const float back = 1.0f - head * 2.0f;
+    mb.line(tip, mb.vertex(head, 0.0f, back));
+    mb.line(tip, mb.vertex(-head, 0.0f, back));
+    mb.line(tip, mb.vertex(0.0f, head, back));
+    mb.line(tip, mb.vertex(0.0f, -head, back));
+}
+
+//
+void
+buildAxes(MeshBuilder& mb)
+{
+    const uint32_t colors[3] = {0xff0000ff, 0xff00ff00, 0xffff0000};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const uint32_t o = mb.vertex(0.0f, 0.0f, 0.0f, colors[axis]);
+        const uint32_t e = mb.vertex(axis == 0 ? 1.0f : 0.0f, axis == 1 ? 1.0f : 0.0f, axis == 2 ? 1.0f : 0.0f, colors[axis]);
+        mb.line(o, e);
+    }
+}
+
+} // namespace
+
+//
+//
+//
+void
+buildMeshes(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, Range (&ranges)[ShapeCount])
+{
+    vertices.clear();
+    indices.clear();
+    MeshBuilder mb{vertices, indices};
+
+    auto build = [&](Shape shape, auto func)
+    {
+        auto& range      = ranges[size_t(shape)];
+        range.firstIndex = mb.indexCount();
+        func(mb);
+        range.indexCount = mb.indexCount() - range.firstIndex;
+    };
+    build(Shape::Box, buildBox);
+    build(Shape::Sphere, buildSphere);
+    build(Shape::Line,
+          [](MeshBuilder& m)
+          {
+              auto a = m.vertex(0.0f, 0.0f, 0.0f);
+              m.line(a, m.vertex(1.0f, 0.0f, 0.0f));
+          });
+    build(Shape::Arrow, buildArrow);
+    build(Shape::Axes, buildAxes);
+}
+
+//
+//
+//
+Instance
+makeInstance(const float center[3], const float scale[3], uint32_t color)
+{
+    return {{scale[0], 0.0f, 0.0f, center[0], 0.0f, scale[1], 0.0f, center[1], 0.0f, 0.0f, scale[2], center[2]}, color};
+}
+
+//
+//
+//
+Instance
+makeLineInstance(const float from[3], const float to[3], uint32_t color)
+{
+    return {{to[0] - from[0], 0.0f, 0.0f, from[0], to[1] - from[1], 0.0f, 0.0f, from[1], to[2] - from[2], 0.0f, 0.0f, from[2]},
+            color};
+}
+
+//
+//
+//
+Instance
+makeArrowInstance(const float from[3], const float to[3], uint32_t color)
+{
+    float       z[3] = {to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+    const float len  = std::sqrt(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+    if (len <= 0.0f)
+    {
+        const float zero[3] = {0.0f, 0.0f, 0.0f};
+        return makeInstance(from, zero, color);
+    }
+    for (auto& e : z)
+    {
+        e /= len;
+    }
+    // Z とほぼ平行にならない方を基準にして直交基底を作る
+    const float up[3] = {std::fabs(z[1]) < 0.99f ? 0.0f : 1.0f, std::fabs(z[1]) < 0.99f ? 1.0f : 0.0f, 0.0f};
+    float       x[3]  = {up[1] * z[2] - up[2] * z[1], up[2] * z[0] - up[0] * z[2], up[0] * z[1] - up[1] * z[0]};
+    const float xl    = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+    for (auto& e : x)
+    {
+        e /= xl;
+    }
+    const float y[3] = {z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0]};
+
+    Instance inst;
+    for (int r = 0; r < 3; r++)
+    {
+        inst.rows[r * 4 + 0] = x[r] * len;
+        inst.rows[r * 4 + 1] = y[r] * len;
+        inst.rows[r * 4 + 2] = z[r] * len;
+        inst.rows[r * 4 + 3] = from[r];
+    }
+    inst.color = color;
+    return inst;
+}
+
+//
+//
+//
+Instance
+makeInstance(const float (&matrix)[16], uint32_t color)
+{
+    Instance inst;
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            inst.rows[r * 4 + c] = matrix[c * 4 + r];
+        }
+    }
+    inst.color = color;
+    return inst;
+}
+
+} // namespace DebugShape
@@ -0,0 +1,64 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+//
+// デバッグ表示用の形状(線のみ)
+// 単位形状を1度だけ作っておき、形状毎に変換行列と色のインスタンスを並べて描く
+//
+namespace DebugShape
+{
+
+//
+enum class Shape : uint8_t
+{
+    Box,    // 中心原点、1辺 1
+    Sphere, // 中心原点、半径 1 (3つの大円)
+    Line,   // (0,0,0) - (1,0,0)
+    Arrow,  // (0,0,0) - (0,0,1)、先端に矢じり
+    Axes,   // 原点から X/Y/Z 各 1 (赤/緑/青)
+    Count,
+};
+constexpr size_t ShapeCount = size_t(Shape::Count);
+
+// shader/prim3d.metal の VertexData と同じ並び
+struct Vertex
+{
+    float    position[3];
+    uint32_t color;
+};
+
+// shader/prim3d.metal の ShapeInstance と同じ並び(52 bytes)
+// rows は 3x4 のアフィン変換(行優先、4列目が平行移動)
+struct Instance
+{
+    float    rows[12];
+    uint32_t color;
+};
+static_assert(sizeof(Instance) == 52);
+
+// 形状毎のインデックス範囲
+struct Range
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// 全形状を1つの頂点/インデックス列(線リスト)にまとめる
+void buildMeshes(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, Range (&ranges)[ShapeCount]);
+
+// 各軸の拡大 + 平行移動
+Instance makeInstance(const float center[3], const float scale[3], uint32_t color);
+// Line を from - to に合わせる
+Instance makeLineInstance(const float from[3], const float to[3], uint32_t color);
+// from から to へ向ける(Z 軸を to - from に合わせ、長さで等倍に拡大)
+Instance makeArrowInstance(const float from[3], const float to[3], uint32_t color);
+// 列優先の 4x4 行列(simd::float4x4 と同じ並び)から
+Instance makeInstance(const float (&matrix)[16], uint32_t color);
+
+} // namespace DebugShape
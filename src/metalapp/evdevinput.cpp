@@ -0,0 +1,254 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "evdevinput.h"
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// 軸の番号(範囲が取れない時の既定値)
+struct AxisInfo
+{
+    uint16_t code;
+    int      min;
+    int      max;
+};
+constexpr AxisInfo Axes[PadSample::AxisCount] = {
+    {ABS_X, -32768, 32767}, {ABS_Y, -32768, 32767}, {ABS_RX, -32768, 32767},
+    {ABS_RY, -32768, 32767}, {ABS_Z, 0, 255},        {ABS_RZ, 0, 255},
+};
+
+// Linux のゲームパッドの割り当て(C と D は左と上の面ボタン)
+struct ButtonInfo
+{
+    uint16_t          code;
+    PadSample::Button button;
+};
+constexpr ButtonInfo Buttons[] = {
+    {BTN_DPAD_UP, PadSample::Up},       {BTN_DPAD_DOWN, PadSample::Down}, {BTN_DPAD_LEFT, PadSample::Left},
+    {BTN_DPAD_RIGHT, PadSample::Right}, {BTN_SOUTH, PadSample::A},        {BTN_EAST, PadSample::B},
+    {BTN_WEST, PadSample::C},           {BTN_NORTH, PadSample::D},        {BTN_TL, PadSample::ShoulderL},
+    {BTN_TR, PadSample::ShoulderR},     {BTN_START, PadSample::Menu},     {BTN_SELECT, PadSample::Options},
+};
+
+//
+int
+findButton(uint16_t code)
+{
+    for (const auto& info : Buttons)
+    {
+        if (info.code == code)
+        {
+            return info.button;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+//
+// 時刻を steady_clock(CLOCK_MONOTONIC)に揃える(ファイルの時は ioctl は失敗するのでそのまま)
+//
+EvdevInput::EvdevInput(const char* path)
+{
+    fd_ = ::open(path, O_RDONLY | O_NONBLOCK);
+    if (fd_ < 0)
+    {
+        std::cerr << "EvdevInput: cannot open " << path << std::endl;
+        return;
+    }
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd_, EVIOCSCLOCKID, &clock);
+    for (uint32_t i = 0; i < PadSample::AxisCount; i++)
+    {
+        input_absinfo info{};
+        if (ioctl(fd_, EVIOCGABS(Axes[i].code), &info) == 0 && info.maximum > info.minimum)
+        {
+            ranges_[i] = {info.minimum, info.maximum};
+        }
+        else
+        {
+            ranges_[i] = {Axes[i].min, Axes[i].max};
+        }
+    }
+    state_.connected = true;
+}
+
+//
+//
+//
+EvdevInput::~EvdevInput()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+//
+// SYN_REPORT までを state_ に反映して返す
+//
+bool
+EvdevInput::read(PadSample& sample, int timeoutMs)
+{
+    if (fd_ < 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return false;
+    }
+    for (;;)
+    {
+        if (pos_ == count_ && !fill(timeoutMs))
+        {
+            return false;
+        }
+        const auto& event = buffer_[pos_++];
+        if (event.type == EV_SYN && event.code == SYN_DROPPED)
+        {
+            // 取りこぼした分は分からないので、次の SYN_REPORT まで捨ててから今の状態を読み直す
+            dropping_ = true;
+        }
+        else if (event.type == EV_SYN && event.code == SYN_REPORT)
+        {
+            if (dropping_)
+            {
+                dropping_ = false;
+                if (!resync())
+                {
+                    continue;
+                }
+            }
+            state_.timeNs = uint64_t(event.input_event_sec) * 1000000000ull + uint64_t(event.input_event_usec) * 1000ull;
+            sample        = state_;
+            return true;
+        }
+        else if (!dropping_)
+        {
+            apply(event);
+        }
+    }
+}
+
+//
+// ボタンと軸の今の値をデバイスに問い合わせて state_ を作り直す(ファイルの時は失敗する)
+//
+bool
+EvdevInput::resync()
+{
+    uint8_t keys[KEY_MAX / 8 + 1]{};
+    if (ioctl(fd_, EVIOCGKEY(sizeof(keys)), keys) < 0)
+    {
+        return false;
+    }
+    input_event event{};
+    event.type = EV_KEY;
+    for (const auto& info : Buttons)
+    {
+        event.code  = info.code;
+        event.value = (keys[info.code / 8] >> (info.code % 8)) & 1;
+        apply(event);
+    }
+    // 十字キーが HAT の時は、ボタンの方で離した扱いにした後に HAT の値で上書きする
+    event.type    = EV_ABS;
+    auto readAxis = [&](uint16_t code)
+    {
+        input_absinfo info{};
+        if (ioctl(fd_, EVIOCGABS(code), &info) == 0)
+        {
+            event.code  = code;
+            event.value = info.value;
+            apply(event);
+        }
+    };
+    for (const auto& axis : Axes)
+    {
+        readAxis(axis.code);
+    }
+    readAxis(ABS_HAT0X);
+    readAxis(ABS_HAT0Y);
+    return true;
+}
+
+//
+// 読めるまで timeoutMs 待つ(ファイルの終わりでは待ってから false)
+//
+bool
+EvdevInput::fill(int timeoutMs)
+{
+    pollfd pfd{fd_, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+    {
+        return false;
+    }
+    const auto bytes = ::read(fd_, buffer_, sizeof(buffer_));
+    if (bytes <= 0)
+    {
+        if (bytes == 0 || errno != EAGAIN)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        }
+        return false;
+    }
+    pos_   = 0;
+    count_ = size_t(bytes) / sizeof(input_event);
+    return count_ > 0;
+}
+
+//
+// スティックの上は +(evdev は下が +)、十字キーは HAT で来ることもある
+//
+void
+EvdevInput::apply(const input_event& event)
+{
+    if (event.type == EV_KEY)
+    {
+        const int button = findButton(event.code);
+        if (button >= 0)
+        {
+            state_.setButton(PadSample::Button(button), event.value != 0);
+        }
+    }
+    else if (event.type == EV_ABS)
+    {
+        if (event.code == ABS_HAT0X)
+        {
+            state_.setButton(PadSample::Left, event.value < 0);
+            state_.setButton(PadSample::Right, event.value > 0);
+            return;
+        }
+        if (event.code == ABS_HAT0Y)
+        {
+            state_.setButton(PadSample::Up, event.value < 0);
+            state_.setButton(PadSample::Down, event.value > 0);
+            return;
+        }
+        for (uint32_t i = 0; i < PadSample::AxisCount; i++)
+        {
+            if (Axes[i].code != event.code)
+            {
+                continue;
+            }
+            const auto& range = ranges_[i];
+            const float t     = float(event.value - range.min) / float(range.max - range.min);
+            if (i == PadSample::TriggerL || i == PadSample::TriggerR)
+            {
+                state_.axes[i] = t;
+            }
+            else
+            {
+                const float v  = t * 2.0f - 1.0f;
+                state_.axes[i] = (i == PadSample::LeftY || i == PadSample::RightY) ? -v : v;
+            }
+        }
+    }
+}
+
+//
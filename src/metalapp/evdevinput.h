@@ -0,0 +1,47 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "inputsampler.h"
+#include <linux/input.h>
+
+//
+// Linux の evdev(/dev/input/event*)から読む InputBackend
+// input_event を SYN_REPORT まで読んでまとめて 1 つの PadSample にする(時刻はイベントの時刻)
+// input_event を並べた普通のファイルも読める(最後まで読んだら read は false を返す)
+// SYN_DROPPED の後は次の SYN_REPORT までを捨て、ボタンと軸の今の値を読み直してから続ける
+// (ファイルは読み直せないので、その SYN_REPORT は飛ばす)
+//
+class EvdevInput : public InputBackend
+{
+  public:
+    explicit EvdevInput(const char* path);
+    ~EvdevInput() override;
+    EvdevInput(const EvdevInput&)            = delete;
+    EvdevInput& operator=(const EvdevInput&) = delete;
+
+    [[nodiscard]] bool isOpen() const { return fd_ >= 0; }
+    bool               read(PadSample& sample, int timeoutMs) override;
+
+  private:
+    struct AxisRange
+    {
+        int min;
+        int max;
+    };
+
+    bool fill(int timeoutMs);
+    bool resync();
+    void apply(const input_event& event);
+
+    static constexpr size_t BufferSize = 64;
+
+    int         fd_ = -1;
+    PadSample   state_;
+    AxisRange   ranges_[PadSample::AxisCount];
+    input_event buffer_[BufferSize];
+    size_t      pos_      = 0;
+    size_t      count_    = 0;
+    bool        dropping_ = false; // SYN_DROPPED から次の SYN_REPORT まで
+};
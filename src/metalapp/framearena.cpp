@@ -0,0 +1,134 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "framearena.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+//
+// 今のブロックに入らなければ次のブロックへ(無ければ追加する)
+//
+void*
+FrameArena::allocate(size_t bytes, size_t align)
+{
+    auto aligned = [&](size_t offset) { return (offset + align - 1) & ~(align - 1); };
+
+    while (current_ < blocks_.size())
+    {
+        const auto&  block = blocks_[current_];
+        const size_t start = aligned(offset_);
+        if (start + bytes <= block.size)
+        {
+            offset_ = start + bytes;
+            return block.data.get() + start;
+        }
+        usedBefore_ += offset_;
+        current_++;
+        offset_ = 0;
+    }
+    // new[] の先頭は max_align_t に揃っている
+    const size_t size = std::max(blockSize_, bytes + align);
+    blocks_.push_back({std::make_unique<uint8_t[]>(size), size});
+    offset_ = aligned(0) + bytes;
+    return blocks_.back().data.get() + aligned(0);
+}
+
+//
+//
+//
+std::string_view
+FrameArena::copy(std::string_view str)
+{
+    auto* dst = static_cast<char*>(allocate(str.size() + 1, 1));
+    std::memcpy(dst, str.data(), str.size());
+    dst[str.size()] = '\0';
+    return {dst, str.size()};
+}
+
+//
+// 今のブロックの残りに書いてみて、入らなければ長さ分を確保して書き直す
+//
+std::string_view
+FrameArena::vformat(const char* fmt, va_list args)
+{
+    va_list retry;
+    va_copy(retry, args);
+
+    auto*      dst    = current_ < blocks_.size() ? reinterpret_cast<char*>(blocks_[current_].data.get() + offset_) : nullptr;
+    const auto remain = getRemain();
+    const int  len    = std::vsnprintf(dst, remain, fmt, args);
+    if (len < 0)
+    {
+        va_end(retry);
+        return {};
+    }
+    if (size_t(len) < remain)
+    {
+        offset_ += size_t(len) + 1;
+        va_end(retry);
+        return {dst, size_t(len)};
+    }
+    dst = static_cast<char*>(allocate(size_t(len) + 1, 1));
+    std::vsnprintf(dst, size_t(len) + 1, fmt, retry);
+    va_end(retry);
+    return {dst, size_t(len)};
+}
+
+//
+//
+//
+std::string_view
+FrameArena::format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    auto result = vformat(fmt, args);
+    va_end(args);
+    return result;
+}
+
+//
+//
+//
+void
+FrameArena::reset()
+{
+    current_    = 0;
+    offset_     = 0;
+    usedBefore_ = 0;
+}
+
+//
+//
+//
+size_t
+FrameArena::getRemain() const
+{
+    return current_ < blocks_.size() ? blocks_[current_].size - offset_ : 0;
+}
+
+//
+//
+//
+size_t
+FrameArena::getUsedBytes() const
+{
+    return usedBefore_ + offset_;
+}
+
+//
+//
+//
+size_t
+FrameArena::getCapacity() const
+{
+    size_t total = 0;
+    for (const auto& block : blocks_)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+//
@@ -0,0 +1,67 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+//
+// フレーム内だけ使うデータ用の線形アロケータ
+// reset で先頭に戻すだけ(ブロックは残すので、使う量が落ち着けばヒープ確保は起きない)
+//
+class FrameArena
+{
+  public:
+    static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+    explicit FrameArena(size_t blockSize = DefaultBlockSize) : blockSize_(blockSize) {}
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&&)                 = default;
+    FrameArena& operator=(FrameArena&&)      = default;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    // デストラクタは呼ばないので、破棄が不要な型だけ
+    template <class T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // NUL 終端してコピー
+    std::string_view copy(std::string_view str);
+    // printf 書式で直接書き込む(NUL 終端)
+    std::string_view vformat(const char* fmt, va_list args);
+    std::string_view format(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    // 確保したものを全て捨てる
+    void reset();
+
+    [[nodiscard]] size_t getUsedBytes() const;
+    [[nodiscard]] size_t getCapacity() const;
+    [[nodiscard]] size_t getBlockCount() const { return blocks_.size(); }
+
+  private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t                     size;
+    };
+
+    // 今のブロックの空き
+    [[nodiscard]] size_t getRemain() const;
+
+    std::vector<Block> blocks_;
+    size_t             blockSize_;
+    size_t             current_    = 0; // 使用中のブロック
+    size_t             offset_     = 0; // 使用中のブロックの先頭からの位置
+    size_t             usedBefore_ = 0; // current_ より前のブロックで使った量
+};
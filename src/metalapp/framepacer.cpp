@@ -0,0 +1,143 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "framepacer.h"
+#include <algorithm>
+
+namespace
+{
+//
+float
+toMs(FramePacer::Clock::duration d)
+{
+    return std::chrono::duration<float, std::milli>(d).count();
+}
+
+} // namespace
+
+//
+//
+//
+FramePacer::FramePacer(int framesInFlight) : framesInFlight_(std::clamp(framesInFlight, MinFramesInFlight, MaxFramesInFlight))
+{
+}
+
+//
+//
+//
+bool
+FramePacer::setFramesInFlight(int count)
+{
+    std::lock_guard lock(mutex_);
+    if (inFlight_ > 0)
+    {
+        return false;
+    }
+    framesInFlight_ = std::clamp(count, MinFramesInFlight, MaxFramesInFlight);
+    acquired_       = 0;
+    return true;
+}
+
+//
+// 空きが出るまで待つ(完了は積んだ順なので、次のスロットは必ず空いている)
+//
+int
+FramePacer::acquire()
+{
+    std::unique_lock lock(mutex_);
+    const auto       start = Clock::now();
+    cond_.wait(lock, [this] { return inFlight_ < framesInFlight_; });
+    waitMs_ = toMs(Clock::now() - start);
+    inFlight_++;
+    return int(acquired_++ % uint64_t(framesInFlight_));
+}
+
+//
+//
+//
+void
+FramePacer::submit(int slot)
+{
+    std::lock_guard lock(mutex_);
+    submitTime_[slot] = Clock::now();
+}
+
+//
+//
+//
+void
+FramePacer::complete(int slot)
+{
+    const auto now = Clock::now();
+    {
+        std::lock_guard lock(mutex_);
+        lastLatencyMs_ = toMs(now - submitTime_[slot]);
+        totalLatencyMs_ += lastLatencyMs_;
+        maxLatencyMs_ = std::max(maxLatencyMs_, lastLatencyMs_);
+        completed_++;
+        inFlight_--;
+    }
+    cond_.notify_all();
+}
+
+//
+//
+//
+void
+FramePacer::waitIdle()
+{
+    std::unique_lock lock(mutex_);
+    cond_.wait(lock, [this] { return inFlight_ == 0; });
+}
+
+//
+//
+//
+float
+FramePacer::getLatencyMs() const
+{
+    std::lock_guard lock(mutex_);
+    return float(lastLatencyMs_);
+}
+
+//
+//
+//
+float
+FramePacer::getAverageLatencyMs() const
+{
+    std::lock_guard lock(mutex_);
+    return completed_ > 0 ? float(totalLatencyMs_ / double(completed_)) : 0.0f;
+}
+
+//
+//
+//
+float
+FramePacer::getMaxLatencyMs() const
+{
+    std::lock_guard lock(mutex_);
+    return float(maxLatencyMs_);
+}
+
+//
+//
+//
+uint64_t
+FramePacer::getCompletedCount() const
+{
+    std::lock_guard lock(mutex_);
+    return completed_;
+}
+
+//
+//
+//
+int
+FramePacer::getInFlightCount() const
+{
+    std::lock_guard lock(mutex_);
+    return inFlight_;
+}
+
+//
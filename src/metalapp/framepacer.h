@@ -0,0 +1,68 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+
+//
+// GPU に積んでいるフレーム数を framesInFlight までに抑える
+//   acquire(): 空きを待ってスロット番号を返す(フレームの一番始め、入力を読む前に呼ぶ)
+//   submit(): コマンドバッファを commit した時
+//   complete(): GPU の完了ハンドラから(どのスレッドからでも良い)
+// submit から complete までの時間をフレーム毎の遅延として記録する
+// 少ないほど入力から表示までが短く、多いほど CPU と GPU が並行して動ける
+//
+class FramePacer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MinFramesInFlight = 1;
+    static constexpr int MaxFramesInFlight = 4;
+
+    explicit FramePacer(int framesInFlight = 3);
+    FramePacer(const FramePacer&)            = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // フレームが1つも積まれていない時だけ変えられる(範囲外は丸める)
+    bool setFramesInFlight(int count);
+    [[nodiscard]] int getFramesInFlight() const { return framesInFlight_; }
+
+    // 空いたスロットを返す(0..framesInFlight-1 を順に使う)
+    int  acquire();
+    void submit(int slot);
+    void complete(int slot);
+
+    // 積んだフレームが全て終わるまで待つ
+    void waitIdle();
+
+    // 直前の acquire で待った時間
+    [[nodiscard]] float getWaitMs() const { return waitMs_; }
+    // 最後に完了したフレームの submit から完了までの時間
+    [[nodiscard]] float getLatencyMs() const;
+    // これまでの平均と最大
+    [[nodiscard]] float getAverageLatencyMs() const;
+    [[nodiscard]] float getMaxLatencyMs() const;
+    [[nodiscard]] uint64_t getCompletedCount() const;
+    [[nodiscard]] int      getInFlightCount() const;
+
+  private:
+    mutable std::mutex      mutex_;
+    std::condition_variable cond_;
+    int                     framesInFlight_;
+    int                     inFlight_  = 0;
+    uint64_t                acquired_  = 0;
+    uint64_t                completed_ = 0;
+    float                   waitMs_    = 0.0f;
+
+    std::array<Clock::time_point, MaxFramesInFlight> submitTime_{};
+
+    double lastLatencyMs_  = 0.0;
+    double totalLatencyMs_ = 0.0;
+    double maxLatencyMs_   = 0.0;
+};
@@ -0,0 +1,671 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "framerecorder.h"
+#include "threadrecorders.h"
+#include <cstdio>
+
+//
+enum class FrameRecorder::Op : uint8_t
+{
+    SetDrawColor,
+    Print,
+    PrintFormatted,
+    DrawLine2D,
+    DrawRect2D,
+    FillRect2D,
+    DrawLine3D,
+    DrawRect3D,
+    DrawTriangle3D,
+    DrawPlane3D,
+    DrawLines3D,
+    DrawTriangles3D,
+    DrawLineStrip2D,
+    DrawLineStrip3D,
+    DrawRects2D,
+    PushTransform,
+    PopTransform,
+    SetTransform,
+    SetTranslucentSort3D,
+    DrawBox3D,
+    DrawSphere3D,
+    DrawArrow3D,
+    DrawGrid3D,
+    DrawAxes3D,
+    CreateGeometry,
+    BeginGeometry,
+    EndGeometry,
+    DrawGeometry,
+    DestroyGeometry,
+    SetEyePosition,
+    SetTargetPosition,
+    SetUpVector,
+    SetIdentity,
+    SetViewport,
+};
+
+namespace
+{
+// 記録した列を先頭から読む(配列は記録時に揃えた位置をそのまま指す)
+struct Reader
+{
+    const uint8_t* base;
+    size_t         pos;
+
+    template <class T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, base + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+    template <class T>
+    const T* getArray(size_t count, size_t align)
+    {
+        pos     = (pos + align - 1) & ~(align - 1);
+        auto* p = reinterpret_cast<const T*>(base + pos);
+        pos += sizeof(T) * count;
+        return p;
+    }
+    std::string_view getString()
+    {
+        const auto length = get<uint32_t>();
+        auto*      p      = reinterpret_cast<const char*>(base + pos);
+        pos += length;
+        return {p, length};
+    }
+};
+
+} // namespace
+
+//
+//
+//
+GeometryHandleMap::Handle
+GeometryHandleMap::create()
+{
+    const auto handle = next_++;
+    alive_.insert(handle);
+    return handle;
+}
+
+//
+//
+//
+void
+GeometryHandleMap::destroy(Handle handle)
+{
+    alive_.erase(handle);
+}
+
+//
+//
+//
+void
+GeometryHandleMap::bind(Handle handle, Handle real)
+{
+    if (handle >= real_.size())
+    {
+        real_.resize(handle + 1, 0);
+    }
+    real_[handle] = real;
+}
+
+//
+//
+//
+void
+GeometryHandleMap::unbind(Handle handle)
+{
+    if (handle < real_.size())
+    {
+        real_[handle] = 0;
+    }
+}
+
+//
+//
+//
+FrameRecorder::FrameRecorder(GeometryHandleMap& handles)
+    : handles_(&handles), threads_(std::make_unique<ThreadRecorders>(&handles))
+{
+}
+
+//
+//
+//
+FrameRecorder::FrameRecorder(GeometryHandleMap* handles) : handles_(handles) {}
+
+//
+//
+//
+FrameRecorder::~FrameRecorder() = default;
+
+//
+//
+//
+void
+FrameRecorder::clear()
+{
+    data_.clear();
+    commands_ = 0;
+    if (threads_)
+    {
+        threads_->clear();
+    }
+}
+
+//
+//
+//
+Context&
+FrameRecorder::GetThreadContext(uint32_t sortKey)
+{
+    return threads_ ? threads_->get(sortKey) : *this;
+}
+
+//
+// 記録と同じ並びで読み戻して target を呼ぶ
+//
+void
+FrameRecorder::replay(Context& target) const
+{
+    using simd::float2;
+    using simd::float3;
+    using simd::float4;
+    using simd::float4x4;
+
+    Reader rd{data_.data(), 0};
+    while (rd.pos < data_.size())
+    {
+        const auto op = rd.get<Op>();
+        switch (op)
+        {
+        case Op::SetDrawColor:
+        {
+            const auto c = rd.get<float4>();
+            target.SetDrawColor(c[0], c[1], c[2], c[3]);
+            break;
+        }
+        case Op::Print:
+        {
+            const auto pos = rd.get<float2>();
+            target.Print(pos[0], pos[1], rd.getString());
+            break;
+        }
+        case Op::PrintFormatted:
+        {
+            // 書式化済みの文字列は毎フレーム変わるので Print(登録される)ではなく Printf で渡す
+            const auto pos = rd.get<float2>();
+            const auto msg = rd.getString();
+            target.Printf(pos[0], pos[1], "%.*s", int(msg.size()), msg.data());
+            break;
+        }
+        case Op::DrawLine2D:
+        {
+            const auto from = rd.get<float2>();
+            target.DrawLine2D(from, rd.get<float2>());
+            break;
+        }
+        case Op::DrawRect2D:
+        {
+            const auto pos = rd.get<float2>();
+            target.DrawRect2D(pos, rd.get<float2>());
+            break;
+        }
+        case Op::FillRect2D:
+        {
+            const auto pos = rd.get<float2>();
+            target.FillRect2D(pos, rd.get<float2>());
+            break;
+        }
+        case Op::DrawLine3D:
+        {
+            const auto from = rd.get<float3>();
+            target.DrawLine3D(from, rd.get<float3>());
+            break;
+        }
+        case Op::DrawRect3D:
+        {
+            const auto* p = rd.getArray<float3>(4, ArrayAlign);
+            target.DrawRect3D(p[0], p[1], p[2], p[3]);
+            break;
+        }
+        case Op::DrawTriangle3D:
+        {
+            const auto* p = rd.getArray<float3>(3, ArrayAlign);
+            target.DrawTriangle3D(p[0], p[1], p[2]);
+            break;
+        }
+        case Op::DrawPlane3D:
+        {
+            const auto* p = rd.getArray<float3>(4, ArrayAlign);
+            target.DrawPlane3D(p[0], p[1], p[2], p[3]);
+            break;
+        }
+        case Op::DrawLines3D:
+        case Op::DrawTriangles3D:
+        case Op::DrawLineStrip3D:
+        {
+            const auto    count     = size_t(rd.get<uint64_t>());
+            const bool    hasColors = rd.get<uint8_t>() != 0;
+            const auto*   points    = rd.getArray<float3>(count, ArrayAlign);
+            const float4* colors    = hasColors ? rd.getArray<float4>(count, ArrayAlign) : nullptr;
+            if (op == Op::DrawLines3D)
+            {
+                target.DrawLines3D(points, count, colors);
+            }
+            else if (op == Op::DrawTriangles3D)
+            {
+                target.DrawTriangles3D(points, count, colors);
+            }
+            else
+            {
+                target.DrawLineStrip3D(points, count, colors);
+            }
+            break;
+        }
+        case Op::DrawLineStrip2D:
+        {
+            const auto    count     = size_t(rd.get<uint64_t>());
+            const bool    hasColors = rd.get<uint8_t>() != 0;
+            const auto*   points    = rd.getArray<float2>(count, ArrayAlign);
+            const float4* colors    = hasColors ? rd.getArray<float4>(count, ArrayAlign) : nullptr;
+            target.DrawLineStrip2D(points, count, colors);
+            break;
+        }
+        case Op::DrawRects2D:
+        {
+            const auto  count = size_t(rd.get<uint64_t>());
+            const auto* pos   = rd.getArray<float2>(count, ArrayAlign);
+            const auto* size  = rd.getArray<float2>(count, ArrayAlign);
+            target.DrawRects2D(pos, size, count);
+            break;
+        }
+        case Op::PushTransform:
+            target.PushTransform(*rd.getArray<float4x4>(1, ArrayAlign));
+            break;
+        case Op::PopTransform:
+            target.PopTransform();
+            break;
+        case Op::SetTransform:
+            target.SetTransform(*rd.getArray<float4x4>(1, ArrayAlign));
+            break;
+        case Op::SetTranslucentSort3D:
+            target.SetTranslucentSort3D(rd.get<uint8_t>() != 0);
+            break;
+        case Op::DrawBox3D:
+        {
+            const auto center = rd.get<float3>();
+            target.DrawBox3D(center, rd.get<float3>());
+            break;
+        }
+        case Op::DrawSphere3D:
+        {
+            const auto center = rd.get<float3>();
+            target.DrawSphere3D(center, rd.get<float>());
+            break;
+        }
+        case Op::DrawArrow3D:
+        {
+            const auto from = rd.get<float3>();
+            target.DrawArrow3D(from, rd.get<float3>());
+            break;
+        }
+        case Op::DrawGrid3D:
+        {
+            const auto center    = rd.get<float3>();
+            const auto size      = rd.get<float>();
+            const auto divisions = rd.get<int32_t>();
+            target.DrawGrid3D(center, size, divisions);
+            break;
+        }
+        case Op::DrawAxes3D:
+        {
+            const auto  length    = rd.get<float>();
+            const auto* transform = rd.getArray<float4x4>(1, ArrayAlign);
+            target.DrawAxes3D(*transform, length);
+            break;
+        }
+        case Op::CreateGeometry:
+            handles_->bind(rd.get<GeometryHandle>(), target.CreateGeometry());
+            break;
+        case Op::BeginGeometry:
+            target.BeginGeometry(resolve(rd.get<GeometryHandle>()));
+            break;
+        case Op::EndGeometry:
+            target.EndGeometry();
+            break;
+        case Op::DrawGeometry:
+        {
+            const auto  handle    = rd.get<GeometryHandle>();
+            const auto* transform = rd.getArray<float4x4>(1, ArrayAlign);
+            target.DrawGeometry(resolve(handle), *transform);
+            break;
+        }
+        case Op::DestroyGeometry:
+        {
+            const auto handle = rd.get<GeometryHandle>();
+            target.DestroyGeometry(resolve(handle));
+            handles_->unbind(handle);
+            break;
+        }
+        case Op::SetEyePosition:
+            target.GetCamera().setEyePosition(rd.get<float3>());
+            break;
+        case Op::SetTargetPosition:
+            target.GetCamera().setTargetPosition(rd.get<float3>());
+            break;
+        case Op::SetUpVector:
+            target.GetCamera().setUpVector(rd.get<float3>());
+            break;
+        case Op::SetIdentity:
+            target.GetCamera().setIdentity();
+            break;
+        case Op::SetViewport:
+        {
+            const auto v = rd.get<float4>();
+            target.GetCamera().setViewport(v[0], v[1], v[2], v[3]);
+            break;
+        }
+        }
+    }
+    if (threads_)
+    {
+        threads_->replay(target);
+    }
+}
+
+//
+void
+FrameRecorder::SetDrawColor(float r, float g, float b, float a)
+{
+    put(Op::SetDrawColor, simd::float4{r, g, b, a});
+}
+
+// 文字列は長さと本体をそのまま入れる
+void
+FrameRecorder::Print(float x, float y, std::string_view msg)
+{
+    put(Op::Print, simd::float2{x, y}, uint32_t(msg.size()));
+    write(msg.data(), msg.size());
+}
+
+// 長さを測ってから列に直接書き込む
+void
+FrameRecorder::PrintV(float x, float y, const char* fmt, va_list args)
+{
+    va_list copy;
+    va_copy(copy, args);
+    const int length = std::vsnprintf(nullptr, 0, fmt, copy);
+    va_end(copy);
+    if (length < 0)
+    {
+        return;
+    }
+    put(Op::PrintFormatted, simd::float2{x, y}, uint32_t(length));
+    const size_t pos = data_.size();
+    data_.resize(pos + length + 1);
+    std::vsnprintf(reinterpret_cast<char*>(data_.data() + pos), length + 1, fmt, args);
+    data_.pop_back();
+}
+
+//
+void
+FrameRecorder::DrawLine2D(simd::float2 from, simd::float2 to)
+{
+    put(Op::DrawLine2D, from, to);
+}
+
+//
+void
+FrameRecorder::DrawRect2D(simd::float2 pos, simd::float2 size)
+{
+    put(Op::DrawRect2D, pos, size);
+}
+
+//
+void
+FrameRecorder::FillRect2D(simd::float2 pos, simd::float2 size)
+{
+    put(Op::FillRect2D, pos, size);
+}
+
+//
+void
+FrameRecorder::DrawLine3D(simd::float3 from, simd::float3 to)
+{
+    put(Op::DrawLine3D, from, to);
+}
+
+//
+void
+FrameRecorder::DrawRect3D(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3)
+{
+    const simd::float3 points[] = {p0, p1, p2, p3};
+    put(Op::DrawRect3D);
+    align();
+    write(points, sizeof(points));
+}
+
+//
+void
+FrameRecorder::DrawTriangle3D(simd::float3 v0, simd::float3 v1, simd::float3 v2)
+{
+    const simd::float3 points[] = {v0, v1, v2};
+    put(Op::DrawTriangle3D);
+    align();
+    write(points, sizeof(points));
+}
+
+//
+void
+FrameRecorder::DrawPlane3D(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3)
+{
+    const simd::float3 points[] = {v0, v1, v2, v3};
+    put(Op::DrawPlane3D);
+    align();
+    write(points, sizeof(points));
+}
+
+//
+void
+FrameRecorder::DrawLines3D(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    putArray(Op::DrawLines3D, points, count, colors);
+}
+
+//
+void
+FrameRecorder::DrawTriangles3D(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    putArray(Op::DrawTriangles3D, points, count, colors);
+}
+
+//
+void
+FrameRecorder::DrawLineStrip2D(const simd::float2* points, size_t count, const simd::float4* colors)
+{
+    putArray(Op::DrawLineStrip2D, points, count, colors);
+}
+
+//
+void
+FrameRecorder::DrawLineStrip3D(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    putArray(Op::DrawLineStrip3D, points, count, colors);
+}
+
+//
+void
+FrameRecorder::DrawRects2D(const simd::float2* pos, const simd::float2* size, size_t count)
+{
+    put(Op::DrawRects2D, uint64_t(count));
+    align();
+    write(pos, sizeof(simd::float2) * count);
+    align();
+    write(size, sizeof(simd::float2) * count);
+}
+
+//
+void
+FrameRecorder::PushTransform(const simd::float4x4& transform)
+{
+    put(Op::PushTransform);
+    align();
+    write(&transform, sizeof(transform));
+}
+
+//
+void
+FrameRecorder::PopTransform()
+{
+    put(Op::PopTransform);
+}
+
+//
+void
+FrameRecorder::SetTransform(const simd::float4x4& transform)
+{
+    put(Op::SetTransform);
+    align();
+    write(&transform, sizeof(transform));
+}
+
+//
+void
+FrameRecorder::SetTranslucentSort3D(bool enable)
+{
+    put(Op::SetTranslucentSort3D, uint8_t(enable));
+}
+
+//
+void
+FrameRecorder::DrawBox3D(simd::float3 center, simd::float3 size)
+{
+    put(Op::DrawBox3D, center, size);
+}
+
+//
+void
+FrameRecorder::DrawSphere3D(simd::float3 center, float radius)
+{
+    put(Op::DrawSphere3D, center, radius);
+}
+
+//
+void
+FrameRecorder::DrawArrow3D(simd::float3 from, simd::float3 to)
+{
+    put(Op::DrawArrow3D, from, to);
+}
+
+//
+void
+FrameRecorder::DrawGrid3D(simd::float3 center, float size, int divisions)
+{
+    put(Op::DrawGrid3D, center, size, int32_t(divisions));
+}
+
+//
+void
+FrameRecorder::DrawAxes3D(const simd::float4x4& transform, float length)
+{
+    put(Op::DrawAxes3D, length);
+    align();
+    write(&transform, sizeof(transform));
+}
+
+// ハンドルは記録側で払い出して、再生した時に実際のハンドルと結び付ける
+// (handles_ はスレッドの間で共有しているので、スレッド用では作らない)
+Context::GeometryHandle
+FrameRecorder::CreateGeometry()
+{
+    if (!threads_)
+    {
+        return 0;
+    }
+    const auto handle = handles_->create();
+    put(Op::CreateGeometry, handle);
+    return handle;
+}
+
+//
+bool
+FrameRecorder::BeginGeometry(GeometryHandle handle)
+{
+    if (!threads_ || !handles_->isAlive(handle))
+    {
+        return false;
+    }
+    put(Op::BeginGeometry, handle);
+    return true;
+}
+
+//
+void
+FrameRecorder::EndGeometry()
+{
+    if (threads_)
+    {
+        put(Op::EndGeometry);
+    }
+}
+
+//
+void
+FrameRecorder::DrawGeometry(GeometryHandle handle, const simd::float4x4& transform)
+{
+    put(Op::DrawGeometry, handle);
+    align();
+    write(&transform, sizeof(transform));
+}
+
+//
+void
+FrameRecorder::DestroyGeometry(GeometryHandle handle)
+{
+    if (threads_ && handles_->isAlive(handle))
+    {
+        handles_->destroy(handle);
+        put(Op::DestroyGeometry, handle);
+    }
+}
+
+//
+void
+FrameRecorder::RecordingCamera::setEyePosition(simd::float3 eye)
+{
+    owner_.put(Op::SetEyePosition, eye);
+}
+
+//
+void
+FrameRecorder::RecordingCamera::setTargetPosition(simd::float3 tgt)
+{
+    owner_.put(Op::SetTargetPosition, tgt);
+}
+
+//
+void
+FrameRecorder::RecordingCamera::setUpVector(simd::float3 up)
+{
+    owner_.put(Op::SetUpVector, up);
+}
+
+//
+void
+FrameRecorder::RecordingCamera::setIdentity()
+{
+    owner_.put(Op::SetIdentity);
+}
+
+//
+void
+FrameRecorder::RecordingCamera::setViewport(float fovy, float aspect, float znear, float zfar)
+{
+    owner_.put(Op::SetViewport, simd::float4{fovy, aspect, znear, zfar});
+}
+
+//
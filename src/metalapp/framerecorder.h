@@ -0,0 +1,162 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <context.h>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+class ThreadRecorders;
+
+//
+// 記録側で払い出すジオメトリハンドルと、再生先で作った実際のハンドルの対応
+// 記録側(create/destroy/isAlive)と再生側(bind/resolve/unbind)は別のスレッドから使って良い
+// (互いのメンバーには触らない)
+//
+class GeometryHandleMap
+{
+    using Handle = Context::GeometryHandle;
+
+    // 記録スレッド
+    Handle                     next_ = 1;
+    std::unordered_set<Handle> alive_;
+    // 再生スレッド
+    std::vector<Handle> real_;
+
+  public:
+    Handle create();
+    void   destroy(Handle handle);
+    bool   isAlive(Handle handle) const { return alive_.count(handle) != 0; }
+
+    void   bind(Handle handle, Handle real);
+    void   unbind(Handle handle);
+    Handle resolve(Handle handle) const { return handle < real_.size() ? real_[handle] : 0; }
+};
+
+//
+// Context への呼び出しを記録して、後で別の Context に同じ順で再生する
+// 記録中に参照されるものは全てコピーする(文字列、配列、カメラの設定も)
+// clear してもバッファは残すので、量が落ち着けばヒープ確保は起きない
+// GetThreadContext で記録したものは、自分の記録の後にまとめて再生する
+//
+class FrameRecorder : public Context
+{
+  public:
+    explicit FrameRecorder(GeometryHandleMap& handles);
+    // スレッド用(ThreadRecorders が作る): ジオメトリの作成と編集はできず、GetThreadContext は自分を返す
+    // handles が nullptr なら DrawGeometry のハンドルは変換せずに渡す
+    explicit FrameRecorder(GeometryHandleMap* handles);
+    ~FrameRecorder() override;
+    // camera_ が自分を指しているのでコピーしない
+    FrameRecorder(const FrameRecorder&)            = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // 記録を捨てる(スレッドの分も)
+    void clear();
+    // 記録した順に target を呼ぶ(記録は残る)
+    void replay(Context& target) const;
+
+    // スレッドの分は含まない
+    [[nodiscard]] size_t getCommandCount() const { return commands_; }
+    [[nodiscard]] size_t getBytes() const { return data_.size(); }
+    [[nodiscard]] bool   empty() const { return commands_ == 0; }
+
+    Context&         GetThreadContext(uint32_t sortKey = 0) override;
+    CameraInterface& GetCamera() override { return camera_; }
+    void             SetDrawColor(float r, float g, float b, float a = 1.0f) override;
+    void             Print(float x, float y, std::string_view msg) override;
+    void             PrintV(float x, float y, const char* fmt, va_list args) override;
+    void             DrawLine2D(simd::float2 from, simd::float2 to) override;
+    void             DrawRect2D(simd::float2 pos, simd::float2 size) override;
+    void             FillRect2D(simd::float2 pos, simd::float2 size) override;
+    void             DrawLine3D(simd::float3 from, simd::float3 to) override;
+    void             DrawRect3D(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3) override;
+    void             DrawTriangle3D(simd::float3 v0, simd::float3 v1, simd::float3 v2) override;
+    void             DrawPlane3D(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3) override;
+    void             DrawLines3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) override;
+    void             DrawTriangles3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) override;
+    void             DrawLineStrip2D(const simd::float2* points, size_t count, const simd::float4* colors = nullptr) override;
+    void             DrawLineStrip3D(const simd::float3* points, size_t count, const simd::float4* colors = nullptr) override;
+    void             DrawRects2D(const simd::float2* pos, const simd::float2* size, size_t count) override;
+    void             PushTransform(const simd::float4x4& transform) override;
+    void             PopTransform() override;
+    void             SetTransform(const simd::float4x4& transform) override;
+    void             SetTranslucentSort3D(bool enable) override;
+    void             DrawBox3D(simd::float3 center, simd::float3 size) override;
+    void             DrawSphere3D(simd::float3 center, float radius) override;
+    void             DrawArrow3D(simd::float3 from, simd::float3 to) override;
+    void             DrawGrid3D(simd::float3 center, float size, int divisions) override;
+    void             DrawAxes3D(const simd::float4x4& transform, float length = 1.0f) override;
+    GeometryHandle   CreateGeometry() override;
+    bool             BeginGeometry(GeometryHandle handle) override;
+    void             EndGeometry() override;
+    void             DrawGeometry(GeometryHandle handle, const simd::float4x4& transform) override;
+    void             DestroyGeometry(GeometryHandle handle) override;
+
+  private:
+    enum class Op : uint8_t;
+
+    // カメラへの設定も同じ列に記録する
+    class RecordingCamera : public CameraInterface
+    {
+        FrameRecorder& owner_;
+
+      public:
+        explicit RecordingCamera(FrameRecorder& owner) : owner_(owner) {}
+        void setEyePosition(simd::float3 eye) override;
+        void setTargetPosition(simd::float3 tgt) override;
+        void setUpVector(simd::float3 up) override;
+        void setIdentity() override;
+        void setViewport(float fovy, float aspect, float znear, float zfar) override;
+    };
+
+    //
+    void write(const void* src, size_t bytes)
+    {
+        const size_t pos = data_.size();
+        data_.resize(pos + bytes);
+        std::memcpy(data_.data() + pos, src, bytes);
+    }
+    template <class... Args>
+    void put(Op op, const Args&... args)
+    {
+        write(&op, sizeof(op));
+        (write(&args, sizeof(args)), ...);
+        commands_++;
+    }
+    // 配列は再生時にそのまま渡すので、先頭からの位置を揃えておく(vector の先頭は 16 バイト境界)
+    void align()
+    {
+        data_.resize((data_.size() + ArrayAlign - 1) & ~(ArrayAlign - 1));
+    }
+    // count と配列本体(colors は無ければ記録しない)
+    template <class T>
+    void putArray(Op op, const T* points, size_t count, const simd::float4* colors)
+    {
+        static_assert(alignof(T) <= ArrayAlign);
+        const uint8_t hasColors = colors != nullptr;
+        put(op, uint64_t(count), hasColors);
+        align();
+        write(points, sizeof(T) * count);
+        if (hasColors)
+        {
+            align();
+            write(colors, sizeof(simd::float4) * count);
+        }
+    }
+
+    static constexpr size_t ArrayAlign = 16;
+
+    [[nodiscard]] GeometryHandle resolve(GeometryHandle handle) const { return handles_ ? handles_->resolve(handle) : handle; }
+
+    GeometryHandleMap*               handles_;
+    std::unique_ptr<ThreadRecorders> threads_; // スレッド用の時は無い
+    RecordingCamera                  camera_{*this};
+    std::vector<uint8_t>             data_;
+    size_t                           commands_ = 0;
+};
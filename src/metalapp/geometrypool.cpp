@@ -0,0 +1,260 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include <Metal/Metal.hpp>
+
+#include "geometrypool.h"
+#include "gputrack.h"
+#include "rangealloc.h"
+#include "slotmap.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// インデックスバッファのオフセットを4バイト境界にする
+constexpr size_t IndexAlignment = 2;
+
+//
+struct Record
+{
+    GeometryPool::Mesh mesh;
+    size_t             vertexOffset = 0;
+    size_t             vertexCount  = 0;
+    size_t             indexOffset  = 0;
+    size_t             indexCount   = 0;
+
+    void updateMesh()
+    {
+        mesh.baseVertex  = static_cast<int32_t>(vertexOffset);
+        mesh.firstIndex  = static_cast<uint32_t>(indexOffset);
+        mesh.indexCount  = static_cast<uint32_t>(indexCount);
+        mesh.vertexCount = static_cast<uint32_t>(vertexCount);
+    }
+};
+
+} // namespace
+
+//
+//
+//
+struct GeometryPool::Impl
+{
+    MTL::Buffer*    vertexBuffer_ = nullptr;
+    MTL::Buffer*    indexBuffer_  = nullptr;
+    size_t          stride_       = 0;
+    RangeAllocator  vertexAlloc_;
+    RangeAllocator  indexAlloc_;
+    SlotMap<Record> records_;
+
+    uint8_t*  vertexPtr() { return static_cast<uint8_t*>(vertexBuffer_->contents()); }
+    uint16_t* indexPtr() { return static_cast<uint16_t*>(indexBuffer_->contents()); }
+
+    //
+    void initialize(MTL::Device* dev, size_t vertexStride, size_t maxVertices, size_t maxIndices)
+    {
+        stride_ = vertexStride;
+        vertexAlloc_.reset(maxVertices, 1);
+        indexAlloc_.reset(maxIndices, IndexAlignment);
+        vertexBuffer_ =
+            GpuTrack::newBuffer(dev, vertexStride * maxVertices, MTL::ResourceStorageModeManaged, MemTrack::Category::Vertex);
+        indexBuffer_ = GpuTrack::newBuffer(dev, indexAlloc_.getCapacity() * sizeof(uint16_t), MTL::ResourceStorageModeManaged,
+                                           MemTrack::Category::Index);
+    }
+    //
+    void finalize()
+    {
+        GpuTrack::release(vertexBuffer_, MemTrack::Category::Vertex);
+        GpuTrack::release(indexBuffer_, MemTrack::Category::Index);
+        vertexBuffer_ = nullptr;
+        indexBuffer_  = nullptr;
+        records_      = {};
+    }
+    //
+    Handle allocate(const void* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount)
+    {
+        auto voffset = vertexAlloc_.allocate(vertexCount);
+        if (voffset == RangeAllocator::npos)
+        {
+            return InvalidHandle;
+        }
+        auto ioffset = indexAlloc_.allocate(indexCount);
+        if (ioffset == RangeAllocator::npos)
+        {
+            vertexAlloc_.free(voffset, vertexCount);
+            return InvalidHandle;
+        }
+
+        std::memcpy(vertexPtr() + voffset * stride_, vertices, vertexCount * stride_);
+        std::memcpy(indexPtr() + ioffset, indices, indexCount * sizeof(uint16_t));
+        vertexBuffer_->didModifyRange(NS::Range::Make(voffset * stride_, vertexCount * stride_));
+        indexBuffer_->didModifyRange(NS::Range::Make(ioffset * sizeof(uint16_t), indexCount * sizeof(uint16_t)));
+
+        Record rec;
+        rec.vertexOffset = voffset;
+        rec.vertexCount  = vertexCount;
+        rec.indexOffset  = ioffset;
+        rec.indexCount   = indexCount;
+        rec.updateMesh();
+        const auto handle = records_.create(rec);
+        if (handle == InvalidHandle)
+        {
+            vertexAlloc_.free(voffset, vertexCount);
+            indexAlloc_.free(ioffset, indexCount);
+        }
+        return handle;
+    }
+    //
+    void free(Handle handle)
+    {
+        auto* rec = records_.get(handle);
+        if (rec == nullptr)
+        {
+            return;
+        }
+        vertexAlloc_.free(rec->vertexOffset, rec->vertexCount);
+        indexAlloc_.free(rec->indexOffset, rec->indexCount);
+        records_.destroy(handle);
+    }
+    //
+    // 移動先は RangeAllocator::compact で決める(前方にしか移らないので、その順に memmove すれば良い)
+    //
+    void defragment()
+    {
+        std::vector<RangeAllocator::Move> vmoves;
+        std::vector<RangeAllocator::Move> imoves;
+        records_.forEach(
+            [&](Handle h, Record& rec)
+            {
+                vmoves.push_back({rec.vertexOffset, 0, rec.vertexCount, h});
+                imoves.push_back({rec.indexOffset, 0, rec.indexCount, h});
+            });
+        const size_t vend = vertexAlloc_.compact(vmoves);
+        const size_t iend = indexAlloc_.compact(imoves);
+
+        auto move = [&](const std::vector<RangeAllocator::Move>& moves, uint8_t* base, size_t elemSize, size_t Record::*offset)
+        {
+            for (const auto& m : moves)
+            {
+                if (m.to != m.from)
+                {
+                    std::memmove(base + m.to * elemSize, base + m.from * elemSize, m.size * elemSize);
+                }
+                records_.get(m.id)->*offset = m.to;
+            }
+        };
+        move(vmoves, vertexPtr(), stride_, &Record::vertexOffset);
+        move(imoves, reinterpret_cast<uint8_t*>(indexPtr()), sizeof(uint16_t), &Record::indexOffset);
+        records_.forEach([](Handle, Record& rec) { rec.updateMesh(); });
+
+        if (vend > 0)
+        {
+            vertexBuffer_->didModifyRange(NS::Range::Make(0, vend * stride_));
+        }
+        if (iend > 0)
+        {
+            indexBuffer_->didModifyRange(NS::Range::Make(0, iend * sizeof(uint16_t)));
+        }
+    }
+};
+
+//
+GeometryPool::GeometryPool() : impl_(std::make_unique<Impl>()) {}
+
+//
+GeometryPool::~GeometryPool() { finalize(); }
+
+//
+void
+GeometryPool::initialize(MTL::Device* dev, size_t vertexStride, size_t maxVertices, size_t maxIndices)
+{
+    impl_->initialize(dev, vertexStride, maxVertices, maxIndices);
+}
+
+//
+void
+GeometryPool::finalize()
+{
+    impl_->finalize();
+}
+
+//
+GeometryPool::Handle
+GeometryPool::allocate(const void* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount)
+{
+    return impl_->allocate(vertices, vertexCount, indices, indexCount);
+}
+
+//
+void
+GeometryPool::free(Handle handle)
+{
+    impl_->free(handle);
+}
+
+//
+void
+GeometryPool::defragment()
+{
+    impl_->defragment();
+}
+
+//
+bool
+GeometryPool::isValid(Handle handle) const
+{
+    return impl_->records_.contains(handle);
+}
+
+//
+const GeometryPool::Mesh&
+GeometryPool::getMesh(Handle handle) const
+{
+    static const Mesh empty{};
+    const auto*       rec = impl_->records_.get(handle);
+    return rec ? rec->mesh : empty;
+}
+
+//
+size_t
+GeometryPool::getIndexBufferOffset(Handle handle) const
+{
+    return getMesh(handle).firstIndex * sizeof(uint16_t);
+}
+
+//
+size_t
+GeometryPool::getVertexStride() const
+{
+    return impl_->stride_;
+}
+
+//
+size_t
+GeometryPool::getUsedVertices() const
+{
+    return impl_->vertexAlloc_.getUsed();
+}
+
+//
+size_t
+GeometryPool::getUsedIndices() const
+{
+    return impl_->indexAlloc_.getUsed();
+}
+
+//
+MTL::Buffer*
+GeometryPool::getVertexBuffer()
+{
+    return impl_->vertexBuffer_;
+}
+
+//
+MTL::Buffer*
+GeometryPool::getIndexBuffer()
+{
+    return impl_->indexBuffer_;
+}
+
+//
@@ -0,0 +1,63 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+
+namespace MTL
+{
+class Device;
+class Buffer;
+} // namespace MTL
+
+//
+// 複数メッシュの頂点/インデックスを共有バッファにまとめて確保する
+// ハンドルは世代付き(解放したハンドルは番号が再利用されても別のメッシュを指さない)
+//
+class GeometryPool
+{
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+  public:
+    using Handle                          = uint32_t;
+    static constexpr Handle InvalidHandle = 0;
+
+    // drawIndexedPrimitives にそのまま渡せる範囲
+    struct Mesh
+    {
+        int32_t  baseVertex  = 0;
+        uint32_t firstIndex  = 0;
+        uint32_t indexCount  = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    GeometryPool();
+    virtual ~GeometryPool();
+
+    void initialize(MTL::Device* dev, size_t vertexStride, size_t maxVertices, size_t maxIndices);
+    void finalize();
+
+    // @return 確保できなければ InvalidHandle
+    Handle allocate(const void* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount);
+    // 古いハンドルなら何もしない
+    void free(Handle handle);
+
+    // 使用中の領域を先頭に詰める(GPUが参照中のフレームが無い時に呼ぶこと)
+    void defragment();
+
+    [[nodiscard]] bool isValid(Handle handle) const;
+    // 古いハンドルなら空のメッシュ(indexCount が 0)
+    [[nodiscard]] const Mesh& getMesh(Handle handle) const;
+    [[nodiscard]] size_t      getIndexBufferOffset(Handle handle) const;
+    [[nodiscard]] size_t      getVertexStride() const;
+    [[nodiscard]] size_t      getUsedVertices() const;
+    [[nodiscard]] size_t      getUsedIndices() const;
+
+    MTL::Buffer* getVertexBuffer();
+    MTL::Buffer* getIndexBuffer();
+};
+
+//
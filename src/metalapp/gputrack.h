@@ -0,0 +1,63 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "memtrack.h"
+#include <Metal/Metal.hpp>
+
+//
+// バッファ/テクスチャの生成と解放を MemTrack に記録する
+// (GPU がまだ使っていても release した時点で解放扱い)
+//
+namespace GpuTrack
+{
+
+//
+inline MTL::Buffer*
+newBuffer(MTL::Device* dev, size_t length, MTL::ResourceOptions options, MemTrack::Category category)
+{
+    auto* buffer = dev->newBuffer(length, options);
+    if (buffer)
+    {
+        MemTrack::recordAlloc(MemTrack::Kind::Gpu, category, buffer->allocatedSize());
+    }
+    return buffer;
+}
+
+// 内容をコピーして作る
+inline MTL::Buffer*
+newBuffer(MTL::Device* dev, const void* data, size_t length, MTL::ResourceOptions options, MemTrack::Category category)
+{
+    auto* buffer = dev->newBuffer(data, length, options);
+    if (buffer)
+    {
+        MemTrack::recordAlloc(MemTrack::Kind::Gpu, category, buffer->allocatedSize());
+    }
+    return buffer;
+}
+
+//
+inline MTL::Texture*
+newTexture(MTL::Device* dev, const MTL::TextureDescriptor* desc, MemTrack::Category category)
+{
+    auto* texture = dev->newTexture(desc);
+    if (texture)
+    {
+        MemTrack::recordAlloc(MemTrack::Kind::Gpu, category, texture->allocatedSize());
+    }
+    return texture;
+}
+
+// nullptr なら何もしない
+inline void
+release(MTL::Resource* resource, MemTrack::Category category)
+{
+    if (resource)
+    {
+        MemTrack::recordFree(MemTrack::Kind::Gpu, category, resource->allocatedSize());
+        resource->release();
+    }
+}
+
+} // namespace GpuTrack
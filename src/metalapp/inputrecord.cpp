@@ -0,0 +1,364 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "inputrecord.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace InputRecord
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr int AxisCount = 6;
+
+enum Flag : uint8_t
+{
+    FlagEnabled = 0x10,
+    FlagButtons = 0x20,
+    FlagAxes    = 0x40,
+};
+
+// パッド毎の直前の値(変わった所だけ読み書きする)
+struct PadRecord
+{
+    bool     enabled = false;
+    uint32_t buttons = 0;
+    float    axes[AxisCount]{};
+};
+
+FILE*                 file_ = nullptr;
+Mode                  mode_ = Mode::Off;
+PadRecord             last_[MaxPads];
+Clock::time_point     lastFrame_;
+uint64_t              recordedUs_ = 0;
+std::atomic<uint64_t> frames_{0};
+std::atomic<bool>     finished_{false};
+
+//
+// Button は押下と前のフレームの押下を直接は返さないので On/Release から戻す
+//
+uint32_t
+packButtons(const GamePad::PadState& state)
+{
+    const GamePad::PadState::Button* buttons[] = {
+        &state.buttonUp, &state.buttonDown, &state.buttonLeft, &state.buttonRight, &state.buttonA,    &state.buttonB,
+        &state.buttonC,  &state.buttonD,    &state.shoulderL,  &state.shoulderR,   &state.buttonMenu, &state.buttonOptions,
+    };
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        const bool on   = buttons[i]->Pressed();
+        const bool prev = on ? !buttons[i]->On() : buttons[i]->Release();
+        bits |= (on ? 1u << i : 0u) | (prev ? 1u << (i + 12) : 0u);
+    }
+    return bits;
+}
+
+//
+void
+unpackButtons(uint32_t bits, GamePad::PadState& state)
+{
+    GamePad::PadState::Button* buttons[] = {
+        &state.buttonUp, &state.buttonDown, &state.buttonLeft, &state.buttonRight, &state.buttonA,    &state.buttonB,
+        &state.buttonC,  &state.buttonD,    &state.shoulderL,  &state.shoulderR,   &state.buttonMenu, &state.buttonOptions,
+    };
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        const GamePad::PadState::Button newState{(bits & 1u << i) != 0, (bits & 1u << (i + 12)) != 0};
+        *buttons[i] = newState;
+    }
+}
+
+//
+template <class T>
+bool
+put(const T& value)
+{
+    return std::fwrite(&value, sizeof(T), 1, file_) == 1;
+}
+
+// 書けなかったら(ディスクが一杯など)記録をやめる
+void
+writeFailed()
+{
+    perror("input record");
+    mode_ = Mode::Off;
+    stop();
+}
+
+//
+template <class T>
+bool
+get(T& value)
+{
+    return std::fread(&value, sizeof(T), 1, file_) == 1;
+}
+
+//
+void
+finish(const char* reason)
+{
+    if (reason != nullptr)
+    {
+        std::cerr << "input replay: " << reason << " at frame " << frames_.load() << std::endl;
+    }
+    finished_.store(true, std::memory_order_release);
+}
+
+//
+// 次のレコードの先頭を読んで、期待した種類とパッドか確かめる
+//
+bool
+readTag(Call call, int idx, uint8_t& flags)
+{
+    uint8_t tag = 0;
+    if (!get(tag))
+    {
+        finish(call == Call::Frame ? nullptr : "unexpected end of file");
+        return false;
+    }
+    if (Call(tag & 3) != call || ((tag >> 2) & 3) != idx)
+    {
+        finish("diverged from the recording");
+        return false;
+    }
+    flags = tag & 0xf0;
+    return true;
+}
+
+} // namespace
+
+//
+//
+//
+bool
+startRecording(const char* path)
+{
+    stop();
+    file_ = std::fopen(path, "wb");
+    if (file_ == nullptr)
+    {
+        perror(path);
+        return false;
+    }
+    const FileHeader header{Magic, Version};
+    if (!put(header))
+    {
+        writeFailed();
+        return false;
+    }
+    mode_ = Mode::Record;
+    return true;
+}
+
+//
+//
+//
+bool
+startReplay(const char* path)
+{
+    stop();
+    file_ = std::fopen(path, "rb");
+    if (file_ == nullptr)
+    {
+        perror(path);
+        return false;
+    }
+    FileHeader header{};
+    if (!get(header) || header.magic != Magic || header.version != Version)
+    {
+        std::cerr << path << ": not an input recording" << std::endl;
+        stop();
+        return false;
+    }
+    mode_ = Mode::Replay;
+    return true;
+}
+
+//
+//
+//
+void
+stop()
+{
+    // 記録はバッファに残っている分を閉じる時に書くので、ここでも失敗し得る
+    if (file_ != nullptr && std::fclose(file_) != 0 && mode_ == Mode::Record)
+    {
+        perror("input record");
+    }
+    file_ = nullptr;
+    mode_       = Mode::Off;
+    recordedUs_ = 0;
+    for (auto& pad : last_)
+    {
+        pad = PadRecord{};
+    }
+    lastFrame_ = Clock::time_point{};
+    frames_.store(0);
+    finished_.store(false);
+}
+
+//
+//
+//
+Mode
+getMode()
+{
+    return mode_;
+}
+
+//
+//
+//
+bool
+isFinished()
+{
+    return finished_.load(std::memory_order_acquire);
+}
+
+//
+//
+//
+uint64_t
+getFrameCount()
+{
+    return frames_.load(std::memory_order_relaxed);
+}
+
+//
+//
+//
+double
+getRecordedMs()
+{
+    return double(recordedUs_) / 1000.0;
+}
+
+//
+//
+//
+void
+beginFrame()
+{
+    if (mode_ == Mode::Record)
+    {
+        const auto now = Clock::now();
+        const auto us  = lastFrame_ == Clock::time_point{}
+                             ? 0
+                             : std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame_).count();
+        lastFrame_     = now;
+        if (!put(uint8_t(Call::Frame)) || !put(uint32_t(us)))
+        {
+            writeFailed();
+            return;
+        }
+        recordedUs_ += uint64_t(us);
+        frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (mode_ == Mode::Replay && !isFinished())
+    {
+        uint8_t  flags = 0;
+        uint32_t us    = 0;
+        if (readTag(Call::Frame, 0, flags) && get(us))
+        {
+            recordedUs_ += us;
+            frames_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+//
+//
+//
+void
+record(Call call, int idx, const GamePad::PadState& state, bool result)
+{
+    if (mode_ != Mode::Record || idx < 0 || idx >= MaxPads)
+    {
+        return;
+    }
+    PadRecord cur;
+    cur.enabled = result;
+    cur.buttons = packButtons(state);
+    cur.axes[0] = state.leftX;
+    cur.axes[1] = state.leftY;
+    cur.axes[2] = state.rightX;
+    cur.axes[3] = state.rightY;
+    cur.axes[4] = state.triggerL;
+    cur.axes[5] = state.triggerR;
+
+    auto&         last  = last_[idx];
+    uint8_t       flags = cur.enabled ? FlagEnabled : 0;
+    const uint8_t tag   = uint8_t(call) | uint8_t(idx << 2);
+    if (cur.buttons != last.buttons)
+    {
+        flags |= FlagButtons;
+    }
+    if (std::memcmp(cur.axes, last.axes, sizeof(cur.axes)) != 0)
+    {
+        flags |= FlagAxes;
+    }
+    bool ok = put(uint8_t(tag | flags));
+    if (flags & FlagButtons)
+    {
+        ok = ok && put(cur.buttons);
+    }
+    if (flags & FlagAxes)
+    {
+        ok = ok && put(cur.axes);
+    }
+    if (!ok)
+    {
+        writeFailed();
+        return;
+    }
+    last = cur;
+}
+
+//
+// 記録と食い違ったら、それ以降はパッドが無いものとして返す
+//
+bool
+replay(Call call, int idx, GamePad::PadState& state, bool& result)
+{
+    if (mode_ != Mode::Replay)
+    {
+        return false;
+    }
+    uint8_t flags = 0;
+    if (idx < 0 || idx >= MaxPads || isFinished() || !readTag(call, idx, flags))
+    {
+        state.enabled_ = false;
+        result         = false;
+        return true;
+    }
+    auto& last   = last_[idx];
+    last.enabled = (flags & FlagEnabled) != 0;
+    if ((flags & FlagButtons) && !get(last.buttons))
+    {
+        finish("truncated record");
+    }
+    if ((flags & FlagAxes) && !get(last.axes))
+    {
+        finish("truncated record");
+    }
+    state.enabled_ = last.enabled;
+    unpackButtons(last.buttons, state);
+    state.leftX    = last.axes[0];
+    state.leftY    = last.axes[1];
+    state.rightX   = last.axes[2];
+    state.rightY   = last.axes[3];
+    state.triggerL = last.axes[4];
+    state.triggerR = last.axes[5];
+    result         = last.enabled;
+    return true;
+}
+
+} // namespace InputRecord
+
+//
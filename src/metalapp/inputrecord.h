@@ -0,0 +1,68 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <gamepad.h>
+
+//
+// GamePad::GetPadState の結果をファイルに記録して、後で同じ順に返す
+// 毎回同じカメラの動きになるので、性能の計測を繰り返せる
+//
+// ファイル: FileHeader の後にレコードが並ぶ(バイト順は書いたマシンのまま)
+//   1 バイト目: 下位 2 ビットが種類、次の 2 ビットがパッド番号、上位 4 ビットが Flag
+//   Frame:     uint32 前のフレームの時間(マイクロ秒)
+//   Pad:       Buttons なら uint32(下位 12 ビットが押下、次の 12 ビットが前のフレームの押下)
+//              Axes なら float x 6(leftX, leftY, rightX, rightY, triggerL, triggerR)
+//   前のレコード(同じパッド)から変わっていない値は書かない
+// 呼び出しの並びが記録と違ったら(パイプラインの有無などで)、そこで再生をやめる
+//
+namespace InputRecord
+{
+
+constexpr uint32_t Magic   = 0x5249544d; // "MTIR"
+constexpr uint32_t Version = 1;
+constexpr int      MaxPads = 4;
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+enum class Mode
+{
+    Off,
+    Record,
+    Replay,
+};
+
+// GetPadState と GetLatestPadState を分けて記録する
+enum class Call : uint8_t
+{
+    Frame,
+    Pad,
+    LatestPad,
+};
+
+bool startRecording(const char* path);
+bool startReplay(const char* path);
+// 記録中ならファイルを閉じる
+void stop();
+[[nodiscard]] Mode getMode();
+// 再生を最後まで読んだ(または記録と食い違った)
+[[nodiscard]] bool isFinished();
+// 記録、再生したフレーム数
+[[nodiscard]] uint64_t getFrameCount();
+// そのフレームまでの記録した時間の合計
+[[nodiscard]] double getRecordedMs();
+
+// 入力を読むスレッドでフレームの始めに呼ぶ(記録: 前のフレームの時間を書く、再生: 読み進める)
+void beginFrame();
+// 記録中なら結果を書く
+void record(Call call, int idx, const GamePad::PadState& state, bool result);
+// 再生中なら記録した結果を state に入れて true(result は GetPadState の戻り値)
+bool replay(Call call, int idx, GamePad::PadState& state, bool& result);
+
+} // namespace InputRecord
@@ -0,0 +1,238 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "inputsampler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+// 止める時に待つ最長の時間
+constexpr int ReadTimeoutMs = 10;
+
+} // namespace
+
+//
+//
+//
+bool
+PadSample::sameState(const PadSample& other) const
+{
+    if (connected != other.connected || buttons != other.buttons)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < AxisCount; i++)
+    {
+        if (axes[i] != other.axes[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+//
+//
+InputSampler::InputSampler()
+{
+    pending_.reserve(RingSize);
+    events_.reserve(RingSize);
+}
+
+//
+//
+//
+InputSampler::~InputSampler() { stop(); }
+
+//
+//
+//
+void
+InputSampler::start(std::unique_ptr<InputBackend> backend, uint64_t periodNs)
+{
+    stop();
+    backend_  = std::move(backend);
+    periodNs_ = std::max<uint64_t>(periodNs, 1);
+    stop_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this] { run(); });
+}
+
+//
+//
+//
+void
+InputSampler::stop()
+{
+    if (thread_.joinable())
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        thread_.join();
+    }
+    backend_.reset();
+}
+
+//
+// 変わった時だけ積む(同じ状態が続く間はリングを使わない)
+//
+void
+InputSampler::run()
+{
+    PadSample sample;
+    PadSample last;
+    while (!stop_.load(std::memory_order_relaxed))
+    {
+        if (!backend_->read(sample, ReadTimeoutMs) || sample.sameState(last))
+        {
+            continue;
+        }
+        last = sample;
+        if (!ring_.push(sample))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+//
+//
+//
+void
+InputSampler::collect()
+{
+    PadSample sample;
+    while (ring_.pop(sample))
+    {
+        pending_.push_back(sample);
+    }
+}
+
+//
+//
+//
+bool
+InputSampler::update(GamePad::PadState& state, uint64_t timeNs)
+{
+    collect();
+    return build(state, timeNs, true);
+}
+
+//
+//
+//
+bool
+InputSampler::peek(GamePad::PadState& state, uint64_t timeNs)
+{
+    collect();
+    return build(state, timeNs, false);
+}
+
+//
+// consume なら pending_ を events_ に移して、次の起点(last_ と prevButtons_)を進める
+//
+bool
+InputSampler::build(GamePad::PadState& state, uint64_t timeNs, bool consume)
+{
+    uint32_t         rising  = 0; // この間に押されたボタン
+    uint32_t         falling = 0; // この間に離されたボタン
+    uint32_t         current = last_.buttons;
+    const PadSample* before  = &last_;
+    const PadSample* after   = nullptr;
+    for (const auto& sample : pending_)
+    {
+        rising |= sample.buttons & ~current;
+        falling |= current & ~sample.buttons;
+        current = sample.buttons;
+        if (after == nullptr)
+        {
+            if (sample.timeNs <= timeNs)
+            {
+                before = &sample;
+            }
+            else
+            {
+                after = &sample;
+            }
+        }
+    }
+    const PadSample& latest = pending_.empty() ? last_ : pending_.back();
+
+    PadSample result = latest;
+    for (uint32_t i = 0; i < PadSample::AxisCount; i++)
+    {
+        result.axes[i] = before->axes[i];
+    }
+    // 変化した時しか積まないので before は何秒も前のことがある
+    // before の値は after の直前の 1 周期までは保たれていたので、補間はその間だけ
+    if (after != nullptr && after->timeNs > before->timeNs)
+    {
+        const uint64_t from = std::max(before->timeNs, after->timeNs - std::min(after->timeNs, periodNs_));
+        if (timeNs > from)
+        {
+            const float t = float(double(timeNs - from) / double(after->timeNs - from));
+            for (uint32_t i = 0; i < PadSample::AxisCount; i++)
+            {
+                result.axes[i] += (after->axes[i] - before->axes[i]) * t;
+            }
+        }
+    }
+    // 離されていても、この間に押されていれば押した扱い
+    // 前から押していても、一度離して押し直していれば新しい押下(On になる)
+    const uint32_t pressed = latest.buttons | rising;
+    makePadState(result, pressed, prevButtons_ & ~(falling & rising), state);
+
+    if (consume)
+    {
+        last_        = latest;
+        prevButtons_ = pressed;
+        events_.swap(pending_);
+        pending_.clear();
+    }
+    return result.connected;
+}
+
+//
+//
+//
+void
+InputSampler::makePadState(const PadSample& sample, uint32_t pressed, uint32_t prev, GamePad::PadState& state)
+{
+    auto setButton = [&](GamePad::PadState::Button& button, PadSample::Button id)
+    {
+        const uint32_t                  bit = 1u << id;
+        const GamePad::PadState::Button newState{(pressed & bit) != 0, (prev & bit) != 0};
+        button = newState;
+    };
+    state.enabled_ = sample.connected;
+    setButton(state.buttonUp, PadSample::Up);
+    setButton(state.buttonDown, PadSample::Down);
+    setButton(state.buttonLeft, PadSample::Left);
+    setButton(state.buttonRight, PadSample::Right);
+    setButton(state.buttonA, PadSample::A);
+    setButton(state.buttonB, PadSample::B);
+    setButton(state.buttonC, PadSample::C);
+    setButton(state.buttonD, PadSample::D);
+    setButton(state.shoulderL, PadSample::ShoulderL);
+    setButton(state.shoulderR, PadSample::ShoulderR);
+    setButton(state.buttonMenu, PadSample::Menu);
+    setButton(state.buttonOptions, PadSample::Options);
+    state.leftX    = sample.axes[PadSample::LeftX];
+    state.leftY    = sample.axes[PadSample::LeftY];
+    state.rightX   = sample.axes[PadSample::RightX];
+    state.rightY   = sample.axes[PadSample::RightY];
+    state.triggerL = sample.axes[PadSample::TriggerL];
+    state.triggerR = sample.axes[PadSample::TriggerR];
+}
+
+//
+//
+//
+uint64_t
+InputSampler::now()
+{
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+}
+
+//
@@ -0,0 +1,125 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "spscring.h"
+#include <atomic>
+#include <cinttypes>
+#include <gamepad.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//
+// ある時刻のパッドの状態(ボタンはビット、スティックは -1..1、トリガーは 0..1)
+//
+struct PadSample
+{
+    enum Button : uint32_t
+    {
+        Up,
+        Down,
+        Left,
+        Right,
+        A,
+        B,
+        C,
+        D,
+        ShoulderL,
+        ShoulderR,
+        Menu,
+        Options,
+        ButtonCount,
+    };
+    enum Axis : uint32_t
+    {
+        LeftX,
+        LeftY,
+        RightX,
+        RightY,
+        TriggerL,
+        TriggerR,
+        AxisCount,
+    };
+
+    uint64_t timeNs    = 0; // steady_clock
+    bool     connected = false;
+    uint32_t buttons   = 0; // 1 << Button
+    float    axes[AxisCount]{};
+
+    void setButton(Button button, bool on) { buttons = on ? buttons | (1u << button) : buttons & ~(1u << button); }
+    // 時刻以外が同じ
+    [[nodiscard]] bool sameState(const PadSample& other) const;
+};
+
+//
+// 入力デバイス(プラットフォーム毎に作る)
+// read は次の変化を timeoutMs まで待ち、読めれば sample に全体の状態と時刻を入れて true を返す
+//
+class InputBackend
+{
+  public:
+    virtual ~InputBackend() = default;
+    virtual bool read(PadSample& sample, int timeoutMs) = 0;
+};
+
+//
+// 専用のスレッドで backend を読み続け、状態が変わる度に時刻付きでリングに積む
+// 描画スレッドは update でそれまでに積まれたものを全て取り出して PadState を作る
+//   ボタン: 間に一度でも押されていれば押した扱い(1 フレームより短い押下も On になる)
+//           1 フレームに何度押されたかは getEvents で数える
+//   スティック、トリガー: 値は次のサンプルまで保たれているとみなし、変わったのは次のサンプルの直前の
+//           1 周期(periodNs)の間なので、そこだけ線形補間する(最新より後なら最新の値)
+//
+class InputSampler
+{
+  public:
+    static constexpr size_t   RingSize        = 1024;
+    static constexpr uint64_t DefaultPeriodNs = 8000000; // 125Hz(USB のパッドのよくある報告間隔)
+
+    InputSampler();
+    ~InputSampler();
+    InputSampler(const InputSampler&)            = delete;
+    InputSampler& operator=(const InputSampler&) = delete;
+
+    // periodNs は backend が状態を報告する間隔(ポーリングならその周期)
+    void start(std::unique_ptr<InputBackend> backend, uint64_t periodNs = DefaultPeriodNs);
+    // 読み出し中の read が返るのを待って止める
+    void stop();
+    [[nodiscard]] bool isRunning() const { return thread_.joinable(); }
+
+    // 以下は取り出し側(1 スレッドから)
+    // 前回から今までを取り出して state を作る(繋がっていなければ false)
+    bool update(GamePad::PadState& state, uint64_t timeNs);
+    // 同じように作るが、ボタンの押下は次の update に残す(commit 直前の読み直し用)
+    bool peek(GamePad::PadState& state, uint64_t timeNs);
+    // 直前の update で取り出したもの(古い順)
+    [[nodiscard]] const std::vector<PadSample>& getEvents() const { return events_; }
+    // リングが一杯で捨てた数
+    [[nodiscard]] uint64_t getDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // sample の内容を state に入れる
+    // pressed は押した扱いにするボタン、prev は前のフレームで押していたボタン
+    static void makePadState(const PadSample& sample, uint32_t pressed, uint32_t prev, GamePad::PadState& state);
+    // steady_clock の今の時刻
+    static uint64_t now();
+
+  private:
+    void run();
+    void collect();
+    bool build(GamePad::PadState& state, uint64_t timeNs, bool consume);
+
+    std::unique_ptr<InputBackend> backend_;
+    uint64_t                      periodNs_ = DefaultPeriodNs;
+    std::thread                   thread_;
+    std::atomic<bool>             stop_{false};
+    std::atomic<uint64_t>         dropped_{0};
+    SpscRing<PadSample, RingSize> ring_;
+
+    // 取り出し側
+    std::vector<PadSample> pending_; // リングから出したが、まだ update していない
+    std::vector<PadSample> events_;
+    PadSample              last_;            // 前の update までで最新
+    uint32_t               prevButtons_ = 0; // 前の update で押していた
+};
@@ -0,0 +1,93 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "instancepack.h"
+#include "packing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace InstancePack
+{
+namespace
+{
+// 1 回に変換するインスタンス数(作業領域がL1に収まる大きさ)
+constexpr size_t Block = 64;
+
+// 作業領域(4要素 x Block)
+struct Work
+{
+    alignas(64) float    rotation[Block * 4];
+    alignas(64) float    translation[Block * 4];
+    alignas(64) float    scale[Block * 4];
+    alignas(64) float    color[Block * 4];
+    alignas(64) int16_t  rotationOut[Block * 4];
+    alignas(64) uint16_t scaleOut[Block * 4];
+    alignas(64) uint8_t  colorOut[Block * 4];
+};
+
+// [-1,1] -> snorm16 (Packing::packSNorm16 と同じ丸め、分岐しない)
+inline int16_t
+snorm16(float v)
+{
+    v = std::min(std::max(v, -1.0f), 1.0f) * 32767.0f;
+    return int16_t(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+// [0,1] -> unorm8
+inline uint8_t
+unorm8(float v)
+{
+    return uint8_t(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+} // namespace
+
+//
+// 集める -> 要素毎に変換 -> 書き出す、の3段に分ける
+// 真ん中は float の配列を端から順に変換するだけなので、コンパイラが SIMD 命令にできる
+//
+void
+pack(const float* rotation, const float* translation, const float* scale, const float* color, const uint32_t* order,
+     size_t count, CompactInstanceData* dst)
+{
+    Work w;
+    for (size_t base = 0; base < count; base += Block)
+    {
+        const size_t n = std::min(Block, count - base);
+        for (size_t i = 0; i < n; i++)
+        {
+            const size_t src = order ? order[base + i] : base + i;
+            std::memcpy(&w.rotation[i * 4], &rotation[src * 4], sizeof(float) * 4);
+            std::memcpy(&w.translation[i * 4], &translation[src * 4], sizeof(float) * 4);
+            std::memcpy(&w.scale[i * 4], &scale[src * 4], sizeof(float) * 4);
+            std::memcpy(&w.color[i * 4], &color[src * 4], sizeof(float) * 4);
+        }
+
+        // 最後のブロックは集めた分だけ(残りは前のブロックの値か未初期化)
+        const size_t lanes = n * 4;
+        for (size_t i = 0; i < lanes; i++)
+        {
+            w.rotationOut[i] = snorm16(w.rotation[i]);
+        }
+        for (size_t i = 0; i < lanes; i++)
+        {
+            w.scaleOut[i] = Packing::packHalfBranchless(w.scale[i]);
+        }
+        for (size_t i = 0; i < lanes; i++)
+        {
+            w.colorOut[i] = unorm8(w.color[i]);
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            auto& out = dst[base + i];
+            std::memcpy(out.rotation, &w.rotationOut[i * 4], sizeof(out.rotation));
+            std::memcpy(out.translation, &w.translation[i * 4], sizeof(out.translation));
+            std::memcpy(out.scale, &w.scaleOut[i * 4], sizeof(out.scale));
+            out.padding = 0;
+            std::memcpy(&out.color, &w.colorOut[i * 4], sizeof(out.color));
+        }
+    }
+}
+
+} // namespace InstancePack
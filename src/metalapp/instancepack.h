@@ -0,0 +1,46 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#if __has_include(<simd/simd.h>)
+#include <simd/simd.h>
+#endif
+
+//
+// 32byteのインスタンスデータ(シェーダの CompactInstanceData と同じ並び)
+//
+struct CompactInstanceData
+{
+    int16_t  rotation[4];    // snorm16 quaternion(x, y, z, w)
+    float    translation[3]; //
+    uint16_t scale[3];       // half3
+    uint16_t padding;        //
+    uint32_t color;          // rgba8
+};
+static_assert(sizeof(CompactInstanceData) == 32);
+
+namespace InstancePack
+{
+
+// SoA の入力を order の順に詰めて書き込む(order が nullptr なら先頭から)
+// 入力は 1 インスタンス 4 float ずつ(simd_quatf、simd::float3、simd::float4 と同じ並び)
+// Block 個ずつ集めてから要素毎の変換をまとめて行う(変換のループはベクトル化される)
+void pack(const float* rotation, const float* translation, const float* scale, const float* color, const uint32_t* order,
+          size_t count, CompactInstanceData* dst);
+
+#if __has_include(<simd/simd.h>)
+//
+inline void
+pack(const simd_quatf* rotation, const simd::float3* translation, const simd::float3* scale, const simd::float4* color,
+     const uint32_t* order, size_t count, CompactInstanceData* dst)
+{
+    static_assert(sizeof(simd_quatf) == 16 && sizeof(simd::float3) == 16 && sizeof(simd::float4) == 16);
+    pack(reinterpret_cast<const float*>(rotation), reinterpret_cast<const float*>(translation),
+         reinterpret_cast<const float*>(scale), reinterpret_cast<const float*>(color), order, count, dst);
+}
+#endif
+
+} // namespace InstancePack
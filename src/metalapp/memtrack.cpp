@@ -0,0 +1,157 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "memtrack.h"
+#include <atomic>
+
+namespace MemTrack
+{
+namespace
+{
+// カテゴリ毎に別のスレッドから更新されるので、キャッシュラインを分ける
+// フレーム内の確保回数は allocs の差で出す(確保毎の更新は live、allocs と peak だけ)
+struct alignas(64) Counter
+{
+    std::atomic<size_t>   live{0};
+    std::atomic<size_t>   peak{0};
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> frameStart{0}; // フレームの始めの allocs
+    std::atomic<uint64_t> lastFrameAllocs{0};
+
+    void add(size_t bytes)
+    {
+        const size_t now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        updatePeak(now);
+        allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void remove(size_t bytes)
+    {
+        live.fetch_sub(bytes, std::memory_order_relaxed);
+        frees.fetch_add(1, std::memory_order_relaxed);
+    }
+    void updatePeak(size_t now)
+    {
+        size_t prev = peak.load(std::memory_order_relaxed);
+        while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed))
+        {
+        }
+    }
+    void reset()
+    {
+        live            = 0;
+        peak            = 0;
+        allocs          = 0;
+        frees           = 0;
+        frameStart      = 0;
+        lastFrameAllocs = 0;
+    }
+    void beginFrame()
+    {
+        const uint64_t now = allocs.load(std::memory_order_relaxed);
+        lastFrameAllocs.store(now - frameStart.exchange(now, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    Stats get() const
+    {
+        return {live.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed),
+                allocs.load(std::memory_order_relaxed), frees.load(std::memory_order_relaxed),
+                lastFrameAllocs.load(std::memory_order_relaxed)};
+    }
+};
+
+// operator new から呼ばれるので、静的初期化の順番に依存しない定数初期化だけ
+Counter               counters[2][CategoryCount];
+Counter               totals[2];
+thread_local Category currentScope = Category::General;
+
+const char* const categoryNames[CategoryCount] = {"general", "vertex", "index", "instance", "texture", "text", "camera"};
+
+} // namespace
+
+//
+void
+recordAlloc(Kind kind, Category category, size_t bytes)
+{
+    counters[size_t(kind)][size_t(category)].add(bytes);
+    totals[size_t(kind)].add(bytes);
+}
+
+//
+void
+recordFree(Kind kind, Category category, size_t bytes)
+{
+    counters[size_t(kind)][size_t(category)].remove(bytes);
+    totals[size_t(kind)].remove(bytes);
+}
+
+//
+Stats
+getStats(Kind kind, Category category)
+{
+    return counters[size_t(kind)][size_t(category)].get();
+}
+
+//
+Stats
+getTotal(Kind kind)
+{
+    return totals[size_t(kind)].get();
+}
+
+//
+void
+beginFrame()
+{
+    for (auto& kind : counters)
+    {
+        for (auto& counter : kind)
+        {
+            counter.beginFrame();
+        }
+    }
+    for (auto& counter : totals)
+    {
+        counter.beginFrame();
+    }
+}
+
+//
+void
+reset()
+{
+    for (auto& kind : counters)
+    {
+        for (auto& counter : kind)
+        {
+            counter.reset();
+        }
+    }
+    for (auto& counter : totals)
+    {
+        counter.reset();
+    }
+}
+
+//
+const char*
+getCategoryName(Category category)
+{
+    return category < Category::Count ? categoryNames[size_t(category)] : "unknown";
+}
+
+//
+Category
+getScope()
+{
+    return currentScope;
+}
+
+//
+Scope::Scope(Category category) : prev_(currentScope) { currentScope = category; }
+
+//
+Scope::~Scope() { currentScope = prev_; }
+
+} // namespace MemTrack
+
+//
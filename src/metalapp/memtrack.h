@@ -0,0 +1,77 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+//
+// メモリ使用量の集計(カテゴリ毎の使用中/最大バイト数と確保回数)
+// ヒープは memtrack_new.cpp の operator new から、GPU は gputrack.h から記録する
+// 記録はどのスレッドからでも良い(カウンタは atomic)
+//
+namespace MemTrack
+{
+
+//
+enum class Category : uint8_t
+{
+    General,
+    Vertex,
+    Index,
+    Instance,
+    Texture,
+    Text,
+    Camera,
+    Count,
+};
+constexpr size_t CategoryCount = size_t(Category::Count);
+
+//
+enum class Kind : uint8_t
+{
+    Heap,
+    Gpu,
+};
+
+//
+struct Stats
+{
+    size_t   liveBytes       = 0;
+    size_t   peakBytes       = 0;
+    uint64_t allocCount      = 0;
+    uint64_t freeCount       = 0;
+    uint64_t frameAllocCount = 0; // 直前のフレームで確保した回数
+};
+
+void recordAlloc(Kind kind, Category category, size_t bytes);
+void recordFree(Kind kind, Category category, size_t bytes);
+
+[[nodiscard]] Stats getStats(Kind kind, Category category);
+// 全カテゴリの合計(peakBytes は合計値の最大)
+[[nodiscard]] Stats getTotal(Kind kind);
+
+// フレームの区切り(frameAllocCount を確定して数え直す)
+void beginFrame();
+// 全てのカウンタを 0 に戻す
+void reset();
+
+[[nodiscard]] const char* getCategoryName(Category category);
+
+// このスレッドで以降のヒープ確保を記録するカテゴリ
+[[nodiscard]] Category getScope();
+
+// スコープの間だけカテゴリを切り替える(入れ子にできる)
+class Scope
+{
+    Category prev_;
+
+  public:
+    explicit Scope(Category category);
+    ~Scope();
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+} // namespace MemTrack
@@ -0,0 +1,194 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// グローバルな operator new/delete を置き換えて MemTrack にヒープ確保を記録する
+// (確保した領域の前にサイズとカテゴリを置く)
+//
+#include "memtrack.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+//
+struct Header
+{
+    size_t             size;
+    uint32_t           offset; // malloc した先頭からの位置
+    MemTrack::Category category;
+};
+constexpr size_t HeaderSize = 16;
+static_assert(sizeof(Header) <= HeaderSize);
+
+//
+void*
+allocate(size_t size, size_t align)
+{
+    const size_t offset = std::max(HeaderSize, align);
+    void*        raw    = nullptr;
+    if (size > SIZE_MAX - offset)
+    {
+        return nullptr;
+    }
+    if (align <= alignof(std::max_align_t))
+    {
+        raw = std::malloc(size + offset);
+    }
+    else if (posix_memalign(&raw, align, size + offset) != 0)
+    {
+        raw = nullptr;
+    }
+    if (raw == nullptr)
+    {
+        return nullptr;
+    }
+    auto* user   = static_cast<uint8_t*>(raw) + offset;
+    auto* header = reinterpret_cast<Header*>(user - HeaderSize);
+
+    header->size     = size;
+    header->offset   = uint32_t(offset);
+    header->category = MemTrack::getScope();
+    MemTrack::recordAlloc(MemTrack::Kind::Heap, header->category, size);
+    return user;
+}
+
+//
+void*
+allocateOrThrow(size_t size, size_t align)
+{
+    for (;;)
+    {
+        if (auto* p = allocate(size, align))
+        {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+//
+void
+release(void* ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    auto* user   = static_cast<uint8_t*>(ptr);
+    auto* header = reinterpret_cast<Header*>(user - HeaderSize);
+    MemTrack::recordFree(MemTrack::Kind::Heap, header->category, header->size);
+    std::free(user - header->offset);
+}
+
+} // namespace
+
+void*
+operator new(size_t size)
+{
+    return allocateOrThrow(size, 0);
+}
+void*
+operator new[](size_t size)
+{
+    return allocateOrThrow(size, 0);
+}
+void*
+operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size, 0);
+}
+void*
+operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size, 0);
+}
+void*
+operator new(size_t size, std::align_val_t align)
+{
+    return allocateOrThrow(size, size_t(align));
+}
+void*
+operator new[](size_t size, std::align_val_t align)
+{
+    return allocateOrThrow(size, size_t(align));
+}
+void*
+operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return allocate(size, size_t(align));
+}
+void*
+operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return allocate(size, size_t(align));
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr) noexcept
+{
+    release(ptr);
+}
+void
+operator delete(void* ptr, size_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    release(ptr);
+}
+void
+operator delete(void* ptr, std::align_val_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    release(ptr);
+}
+void
+operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release(ptr);
+}
+void
+operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release(ptr);
+}
+
+//
@@ -0,0 +1,332 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "meshsimplify.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace MeshSimplify
+{
+namespace
+{
+//
+struct Vec3
+{
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+
+    Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(double s) const { return {x * s, y * s, z * s}; }
+};
+
+double
+dot(const Vec3& a, const Vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3
+cross(const Vec3& a, const Vec3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// 対称4x4行列(平面の二乗距離の和)
+struct Quadric
+{
+    std::array<double, 10> m{};
+
+    void addPlane(const Vec3& n, double d, double w)
+    {
+        m[0] += w * n.x * n.x;
+        m[1] += w * n.x * n.y;
+        m[2] += w * n.x * n.z;
+        m[3] += w * n.x * d;
+        m[4] += w * n.y * n.y;
+        m[5] += w * n.y * n.z;
+        m[6] += w * n.y * d;
+        m[7] += w * n.z * n.z;
+        m[8] += w * n.z * d;
+        m[9] += w * d * d;
+    }
+    void add(const Quadric& o)
+    {
+        for (size_t i = 0; i < m.size(); i++)
+        {
+            m[i] += o.m[i];
+        }
+    }
+    [[nodiscard]] double error(const Vec3& p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z +
+               2.0 * m[6] * y + m[7] * z * z + 2.0 * m[8] * z + m[9];
+    }
+};
+
+//
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    double   cost;
+};
+
+const float*
+attr(const float* base, size_t stride, size_t idx)
+{
+    return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(base) + stride * idx);
+}
+
+} // namespace
+
+//
+//
+//
+float
+simplify(const VertexStream& vs, const std::vector<uint16_t>& indices, std::vector<uint16_t>& result, const Option& opt)
+{
+    result = indices;
+    if (vs.position == nullptr || vs.count == 0 || indices.size() < 3)
+    {
+        return 0.0f;
+    }
+
+    // 位置はバウンディングボックスの最大辺で正規化する
+    std::vector<Vec3> pos(vs.count);
+    Vec3              bmin{1e30, 1e30, 1e30};
+    Vec3              bmax{-1e30, -1e30, -1e30};
+    for (size_t i = 0; i < vs.count; i++)
+    {
+        auto* p = attr(vs.position, vs.stride, i);
+        pos[i]  = {p[0], p[1], p[2]};
+        bmin    = {std::min(bmin.x, pos[i].x), std::min(bmin.y, pos[i].y), std::min(bmin.z, pos[i].z)};
+        bmax    = {std::max(bmax.x, pos[i].x), std::max(bmax.y, pos[i].y), std::max(bmax.z, pos[i].z)};
+    }
+    const auto   ext   = bmax - bmin;
+    const double scale = 1.0 / std::max({ext.x, ext.y, ext.z, 1e-12});
+    for (auto& p : pos)
+    {
+        p = (p - bmin) * scale;
+    }
+
+    // 頂点毎の Quadric と周辺面積
+    std::vector<Quadric> quadric(vs.count);
+    std::vector<double>  area(vs.count, 0.0);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        const uint32_t tri[3] = {indices[t], indices[t + 1], indices[t + 2]};
+        auto           n      = cross(pos[tri[1]] - pos[tri[0]], pos[tri[2]] - pos[tri[0]]);
+        auto           len    = std::sqrt(dot(n, n));
+        if (len <= 0.0)
+        {
+            continue;
+        }
+        n        = n * (1.0 / len);
+        double d = -dot(n, pos[tri[0]]);
+        double w = len * 0.5;
+        for (auto v : tri)
+        {
+            quadric[v].addPlane(n, d, w);
+            area[v] += w;
+        }
+    }
+
+    auto attributeError = [&](uint32_t a, uint32_t b)
+    {
+        double err = 0.0;
+        if (vs.normal && opt.normalWeight > 0.0f)
+        {
+            auto* na = attr(vs.normal, vs.stride, a);
+            auto* nb = attr(vs.normal, vs.stride, b);
+            Vec3  dn{double(na[0]) - nb[0], double(na[1]) - nb[1], double(na[2]) - nb[2]};
+            err += opt.normalWeight * dot(dn, dn);
+        }
+        if (vs.texcoord && opt.uvWeight > 0.0f)
+        {
+            auto*  ta = attr(vs.texcoord, vs.stride, a);
+            auto*  tb = attr(vs.texcoord, vs.stride, b);
+            double du = double(ta[0]) - tb[0];
+            double dv = double(ta[1]) - tb[1];
+            err += opt.uvWeight * (du * du + dv * dv);
+        }
+        return err;
+    };
+
+    const size_t targetTriangles = std::max<size_t>(1, size_t(indices.size() / 3 * opt.targetRatio));
+    const double maxCost         = double(opt.maxError) * opt.maxError;
+    double       resultCost      = 0.0;
+
+    std::vector<uint32_t> adjOffset;
+    std::vector<uint32_t> adjTriangle;
+    std::vector<uint8_t>  border;
+    std::vector<uint8_t>  touched;
+    std::vector<uint32_t> remap;
+    std::vector<Collapse> candidates;
+    std::vector<uint64_t> edges;
+
+    while (result.size() / 3 > targetTriangles)
+    {
+        const size_t nbTri = result.size() / 3;
+
+        // 頂点->三角形の隣接リスト
+        adjOffset.assign(vs.count + 1, 0);
+        for (auto v : result)
+        {
+            adjOffset[v + 1]++;
+        }
+        for (size_t i = 0; i < vs.count; i++)
+        {
+            adjOffset[i + 1] += adjOffset[i];
+        }
+        adjTriangle.resize(result.size());
+        {
+            auto fill = adjOffset;
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                adjTriangle[fill[result[i]]++] = uint32_t(i / 3);
+            }
+        }
+
+        // 1つの三角形にしか使われていない辺が境界
+        edges.clear();
+        for (size_t t = 0; t < nbTri; t++)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                uint64_t a = result[t * 3 + e];
+                uint64_t b = result[t * 3 + (e + 1) % 3];
+                edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        border.assign(vs.count, 0);
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i])
+            {
+                j++;
+            }
+            if (j - i == 1)
+            {
+                border[edges[i] >> 32]        = 1;
+                border[edges[i] & 0xffffffff] = 1;
+            }
+            i = j;
+        }
+
+        // 候補の辺とコスト
+        candidates.clear();
+        for (size_t t = 0; t < nbTri; t++)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                uint32_t a = result[t * 3 + e];
+                uint32_t b = result[t * 3 + (e + 1) % 3];
+                for (int dir = 0; dir < 2; dir++)
+                {
+                    uint32_t from = dir ? b : a;
+                    uint32_t to   = dir ? a : b;
+                    if (opt.lockBorder && border[from])
+                    {
+                        continue;
+                    }
+                    // 寄せた後の頂点は両方の平面を受け持つので Q_from + Q_to で測る
+                    Quadric q = quadric[from];
+                    q.add(quadric[to]);
+                    double cost = q.error(pos[to]) / std::max(area[from] + area[to], 1e-12) + attributeError(from, to);
+                    candidates.push_back({from, to, cost});
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](auto& l, auto& r) { return l.cost < r.cost; });
+
+        touched.assign(vs.count, 0);
+        remap.resize(vs.count);
+        for (size_t i = 0; i < vs.count; i++)
+        {
+            remap[i] = uint32_t(i);
+        }
+
+        // 法線が反転する三角形ができるなら不可
+        auto flipped = [&](uint32_t from, uint32_t to)
+        {
+            for (auto i = adjOffset[from]; i < adjOffset[from + 1]; i++)
+            {
+                const auto* tri = &result[adjTriangle[i] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                {
+                    continue;
+                }
+                Vec3 p[3];
+                Vec3 q[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    p[k] = pos[tri[k]];
+                    q[k] = tri[k] == from ? pos[to] : pos[tri[k]];
+                }
+                auto n0 = cross(p[1] - p[0], p[2] - p[0]);
+                auto n1 = cross(q[1] - q[0], q[2] - q[0]);
+                if (dot(n0, n1) <= 0.0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        size_t removed = 0;
+        for (auto& c : candidates)
+        {
+            if (c.cost > maxCost || nbTri - removed <= targetTriangles)
+            {
+                break;
+            }
+            if (touched[c.from] || touched[c.to] || flipped(c.from, c.to))
+            {
+                continue;
+            }
+            remap[c.from] = c.to;
+            quadric[c.to].add(quadric[c.from]);
+            area[c.to] += area[c.from];
+            resultCost = std::max(resultCost, c.cost);
+
+            // 同一パス内で隣接する頂点は動かさない
+            for (auto i = adjOffset[c.from]; i < adjOffset[c.from + 1]; i++)
+            {
+                const auto* tri = &result[adjTriangle[i] * 3];
+                bool        has = tri[0] == c.to || tri[1] == c.to || tri[2] == c.to;
+                removed += has ? 1 : 0;
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+            }
+        }
+        if (removed == 0)
+        {
+            break;
+        }
+
+        // 縮退した三角形を除去
+        size_t dst = 0;
+        for (size_t t = 0; t < nbTri; t++)
+        {
+            auto a = remap[result[t * 3 + 0]];
+            auto b = remap[result[t * 3 + 1]];
+            auto c = remap[result[t * 3 + 2]];
+            if (a == b || b == c || c == a)
+            {
+                continue;
+            }
+            result[dst++] = uint16_t(a);
+            result[dst++] = uint16_t(b);
+            result[dst++] = uint16_t(c);
+        }
+        result.resize(dst);
+    }
+
+    return float(std::sqrt(resultCost));
+}
+
+} // namespace MeshSimplify
@@ -0,0 +1,40 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+//
+// Quadric Error Metrics によるメッシュ簡略化
+// (頂点を既存頂点へ寄せる edge collapse なので頂点バッファは共有できる)
+//
+namespace MeshSimplify
+{
+
+//
+struct Option
+{
+    float targetRatio  = 0.5f;  // 目標三角形数(元の数に対する比率)
+    float maxError     = 0.02f; // 許容誤差(メッシュの大きさに対する比率)
+    float normalWeight = 0.5f;  // 法線の差の重み
+    float uvWeight     = 0.5f;  // UVの差の重み
+    bool  lockBorder   = true;  // 境界(穴/UVシーム)の頂点を動かさない
+};
+
+// 頂点属性の参照(stride はバイト単位)
+struct VertexStream
+{
+    const float* position = nullptr;
+    const float* normal   = nullptr;
+    const float* texcoord = nullptr;
+    size_t       stride   = 0;
+    size_t       count    = 0;
+};
+
+// @return 簡略化後の誤差(メッシュの大きさに対する比率)
+float simplify(const VertexStream& vs, const std::vector<uint16_t>& indices, std::vector<uint16_t>& result, const Option& opt);
+
+} // namespace MeshSimplify
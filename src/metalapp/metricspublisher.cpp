@@ -0,0 +1,157 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "metricspublisher.h"
+#include "perfstats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <cerrno>
+#include <csignal>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+static_assert(PerfStats::CounterCount <= LiveMetrics::MaxCounters);
+
+//
+uint64_t
+toUs(float ms)
+{
+    return ms > 0.0f ? uint64_t(ms * 1000.0f) : 0;
+}
+
+// 同じ名前の共有メモリに書いているプロセスがまだ生きているか
+// (落ちたプロセスが残したものや、ヘッダの読めないものは使われていないとみなす)
+bool
+isWriterAlive(const char* name)
+{
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    void*       addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(LiveMetrics::Segment))
+    {
+        addr = mmap(nullptr, sizeof(LiveMetrics::Segment), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+    const auto* segment = static_cast<const LiveMetrics::Segment*>(addr);
+    const auto  pid     = pid_t(segment->writerPid);
+    const bool  valid   = LiveMetrics::isValid(*segment);
+    munmap(addr, sizeof(LiveMetrics::Segment));
+    return valid && pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+} // namespace
+
+//
+//
+//
+MetricsPublisher::~MetricsPublisher() { close(); }
+
+//
+// ヘッダを書いてから最後に magic を書く(読む側は magic を見てから他を読む)
+// 他のプロセスが書いている途中のものは奪わずに失敗する
+//
+bool
+MetricsPublisher::open(const char* name)
+{
+    close();
+
+    if (isWriterAlive(name))
+    {
+        fprintf(stderr, "live metrics: %s is in use by another process\n", name);
+        return false;
+    }
+    shm_unlink(name);
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        perror("shm_open");
+        return false;
+    }
+    void* addr = MAP_FAILED;
+    if (ftruncate(fd, sizeof(LiveMetrics::Segment)) == 0)
+    {
+        addr = mmap(nullptr, sizeof(LiveMetrics::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        perror("live metrics");
+        shm_unlink(name);
+        return false;
+    }
+
+    // ftruncate した領域は 0 で埋まっている
+    segment_                = new (addr) LiveMetrics::Segment;
+    segment_->version       = LiveMetrics::Version;
+    segment_->size          = sizeof(LiveMetrics::Segment);
+    segment_->counterCount  = PerfStats::CounterCount;
+    segment_->bucketCount   = LiveMetrics::BucketCount;
+    segment_->bucketWidthUs = BucketWidthUs;
+    segment_->writerPid     = uint64_t(getpid());
+    for (size_t i = 0; i < PerfStats::CounterCount; i++)
+    {
+        snprintf(segment_->counterNames[i], LiveMetrics::NameLength, "%s", PerfStats::getCounterName(PerfStats::Counter(i)));
+    }
+    segment_->sequence.store(0, std::memory_order_relaxed);
+    segment_->magic.store(LiveMetrics::Magic, std::memory_order_release);
+
+    payload_ = {};
+    snprintf(name_, sizeof(name_), "%s", name);
+    return true;
+}
+
+//
+//
+//
+void
+MetricsPublisher::close()
+{
+    if (segment_ == nullptr)
+    {
+        return;
+    }
+    munmap(segment_, sizeof(LiveMetrics::Segment));
+    shm_unlink(name_);
+    segment_ = nullptr;
+}
+
+//
+//
+//
+void
+MetricsPublisher::publish(float drawMs)
+{
+    if (segment_ == nullptr)
+    {
+        return;
+    }
+    const auto frame  = PerfStats::getFrame(0);
+    const auto drawUs = toUs(drawMs);
+    const auto now    = std::chrono::steady_clock::now().time_since_epoch();
+
+    payload_.frameIndex  = PerfStats::getFrameIndex();
+    payload_.timestampNs = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    payload_.cpuUs       = toUs(frame.cpuMs);
+    payload_.waitUs      = toUs(frame.waitMs);
+    payload_.drawUs      = drawUs;
+    std::copy_n(frame.counters, PerfStats::CounterCount, payload_.counters);
+    payload_.histogram[std::min<uint64_t>(drawUs / BucketWidthUs, LiveMetrics::BucketCount - 1)]++;
+
+    LiveMetrics::write(*segment_, payload_);
+}
+
+//
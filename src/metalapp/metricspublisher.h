@@ -0,0 +1,40 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <livemetrics.h>
+
+//
+// PerfStats の直前のフレームを共有メモリ(include/livemetrics.h)に毎フレーム書き出す
+// 書き込みはコピーだけ(システムコールもロックも無い)なので、読む側がいても描画は止まらない
+//
+class MetricsPublisher
+{
+  public:
+    static constexpr uint32_t BucketWidthUs = 500;
+
+    MetricsPublisher() = default;
+    ~MetricsPublisher();
+    MetricsPublisher(const MetricsPublisher&)            = delete;
+    MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+
+    // 共有メモリを作る(同じ名前の古いものは作り直すが、書いているプロセスが生きていれば失敗する)
+    bool open(const char* name = LiveMetrics::DefaultName);
+    // 共有メモリを消す
+    void close();
+    [[nodiscard]] bool isOpen() const { return segment_ != nullptr; }
+
+    // PerfStats::endFrame の後に呼ぶ(drawMs は Renderer::draw 全体の時間)
+    void publish(float drawMs);
+
+    // 書き出した内容(ヒストグラムは開いてからの累計)
+    [[nodiscard]] const LiveMetrics::Payload& getPayload() const { return payload_; }
+
+  private:
+    LiveMetrics::Segment* segment_ = nullptr;
+    LiveMetrics::Payload  payload_{};
+    char                  name_[64]{};
+};
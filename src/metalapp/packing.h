@@ -0,0 +1,181 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+
+//
+// GPU向けの量子化/パック関数(シェーダ側のデコードと対になる)
+//
+namespace Packing
+{
+
+// float -> half (round to nearest even)
+inline uint16_t
+packHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int32_t  exp  = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t       mant = bits & 0x7fffff;
+
+    if (((bits >> 23) & 0xff) == 0xff)
+    {
+        // inf / nan
+        return uint16_t(sign | 0x7c00 | (mant ? 0x200 : 0));
+    }
+    if (exp >= 31)
+    {
+        return uint16_t(sign | 0x7c00);
+    }
+    if (exp <= 0)
+    {
+        if (exp < -10)
+        {
+            return uint16_t(sign);
+        }
+        mant |= 0x800000;
+        const uint32_t shift = uint32_t(14 - exp);
+        uint32_t       half  = mant >> shift;
+        const uint32_t rem   = mant & ((1u << shift) - 1);
+        const uint32_t mid   = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1)))
+        {
+            half++;
+        }
+        return uint16_t(sign | half);
+    }
+    uint32_t   half = sign | (uint32_t(exp) << 10) | (mant >> 13);
+    const auto rem  = mant & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+    {
+        // 桁上がりで指数部に繰り上がってもそのまま正しい値になる
+        half++;
+    }
+    return uint16_t(half);
+}
+
+// packHalf と同じ結果を分岐なしで求める(ループに入れるとベクトル化される)
+//   正規化数: 指数を付け替えて、下位 13 ビットを偶数丸めで落とす
+//   非正規化数と 0: 仮数の位置を合わせる数を足して、浮動小数点の加算に丸めさせる
+inline uint16_t
+packHalfBranchless(float value)
+{
+    constexpr uint32_t f16max      = (127 + 16) << 23; // 65536 (これ以上は inf)
+    constexpr uint32_t f32infty    = 255 << 23;
+    constexpr uint32_t minNormal   = 113 << 23; // 2^-14
+    constexpr uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    const uint32_t normal = (bits + ((15u - 127u) << 23) + 0xfff + ((bits >> 13) & 1)) >> 13;
+    float          magic;
+    std::memcpy(&magic, &denormMagic, sizeof(magic));
+    float denorm;
+    std::memcpy(&denorm, &bits, sizeof(denorm));
+    denorm += magic;
+    uint32_t denormBits;
+    std::memcpy(&denormBits, &denorm, sizeof(denormBits));
+    denormBits -= denormMagic;
+
+    const uint32_t special = bits > f32infty ? 0x7e00 : 0x7c00;
+    const uint32_t finite  = bits < minNormal ? denormBits : normal;
+    return uint16_t((bits >= f16max ? special : finite) | (sign >> 16));
+}
+
+// half -> float
+inline float
+unpackHalf(uint16_t value)
+{
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    const uint32_t exp  = (value >> 10) & 0x1f;
+    const uint32_t mant = value & 0x3ff;
+    if (exp == 0)
+    {
+        float f = std::ldexp(float(mant), -24);
+        return sign ? -f : f;
+    }
+    uint32_t bits = sign | ((exp == 31 ? 255 : exp - 15 + 127) << 23) | (mant << 13);
+    float    f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// [0,1] -> 16bit unorm
+inline uint16_t
+packUNorm16(float value)
+{
+    return uint16_t(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+// [-1,1] -> 16bit snorm
+inline int16_t
+packSNorm16(float value)
+{
+    return int16_t(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// AABB の1軸(origin から extent の幅)に対する位置 -> 16bit unorm(幅が 0 の軸は 0)
+inline uint16_t
+packPosition(float value, float origin, float extent)
+{
+    return packUNorm16(extent > 0.0f ? (value - origin) / extent : 0.0f);
+}
+
+// packPosition の逆(シェーダの MeshBounds によるデコードと同じ式)
+inline float
+unpackPosition(uint16_t value, float origin, float extent)
+{
+    return origin + value / 65535.0f * extent;
+}
+
+// 単位ベクトルを八面体マッピングで2要素にする
+inline void
+packOctNormal(float x, float y, float z, int16_t out[2])
+{
+    const float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    float       u  = l1 > 0.0f ? x / l1 : 0.0f;
+    float       v  = l1 > 0.0f ? y / l1 : 0.0f;
+    if (z < 0.0f)
+    {
+        const float ou = u;
+        u              = (1.0f - std::fabs(v)) * (ou >= 0.0f ? 1.0f : -1.0f);
+        v              = (1.0f - std::fabs(ou)) * (v >= 0.0f ? 1.0f : -1.0f);
+    }
+    out[0] = packSNorm16(u);
+    out[1] = packSNorm16(v);
+}
+
+// RGBA [0,1] -> 8bit unorm x4 (r が下位バイト、シェーダの unpack_unorm4x8_to_float と対)
+inline uint32_t
+packUNorm4x8(float r, float g, float b, float a)
+{
+    auto u8 = [](float v) { return uint32_t(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    return u8(r) | (u8(g) << 8) | (u8(b) << 16) | (u8(a) << 24);
+}
+
+//
+inline void
+unpackOctNormal(const int16_t in[2], float out[3])
+{
+    float x = std::max(in[0] / 32767.0f, -1.0f);
+    float y = std::max(in[1] / 32767.0f, -1.0f);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    float len = std::sqrt(x * x + y * y + z * z);
+    out[0]    = x / len;
+    out[1]    = y / len;
+    out[2]    = z / len;
+}
+
+} // namespace Packing
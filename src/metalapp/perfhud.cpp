@@ -0,0 +1,105 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "perfhud.h"
+#include "simple2d.h"
+#include "textdraw.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+constexpr float GraphWidth  = float(PerfStats::HistorySize);
+constexpr float GraphHeight = 64.0f;
+constexpr float TextSize    = 16.0f;
+constexpr float LineHeight  = 20.0f;
+constexpr int   TextLines   = 4;
+// グラフの上端は最低でも 30fps 分
+constexpr float MinScaleMs = 1000.0f / 30.0f;
+constexpr float TargetMs   = 1000.0f / 60.0f;
+
+//
+unsigned long long
+counter(const PerfStats::Frame& frame, PerfStats::Counter id)
+{
+    return frame.counters[size_t(id)];
+}
+
+} // namespace
+
+//
+//
+//
+void
+PerfHud::setPosition(float x, float y)
+{
+    x_ = x;
+    y_ = y;
+}
+
+//
+//
+//
+void
+PerfHud::setRefreshFrames(uint32_t frames)
+{
+    refreshFrames_ = std::max(frames, 1u);
+}
+
+//
+// グラフは毎フレーム、数値は refreshFrames_ 毎に更新する
+//
+void
+PerfHud::draw(Simple2D& render2d, TextDraw& text)
+{
+    using PerfStats::Counter;
+
+    const auto frameIndex = PerfStats::getFrameIndex();
+    if (frameIndex >= nextRefresh_)
+    {
+        summary_     = PerfStats::getSummary();
+        nextRefresh_ = frameIndex + refreshFrames_;
+    }
+
+    const float panelHeight = GraphHeight + LineHeight * TextLines + 8.0f;
+    render2d.setLayer(std::numeric_limits<int16_t>::max());
+    render2d.setBlend(Simple2D::Blend::Alpha);
+    render2d.setDrawColor(0.0f, 0.0f, 0.0f, 0.6f);
+    render2d.fillRect(x_, y_, x_ + GraphWidth + 8.0f, y_ + panelHeight);
+    render2d.setLayer(0);
+
+    // CPU 時間(古い順に左から)
+    const size_t count  = PerfStats::copyFrameTimes(times_, PerfStats::HistorySize);
+    const float  scale  = std::max(MinScaleMs, summary_.cpuMax);
+    const float  left   = x_ + 4.0f;
+    const float  bottom = y_ + 4.0f + GraphHeight;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float h = std::min(times_[i] / scale, 1.0f) * GraphHeight;
+        points_[i]    = simd::float2{left + float(i), bottom - h};
+    }
+    const float targetY = bottom - TargetMs / scale * GraphHeight;
+    render2d.setDrawColor(0.3f, 0.8f, 0.3f, 1.0f);
+    render2d.drawLine(left, targetY, left + GraphWidth, targetY);
+    render2d.setDrawColor(1.0f, 0.8f, 0.2f, 1.0f);
+    render2d.drawLineStrip(points_, count, nullptr);
+
+    const auto& s    = summary_;
+    const auto& last = summary_.last;
+    const float tx   = left;
+    float       ty   = bottom + 4.0f;
+    text.setSize(TextSize);
+    text.setColor(1.0f, 1.0f, 1.0f, 1.0f);
+    text.printf(tx, ty, "cpu %.2fms p50 %.2f p95 %.2f p99 %.2f max %.2f", s.cpuAvg, s.cpuP50, s.cpuP95, s.cpuP99, s.cpuMax);
+    ty += LineHeight;
+    text.printf(tx, ty, "wait %.2fms latency %.2fms draw %llu instance %llu", s.waitAvg, s.latencyAvg,
+                counter(last, Counter::DrawCalls), counter(last, Counter::Instances));
+    ty += LineHeight;
+    text.printf(tx, ty, "vertex %llu index %llu upload %.1fKB", counter(last, Counter::Vertices), counter(last, Counter::Indices),
+                counter(last, Counter::UploadBytes) / 1024.0);
+    ty += LineHeight;
+    text.printf(tx, ty, "texture %llu text %llu", counter(last, Counter::TexturesCreated),
+                counter(last, Counter::TextRasterized));
+}
+
+//
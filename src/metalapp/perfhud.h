@@ -0,0 +1,33 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "perfstats.h"
+#include <cinttypes>
+#include <simd/vector_types.h>
+
+class Simple2D;
+class TextDraw;
+
+//
+// PerfStats の内容を画面に出す(CPU 時間のグラフと数値)
+// 数値は refreshFrames 毎にしか更新しないので、文字列のテクスチャは毎フレーム作り直さない
+//
+class PerfHud
+{
+    float              x_             = 16.0f;
+    float              y_             = 16.0f;
+    uint32_t           refreshFrames_ = 30;
+    uint64_t           nextRefresh_   = 0;
+    PerfStats::Summary summary_;
+    float              times_[PerfStats::HistorySize];
+    simd::float2       points_[PerfStats::HistorySize];
+
+  public:
+    void setPosition(float x, float y);
+    void setRefreshFrames(uint32_t frames);
+
+    // フレームの描画を積む前に呼ぶ(TextDraw の大きさと色は変わる)
+    void draw(Simple2D& render2d, TextDraw& text);
+};
@@ -0,0 +1,171 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "perfstats.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace PerfStats
+{
+namespace
+{
+std::atomic<uint64_t> current[CounterCount];
+
+// 描画スレッドだけが触る
+Frame    history[HistorySize];
+uint64_t frameIndex = 0;
+
+const char* const counterNames[CounterCount] = {
+    "draw calls", "vertices", "indices", "instances", "upload bytes", "textures", "text",
+};
+
+} // namespace
+
+//
+void
+add(Counter counter, uint64_t value)
+{
+    current[size_t(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+//
+void
+addDraw(uint64_t vertices, uint64_t indices, uint64_t instances)
+{
+    add(Counter::DrawCalls);
+    add(Counter::Vertices, vertices * instances);
+    add(Counter::Indices, indices * instances);
+    add(Counter::Instances, instances);
+}
+
+//
+uint64_t
+getCurrent(Counter counter)
+{
+    return current[size_t(counter)].load(std::memory_order_relaxed);
+}
+
+//
+void
+endFrame(float cpuMs, float waitMs, float latencyMs)
+{
+    auto& frame     = history[frameIndex % HistorySize];
+    frame.cpuMs     = cpuMs;
+    frame.waitMs    = waitMs;
+    frame.latencyMs = latencyMs;
+    for (size_t i = 0; i < CounterCount; i++)
+    {
+        frame.counters[i] = current[i].exchange(0, std::memory_order_relaxed);
+    }
+    frameIndex++;
+}
+
+//
+Summary
+getSummary()
+{
+    Summary summary;
+    summary.frameCount = size_t(std::min<uint64_t>(frameIndex, HistorySize));
+    if (summary.frameCount == 0)
+    {
+        return summary;
+    }
+
+    float  times[HistorySize];
+    double cpuTotal     = 0.0;
+    double waitTotal    = 0.0;
+    double latencyTotal = 0.0;
+    for (size_t i = 0; i < summary.frameCount; i++)
+    {
+        const auto& frame = history[i];
+        times[i]          = frame.cpuMs;
+        cpuTotal += frame.cpuMs;
+        waitTotal += frame.waitMs;
+        latencyTotal += frame.latencyMs;
+        summary.waitMax    = std::max(summary.waitMax, frame.waitMs);
+        summary.latencyMax = std::max(summary.latencyMax, frame.latencyMs);
+    }
+    const auto count   = float(summary.frameCount);
+    summary.cpuAvg     = float(cpuTotal / count);
+    summary.waitAvg    = float(waitTotal / count);
+    summary.latencyAvg = float(latencyTotal / count);
+    summary.cpuMin     = *std::min_element(times, times + summary.frameCount);
+    summary.cpuMax     = *std::max_element(times, times + summary.frameCount);
+    summary.cpuP50     = percentile(times, summary.frameCount, 0.50f);
+    summary.cpuP95     = percentile(times, summary.frameCount, 0.95f);
+    summary.cpuP99     = percentile(times, summary.frameCount, 0.99f);
+    summary.last       = getFrame(0);
+    return summary;
+}
+
+//
+Frame
+getFrame(size_t age)
+{
+    if (age >= HistorySize || age >= frameIndex)
+    {
+        return {};
+    }
+    return history[(frameIndex - 1 - age) % HistorySize];
+}
+
+//
+size_t
+copyFrameTimes(float* dst, size_t maxCount)
+{
+    const size_t count = size_t(std::min<uint64_t>({frameIndex, HistorySize, maxCount}));
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = getFrame(count - 1 - i).cpuMs;
+    }
+    return count;
+}
+
+//
+uint64_t
+getFrameIndex()
+{
+    return frameIndex;
+}
+
+//
+void
+reset()
+{
+    for (auto& counter : current)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& frame : history)
+    {
+        frame = {};
+    }
+    frameIndex = 0;
+}
+
+//
+const char*
+getCounterName(Counter counter)
+{
+    return counter < Counter::Count ? counterNames[size_t(counter)] : "unknown";
+}
+
+// 小さい方から ceil(p * count) 番目(nth_element なので全体は並べ替えない)
+// p は float なので 0.99f * 100 が 100 番目にならないよう少しだけ切り下げる
+float
+percentile(float* values, size_t count, float p)
+{
+    if (count == 0)
+    {
+        return 0.0f;
+    }
+    const auto rank = size_t(std::ceil(double(std::clamp(p, 0.0f, 1.0f)) * double(count) - 1e-4));
+    const auto nth  = values + (rank > 0 ? rank - 1 : 0);
+    std::nth_element(values, nth, values + count);
+    return *nth;
+}
+
+} // namespace PerfStats
+
+//
@@ -0,0 +1,86 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+//
+// フレーム毎の実行統計(描画回数、頂点/インデックス数、転送量など)と CPU 時間の履歴
+// 加算はどのスレッドからでも良い(relaxed な atomic だけなので常に有効にしておける)
+// endFrame と履歴の参照は描画スレッドから呼ぶ
+//
+namespace PerfStats
+{
+
+//
+enum class Counter : uint8_t
+{
+    DrawCalls,
+    Vertices,
+    Indices,
+    Instances,
+    UploadBytes,
+    TexturesCreated,
+    TextRasterized,
+    Count,
+};
+constexpr size_t CounterCount = size_t(Counter::Count);
+
+// 保持するフレーム数
+constexpr size_t HistorySize = 240;
+
+//
+struct Frame
+{
+    float    cpuMs                  = 0.0f; // 待ち時間を除いたフレームの処理時間
+    float    waitMs                 = 0.0f; // 空きフレーム(GPU の完了)を待った時間
+    float    latencyMs              = 0.0f; // 最後に完了したフレームの submit から完了まで
+    uint64_t counters[CounterCount] = {};
+};
+
+// 履歴全体の集計(パーセンタイルは nearest-rank)
+struct Summary
+{
+    size_t frameCount = 0; // 集計したフレーム数(最大 HistorySize)
+    float  cpuAvg     = 0.0f;
+    float  cpuMin     = 0.0f;
+    float  cpuMax     = 0.0f;
+    float  cpuP50     = 0.0f;
+    float  cpuP95     = 0.0f;
+    float  cpuP99     = 0.0f;
+    float  waitAvg    = 0.0f;
+    float  waitMax    = 0.0f;
+    float  latencyAvg = 0.0f;
+    float  latencyMax = 0.0f;
+    Frame  last;
+};
+
+void add(Counter counter, uint64_t value = 1);
+// 描画1回分(頂点/インデックス数は1インスタンス分、インスタンス数を掛けて足す)
+// 頂点数が分からない共有メッシュはインデックス数を渡す
+void addDraw(uint64_t vertices, uint64_t indices, uint64_t instances = 1);
+// 今のフレームでここまでに足された値
+[[nodiscard]] uint64_t getCurrent(Counter counter);
+
+// フレームの区切り(カウンタを履歴に移して 0 から数え直す)
+void endFrame(float cpuMs, float waitMs, float latencyMs = 0.0f);
+
+[[nodiscard]] Summary getSummary();
+// age フレーム前(0 が直前に終わったフレーム、無ければ空)
+[[nodiscard]] Frame getFrame(size_t age = 0);
+// CPU 時間を古い順に dst へ書く(書いた数を返す)
+size_t copyFrameTimes(float* dst, size_t maxCount);
+// これまでに endFrame した回数
+[[nodiscard]] uint64_t getFrameIndex();
+
+// 履歴とカウンタを全て捨てる
+void reset();
+
+[[nodiscard]] const char* getCounterName(Counter counter);
+
+// values を並べ替えて p (0..1) のパーセンタイルを返す(count が 0 なら 0)
+[[nodiscard]] float percentile(float* values, size_t count, float p);
+
+} // namespace PerfStats
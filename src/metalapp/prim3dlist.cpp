@@ -0,0 +1,583 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "prim3dlist.h"
+#include "packing.h"
+#include "radixsort.h"
+#include "transformbatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <matrix.h>
+
+namespace
+{
+//
+Prim3DList::Vertex
+makeVertex(simd::float3 pos, uint32_t color)
+{
+    return {{pos.x, pos.y, pos.z}, color};
+}
+
+// ビュー空間の z を昇順(奥から手前)に並ぶ 24bit のキーにする
+uint32_t
+depthKey(float z)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &z, sizeof(bits));
+    bits = (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+    return bits >> 8;
+}
+
+} // namespace
+
+//
+//
+//
+Prim3DList::Prim3DList() : transform_(math::makeIdentity()), view_(math::makeIdentity()) {}
+
+//
+void
+Prim3DList::reserve(size_t lineVertices, size_t triangleVertices)
+{
+    lineBatch_.vertices.reserve(lineVertices);
+    lineBatch_.indices.reserve(lineVertices);
+    triangleBatch_.vertices.reserve(triangleVertices);
+    triangleBatch_.indices.reserve(triangleVertices);
+}
+
+//
+void
+Prim3DList::clear()
+{
+    lineBatch_.clear();
+    triangleBatch_.clear();
+    geometryDraws_.clear();
+    for (auto& list : shapeInstances_)
+    {
+        list.clear();
+    }
+    transformStack_.clear();
+    setTransform(math::makeIdentity());
+}
+
+//
+void
+Prim3DList::setDrawColor(float red, float green, float blue, float alpha)
+{
+    drawColor_ = Packing::packUNorm4x8(red, green, blue, alpha);
+}
+
+// 行列を設定してから追加された頂点にまとめて掛ける(単位行列なら何もしない)
+void
+Prim3DList::flushTransform()
+{
+    if (!identity_)
+    {
+        applyTransform(*lineTarget_, lineMark_);
+        applyTransform(*triangleTarget_, triangleMark_);
+    }
+    markTransform();
+}
+
+//
+void
+Prim3DList::applyTransform(Batch& batch, size_t first)
+{
+    auto apply = [this](Vertex* data, size_t count) { TransformBatch::apply(transform_, data, sizeof(Vertex), count); };
+    batch.vertices.forEachRange(first, batch.vertices.size(), apply);
+}
+
+//
+void
+Prim3DList::markTransform()
+{
+    lineMark_     = lineTarget_->getVertexCount();
+    triangleMark_ = triangleTarget_->getVertexCount();
+}
+
+//
+void
+Prim3DList::setTransform(const simd::float4x4& transform)
+{
+    flushTransform();
+    transform_ = transform;
+    identity_  = TransformBatch::isIdentity(transform_);
+}
+
+//
+void
+Prim3DList::pushTransform(const simd::float4x4& transform)
+{
+    transformStack_.push_back(transform_);
+    setTransform(simd_mul(transform_, transform));
+}
+
+//
+void
+Prim3DList::popTransform()
+{
+    if (!transformStack_.empty())
+    {
+        const auto parent = transformStack_.back();
+        transformStack_.pop_back();
+        setTransform(parent);
+    }
+}
+
+//
+uint32_t
+Prim3DList::getColor(const simd::float4* colors, size_t idx) const
+{
+    if (colors == nullptr)
+    {
+        return drawColor_;
+    }
+    const auto& c = colors[idx];
+    return Packing::packUNorm4x8(c.x, c.y, c.z, c.w);
+}
+
+// 頂点を追加して、連番でインデックスを振る
+void
+Prim3DList::append(Batch& batch, const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    const uint32_t base = batch.getVertexCount();
+    batch.appendVertices(count,
+                         [&](Vertex* dst, size_t first, size_t n)
+                         {
+                             for (size_t i = 0; i < n; i++)
+                             {
+                                 dst[i] = makeVertex(points[first + i], getColor(colors, first + i));
+                             }
+                         });
+    batch.appendIndices(count,
+                        [&](uint32_t* dst, size_t first, size_t n)
+                        {
+                            for (size_t i = 0; i < n; i++)
+                            {
+                                dst[i] = base + uint32_t(first + i);
+                            }
+                        });
+}
+
+//
+void
+Prim3DList::drawLines(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    append(*lineTarget_, points, count & ~size_t(1), colors);
+}
+
+//
+void
+Prim3DList::drawTriangles(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    append(*triangleTarget_, points, count - count % 3, colors);
+}
+
+// 頂点は共有して、線分毎にインデックスを2つ
+void
+Prim3DList::drawLineStrip(const simd::float3* points, size_t count, const simd::float4* colors, bool loop)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    auto&          batch = *lineTarget_;
+    const uint32_t base  = batch.getVertexCount();
+    const size_t   lines = loop ? count : count - 1;
+    batch.appendVertices(count,
+                         [&](Vertex* dst, size_t first, size_t n)
+                         {
+                             for (size_t i = 0; i < n; i++)
+                             {
+                                 dst[i] = makeVertex(points[first + i], getColor(colors, first + i));
+                             }
+                         });
+    // k 番目のインデックスは線分 k / 2 の始点か終点(loop の最後だけ先頭へ戻る)
+    batch.appendIndices(lines * 2,
+                        [&](uint32_t* dst, size_t first, size_t n)
+                        {
+                            for (size_t i = 0; i < n; i++)
+                            {
+                                const size_t k = first + i;
+                                const size_t v = k / 2 + (k & 1);
+                                dst[i]         = base + uint32_t(v == count ? 0 : v);
+                            }
+                        });
+}
+
+//
+void
+Prim3DList::drawLine(simd::float3 from, simd::float3 to)
+{
+    const simd::float3 points[2] = {from, to};
+    append(*lineTarget_, points, 2, nullptr);
+}
+
+//
+void
+Prim3DList::drawRect(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3)
+{
+    const simd::float3 points[4] = {p0, p1, p2, p3};
+    drawLineStrip(points, 4, nullptr, true);
+}
+
+//
+void
+Prim3DList::drawTriangle(simd::float3 v0, simd::float3 v1, simd::float3 v2)
+{
+    const simd::float3 points[3] = {v0, v1, v2};
+    append(*triangleTarget_, points, 3, nullptr);
+}
+
+// 4頂点 + 6インデックス
+void
+Prim3DList::drawPlane(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3)
+{
+    auto&          batch = *triangleTarget_;
+    const uint32_t base  = batch.getVertexCount();
+    batch.addVertex(makeVertex(v0, drawColor_));
+    batch.addVertex(makeVertex(v1, drawColor_));
+    batch.addVertex(makeVertex(v2, drawColor_));
+    batch.addVertex(makeVertex(v3, drawColor_));
+    for (uint32_t i : {0, 1, 2, 0, 2, 3})
+    {
+        batch.addIndex(base + i);
+    }
+}
+
+//
+void
+Prim3DList::addShape(DebugShape::Shape shape, DebugShape::Instance inst)
+{
+    if (!identity_)
+    {
+        TransformBatch::applyRows(transform_, inst.rows);
+    }
+    shapeInstances_[size_t(shape)].push_back(inst);
+}
+
+//
+void
+Prim3DList::drawShape(DebugShape::Shape shape, const simd::float4x4& transform)
+{
+    float m[16];
+    std::memcpy(m, &transform, sizeof(m));
+    addShape(shape, DebugShape::makeInstance(m, drawColor_));
+}
+
+//
+void
+Prim3DList::drawBox(simd::float3 center, simd::float3 size)
+{
+    const float c[3] = {center.x, center.y, center.z};
+    const float s[3] = {size.x, size.y, size.z};
+    addShape(DebugShape::Shape::Box, DebugShape::makeInstance(c, s, drawColor_));
+}
+
+//
+void
+Prim3DList::drawSphere(simd::float3 center, float radius)
+{
+    const float c[3] = {center.x, center.y, center.z};
+    const float s[3] = {radius, radius, radius};
+    addShape(DebugShape::Shape::Sphere, DebugShape::makeInstance(c, s, drawColor_));
+}
+
+//
+void
+Prim3DList::drawArrow(simd::float3 from, simd::float3 to)
+{
+    const float f[3] = {from.x, from.y, from.z};
+    const float t[3] = {to.x, to.y, to.z};
+    addShape(DebugShape::Shape::Arrow, DebugShape::makeArrowInstance(f, t, drawColor_));
+}
+
+// X/Z 方向に divisions 本ずつ
+void
+Prim3DList::drawGrid(simd::float3 center, float size, int divisions)
+{
+    const float half = size * 0.5f;
+    for (int i = 0; i <= divisions; i++)
+    {
+        const float t     = -half + size * float(i) / float(std::max(divisions, 1));
+        const float x0[3] = {center.x - half, center.y, center.z + t};
+        const float x1[3] = {center.x + half, center.y, center.z + t};
+        const float z0[3] = {center.x + t, center.y, center.z - half};
+        const float z1[3] = {center.x + t, center.y, center.z + half};
+        addShape(DebugShape::Shape::Line, DebugShape::makeLineInstance(x0, x1, drawColor_));
+        addShape(DebugShape::Shape::Line, DebugShape::makeLineInstance(z0, z1, drawColor_));
+    }
+}
+
+//
+void
+Prim3DList::drawAxes(const simd::float4x4& transform, float length)
+{
+    float m[16];
+    std::memcpy(m, &transform, sizeof(m));
+    for (int i = 0; i < 12; i++)
+    {
+        m[i] *= length;
+    }
+    // 軸の色は頂点色のまま
+    addShape(DebugShape::Shape::Axes, DebugShape::makeInstance(m, 0xffffffff));
+}
+
+//
+const Prim3DList::ShapeList&
+Prim3DList::getShapes(DebugShape::Shape shape) const
+{
+    return shapeInstances_[size_t(shape)];
+}
+
+//
+size_t
+Prim3DList::getShapeCount() const
+{
+    size_t total = 0;
+    for (const auto& list : shapeInstances_)
+    {
+        total += list.size();
+    }
+    return total;
+}
+
+//
+Prim3DList::GeometryHandle
+Prim3DList::createGeometry()
+{
+    return geometries_.create(std::make_unique<Geometry>());
+}
+
+// 以降の描画を handle に記録する(中身は作り直し)
+bool
+Prim3DList::beginGeometry(GeometryHandle handle)
+{
+    auto* slot = geometries_.get(handle);
+    if (slot == nullptr)
+    {
+        return false;
+    }
+    flushTransform();
+    auto& geom = **slot;
+    geom.lines.clear();
+    geom.triangles.clear();
+    geom.dirty      = true;
+    lineTarget_     = &geom.lines;
+    triangleTarget_ = &geom.triangles;
+    recording_      = handle;
+    markTransform();
+    return true;
+}
+
+//
+void
+Prim3DList::endGeometry()
+{
+    flushTransform();
+    lineTarget_     = &lineBatch_;
+    triangleTarget_ = &triangleBatch_;
+    recording_      = InvalidGeometry;
+    markTransform();
+}
+
+//
+void
+Prim3DList::drawGeometry(GeometryHandle handle, const simd::float4x4& transform)
+{
+    if (identity_)
+    {
+        geometryDraws_.push_back({handle, transform});
+        return;
+    }
+    geometryDraws_.push_back({handle, simd_mul(transform_, transform)});
+}
+
+//
+MTL::Buffer*
+Prim3DList::destroyGeometry(GeometryHandle handle)
+{
+    auto* slot = geometries_.get(handle);
+    if (slot == nullptr)
+    {
+        return nullptr;
+    }
+    if (handle == recording_)
+    {
+        endGeometry();
+    }
+    auto* buffer = (*slot)->buffer;
+    geometries_.destroy(handle);
+    return buffer;
+}
+
+//
+Prim3DList::Geometry*
+Prim3DList::findGeometry(GeometryHandle handle)
+{
+    auto* slot = geometries_.get(handle);
+    return slot == nullptr || handle == recording_ ? nullptr : slot->get();
+}
+
+//
+void
+Prim3DList::layoutGeometry(Geometry& geom)
+{
+    geom.triangleOffset = (geom.lines.getBytes() + 15) & ~size_t(15);
+    geom.bytes          = geom.triangles.empty() ? geom.lines.getBytes() : geom.triangleOffset + geom.triangles.getBytes();
+    geom.dirty          = false;
+}
+
+//
+size_t
+Prim3DList::getImmediateBytes() const
+{
+    return lineBatch_.getBytes() + triangleBatch_.getBytes() + getShapeCount() * sizeof(DebugShape::Instance);
+}
+
+//
+float
+Prim3DList::viewDepth(const float* p) const
+{
+    return view_.columns[0].z * p[0] + view_.columns[1].z * p[1] + view_.columns[2].z * p[2] + view_.columns[3].z;
+}
+
+//
+float
+Prim3DList::getNearestDepth(const Batch& batch) const
+{
+    float nearest = batch.vertices.empty() ? 0.0f : INFINITY;
+    batch.vertices.forEachChunk(
+        [&](const Vertex* data, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                nearest = std::min(nearest, -viewDepth(data[i].position));
+            }
+        });
+    return nearest;
+}
+
+//
+float
+Prim3DList::getNearestDepth(DebugShape::Shape shape) const
+{
+    const auto& list    = getShapes(shape);
+    float       nearest = list.empty() ? 0.0f : INFINITY;
+    list.forEachChunk(
+        [&](const DebugShape::Instance* data, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                const float origin[3] = {data[i].rows[3], data[i].rows[7], data[i].rows[11]};
+                nearest               = std::min(nearest, -viewDepth(origin));
+            }
+        });
+    return nearest;
+}
+
+//
+float
+Prim3DList::getDrawDepth(const GeometryDraw& draw) const
+{
+    const auto& t         = draw.transform.columns[3];
+    const float origin[3] = {t.x, t.y, t.z};
+    return -viewDepth(origin);
+}
+
+//
+void
+Prim3DList::sortTriangles(uint32_t* out)
+{
+    const auto& batch = triangleBatch_;
+    vertexDepth_.resize(batch.getVertexCount());
+    vertexTranslucent_.resize(batch.getVertexCount());
+    size_t vi = 0;
+    batch.vertices.forEachChunk(
+        [&](const Vertex* data, size_t n)
+        {
+            for (size_t i = 0; i < n; i++, vi++)
+            {
+                vertexDepth_[vi]       = viewDepth(data[i].position);
+                vertexTranslucent_[vi] = (data[i].color >> 24) < 0xff;
+            }
+        });
+
+    sortIndices_.clear();
+    sortKeys_.clear();
+    sortOrder_.clear();
+    size_t   opaque = 0;
+    uint32_t tri[3];
+    size_t   k = 0;
+    batch.indices.forEachChunk(
+        [&](const uint32_t* idx, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                tri[k++] = idx[i];
+                if (k < 3)
+                {
+                    continue;
+                }
+                k = 0;
+                if (vertexTranslucent_[tri[0]] | vertexTranslucent_[tri[1]] | vertexTranslucent_[tri[2]])
+                {
+                    const float z = vertexDepth_[tri[0]] + vertexDepth_[tri[1]] + vertexDepth_[tri[2]];
+                    sortOrder_.push_back(uint32_t(sortKeys_.size()));
+                    sortKeys_.push_back(depthKey(z));
+                    sortIndices_.insert(sortIndices_.end(), tri, tri + 3);
+                }
+                else
+                {
+                    out[opaque++] = tri[0];
+                    out[opaque++] = tri[1];
+                    out[opaque++] = tri[2];
+                }
+            }
+        });
+
+    RadixSort::sortParallel(sortKeys_, sortOrder_, tmpKeys_, tmpOrder_);
+    for (auto order : sortOrder_)
+    {
+        const uint32_t* src = &sortIndices_[order * 3];
+        out[opaque++]       = src[0];
+        out[opaque++]       = src[1];
+        out[opaque++]       = src[2];
+    }
+}
+
+// 形状毎に1回の描画なので、違う形状同士の前後は並べ替えない
+void
+Prim3DList::sortShapes(DebugShape::Shape shape, DebugShape::Instance* dst)
+{
+    sortShapes_.clear();
+    sortKeys_.clear();
+    sortOrder_.clear();
+    size_t opaque = 0;
+    getShapes(shape).forEachChunk(
+        [&](const DebugShape::Instance* data, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                const auto& inst = data[i];
+                if ((inst.color >> 24) == 0xff)
+                {
+                    dst[opaque++] = inst;
+                    continue;
+                }
+                const float origin[3] = {inst.rows[3], inst.rows[7], inst.rows[11]};
+                sortOrder_.push_back(uint32_t(sortShapes_.size()));
+                sortKeys_.push_back(depthKey(viewDepth(origin)));
+                sortShapes_.push_back(inst);
+            }
+        });
+
+    RadixSort::sortParallel(sortKeys_, sortOrder_, tmpKeys_, tmpOrder_);
+    for (auto order : sortOrder_)
+    {
+        dst[opaque++] = sortShapes_[order];
+    }
+}
+
+//
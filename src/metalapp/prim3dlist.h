@@ -0,0 +1,197 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "chunklist.h"
+#include "debugshape.h"
+#include "primbatch.h"
+#include "slotmap.h"
+#include <cinttypes>
+#include <memory>
+#include <simd/simd.h>
+#include <vector>
+
+namespace MTL
+{
+class Buffer;
+} // namespace MTL
+
+//
+// Simple3D の描画リスト(Metal を使わない側)
+// 線/三角形/デバッグ形状の追加、変換行列の一括適用、保持するジオメトリの記録と
+// 半透明の並べ替えを持ち、転送と描画は Simple3D が行う
+//
+class Prim3DList
+{
+  public:
+    using GeometryHandle = uint32_t;
+
+    static constexpr GeometryHandle InvalidGeometry = 0;
+
+    // shader/prim3d.metal の VertexData と同じ並び
+    struct Vertex
+    {
+        float    position[3];
+        uint32_t color;
+    };
+    static_assert(sizeof(Vertex) == 16);
+
+    using Batch     = PrimBatch<Vertex>;
+    using ShapeList = ChunkList<DebugShape::Instance, 1024>;
+
+    // 保持しておく線/三角形(変更があった時だけ転送し直す)
+    // バッファには線の後ろに 16 バイト境界から三角形を置く
+    struct Geometry
+    {
+        Batch        lines;
+        Batch        triangles;
+        MTL::Buffer* buffer         = nullptr; // Simple3D が作って解放する
+        size_t       triangleOffset = 0;
+        size_t       bytes          = 0; // バッファ全体
+        bool         dirty          = true;
+    };
+
+    //
+    struct GeometryDraw
+    {
+        GeometryHandle handle;
+        simd::float4x4 transform;
+    };
+
+    Prim3DList();
+
+    // 初期に用意しておく量(超えてもチャンクを足すだけ)
+    void reserve(size_t lineVertices, size_t triangleVertices);
+    // フレーム毎の描画を消して、変換行列を単位行列に戻す(保持するジオメトリは残す)
+    void clear();
+
+    void                   setDrawColor(float red, float green, float blue, float alpha);
+    [[nodiscard]] uint32_t getDrawColor() const { return drawColor_; }
+
+    void drawLine(simd::float3 from, simd::float3 to);
+    void drawRect(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3);
+    void drawTriangle(simd::float3 v0, simd::float3 v1, simd::float3 v2);
+    void drawPlane(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3);
+    // colors が nullptr なら描画色(端数の点は捨てる)
+    void drawLines(const simd::float3* points, size_t count, const simd::float4* colors);
+    void drawLineStrip(const simd::float3* points, size_t count, const simd::float4* colors, bool loop);
+    void drawTriangles(const simd::float3* points, size_t count, const simd::float4* colors);
+
+    // デバッグ形状
+    void addShape(DebugShape::Shape shape, DebugShape::Instance inst);
+    void drawShape(DebugShape::Shape shape, const simd::float4x4& transform);
+    void drawBox(simd::float3 center, simd::float3 size);
+    void drawSphere(simd::float3 center, float radius);
+    void drawArrow(simd::float3 from, simd::float3 to);
+    void drawGrid(simd::float3 center, float size, int divisions);
+    void drawAxes(const simd::float4x4& transform, float length);
+
+    // 以降に追加する頂点に掛ける行列(flushTransform か次の setTransform でまとめて掛ける)
+    void setTransform(const simd::float4x4& transform);
+    void flushTransform();
+    // 今の行列を積んでから右に transform を掛ける、pop で積んだ行列に戻す(clear の単位行列より下には戻らない)
+    void                         pushTransform(const simd::float4x4& transform);
+    void                         popTransform();
+    [[nodiscard]] simd::float4x4 getTransform() const { return transform_; }
+    [[nodiscard]] size_t         getTransformDepth() const { return transformStack_.size(); }
+
+    // 保持するジオメトリ
+    GeometryHandle createGeometry();
+    bool           beginGeometry(GeometryHandle handle);
+    void           endGeometry();
+    void           drawGeometry(GeometryHandle handle, const simd::float4x4& transform);
+    // 破棄したジオメトリの buffer を返す(呼び出し側で解放する)
+    MTL::Buffer* destroyGeometry(GeometryHandle handle);
+    // 記録中と無効なハンドルは nullptr
+    [[nodiscard]] Geometry* findGeometry(GeometryHandle handle);
+    // 積まれた描画毎に fn(const GeometryDraw&, Geometry&, bool upload)
+    // 記録中と無効なハンドルは飛ばす。dirty なら配置を計算し直して upload = true で渡すので、
+    // 呼び出し側は geom.bytes を転送する(同じフレームで2回目以降の描画は false)
+    // @return 転送が要るバイト数の合計
+    template <class Fn>
+    size_t forEachGeometryDraw(Fn&& fn)
+    {
+        size_t uploadBytes = 0;
+        for (const auto& draw : geometryDraws_)
+        {
+            auto* geom = findGeometry(draw.handle);
+            if (geom == nullptr)
+            {
+                continue;
+            }
+            const bool upload = geom->dirty;
+            if (upload)
+            {
+                layoutGeometry(*geom);
+                uploadBytes += geom->bytes;
+            }
+            fn(draw, *geom, upload);
+        }
+        return uploadBytes;
+    }
+    // 生きているジオメトリ毎に fn(Geometry&)
+    template <class Fn>
+    void forEachGeometry(Fn&& fn)
+    {
+        geometries_.forEach([&fn](GeometryHandle, std::unique_ptr<Geometry>& geom) { fn(*geom); });
+    }
+
+    [[nodiscard]] const Batch&                     getLines() const { return lineBatch_; }
+    [[nodiscard]] const Batch&                     getTriangles() const { return triangleBatch_; }
+    [[nodiscard]] const ShapeList&                 getShapes(DebugShape::Shape shape) const;
+    [[nodiscard]] size_t                           getShapeCount() const;
+    [[nodiscard]] const std::vector<GeometryDraw>& getGeometryDraws() const { return geometryDraws_; }
+    // 毎フレーム転送する量(線/三角形のバッチとデバッグ形状のインスタンス)
+    [[nodiscard]] size_t getImmediateBytes() const;
+
+    // 半透明(頂点色のαが1未満)の並べ替え
+    void               setSortTranslucent(bool enable) { sortTranslucent_ = enable; }
+    [[nodiscard]] bool getSortTranslucent() const { return sortTranslucent_; }
+    void               setViewMatrix(const simd::float4x4& view) { view_ = view; }
+    // ビュー空間の z (奥ほど小さい)
+    [[nodiscard]] float viewDepth(const float* p) const;
+    // 不透明な三角形は追加順のまま、半透明な三角形は重心の奥から順にインデックスを out に書く
+    void sortTriangles(uint32_t* out);
+    // 半透明なインスタンスを後ろに集めて、原点の奥から順に dst に書く
+    void sortShapes(DebugShape::Shape shape, DebugShape::Instance* dst);
+
+    // RenderQueue のキーに使う手前からの距離(ビュー空間の -z、空なら 0)
+    // バッチは一番手前の頂点、形状は一番手前のインスタンスの原点、ジオメトリはモデル行列の原点
+    [[nodiscard]] float getNearestDepth(const Batch& batch) const;
+    [[nodiscard]] float getNearestDepth(DebugShape::Shape shape) const;
+    [[nodiscard]] float getDrawDepth(const GeometryDraw& draw) const;
+
+  private:
+    ShapeList                          shapeInstances_[DebugShape::ShapeCount];
+    Batch                              lineBatch_;
+    Batch                              triangleBatch_;
+    SlotMap<std::unique_ptr<Geometry>> geometries_;
+    std::vector<GeometryDraw>          geometryDraws_;
+    Batch*                             lineTarget_     = &lineBatch_;
+    Batch*                             triangleTarget_ = &triangleBatch_;
+    GeometryHandle                     recording_      = InvalidGeometry;
+    uint32_t                           drawColor_      = 0xffffffff;
+    simd::float4x4                     transform_;
+    std::vector<simd::float4x4>        transformStack_; // push した時点の transform_
+    bool                               identity_     = true;
+    size_t                             lineMark_     = 0; // transform_ を設定した時点の頂点数
+    size_t                             triangleMark_ = 0;
+
+    bool                              sortTranslucent_ = false;
+    simd::float4x4                    view_;
+    std::vector<float>                vertexDepth_; // 並べ替えの作業領域
+    std::vector<uint8_t>              vertexTranslucent_;
+    std::vector<uint32_t>             sortIndices_;
+    std::vector<uint32_t>             sortKeys_;
+    std::vector<uint32_t>             sortOrder_;
+    std::vector<uint32_t>             tmpKeys_;
+    std::vector<uint32_t>             tmpOrder_;
+    std::vector<DebugShape::Instance> sortShapes_;
+
+    static void layoutGeometry(Geometry& geom);
+    void        applyTransform(Batch& batch, size_t first);
+    void        markTransform();
+    uint32_t    getColor(const simd::float4* colors, size_t idx) const;
+    void        append(Batch& batch, const simd::float3* points, size_t count, const simd::float4* colors);
+};
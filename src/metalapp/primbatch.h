@@ -0,0 +1,74 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "chunklist.h"
+#include <cinttypes>
+#include <cstddef>
+
+//
+// プリミティブ描画用の頂点 + インデックスのリスト
+// (頂点の後ろにインデックスを続けて1つのバッファで転送する)
+//
+template <class Vertex>
+struct PrimBatch
+{
+    static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0);
+
+    ChunkList<Vertex, 4096>   vertices;
+    ChunkList<uint32_t, 8192> indices;
+
+    //
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+    }
+    [[nodiscard]] bool empty() const { return indices.empty(); }
+
+    // 次に追加する頂点の番号
+    [[nodiscard]] uint32_t getVertexCount() const { return uint32_t(vertices.size()); }
+    [[nodiscard]] size_t   getIndexCount() const { return indices.size(); }
+
+    void addVertex(const Vertex& v) { vertices.push_back(v); }
+    void addIndex(uint32_t idx) { indices.push_back(idx); }
+
+    // count 個をチャンク毎にまとめて確保し、fn(T* dst, size_t first, size_t n) で埋めてもらう
+    // (dst[0..n) が通し番号 first から first + n - 1 に当たる)
+    template <class Fn>
+    void appendVertices(size_t count, Fn&& fn)
+    {
+        fill(vertices, count, fn);
+    }
+    template <class Fn>
+    void appendIndices(size_t count, Fn&& fn)
+    {
+        fill(indices, count, fn);
+    }
+
+    [[nodiscard]] size_t getVertexBytes() const { return vertices.size() * sizeof(Vertex); }
+    [[nodiscard]] size_t getIndexBytes() const { return indices.size() * sizeof(uint32_t); }
+    [[nodiscard]] size_t getBytes() const { return getVertexBytes() + getIndexBytes(); }
+
+    //
+    template <class List, class Fn>
+    static void fill(List& list, size_t count, Fn& fn)
+    {
+        for (size_t first = 0; first < count;)
+        {
+            size_t got;
+            auto*  dst = list.append(count - first, got);
+            fn(dst, first, got);
+            first += got;
+        }
+    }
+
+    // dst に getBytes() 分をチャンク毎に書き出す(インデックスは getVertexBytes() の位置から)
+    void copyTo(void* dst) const
+    {
+        auto* p = static_cast<uint8_t*>(dst);
+        vertices.copyTo(reinterpret_cast<Vertex*>(p));
+        indices.copyTo(reinterpret_cast<uint32_t*>(p + getVertexBytes()));
+    }
+};
@@ -0,0 +1,314 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+
+//
+// コンパイル時に生成する基本形状(頂点は結合済み、そのまま転送できる)
+//
+namespace PrimitiveMesh
+{
+
+// Vertex の描画用頂点と同じ並び(float3 position / float3 normal / float2 texcoord)
+struct alignas(16) MeshVertex
+{
+    float position[4];
+    float normal[4];
+    float texcoord[4];
+};
+static_assert(sizeof(MeshVertex) == 48);
+
+//
+template <size_t NV, size_t NI>
+struct Mesh
+{
+    static constexpr size_t vertexCount = NV;
+    static constexpr size_t indexCount  = NI;
+
+    std::array<MeshVertex, NV> vertices{};
+    std::array<uint16_t, NI>   indices{};
+};
+
+namespace detail
+{
+constexpr double Pi = 3.14159265358979323846;
+
+// [-pi, pi] に畳んでからテイラー展開
+constexpr double
+sin(double x)
+{
+    while (x > Pi)
+    {
+        x -= 2.0 * Pi;
+    }
+    while (x < -Pi)
+    {
+        x += 2.0 * Pi;
+    }
+    double term = x;
+    double sum  = x;
+    for (int n = 1; n < 12; n++)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double
+cos(double x)
+{
+    return sin(x + Pi * 0.5);
+}
+
+constexpr MeshVertex
+makeVertex(double px, double py, double pz, double nx, double ny, double nz, double u, double v)
+{
+    return {{float(px), float(py), float(pz), 0.0f}, {float(nx), float(ny), float(nz), 0.0f}, {float(u), float(v), 0.0f, 0.0f}};
+}
+
+} // namespace detail
+
+//
+// 1辺 size の立方体(面毎に頂点を分ける)
+//
+constexpr Mesh<24, 36>
+makeCube(float size = 1.0f)
+{
+    Mesh<24, 36> mesh;
+    const double s = size * 0.5;
+    // 面の法線と、面上の右/上方向
+    const double face[6][3][3] = {
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},   {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}}, {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+        {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}}, {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}}, {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+    };
+    const double corner[4][4] = {{-1, -1, 0, 1}, {1, -1, 1, 1}, {1, 1, 1, 0}, {-1, 1, 0, 0}};
+
+    for (size_t f = 0; f < 6; f++)
+    {
+        const auto& n = face[f][0];
+        const auto& r = face[f][1];
+        const auto& u = face[f][2];
+        for (size_t c = 0; c < 4; c++)
+        {
+            const auto& cn = corner[c];
+            double      p[3]{};
+            for (int e = 0; e < 3; e++)
+            {
+                p[e] = (n[e] + r[e] * cn[0] + u[e] * cn[1]) * s;
+            }
+            mesh.vertices[f * 4 + c] = detail::makeVertex(p[0], p[1], p[2], n[0], n[1], n[2], cn[2], cn[3]);
+        }
+        const uint16_t base    = uint16_t(f * 4);
+        const uint16_t quad[6] = {0, 1, 2, 2, 3, 0};
+        for (size_t i = 0; i < 6; i++)
+        {
+            mesh.indices[f * 6 + i] = uint16_t(base + quad[i]);
+        }
+    }
+    return mesh;
+}
+
+//
+// 直径 1 の UV 球(極の縮退三角形は作らない)
+//
+template <size_t Slices, size_t Stacks>
+constexpr Mesh<(Slices + 1) * (Stacks + 1), Slices * (Stacks - 1) * 6>
+makeSphere()
+{
+    static_assert(Slices >= 3 && Stacks >= 2);
+    Mesh<(Slices + 1) * (Stacks + 1), Slices * (Stacks - 1) * 6> mesh;
+
+    for (size_t i = 0; i <= Stacks; i++)
+    {
+        const double phi = detail::Pi * double(i) / double(Stacks);
+        for (size_t j = 0; j <= Slices; j++)
+        {
+            const double theta = 2.0 * detail::Pi * double(j) / double(Slices);
+            const double nx    = detail::sin(phi) * detail::cos(theta);
+            const double ny    = detail::cos(phi);
+            const double nz    = -detail::sin(phi) * detail::sin(theta);
+            const double u     = double(j) / double(Slices);
+            const double v     = double(i) / double(Stacks);
+
+            mesh.vertices[i * (Slices + 1) + j] = detail::makeVertex(nx * 0.5, ny * 0.5, nz * 0.5, nx, ny, nz, u, v);
+        }
+    }
+
+    size_t idx = 0;
+    for (size_t i = 0; i < Stacks; i++)
+    {
+        for (size_t j = 0; j < Slices; j++)
+        {
+            const uint16_t a = uint16_t(i * (Slices + 1) + j);
+            const uint16_t b = uint16_t(a + Slices + 1);
+            if (i != 0)
+            {
+                mesh.indices[idx++] = a;
+                mesh.indices[idx++] = b;
+                mesh.indices[idx++] = uint16_t(a + 1);
+            }
+            if (i != Stacks - 1)
+            {
+                mesh.indices[idx++] = uint16_t(a + 1);
+                mesh.indices[idx++] = b;
+                mesh.indices[idx++] = uint16_t(b + 1);
+            }
+        }
+    }
+    return mesh;
+}
+
+//
+// 直径 1、高さ 1 の円柱(側面と上下の蓋)
+//
+template <size_t Slices>
+constexpr Mesh<(Slices + 1) * 2 + (Slices + 2) * 2, Slices * 12>
+makeCylinder()
+{
+    static_assert(Slices >= 3);
+    Mesh<(Slices + 1) * 2 + (Slices + 2) * 2, Slices * 12> mesh;
+
+    // 側面
+    for (size_t j = 0; j <= Slices; j++)
+    {
+        const double theta = 2.0 * detail::Pi * double(j) / double(Slices);
+        const double nx    = detail::cos(theta);
+        const double nz    = -detail::sin(theta);
+        const double u     = double(j) / double(Slices);
+
+        mesh.vertices[j * 2 + 0] = detail::makeVertex(nx * 0.5, 0.5, nz * 0.5, nx, 0.0, nz, u, 0.0);
+        mesh.vertices[j * 2 + 1] = detail::makeVertex(nx * 0.5, -0.5, nz * 0.5, nx, 0.0, nz, u, 1.0);
+    }
+    size_t idx = 0;
+    for (size_t j = 0; j < Slices; j++)
+    {
+        const uint16_t a      = uint16_t(j * 2);
+        const uint16_t tri[6] = {a, uint16_t(a + 1), uint16_t(a + 2), uint16_t(a + 2), uint16_t(a + 1), uint16_t(a + 3)};
+        for (auto i : tri)
+        {
+            mesh.indices[idx++] = i;
+        }
+    }
+
+    // 蓋(中心 + 周囲)
+    for (size_t cap = 0; cap < 2; cap++)
+    {
+        const double   y      = cap == 0 ? 0.5 : -0.5;
+        const double   ny     = cap == 0 ? 1.0 : -1.0;
+        const uint16_t center = uint16_t((Slices + 1) * 2 + cap * (Slices + 2));
+
+        mesh.vertices[center] = detail::makeVertex(0.0, y, 0.0, 0.0, ny, 0.0, 0.5, 0.5);
+        for (size_t j = 0; j <= Slices; j++)
+        {
+            const double theta = 2.0 * detail::Pi * double(j) / double(Slices);
+            const double cx    = detail::cos(theta);
+            const double cz    = -detail::sin(theta);
+
+            mesh.vertices[center + 1 + j] =
+                detail::makeVertex(cx * 0.5, y, cz * 0.5, 0.0, ny, 0.0, cx * 0.5 + 0.5, cz * 0.5 + 0.5);
+        }
+        for (size_t j = 0; j < Slices; j++)
+        {
+            const uint16_t p0 = uint16_t(center + 1 + j);
+            const uint16_t p1 = uint16_t(p0 + 1);
+
+            mesh.indices[idx++] = center;
+            mesh.indices[idx++] = cap == 0 ? p0 : p1;
+            mesh.indices[idx++] = cap == 0 ? p1 : p0;
+        }
+    }
+    return mesh;
+}
+
+//
+// XZ平面上の 1x1 のグリッド(+Y向き)
+//
+template <size_t DivX, size_t DivZ>
+constexpr Mesh<(DivX + 1) * (DivZ + 1), DivX * DivZ * 6>
+makeGrid()
+{
+    static_assert(DivX >= 1 && DivZ >= 1);
+    Mesh<(DivX + 1) * (DivZ + 1), DivX * DivZ * 6> mesh;
+
+    for (size_t z = 0; z <= DivZ; z++)
+    {
+        for (size_t x = 0; x <= DivX; x++)
+        {
+            const double u = double(x) / double(DivX);
+            const double v = double(z) / double(DivZ);
+
+            mesh.vertices[z * (DivX + 1) + x] = detail::makeVertex(u - 0.5, 0.0, v - 0.5, 0.0, 1.0, 0.0, u, v);
+        }
+    }
+    size_t idx = 0;
+    for (size_t z = 0; z < DivZ; z++)
+    {
+        for (size_t x = 0; x < DivX; x++)
+        {
+            const uint16_t a      = uint16_t(z * (DivX + 1) + x);
+            const uint16_t b      = uint16_t(a + DivX + 1);
+            const uint16_t tri[6] = {a, b, uint16_t(a + 1), uint16_t(a + 1), b, uint16_t(b + 1)};
+            for (auto i : tri)
+            {
+                mesh.indices[idx++] = i;
+            }
+        }
+    }
+    return mesh;
+}
+
+//
+// 検証: インデックスが範囲内で、三角形の向き(反時計回りが表)が頂点法線と一致しているか
+//
+template <size_t NV, size_t NI>
+constexpr bool
+isValid(const Mesh<NV, NI>& mesh)
+{
+    if (NI % 3 != 0 || NV > 65536)
+    {
+        return false;
+    }
+    for (size_t t = 0; t < NI; t += 3)
+    {
+        const MeshVertex* v[3]{};
+        for (size_t k = 0; k < 3; k++)
+        {
+            if (mesh.indices[t + k] >= NV)
+            {
+                return false;
+            }
+            v[k] = &mesh.vertices[mesh.indices[t + k]];
+        }
+        double d0[3]{};
+        double d1[3]{};
+        for (int e = 0; e < 3; e++)
+        {
+            d0[e] = double(v[1]->position[e]) - v[0]->position[e];
+            d1[e] = double(v[2]->position[e]) - v[1]->position[e];
+        }
+        const double n[3] = {d0[1] * d1[2] - d0[2] * d1[1], d0[2] * d1[0] - d0[0] * d1[2], d0[0] * d1[1] - d0[1] * d1[0]};
+        double       dot  = 0.0;
+        for (int e = 0; e < 3; e++)
+        {
+            dot += n[e] * (double(v[0]->normal[e]) + v[1]->normal[e] + v[2]->normal[e]);
+        }
+        if (dot <= 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isValid(makeCube()));
+static_assert(isValid(makeSphere<16, 8>()));
+static_assert(isValid(makeCylinder<16>()));
+static_assert(isValid(makeGrid<4, 3>()));
+static_assert(makeCube().vertices[0].position[0] == -0.5f && makeCube().vertices[0].texcoord[1] == 1.0f);
+
+} // namespace PrimitiveMesh
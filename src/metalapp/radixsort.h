@@ -0,0 +1,340 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// 符号なし整数キーの LSD 基数ソート(8bit x キーのバイト数パス、安定)
+// 全要素で同じ値になる桁のパスは飛ばす
+//
+namespace RadixSort
+{
+
+// sortParallel で1スレッドに割り当てる最小の要素数
+constexpr size_t   MinCountPerThread = 1 << 16;
+constexpr unsigned MaxThreads        = 8;
+
+// keys/values を keys の昇順に並べ替える(tmpKeys/tmpValues は count 個の作業領域)
+template <class Key, class Value>
+void
+sort(Key* keys, Value* values, size_t count, Key* tmpKeys, Value* tmpValues)
+{
+    static_assert(std::is_unsigned_v<Key>);
+    constexpr int Passes = int(sizeof(Key));
+
+    // 全パス分のヒストグラムを1回の走査で作る
+    size_t histogram[Passes][256] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        const Key key = keys[i];
+        for (int p = 0; p < Passes; p++)
+        {
+            histogram[p][(key >> (p * 8)) & 0xff]++;
+        }
+    }
+
+    Key*   srcKeys   = keys;
+    Value* srcValues = values;
+    Key*   dstKeys   = tmpKeys;
+    Value* dstValues = tmpValues;
+    for (int p = 0; p < Passes; p++)
+    {
+        auto& hist = histogram[p];
+        if (count == 0 || hist[(srcKeys[0] >> (p * 8)) & 0xff] == count)
+        {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto& h : hist)
+        {
+            const size_t n = h;
+            h              = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t dst = hist[(srcKeys[i] >> (p * 8)) & 0xff]++;
+            dstKeys[dst]     = srcKeys[i];
+            dstValues[dst]   = srcValues[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+    // 奇数回入れ替えた時は元の配列に戻す
+    if (srcKeys != keys)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i]   = srcKeys[i];
+            values[i] = srcValues[i];
+        }
+    }
+}
+
+//
+template <class Key, class Value>
+void
+sort(std::vector<Key>& keys, std::vector<Value>& values, std::vector<Key>& tmpKeys, std::vector<Value>& tmpValues)
+{
+    tmpKeys.resize(keys.size());
+    tmpValues.resize(values.size());
+    sort(keys.data(), values.data(), keys.size(), tmpKeys.data(), tmpValues.data());
+}
+
+namespace detail
+{
+// 全スレッドが揃うまで待つ(C++17 なので std::barrier の代わり)
+class Barrier
+{
+    std::mutex              mutex_;
+    std::condition_variable cond_;
+    unsigned                count_;
+    unsigned                waiting_    = 0;
+    unsigned                generation_ = 0;
+
+  public:
+    explicit Barrier(unsigned count) : count_(count) {}
+
+    void wait()
+    {
+        std::unique_lock lock(mutex_);
+        const auto       gen = generation_;
+        if (++waiting_ == count_)
+        {
+            waiting_ = 0;
+            generation_++;
+            cond_.notify_all();
+            return;
+        }
+        cond_.wait(lock, [&] { return gen != generation_; });
+    }
+};
+
+// sortParallel の作業スレッド(初めて使った時に作って、終了まで待機させておく)
+// 呼び出したスレッドが番号 0 を受け持ち、1 以降をプールのスレッドが受け持つ
+class WorkerPool
+{
+    using Job = void (*)(void*, unsigned);
+
+    std::mutex               runMutex_; // 別のスレッドから同時に呼ばれたら順番に
+    std::mutex               mutex_;
+    std::condition_variable  wake_;
+    std::condition_variable  done_;
+    std::vector<std::thread> threads_;
+    Job                      job_        = nullptr;
+    void*                    context_    = nullptr;
+    unsigned                 active_     = 0; // 今回の作業に使うスレッド数(呼び出し元を含む)
+    unsigned                 pending_    = 0; // まだ終わっていないプールのスレッド数
+    uint64_t                 generation_ = 0;
+    bool                     quit_       = false;
+
+    //
+    void loop(unsigned index)
+    {
+        uint64_t         seen = 0;
+        std::unique_lock lock(mutex_);
+        for (;;)
+        {
+            wake_.wait(lock, [&] { return quit_ || generation_ != seen; });
+            if (quit_)
+            {
+                return;
+            }
+            seen = generation_;
+            if (index >= active_)
+            {
+                continue;
+            }
+            const auto job     = job_;
+            const auto context = context_;
+            lock.unlock();
+            job(context, index);
+            lock.lock();
+            if (--pending_ == 0)
+            {
+                done_.notify_one();
+            }
+        }
+    }
+
+  public:
+    static WorkerPool& get()
+    {
+        static WorkerPool pool;
+        return pool;
+    }
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            quit_ = true;
+        }
+        wake_.notify_all();
+        for (auto& th : threads_)
+        {
+            th.join();
+        }
+    }
+
+    // fn(0) .. fn(threadCount - 1) を並行に呼んで、全て終わるまで待つ
+    template <class Fn>
+    void run(unsigned threadCount, Fn& fn)
+    {
+        std::lock_guard runLock(runMutex_);
+        {
+            std::lock_guard lock(mutex_);
+            while (threads_.size() + 1 < threadCount)
+            {
+                const auto index = unsigned(threads_.size() + 1);
+                threads_.emplace_back([this, index] { loop(index); });
+            }
+            job_     = [](void* context, unsigned index) { (*static_cast<Fn*>(context))(index); };
+            context_ = &fn;
+            active_  = threadCount;
+            pending_ = threadCount - 1;
+            generation_++;
+        }
+        wake_.notify_all();
+        fn(0);
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [&] { return pending_ == 0; });
+    }
+};
+} // namespace detail
+
+// sort と同じ結果を複数スレッドで作る
+// 要素を連続した区間でスレッドに分け、パス毎に (桁, スレッド) 順の書き込み位置を決めるので安定
+// threadCount が 0 ならコア数(どちらも MaxThreads まで)、要素が少なければ呼び出したスレッドだけで sort する
+// スレッドは detail::WorkerPool のものを使い回し、作業領域もスタックに置くので呼び出し毎の確保は無い
+template <class Key, class Value>
+void
+sortParallel(Key* keys, Value* values, size_t count, Key* tmpKeys, Value* tmpValues, unsigned threadCount = 0)
+{
+    static_assert(std::is_unsigned_v<Key>);
+    constexpr int Passes = int(sizeof(Key));
+    using Histogram      = std::array<size_t, 256>;
+
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    threadCount = unsigned(std::min<size_t>({threadCount, MaxThreads, count / MinCountPerThread}));
+    if (threadCount <= 1)
+    {
+        sort(keys, values, count, tmpKeys, tmpValues);
+        return;
+    }
+
+    std::array<std::array<Histogram, Passes>, MaxThreads> local{};
+    std::array<Histogram, MaxThreads>                     offsets;
+    std::array<bool, Passes>                              skip{};
+    detail::Barrier                                       barrier(threadCount);
+
+    auto worker = [&](unsigned t)
+    {
+        const size_t begin = count * t / threadCount;
+        const size_t end   = count * (t + 1) / threadCount;
+        auto&        hist  = local[t];
+        for (size_t i = begin; i < end; i++)
+        {
+            const Key key = keys[i];
+            for (int p = 0; p < Passes; p++)
+            {
+                hist[p][(key >> (p * 8)) & 0xff]++;
+            }
+        }
+        barrier.wait();
+        if (t == 0)
+        {
+            for (int p = 0; p < Passes; p++)
+            {
+                const size_t digit = (keys[0] >> (p * 8)) & 0xff;
+                size_t       same  = 0;
+                for (unsigned th = 0; th < threadCount; th++)
+                {
+                    same += local[th][p][digit];
+                }
+                skip[p] = same == count;
+            }
+        }
+        barrier.wait();
+
+        // 入れ替えは全スレッドで同じように進む
+        Key*   srcKeys   = keys;
+        Value* srcValues = values;
+        Key*   dstKeys   = tmpKeys;
+        Value* dstValues = tmpValues;
+        bool   first     = true;
+        for (int p = 0; p < Passes; p++)
+        {
+            if (skip[p])
+            {
+                continue;
+            }
+            // 2回目以降は区間の中身が変わっているので数え直す
+            if (!first)
+            {
+                hist[p].fill(0);
+                for (size_t i = begin; i < end; i++)
+                {
+                    hist[p][(srcKeys[i] >> (p * 8)) & 0xff]++;
+                }
+                barrier.wait();
+            }
+            if (t == 0)
+            {
+                size_t offset = 0;
+                for (size_t d = 0; d < 256; d++)
+                {
+                    for (unsigned th = 0; th < threadCount; th++)
+                    {
+                        offsets[th][d] = offset;
+                        offset += local[th][p][d];
+                    }
+                }
+            }
+            barrier.wait();
+            auto& offset = offsets[t];
+            for (size_t i = begin; i < end; i++)
+            {
+                const size_t dst = offset[(srcKeys[i] >> (p * 8)) & 0xff]++;
+                dstKeys[dst]     = srcKeys[i];
+                dstValues[dst]   = srcValues[i];
+            }
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+            first = false;
+            barrier.wait();
+        }
+        if (srcKeys != keys)
+        {
+            std::copy(srcKeys + begin, srcKeys + end, keys + begin);
+            std::copy(srcValues + begin, srcValues + end, values + begin);
+        }
+    };
+
+    detail::WorkerPool::get().run(threadCount, worker);
+}
+
+//
+template <class Key, class Value>
+void
+sortParallel(std::vector<Key>& keys, std::vector<Value>& values, std::vector<Key>& tmpKeys, std::vector<Value>& tmpValues)
+{
+    tmpKeys.resize(keys.size());
+    tmpValues.resize(values.size());
+    sortParallel(keys.data(), values.data(), keys.size(), tmpKeys.data(), tmpValues.data());
+}
+
+} // namespace RadixSort
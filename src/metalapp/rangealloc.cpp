@@ -0,0 +1,122 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "rangealloc.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+//
+//
+//
+void
+RangeAllocator::reset(size_t capacity, size_t alignment)
+{
+    alignment_ = std::max<size_t>(alignment, 1);
+    capacity_  = capacity / alignment_ * alignment_;
+    used_      = 0;
+    freeList_.clear();
+    if (capacity_ > 0)
+    {
+        freeList_[0] = capacity_;
+    }
+}
+
+//
+//
+//
+size_t
+RangeAllocator::allocate(size_t size)
+{
+    size = alignedSize(std::max<size_t>(size, 1));
+    for (auto it = freeList_.begin(); it != freeList_.end(); ++it)
+    {
+        if (it->second < size)
+        {
+            continue;
+        }
+        auto offset = it->first;
+        auto remain = it->second - size;
+        freeList_.erase(it);
+        if (remain > 0)
+        {
+            freeList_[offset + size] = remain;
+        }
+        used_ += size;
+        return offset;
+    }
+    return npos;
+}
+
+//
+//
+//
+void
+RangeAllocator::free(size_t offset, size_t size)
+{
+    size = alignedSize(std::max<size_t>(size, 1));
+    assert(offset + size <= capacity_);
+    used_ -= size;
+
+    auto next = freeList_.lower_bound(offset);
+    // 後ろと結合
+    if (next != freeList_.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeList_.erase(next);
+    }
+    // 前と結合
+    if (next != freeList_.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+    freeList_.emplace_hint(next, offset, size);
+}
+
+//
+//
+//
+size_t
+RangeAllocator::compact(std::vector<Move>& moves)
+{
+    std::sort(moves.begin(), moves.end(), [](const Move& l, const Move& r) { return l.from < r.from; });
+    size_t end  = 0;
+    size_t prev = 0; // 前の範囲の元の末尾
+    for (auto& m : moves)
+    {
+        const size_t size = alignedSize(std::max<size_t>(m.size, 1));
+        assert(m.from >= prev); // 範囲が重なっている
+        prev = m.from + size;
+        m.to = end;
+        end += size;
+    }
+    assert(end == used_); // 渡されていない使用中の範囲がある
+    (void)prev;
+
+    freeList_.clear();
+    if (end < capacity_)
+    {
+        freeList_[end] = capacity_ - end;
+    }
+    used_ = end;
+    return end;
+}
+
+//
+//
+//
+size_t
+RangeAllocator::getLargestFree() const
+{
+    size_t largest = 0;
+    for (auto& fb : freeList_)
+    {
+        largest = std::max(largest, fb.second);
+    }
+    return largest;
+}
@@ -0,0 +1,56 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+//
+// 連続領域の部分確保(first fit / 解放時に隣接領域と結合)
+//
+class RangeAllocator
+{
+    std::map<size_t, size_t> freeList_; // offset -> size
+    size_t                   capacity_  = 0;
+    size_t                   alignment_ = 1;
+    size_t                   used_      = 0;
+
+  public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    // 詰め直しで使用中の範囲を移す先
+    struct Move
+    {
+        size_t   from = 0; // 今の位置
+        size_t   to   = 0; // 詰めた後の位置(compact が書く)
+        size_t   size = 0;
+        uint32_t id   = 0; // 呼び出し側の識別子
+    };
+
+    RangeAllocator() = default;
+    RangeAllocator(size_t capacity, size_t alignment) { reset(capacity, alignment); }
+
+    // 全て解放して容量を設定
+    void reset(size_t capacity, size_t alignment = 1);
+
+    // 容量はそのままで全て解放
+    void clear() { reset(capacity_, alignment_); }
+
+    // @return 先頭位置(確保できなければ npos)
+    size_t allocate(size_t size);
+    void   free(size_t offset, size_t size);
+
+    // 使用中の範囲(moves の from と size)を先頭から隙間なく並べ直し、空きを末尾の1つにまとめる
+    // moves は from の順に並べ替えて to を書く(to は from より後ろにならないので、返した順に memmove すれば上書きしない)
+    // @return 使用中の末尾
+    size_t compact(std::vector<Move>& moves);
+
+    [[nodiscard]] size_t alignedSize(size_t size) const { return (size + alignment_ - 1) / alignment_ * alignment_; }
+    [[nodiscard]] size_t getCapacity() const { return capacity_; }
+    [[nodiscard]] size_t getUsed() const { return used_; }
+    [[nodiscard]] size_t getLargestFree() const;
+    [[nodiscard]] size_t getFreeBlockCount() const { return freeList_.size(); }
+};
@@ -0,0 +1,441 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "rendergraph.h"
+#include <algorithm>
+#include <functional>
+
+//
+//
+//
+RenderGraph::ResourceId
+RenderGraph::createTransient(const char* name, const TextureDesc& desc)
+{
+    resources_.push_back({name, desc, false, takeList(), {}, Invalid});
+    return ResourceId(resources_.size() - 1);
+}
+
+//
+//
+//
+RenderGraph::ResourceId
+RenderGraph::importResource(const char* name)
+{
+    resources_.push_back({name, {}, true, takeList(), {}, Invalid});
+    return ResourceId(resources_.size() - 1);
+}
+
+//
+//
+//
+RenderGraph::PassId
+RenderGraph::addPass(const char* name, Execute execute, void* user)
+{
+    passes_.push_back({name, execute, user, takeList(), takeList()});
+    return PassId(passes_.size() - 1);
+}
+
+//
+//
+//
+void
+RenderGraph::read(PassId pass, ResourceId resource)
+{
+    passes_[pass].reads.push_back(resource);
+}
+
+//
+//
+//
+void
+RenderGraph::write(PassId pass, ResourceId resource)
+{
+    passes_[pass].writes.push_back(resource);
+    resources_[resource].writers.push_back(pass);
+}
+
+//
+//
+//
+void
+RenderGraph::setSideEffect(PassId pass)
+{
+    passes_[pass].sideEffect = true;
+}
+
+//
+//
+//
+void
+RenderGraph::clear()
+{
+    for (auto& pass : passes_)
+    {
+        releaseList(pass.reads);
+        releaseList(pass.writes);
+    }
+    for (auto& res : resources_)
+    {
+        releaseList(res.writers);
+    }
+    passes_.clear();
+    resources_.clear();
+    order_.clear();
+    physicalSize_.clear();
+}
+
+//
+// 宣言の配列は clear で捨てずに取っておき、次のフレームの宣言で使い回す
+//
+std::vector<uint32_t>
+RenderGraph::takeList()
+{
+    if (spareLists_.empty())
+    {
+        return {};
+    }
+    auto list = std::move(spareLists_.back());
+    spareLists_.pop_back();
+    return list;
+}
+
+//
+void
+RenderGraph::releaseList(std::vector<uint32_t>& list)
+{
+    list.clear();
+    spareLists_.push_back(std::move(list));
+}
+
+//
+//
+//
+size_t
+RenderGraph::getBytes(const TextureDesc& desc)
+{
+    return size_t(desc.width) * desc.height * desc.bytesPerPixel;
+}
+
+//
+//
+//
+size_t
+RenderGraph::getTransientBytes() const
+{
+    size_t total = 0;
+    for (auto size : physicalSize_)
+    {
+        total += size;
+    }
+    return total;
+}
+
+//
+//
+//
+size_t
+RenderGraph::getRequestedBytes() const
+{
+    size_t total = 0;
+    for (const auto& res : resources_)
+    {
+        if (res.physical != Invalid)
+        {
+            total += getBytes(res.desc);
+        }
+    }
+    return total;
+}
+
+namespace
+{
+// pass が読む resource の書き込み元: pass より前に宣言された書き込み(無ければ全ての書き込み)
+template <class Writers, class Func>
+void
+forEachSource(const Writers& writers, uint32_t pass, Func&& func)
+{
+    const auto before = std::lower_bound(writers.begin(), writers.end(), pass);
+    const auto last   = before == writers.begin() ? writers.end() : before;
+    for (auto it = writers.begin(); it != last; ++it)
+    {
+        if (*it != pass)
+        {
+            func(*it);
+        }
+    }
+}
+} // namespace
+
+//
+// 削除されないパスから読み込みを辿って、使われるパスに印を付ける
+//
+void
+RenderGraph::cull()
+{
+    stack_.clear();
+    for (PassId p = 0; p < passes_.size(); p++)
+    {
+        auto& pass = passes_[p];
+        pass.alive = pass.sideEffect;
+        for (auto r : pass.writes)
+        {
+            pass.alive |= resources_[r].imported;
+        }
+        if (pass.alive)
+        {
+            stack_.push_back(p);
+        }
+    }
+    while (!stack_.empty())
+    {
+        const PassId p = stack_.back();
+        stack_.pop_back();
+        for (auto r : passes_[p].reads)
+        {
+            forEachSource(resources_[r].writers, p,
+                          [&](PassId w)
+                          {
+                              if (!passes_[w].alive)
+                              {
+                                  passes_[w].alive = true;
+                                  stack_.push_back(w);
+                              }
+                          });
+        }
+    }
+}
+
+//
+// 依存(書き込み->読み込み、読み込み->後の書き込み、書き込み同士は宣言順)でトポロジカルソート
+// 順序に制約が無いパス同士は宣言順
+//
+bool
+RenderGraph::sortPasses()
+{
+    auto forEachEdge = [&](auto&& func)
+    {
+        for (const auto& res : resources_)
+        {
+            PassId prev = Invalid;
+            for (auto w : res.writers)
+            {
+                if (!passes_[w].alive)
+                {
+                    continue;
+                }
+                if (prev != Invalid)
+                {
+                    func(prev, w);
+                }
+                prev = w;
+            }
+        }
+        for (PassId p = 0; p < passes_.size(); p++)
+        {
+            const auto& pass = passes_[p];
+            if (!pass.alive)
+            {
+                continue;
+            }
+            for (auto r : pass.reads)
+            {
+                const auto& writers = resources_[r].writers;
+                forEachSource(writers, p, [&](PassId w) { func(w, p); });
+                // 前の書き込みを読んだなら、後の書き込みはこのパスの後
+                if (!writers.empty() && writers.front() < p)
+                {
+                    for (auto it = std::upper_bound(writers.begin(), writers.end(), p); it != writers.end(); ++it)
+                    {
+                        if (passes_[*it].alive)
+                        {
+                            func(p, *it);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    // 隣接リストを CSR で作る
+    const size_t count = passes_.size();
+    edgeOffset_.assign(count + 1, 0);
+    indegree_.assign(count, 0);
+    forEachEdge(
+        [&](PassId from, PassId to)
+        {
+            edgeOffset_[from + 1]++;
+            indegree_[to]++;
+        });
+    for (size_t i = 0; i < count; i++)
+    {
+        edgeOffset_[i + 1] += edgeOffset_[i];
+    }
+    edges_.resize(edgeOffset_[count]);
+    edgeFill_.assign(edgeOffset_.begin(), edgeOffset_.end() - 1);
+    forEachEdge([&](PassId from, PassId to) { edges_[edgeFill_[from]++] = to; });
+
+    // 実行可能なパスのうち宣言順で最も早いものから
+    order_.clear();
+    stack_.clear();
+    size_t alive = 0;
+    for (PassId p = 0; p < count; p++)
+    {
+        if (passes_[p].alive)
+        {
+            alive++;
+            if (indegree_[p] == 0)
+            {
+                stack_.push_back(p);
+            }
+        }
+    }
+    std::make_heap(stack_.begin(), stack_.end(), std::greater<>());
+    while (!stack_.empty())
+    {
+        std::pop_heap(stack_.begin(), stack_.end(), std::greater<>());
+        const PassId p = stack_.back();
+        stack_.pop_back();
+        order_.push_back(p);
+        for (auto i = edgeOffset_[p]; i < edgeOffset_[p + 1]; i++)
+        {
+            if (--indegree_[edges_[i]] == 0)
+            {
+                stack_.push_back(edges_[i]);
+                std::push_heap(stack_.begin(), stack_.end(), std::greater<>());
+            }
+        }
+    }
+    return order_.size() == alive;
+}
+
+//
+//
+//
+void
+RenderGraph::computeLifetimes()
+{
+    for (auto& res : resources_)
+    {
+        res.lifetime = {};
+        res.physical = Invalid;
+    }
+    for (uint32_t i = 0; i < order_.size(); i++)
+    {
+        const auto& pass  = passes_[order_[i]];
+        auto        touch = [&](ResourceId r)
+        {
+            auto& lt = resources_[r].lifetime;
+            lt.first = std::min(lt.first, i);
+            lt.last  = lt.last == Invalid ? i : std::max(lt.last, i);
+        };
+        std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+        std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+    }
+}
+
+//
+// 使い始めの順に、空いているスロットのうち大きさの合うものへ入れる
+// (空きが無ければスロットを足す、足りなければ一番大きい空きを広げる)
+//
+void
+RenderGraph::assignPhysical()
+{
+    physicalSize_.clear();
+    physicalLast_.clear();
+    transients_.clear();
+    for (ResourceId r = 0; r < resources_.size(); r++)
+    {
+        const auto& res = resources_[r];
+        if (!res.imported && res.lifetime.first != Invalid)
+        {
+            transients_.push_back(r);
+        }
+    }
+    std::sort(transients_.begin(), transients_.end(),
+              [&](ResourceId a, ResourceId b)
+              {
+                  const auto& ra = resources_[a];
+                  const auto& rb = resources_[b];
+                  if (ra.lifetime.first != rb.lifetime.first)
+                  {
+                      return ra.lifetime.first < rb.lifetime.first;
+                  }
+                  return getBytes(ra.desc) > getBytes(rb.desc);
+              });
+
+    for (auto r : transients_)
+    {
+        auto&        res   = resources_[r];
+        const size_t bytes = getBytes(res.desc);
+        uint32_t     fit   = Invalid;
+        uint32_t     large = Invalid;
+        for (uint32_t s = 0; s < physicalSize_.size(); s++)
+        {
+            if (physicalLast_[s] >= res.lifetime.first)
+            {
+                continue;
+            }
+            const size_t size = physicalSize_[s];
+            if (size >= bytes && (fit == Invalid || size < physicalSize_[fit]))
+            {
+                fit = s;
+            }
+            if (large == Invalid || size > physicalSize_[large])
+            {
+                large = s;
+            }
+        }
+        uint32_t slot = fit != Invalid ? fit : large;
+        if (slot == Invalid)
+        {
+            slot = uint32_t(physicalSize_.size());
+            physicalSize_.push_back(0);
+            physicalLast_.push_back(0);
+        }
+        physicalSize_[slot] = std::max(physicalSize_[slot], bytes);
+        physicalLast_[slot] = res.lifetime.last;
+        res.physical        = slot;
+    }
+}
+
+//
+//
+//
+bool
+RenderGraph::compile()
+{
+    // 書き込みは宣言順(パス番号順)で見る
+    for (auto& res : resources_)
+    {
+        auto& writers = res.writers;
+        std::sort(writers.begin(), writers.end());
+        writers.erase(std::unique(writers.begin(), writers.end()), writers.end());
+    }
+    cull();
+    if (!sortPasses())
+    {
+        order_.clear();
+        return false;
+    }
+    computeLifetimes();
+    assignPhysical();
+    return true;
+}
+
+//
+//
+//
+void
+RenderGraph::execute(void* context) const
+{
+    for (auto p : order_)
+    {
+        const auto& pass = passes_[p];
+        if (pass.execute)
+        {
+            pass.execute(pass.user, context);
+        }
+    }
+}
+
+//
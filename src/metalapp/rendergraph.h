@@ -0,0 +1,122 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+//
+// パスが読み書きするリソースを宣言して、不要なパスの削除/実行順/リソースの寿命を決める
+// 寿命が重ならない一時リソースは同じ実体(物理スロット)を共有する
+// (GPU API には依存しない、実体の確保は呼び出し側で物理スロット毎に行う)
+//
+class RenderGraph
+{
+  public:
+    using ResourceId = uint32_t;
+    using PassId     = uint32_t;
+    // context は execute に渡したもの(コマンドバッファなど)
+    using Execute = void (*)(void* user, void* context);
+
+    static constexpr uint32_t Invalid = 0xffffffff;
+
+    // 一時リソースの記述(format は呼び出し側の値をそのまま持つだけ)
+    struct TextureDesc
+    {
+        uint32_t width         = 0;
+        uint32_t height        = 0;
+        uint32_t format        = 0;
+        uint32_t bytesPerPixel = 4;
+    };
+
+    // 実行順での最初と最後の位置(使われていなければ Invalid)
+    struct Lifetime
+    {
+        uint32_t first = Invalid;
+        uint32_t last  = Invalid;
+    };
+
+    // name は文字列リテラルを想定(コピーしない)
+    ResourceId createTransient(const char* name, const TextureDesc& desc);
+    // 外部のリソース(画面など)、書き込むパスは削除しない
+    ResourceId importResource(const char* name);
+    PassId     addPass(const char* name, Execute execute, void* user);
+    void       read(PassId pass, ResourceId resource);
+    void       write(PassId pass, ResourceId resource);
+    // 出力が読まれなくても削除しない
+    void setSideEffect(PassId pass);
+
+    // @return 依存が循環していたら false
+    bool compile();
+    // compile した順に実行
+    void execute(void* context) const;
+    // 宣言を全て捨てる(作業領域と宣言の配列は残すので、同じ規模のグラフならヒープ確保しない)
+    void clear();
+
+    [[nodiscard]] const std::vector<PassId>& getOrder() const { return order_; }
+    [[nodiscard]] bool                       isCulled(PassId pass) const { return !passes_[pass].alive; }
+    [[nodiscard]] const Lifetime&            getLifetime(ResourceId resource) const { return resources_[resource].lifetime; }
+    [[nodiscard]] const TextureDesc&         getDesc(ResourceId resource) const { return resources_[resource].desc; }
+    [[nodiscard]] const char*                getPassName(PassId pass) const { return passes_[pass].name; }
+    [[nodiscard]] const char*                getResourceName(ResourceId resource) const { return resources_[resource].name; }
+    [[nodiscard]] size_t                     getPassCount() const { return passes_.size(); }
+    [[nodiscard]] size_t                     getResourceCount() const { return resources_.size(); }
+
+    // 一時リソースの割り当て先(外部や未使用なら Invalid)
+    [[nodiscard]] uint32_t getPhysicalIndex(ResourceId resource) const { return resources_[resource].physical; }
+    [[nodiscard]] size_t   getPhysicalCount() const { return physicalSize_.size(); }
+    [[nodiscard]] size_t   getPhysicalSize(uint32_t physical) const { return physicalSize_[physical]; }
+    // 共有した後の合計と、共有しなかった場合の合計
+    [[nodiscard]] size_t getTransientBytes() const;
+    [[nodiscard]] size_t getRequestedBytes() const;
+
+  private:
+    struct Pass
+    {
+        const char*             name;
+        Execute                 execute;
+        void*                   user;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        bool                    sideEffect = false;
+        bool                    alive      = false;
+    };
+    struct Resource
+    {
+        const char*         name;
+        TextureDesc         desc;
+        bool                imported;
+        std::vector<PassId> writers; // 宣言順
+        Lifetime            lifetime;
+        uint32_t            physical = Invalid;
+    };
+
+    static size_t getBytes(const TextureDesc& desc);
+
+    std::vector<uint32_t> takeList();
+    void                  releaseList(std::vector<uint32_t>& list);
+
+    void cull();
+    bool sortPasses();
+    void computeLifetimes();
+    void assignPhysical();
+
+    std::vector<Pass>     passes_;
+    std::vector<Resource> resources_;
+    std::vector<PassId>   order_;
+    std::vector<size_t>   physicalSize_;
+
+    // compile の作業領域
+    std::vector<PassId>     stack_;
+    std::vector<uint32_t>   indegree_;
+    std::vector<uint32_t>   edgeOffset_;
+    std::vector<uint32_t>   edgeFill_;
+    std::vector<PassId>     edges_;
+    std::vector<ResourceId> transients_;
+    std::vector<uint32_t>   physicalLast_;
+
+    // clear したパスとリソースの reads/writes/writers(容量を残して使い回す)
+    std::vector<std::vector<uint32_t>> spareLists_;
+};
@@ -0,0 +1,111 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "renderqueue.h"
+#include "radixsort.h"
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t DepthBits = 24;
+constexpr uint32_t DepthMax  = (1u << DepthBits) - 1;
+
+//
+uint64_t
+quantizeDepth(float depth)
+{
+    return uint64_t(std::clamp(depth, 0.0f, 1.0f) * float(DepthMax) + 0.5f);
+}
+
+} // namespace
+
+//
+//
+//
+uint64_t
+RenderQueue::makeKey(uint8_t layer, uint32_t pipeline, uint32_t texture, float depth, bool translucent)
+{
+    const uint64_t state = uint64_t(std::min(pipeline, MaxPipeline)) << 12 | std::min(texture, MaxTexture);
+    uint64_t       key   = uint64_t(layer) << 56 | uint64_t(translucent) << 55;
+    if (translucent)
+    {
+        key |= (DepthMax - quantizeDepth(depth)) << 31 | state << 7;
+    }
+    else
+    {
+        key |= state << 31 | quantizeDepth(depth) << 7;
+    }
+    return key;
+}
+
+//
+//
+//
+uint32_t
+RenderQueue::getPipeline(uint64_t key)
+{
+    return uint32_t(key >> (isTranslucent(key) ? 19 : 43)) & MaxPipeline;
+}
+
+//
+//
+//
+uint32_t
+RenderQueue::getTexture(uint64_t key)
+{
+    return uint32_t(key >> (isTranslucent(key) ? 7 : 31)) & MaxTexture;
+}
+
+//
+//
+//
+void
+RenderQueue::clear()
+{
+    commands_.clear();
+    keys_.clear();
+    order_.clear();
+}
+
+//
+//
+//
+void
+RenderQueue::submit(uint64_t key, Execute execute, void* user, uint32_t param)
+{
+    order_.push_back(uint32_t(commands_.size()));
+    keys_.push_back(key);
+    commands_.push_back({execute, user, param});
+}
+
+//
+// 安定ソートなので同じキーは submit 順のまま
+//
+void
+RenderQueue::sort()
+{
+    RadixSort::sort(keys_, order_, tmpKeys_, tmpOrder_);
+}
+
+//
+//
+//
+void
+RenderQueue::execute(void* context) const
+{
+    stateChanges_  = 0;
+    uint32_t state = ~0u;
+    for (size_t i = 0; i < order_.size(); i++)
+    {
+        const uint32_t s = getPipeline(keys_[i]) << 12 | getTexture(keys_[i]);
+        if (s != state)
+        {
+            state = s;
+            stateChanges_++;
+        }
+        const auto& cmd = commands_[order_[i]];
+        cmd.execute(cmd.user, context, cmd.param);
+    }
+}
+
+//
@@ -0,0 +1,58 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+//
+// 描画をソートキー付きのコマンドとして積み、キー順に実行する
+// キー(上位から): layer(8) | translucent(1) | 残り 55bit
+//   不透明: pipeline(12) | texture(12) | depth(24, 手前から) | 空き(7)
+//   半透明: depth(24, 奥から) | pipeline(12) | texture(12) | 空き(7)
+// (同じキーは積んだ順)
+//
+class RenderQueue
+{
+  public:
+    // context は execute に渡したもの(エンコーダなど)
+    using Execute = void (*)(void* user, void* context, uint32_t param);
+
+    static constexpr uint32_t MaxPipeline = 0xfff;
+    static constexpr uint32_t MaxTexture  = 0xfff;
+
+    // depth は [0, 1] (0 が手前)
+    static uint64_t makeKey(uint8_t layer, uint32_t pipeline, uint32_t texture, float depth, bool translucent = false);
+
+    static uint8_t  getLayer(uint64_t key) { return uint8_t(key >> 56); }
+    static bool     isTranslucent(uint64_t key) { return (key >> 55) & 1; }
+    static uint32_t getPipeline(uint64_t key);
+    static uint32_t getTexture(uint64_t key);
+
+    void clear();
+    void submit(uint64_t key, Execute execute, void* user, uint32_t param = 0);
+    void sort();
+    // sort した順に実行
+    void execute(void* context) const;
+
+    [[nodiscard]] size_t size() const { return commands_.size(); }
+    // 直前の execute で pipeline/texture が切り替わった回数
+    [[nodiscard]] size_t getStateChanges() const { return stateChanges_; }
+
+  private:
+    struct Command
+    {
+        Execute  execute;
+        void*    user;
+        uint32_t param;
+    };
+
+    std::vector<Command>  commands_;
+    std::vector<uint64_t> keys_;
+    std::vector<uint32_t> order_;
+    std::vector<uint64_t> tmpKeys_;
+    std::vector<uint32_t> tmpOrder_;
+    mutable size_t        stateChanges_ = 0;
+};
@@ -20,7 +20,7 @@ ShaderSet::~ShaderSet() { release(); }
 //
 //
 bool
-ShaderSet::build(MTL::Device* dev, const char* program, const char* vsMain, const char* fgMain, bool blendAlpha)
+ShaderSet::build(MTL::Device* dev, const char* program, const char* vsMain, const char* fgMain, Blend blend)
 {
     // 基本的にサンプルのまま
     using NS::StringEncoding::UTF8StringEncoding;
@@ -57,11 +57,12 @@ ShaderSet::build(MTL::Device* dev, const char* program, const char* vsMain, cons
 
     auto* clrAtt = pDesc->colorAttachments()->object(0);
     clrAtt->setPixelFormat(MTL::PixelFormat::PixelFormatBGRA8Unorm_sRGB);
-    if (blendAlpha)
+    if (blend != Blend::None)
     {
         clrAtt->setBlendingEnabled(true);
         clrAtt->setSourceRGBBlendFactor(MTL::BlendFactor::BlendFactorSourceAlpha);
-        clrAtt->setDestinationRGBBlendFactor(MTL::BlendFactor::BlendFactorOneMinusSourceAlpha);
+        clrAtt->setDestinationRGBBlendFactor(blend == Blend::Add ? MTL::BlendFactor::BlendFactorOne
+                                                                 : MTL::BlendFactor::BlendFactorOneMinusSourceAlpha);
         clrAtt->setRgbBlendOperation(MTL::BlendOperation::BlendOperationAdd);
     }
     pDesc->setDepthAttachmentPixelFormat(MTL::PixelFormat::PixelFormatDepth16Unorm);
@@ -91,7 +92,7 @@ ShaderSet::build(MTL::Device* dev, const char* program, const char* vsMain, cons
 //
 //
 bool
-ShaderSet::load(MTL::Device* dev, std::string path, const char* vsMain, const char* fgMain, bool blendAlpha)
+ShaderSet::load(MTL::Device* dev, std::string path, const char* vsMain, const char* fgMain, Blend blend)
 {
     std::ifstream file(path);
     if (file.fail())
@@ -108,7 +109,7 @@ ShaderSet::load(MTL::Device* dev, std::string path, const char* vsMain, const ch
     buffer.resize(sz);
     file.read(buffer.data(), sz);
 
-    return build(dev, buffer.c_str(), vsMain, fgMain, blendAlpha);
+    return build(dev, buffer.c_str(), vsMain, fgMain, blend);
 }
 
 //
@@ -5,6 +5,7 @@
 
 #include <cinttypes>
 #include <string>
+#include <utility>
 
 namespace MTL
 {
@@ -22,11 +23,26 @@ class ShaderSet
     MTL::RenderPipelineState* rpState_       = nullptr;
 
   public:
+    enum class Blend
+    {
+        None,
+        Alpha,
+        Add,
+    };
+
     ShaderSet() = default;
     virtual ~ShaderSet();
 
-    bool build(MTL::Device* dev, const char* program, const char* vsMain, const char* fgMain, bool blendAlpha = false);
-    bool load(MTL::Device* dev, std::string path, const char* vsMain, const char* fgMain, bool blendAlpha = false);
+    bool build(MTL::Device* dev, const char* program, const char* vsMain, const char* fgMain, Blend blend);
+    bool load(MTL::Device* dev, std::string path, const char* vsMain, const char* fgMain, Blend blend);
+    bool build(MTL::Device* dev, const char* program, const char* vsMain, const char* fgMain, bool blendAlpha = false)
+    {
+        return build(dev, program, vsMain, fgMain, blendAlpha ? Blend::Alpha : Blend::None);
+    }
+    bool load(MTL::Device* dev, std::string path, const char* vsMain, const char* fgMain, bool blendAlpha = false)
+    {
+        return load(dev, std::move(path), vsMain, fgMain, blendAlpha ? Blend::Alpha : Blend::None);
+    }
     void release();
 
     MTL::Library*             getShaderLibrary() { return shaderLibrary_; }
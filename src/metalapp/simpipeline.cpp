@@ -0,0 +1,125 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "simpipeline.h"
+#include <chrono>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+//
+float
+toMs(Clock::duration d)
+{
+    return std::chrono::duration<float, std::milli>(d).count();
+}
+
+} // namespace
+
+//
+//
+//
+SimPipeline::SimPipeline() = default;
+
+//
+//
+//
+SimPipeline::~SimPipeline() { stop(); }
+
+//
+//
+//
+void
+SimPipeline::start(Update update)
+{
+    stop();
+    update_   = update;
+    stop_     = false;
+    recorded_ = 0;
+    consumed_ = 0;
+    for (auto& frame : frames_)
+    {
+        frame.clear();
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+//
+//
+//
+void
+SimPipeline::stop()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+}
+
+//
+// recorded_ == consumed_ の間は描画側はどのスロットも読んでいない
+//
+const FrameRecorder&
+SimPipeline::acquire()
+{
+    std::unique_lock lock(mutex_);
+    const auto       start = Clock::now();
+    cond_.wait(lock, [this] { return recorded_ > consumed_; });
+    waitMs_ = toMs(Clock::now() - start);
+    return frames_[consumed_ % Depth];
+}
+
+//
+//
+//
+void
+SimPipeline::release()
+{
+    {
+        std::lock_guard lock(mutex_);
+        consumed_++;
+    }
+    cond_.notify_all();
+}
+
+//
+// 空いているスロットに次のフレームを記録する(スロットを選ぶ時だけロックする)
+//
+void
+SimPipeline::run()
+{
+    for (;;)
+    {
+        uint64_t frameIndex;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return stop_ || recorded_ - consumed_ < Depth; });
+            if (stop_)
+            {
+                return;
+            }
+            frameIndex = recorded_;
+        }
+
+        auto&      frame = frames_[frameIndex % Depth];
+        const auto start = Clock::now();
+        frame.clear();
+        update_(frame);
+        updateMs_.store(toMs(Clock::now() - start), std::memory_order_relaxed);
+
+        {
+            std::lock_guard lock(mutex_);
+            recorded_++;
+        }
+        cond_.notify_all();
+    }
+}
+
+//
@@ -0,0 +1,62 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "framerecorder.h"
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//
+// 更新処理を別スレッドで FrameRecorder に記録し、描画スレッドが前のフレームを再生する
+// フレーム k は必ず frames_[k % Depth] に記録され、描画側は k の順に受け取る(飛ばさない)
+// 記録側は描画側が返すまで Depth フレームより先には進まない
+//
+class SimPipeline
+{
+  public:
+    using Update = void (*)(Context& context);
+
+    static constexpr int Depth = 2;
+
+    SimPipeline();
+    ~SimPipeline();
+    SimPipeline(const SimPipeline&)            = delete;
+    SimPipeline& operator=(const SimPipeline&) = delete;
+
+    // 記録スレッドを始める(update は記録スレッドから呼ばれる)
+    void start(Update update);
+    // 記録中のフレームが終わるのを待って止める
+    void stop();
+    [[nodiscard]] bool isRunning() const { return thread_.joinable(); }
+
+    // 描画スレッド: 次のフレームの記録が終わるまで待つ
+    const FrameRecorder& acquire();
+    // 再生が終わったら返す(記録スレッドが次に使う)
+    void release();
+
+    // acquire で待った時間
+    [[nodiscard]] float getWaitMs() const { return waitMs_; }
+    // 最後に記録したフレームの update の時間
+    [[nodiscard]] float getUpdateMs() const { return updateMs_.load(std::memory_order_relaxed); }
+    // acquire したフレームの番号(0 から)
+    [[nodiscard]] uint64_t getFrameIndex() const { return consumed_; }
+
+  private:
+    void run();
+
+    GeometryHandleMap       handles_;
+    FrameRecorder           frames_[Depth]{FrameRecorder{handles_}, FrameRecorder{handles_}};
+    std::mutex              mutex_;
+    std::condition_variable cond_;
+    std::thread             thread_;
+    Update                  update_   = nullptr;
+    uint64_t                recorded_ = 0; // 記録し終わったフレーム数
+    uint64_t                consumed_ = 0; // 描画側が返したフレーム数
+    bool                    stop_     = false;
+    float                   waitMs_   = 0.0f;
+    std::atomic<float>      updateMs_{0.0f};
+};
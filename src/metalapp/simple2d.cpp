@@ -7,8 +7,14 @@
 
 #include "Metal/MTLRenderCommandEncoder.hpp"
 #include "Metal/MTLResource.hpp"
+#include "gputrack.h"
+#include "packing.h"
+#include "perfstats.h"
+#include "primbatch.h"
 #include "shaderset.h"
 #include "simple2d.h"
+#include "texture.h"
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <memory>
@@ -17,14 +23,16 @@
 
 namespace
 {
+// 初期に用意しておく量(超えてもチャンクを足すだけ)
 constexpr size_t maxVertex = 20000;
 
-//
+// shader/prim2d.metal の VertexData2D と同じ並び
 struct PrimData2D
 {
-    simd::float2 position;
-    simd::float4 color;
+    float    position[2];
+    uint32_t color;
 };
+static_assert(sizeof(PrimData2D) == 12);
 
 //
 struct ScreenData
@@ -45,77 +53,309 @@ struct Simple2D::Impl
     ShaderSet               shader_;
     ShaderSet               primShader_;
     ScreenData              scrData_;
-    std::vector<PrimData2D> primitiveList_;
-    simd::float4            drawColor_{1.0f, 1.0f, 1.0f, 1.0f};
+    ShaderSet               spriteShader_[2]; // SpriteBatch::Blend 毎
+    MTL::DepthStencilState* spriteDsState_ = nullptr;
+    MTL::Buffer*            quadIndex_     = nullptr;
+    size_t                  quadCapacity_  = 0;
+    Texture                 whiteTex_;
+    PrimBatch<PrimData2D>   lineBatch_;
+    SpriteBatch             sprites_;
+    uint32_t                drawColor_   = 0xffffffff;
+    int16_t                 layer_       = 0;
+    Blend                   blend_       = Blend::Alpha;
+    std::vector<DrawItem>   items_;
+    MTL::Buffer*            spriteBuffer_ = nullptr; // フレーム毎に転送するもの
+    MTL::Buffer*            lineBuffer_   = nullptr;
+    size_t                  uploadBytes_  = 0;
+    size_t                  spriteDraws_  = 0;
 
-    ~Impl() { shader_.release(); }
+    ~Impl()
+    {
+        releaseFrame();
+        shader_.release();
+    }
     void initialize(MTL::Device* dev, float width, float height)
     {
         device_       = dev;
         scrData_.size = {width, height};
-        scrBuffer_    = dev->newBuffer(&scrData_, sizeof(scrData_), MTL::ResourceOptionCPUCacheModeDefault);
+        scrBuffer_    = GpuTrack::newBuffer(dev, &scrData_, sizeof(scrData_), MTL::ResourceOptionCPUCacheModeDefault,
+                                            MemTrack::Category::Camera);
         shader_.load(dev, "shader/simple2d.metal", "vert2d", "frag2d", true);
         primShader_.load(dev, "shader/prim2d.metal", "vert2d", "frag2d", true);
+        spriteShader_[int(Blend::Alpha)].load(dev, "shader/simple2d.metal", "vertSprite", "frag2d", ShaderSet::Blend::Alpha);
+        spriteShader_[int(Blend::Add)].load(dev, "shader/simple2d.metal", "vertSprite", "frag2d", ShaderSet::Blend::Add);
+        sprites_.setViewport(width, height);
+
+        // 塗り潰し用の白
+        uint8_t white[4] = {0xff, 0xff, 0xff, 0xff};
+        whiteTex_.loadFromMemory(dev, white, 1, 1);
 
         auto* dsDesc = MTL::DepthStencilDescriptor::alloc()->init();
         dsDesc->setDepthCompareFunction(MTL::CompareFunction::CompareFunctionLess);
         dsDesc->setDepthWriteEnabled(true);
         dsState_ = dev->newDepthStencilState(dsDesc);
+        // スプライトは重ねて描くので深度を使わない
+        dsDesc->setDepthCompareFunction(MTL::CompareFunction::CompareFunctionAlways);
+        dsDesc->setDepthWriteEnabled(false);
+        spriteDsState_ = dev->newDepthStencilState(dsDesc);
         dsDesc->release();
 
-        primitiveList_.reserve(maxVertex);
-        primitiveList_.resize(0);
+        lineBatch_.vertices.reserve(maxVertex);
+        lineBatch_.indices.reserve(maxVertex);
     }
     void finalize()
     {
-        if (scrBuffer_)
-        {
-            scrBuffer_->release();
-            scrBuffer_ = nullptr;
-        }
+        GpuTrack::release(scrBuffer_, MemTrack::Category::Camera);
+        scrBuffer_ = nullptr;
         if (dsState_)
         {
             dsState_->release();
             dsState_ = nullptr;
         }
+        if (spriteDsState_)
+        {
+            spriteDsState_->release();
+            spriteDsState_ = nullptr;
+        }
+        GpuTrack::release(quadIndex_, MemTrack::Category::Index);
+        quadIndex_    = nullptr;
+        quadCapacity_ = 0;
+        for (auto& shader : spriteShader_)
+        {
+            shader.release();
+        }
+        whiteTex_.release();
         device_ = nullptr;
     }
-    void setDrawColor(float red, float green, float blue, float alpha) { drawColor_ = {red, green, blue, alpha}; }
+    void setDrawColor(float red, float green, float blue, float alpha)
+    {
+        drawColor_ = Packing::packUNorm4x8(red, green, blue, alpha);
+    }
     void setup(MTL::RenderCommandEncoder* enc)
     {
         enc->setRenderPipelineState(shader_.getRenderPipelineState());
-        enc->setDepthStencilState(dsState_);
+        setupState(enc, dsState_);
+    }
+    void setupState(MTL::RenderCommandEncoder* enc, MTL::DepthStencilState* dsState)
+    {
+        enc->setDepthStencilState(dsState);
 
         enc->setCullMode(MTL::CullModeBack);
         enc->setFrontFacingWinding(MTL::Winding::WindingClockwise);
         enc->setVertexBuffer(scrBuffer_, 0, 1);
     }
-    void clearDraw() { primitiveList_.resize(0); }
-    //
-    void render(MTL::RenderCommandEncoder* enc)
+    void clearDraw()
+    {
+        releaseFrame();
+        lineBatch_.clear();
+        sprites_.clear();
+    }
+    // 前のフレームの転送用バッファ(エンコーダが参照を持っているので描き終わる前に手放して良い)
+    void releaseFrame()
     {
-        if (!primitiveList_.empty())
+        GpuTrack::release(spriteBuffer_, MemTrack::Category::Vertex);
+        GpuTrack::release(lineBuffer_, MemTrack::Category::Vertex);
+        spriteBuffer_ = nullptr;
+        lineBuffer_   = nullptr;
+        items_.clear();
+    }
+    // 矩形 n 個分のインデックス(0,1,2, 2,1,3 + 4n)は使い回す
+    void reserveQuadIndex(size_t quads)
+    {
+        if (quads <= quadCapacity_)
         {
-            enc->setRenderPipelineState(primShader_.getRenderPipelineState());
+            return;
+        }
+        quadCapacity_ = std::max<size_t>(quadCapacity_ * 2, std::max<size_t>(quads, 1024));
+        GpuTrack::release(quadIndex_, MemTrack::Category::Index);
+        quadIndex_ = GpuTrack::newBuffer(device_, quadCapacity_ * 6 * sizeof(uint32_t), MTL::ResourceStorageModeManaged,
+                                         MemTrack::Category::Index);
 
-            auto* buff = device_->newBuffer(primitiveList_.data(), primitiveList_.size() * sizeof(PrimData2D),
-                                            MTL::ResourceOptionCPUCacheModeDefault);
-            enc->setVertexBuffer(buff, 0, 0);
-            enc->drawPrimitives(MTL::PrimitiveType::PrimitiveTypeLine, 0, primitiveList_.size(), 1);
-            buff->release();
+        auto* dst = static_cast<uint32_t*>(quadIndex_->contents());
+        for (uint32_t q = 0; q < quadCapacity_; q++, dst += 6)
+        {
+            const uint32_t base = q * 4;
+            dst[0]              = base + 0;
+            dst[1]              = base + 1;
+            dst[2]              = base + 2;
+            dst[3]              = base + 2;
+            dst[4]              = base + 1;
+            dst[5]              = base + 3;
+        }
+        quadIndex_->didModifyRange(NS::Range::Make(0, quadIndex_->length()));
+    }
+    // 並べ替えた矩形を転送して Run 毎に1つ
+    void prepareSprites()
+    {
+        spriteDraws_ = 0;
+        if (sprites_.getQuadCount() == 0)
+        {
+            return;
+        }
+        sprites_.build();
+        reserveQuadIndex(sprites_.getQuadCount());
+
+        const auto& vertices = sprites_.getVertices();
+        const auto  bytes    = vertices.size() * sizeof(SpriteBatch::Vertex);
+        uploadBytes_ += bytes;
+
+        spriteBuffer_ = GpuTrack::newBuffer(device_, vertices.data(), bytes, MTL::ResourceOptionCPUCacheModeWriteCombined,
+                                            MemTrack::Category::Vertex);
+
+        const auto& runs = sprites_.getRuns();
+        for (uint32_t i = 0; i < runs.size(); i++)
+        {
+            items_.push_back({DrawKind::Sprite, runs[i].blend, runs[i].textureIndex, i});
+        }
+        spriteDraws_ = runs.size();
+    }
+    // 頂点とインデックスを1つのバッファにまとめて転送
+    void prepare()
+    {
+        releaseFrame();
+        uploadBytes_ = 0;
+        prepareSprites();
+        if (lineBatch_.empty())
+        {
+            return;
         }
+        auto bytes  = lineBatch_.getBytes();
+        lineBuffer_ = GpuTrack::newBuffer(device_, bytes, MTL::ResourceOptionCPUCacheModeWriteCombined,
+                                          MemTrack::Category::Vertex);
+        lineBatch_.copyTo(lineBuffer_->contents());
+        uploadBytes_ += bytes;
+        items_.push_back({DrawKind::Lines, Blend::Alpha, 0, 0});
+    }
+    //
+    void draw(MTL::RenderCommandEncoder* enc, const DrawItem& item, bool setup)
+    {
+        if (item.kind == DrawKind::Lines)
+        {
+            if (setup)
+            {
+                enc->setRenderPipelineState(primShader_.getRenderPipelineState());
+                setupState(enc, dsState_);
+            }
+            enc->setVertexBuffer(lineBuffer_, 0, 0);
+            enc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeLine, lineBatch_.getIndexCount(), MTL::IndexTypeUInt32,
+                                       lineBuffer_, lineBatch_.getVertexBytes());
+            PerfStats::addDraw(lineBatch_.getVertexCount(), lineBatch_.getIndexCount());
+            return;
+        }
+        // スプライトは重ねて描くので深度を使わない
+        const auto& run = sprites_.getRuns()[item.index];
+        if (setup)
+        {
+            enc->setRenderPipelineState(spriteShader_[int(run.blend)].getRenderPipelineState());
+            setupState(enc, spriteDsState_);
+            enc->setVertexBuffer(spriteBuffer_, 0, 0);
+        }
+        enc->setFragmentTexture(run.texture, 0);
+        enc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, run.quadCount * 6, MTL::IndexTypeUInt32, quadIndex_,
+                                   run.firstQuad * 6 * sizeof(uint32_t));
+        PerfStats::addDraw(run.quadCount * 4, run.quadCount * 6);
+    }
+    //
+    static PrimData2D makeVertex(float x, float y, uint32_t color) { return {{x, y}, color}; }
+    //
+    uint32_t getColor(const simd::float4* colors, size_t idx) const
+    {
+        if (colors == nullptr)
+        {
+            return drawColor_;
+        }
+        const auto& c = colors[idx];
+        return Packing::packUNorm4x8(c.x, c.y, c.z, c.w);
     }
     //
     void drawLine(float x1, float y1, float x2, float y2)
     {
-        PrimData2D p2d_s;
-        PrimData2D p2d_e;
-        p2d_s.position = {x1, y1};
-        p2d_s.color    = drawColor_;
-        p2d_e.position = {x2, y2};
-        p2d_e.color    = drawColor_;
-        primitiveList_.emplace_back(p2d_s);
-        primitiveList_.emplace_back(p2d_e);
+        const uint32_t base = lineBatch_.getVertexCount();
+        lineBatch_.addVertex(makeVertex(x1, y1, drawColor_));
+        lineBatch_.addVertex(makeVertex(x2, y2, drawColor_));
+        lineBatch_.addIndex(base);
+        lineBatch_.addIndex(base + 1);
+    }
+    // 頂点は共有して、線分毎にインデックスを2つ
+    void drawLineStrip(const simd::float2* points, size_t count, const simd::float4* colors)
+    {
+        if (count < 2)
+        {
+            return;
+        }
+        const uint32_t base = lineBatch_.getVertexCount();
+        lineBatch_.appendVertices(count,
+                                  [&](PrimData2D* dst, size_t first, size_t n)
+                                  {
+                                      for (size_t i = 0; i < n; i++)
+                                      {
+                                          const auto& p = points[first + i];
+                                          dst[i]        = makeVertex(p.x, p.y, getColor(colors, first + i));
+                                      }
+                                  });
+        // k 番目のインデックスは線分 k / 2 の始点か終点
+        lineBatch_.appendIndices((count - 1) * 2,
+                                 [&](uint32_t* dst, size_t first, size_t n)
+                                 {
+                                     for (size_t i = 0; i < n; i++)
+                                     {
+                                         const size_t k = first + i;
+                                         dst[i]         = base + uint32_t(k / 2 + (k & 1));
+                                     }
+                                 });
+    }
+    // 1つの矩形で4頂点、4本の線
+    void drawRects(const simd::float4* rects, size_t count)
+    {
+        const uint32_t base = lineBatch_.getVertexCount();
+        lineBatch_.appendVertices(count * 4,
+                                  [&](PrimData2D* dst, size_t first, size_t n)
+                                  {
+                                      for (size_t i = 0; i < n; i++)
+                                      {
+                                          const size_t k = first + i;
+                                          const auto&  r = rects[k / 4];
+                                          const size_t e = k % 4;
+                                          const float  x = e == 0 || e == 3 ? r.x : r.z;
+                                          const float  y = e < 2 ? r.y : r.w;
+                                          dst[i]         = makeVertex(x, y, drawColor_);
+                                      }
+                                  });
+        // 矩形 k / 8 の辺 (k % 8) / 2 の始点か終点
+        lineBatch_.appendIndices(count * 8,
+                                 [&](uint32_t* dst, size_t first, size_t n)
+                                 {
+                                     for (size_t i = 0; i < n; i++)
+                                     {
+                                         const size_t k = first + i;
+                                         const size_t e = (k % 8) / 2 + (k & 1);
+                                         dst[i]         = base + uint32_t(k / 8 * 4 + e % 4);
+                                     }
+                                 });
+    }
+    //
+    void addQuad(MTL::Texture* tex, float x1, float y1, float x2, float y2, simd::float4 uv)
+    {
+        sprites_.add(tex, {x1, y1, x2, y2, uv.x, uv.y, uv.z, uv.w, drawColor_}, layer_, blend_);
+    }
+    // 3x3 に分けて、角は拡大しない
+    void drawNineSlice(MTL::Texture* tex, float x, float y, float w, float h, float border, float uvBorder)
+    {
+        border = std::min({border, w * 0.5f, h * 0.5f});
+
+        const float px[4] = {x, x + border, x + w - border, x + w};
+        const float py[4] = {y, y + border, y + h - border, y + h};
+        const float uv[4] = {0.0f, uvBorder, 1.0f - uvBorder, 1.0f};
+        for (int j = 0; j < 3; j++)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                if (px[i] < px[i + 1] && py[j] < py[j + 1])
+                {
+                    addQuad(tex, px[i], py[j], px[i + 1], py[j + 1], {uv[i], uv[j], uv[i + 1], uv[j + 1]});
+                }
+            }
+        }
     }
 };
 
@@ -178,9 +418,27 @@ Simple2D::clearDraw()
 //
 //
 void
-Simple2D::render(MTL::RenderCommandEncoder* enc)
+Simple2D::prepare()
+{
+    impl_->prepare();
+}
+
+//
+//
+//
+const std::vector<Simple2D::DrawItem>&
+Simple2D::getDrawItems() const
 {
-    impl_->render(enc);
+    return impl_->items_;
+}
+
+//
+//
+//
+void
+Simple2D::draw(MTL::RenderCommandEncoder* enc, size_t item, bool setup)
+{
+    impl_->draw(enc, impl_->items_[item], setup);
 }
 
 //
@@ -198,10 +456,89 @@ Simple2D::drawLine(float x1, float y1, float x2, float y2)
 void
 Simple2D::drawRect(float x1, float y1, float x2, float y2)
 {
-    impl_->drawLine(x1, y1, x2, y1);
-    impl_->drawLine(x2, y1, x2, y2);
-    impl_->drawLine(x1, y1, x1, y2);
-    impl_->drawLine(x1, y2, x2, y2);
+    const simd::float4 rect{x1, y1, x2, y2};
+    impl_->drawRects(&rect, 1);
+}
+
+//
+//
+//
+void
+Simple2D::drawLineStrip(const simd::float2* points, size_t count, const simd::float4* colors)
+{
+    impl_->drawLineStrip(points, count, colors);
+}
+
+//
+//
+//
+void
+Simple2D::drawRects(const simd::float4* rects, size_t count)
+{
+    impl_->drawRects(rects, count);
+}
+
+//
+//
+//
+size_t
+Simple2D::getUploadBytes() const
+{
+    return impl_->uploadBytes_;
+}
+
+//
+//
+//
+void
+Simple2D::setLayer(int16_t layer)
+{
+    impl_->layer_ = layer;
+}
+
+//
+//
+//
+void
+Simple2D::setBlend(Blend blend)
+{
+    impl_->blend_ = blend;
+}
+
+//
+//
+//
+void
+Simple2D::fillRect(float x1, float y1, float x2, float y2)
+{
+    impl_->addQuad(impl_->whiteTex_.get(), x1, y1, x2, y2, {0.0f, 0.0f, 1.0f, 1.0f});
+}
+
+//
+//
+//
+void
+Simple2D::drawSprite(Texture& tex, float x, float y, float w, float h, simd::float4 uv)
+{
+    impl_->addQuad(tex.get(), x, y, x + w, y + h, uv);
+}
+
+//
+//
+//
+void
+Simple2D::drawNineSlice(Texture& tex, float x, float y, float w, float h, float border, float uvBorder)
+{
+    impl_->drawNineSlice(tex.get(), x, y, w, h, border, uvBorder);
+}
+
+//
+//
+//
+size_t
+Simple2D::getSpriteDrawCount() const
+{
+    return impl_->spriteDraws_;
 }
 
 //
@@ -3,8 +3,11 @@
 //
 #pragma once
 
+#include "spritebatch.h"
 #include <cinttypes>
 #include <memory>
+#include <simd/vector_types.h>
+#include <vector>
 
 namespace MTL
 {
@@ -12,6 +15,8 @@ class Device;
 class RenderCommandEncoder;
 } // namespace MTL
 
+class Texture;
+
 //
 //
 //
@@ -28,9 +33,47 @@ class Simple2D
     void finalize();
 
     void setupRender(MTL::RenderCommandEncoder* enc);
-    void render(MTL::RenderCommandEncoder* enc);
     void clearDraw();
     void setDrawColor(float red, float green, float blue, float alpha);
     void drawLine(float x1, float y1, float x2, float y2);
     void drawRect(float x1, float y1, float x2, float y2);
+
+    // 配列でまとめて追加(colors が nullptr なら描画色)
+    void drawLineStrip(const simd::float2* points, size_t count, const simd::float4* colors);
+    // rects は (x1, y1, x2, y2)
+    void drawRects(const simd::float4* rects, size_t count);
+
+    // 塗り潰し/スプライト(レイヤー、ブレンド、テクスチャ順にまとめて描画、画面外は捨てる)
+    using Blend = SpriteBatch::Blend;
+    void setLayer(int16_t layer);
+    void setBlend(Blend blend);
+    void fillRect(float x1, float y1, float x2, float y2);
+    // uv は (u1, v1, u2, v2)
+    void drawSprite(Texture& tex, float x, float y, float w, float h, simd::float4 uv = {0.0f, 0.0f, 1.0f, 1.0f});
+    // 9分割パネル: 角は border(画面) / uvBorder(テクスチャ) の大きさで拡大しない
+    void drawNineSlice(Texture& tex, float x, float y, float w, float h, float border, float uvBorder);
+
+    // RenderQueue に積む描画の単位(prepare で転送まで済ませ、draw で1つずつ描く)
+    // スプライトは Run 毎、線はまとめて1つで、重ねる順が決まっているので積んだ順に描く
+    enum class DrawKind : uint8_t
+    {
+        Sprite, // index は Run の番号
+        Lines,
+    };
+    struct DrawItem
+    {
+        DrawKind kind;
+        Blend    blend;
+        uint32_t texture; // テクスチャを最初に使った順の番号
+        uint32_t index;
+    };
+    void                                       prepare();
+    [[nodiscard]] const std::vector<DrawItem>& getDrawItems() const;
+    // setup は直前に別のシェーダで描いた時(シェーダと深度の設定をし直す)
+    void draw(MTL::RenderCommandEncoder* enc, size_t item, bool setup);
+
+    // 直前の prepare で転送したバイト数
+    [[nodiscard]] size_t getUploadBytes() const;
+    // 直前の prepare のスプライト描画回数
+    [[nodiscard]] size_t getSpriteDrawCount() const;
 };
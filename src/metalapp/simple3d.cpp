@@ -8,8 +8,13 @@
 #include "Metal/MTLDevice.hpp"
 #include "Metal/MTLRenderCommandEncoder.hpp"
 #include "Metal/MTLResource.hpp"
+#include "debugshape.h"
+#include "gputrack.h"
+#include "perfstats.h"
+#include "prim3dlist.h"
 #include "shaderset.h"
 #include "simple3d.h"
+#include <cstring>
 #include <memory>
 #include <simd/simd.h>
 #include <simd/vector_types.h>
@@ -17,105 +22,260 @@
 
 namespace
 {
+// 初期に用意しておく量(超えてもチャンクを足すだけ)
 constexpr size_t maxVertex   = 20000;
 constexpr size_t maxTriangle = 10000;
 
-//
-struct PrimData3D
-{
-    simd::float3 position;
-    simd::float4 color;
-};
-
 } // namespace
 
 struct Simple3D::Impl
 {
-    MTL::Device*            device_ = nullptr;
-    ShaderSet               shader_;
-    std::vector<PrimData3D> primitiveList_;
-    std::vector<PrimData3D> triangleList_;
-    simd::float4            drawColor_{1.0f, 1.0f, 1.0f, 1.0f};
+    MTL::Device*          device_ = nullptr;
+    ShaderSet             shader_;
+    ShaderSet             modelShader_;
+    ShaderSet             shapeShader_;
+    MTL::Buffer*          shapeMesh_        = nullptr;
+    size_t                shapeIndexOffset_ = 0;
+    DebugShape::Range     shapeRange_[DebugShape::ShapeCount]{};
+    Prim3DList            list_;
+    std::vector<DrawItem> items_;
+    MTL::Buffer*          lineBuffer_     = nullptr; // 以下はフレーム毎に転送するもの
+    MTL::Buffer*          triangleBuffer_ = nullptr;
+    MTL::Buffer*          shapeBuffer_    = nullptr;
+    size_t                shapeBase_[DebugShape::ShapeCount]{}; // shapeBuffer_ の中の形状毎の先頭
+    size_t                uploadBytes_ = 0;
 
-    ~Impl() { shader_.release(); }
+    ~Impl()
+    {
+        releaseFrame();
+        list_.forEachGeometry([](Prim3DList::Geometry& geom) { GpuTrack::release(geom.buffer, MemTrack::Category::Vertex); });
+        shader_.release();
+        modelShader_.release();
+        shapeShader_.release();
+    }
 
     //
     void initialize(MTL::Device* dev)
     {
         device_ = dev;
         shader_.load(dev, "shader/prim3d.metal", "primVert3d", "primFrag3d", true);
+        modelShader_.load(dev, "shader/prim3d.metal", "primVert3dModel", "primFrag3d", true);
+        shapeShader_.load(dev, "shader/prim3d.metal", "primVert3dInstanced", "primFrag3d", true);
 
-        primitiveList_.reserve(maxVertex);
-        primitiveList_.resize(0);
-        triangleList_.reserve(maxTriangle * 3);
-        triangleList_.resize(0);
+        // デバッグ形状の単位メッシュは最初に1度だけ転送
+        std::vector<DebugShape::Vertex> vertices;
+        std::vector<uint32_t>           indices;
+        DebugShape::buildMeshes(vertices, indices, shapeRange_);
+        shapeIndexOffset_   = vertices.size() * sizeof(DebugShape::Vertex);
+        const size_t iBytes = indices.size() * sizeof(uint32_t);
+        shapeMesh_          = GpuTrack::newBuffer(dev, shapeIndexOffset_ + iBytes, MTL::ResourceStorageModeManaged,
+                                                  MemTrack::Category::Vertex);
+        auto* dst           = static_cast<uint8_t*>(shapeMesh_->contents());
+        std::memcpy(dst, vertices.data(), shapeIndexOffset_);
+        std::memcpy(dst + shapeIndexOffset_, indices.data(), iBytes);
+        shapeMesh_->didModifyRange(NS::Range::Make(0, shapeMesh_->length()));
+
+        list_.reserve(maxVertex, maxTriangle * 3);
     }
     //
-    void finalize() { device_ = nullptr; }
-    //
-    void setDrawColor(float red, float green, float blue, float alpha) { drawColor_ = simd_make_float4(red, green, blue, alpha); }
+    void finalize()
+    {
+        GpuTrack::release(shapeMesh_, MemTrack::Category::Vertex);
+        shapeMesh_ = nullptr;
+        device_ = nullptr;
+    }
+    // 前のフレームの転送用バッファ(エンコーダが参照を持っているので描き終わる前に手放して良い)
+    void releaseFrame()
+    {
+        GpuTrack::release(lineBuffer_, MemTrack::Category::Vertex);
+        GpuTrack::release(triangleBuffer_, MemTrack::Category::Vertex);
+        GpuTrack::release(shapeBuffer_, MemTrack::Category::Instance);
+        lineBuffer_     = nullptr;
+        triangleBuffer_ = nullptr;
+        shapeBuffer_    = nullptr;
+        items_.clear();
+    }
+    // 頂点とインデックスを1つのバッファにまとめて転送
+    MTL::Buffer* uploadBatch(const Prim3DList::Batch& batch)
+    {
+        auto* buff = GpuTrack::newBuffer(device_, batch.getBytes(), MTL::ResourceOptionCPUCacheModeWriteCombined,
+                                         MemTrack::Category::Vertex);
+        batch.copyTo(buff->contents());
+        uploadBytes_ += batch.getBytes();
+        return buff;
+    }
+    // uploadBatch と同じ配置で、インデックスだけ並べ替えて転送
+    MTL::Buffer* uploadSortedTriangles()
+    {
+        const auto& batch = list_.getTriangles();
+        auto*       buff  = GpuTrack::newBuffer(device_, batch.getBytes(), MTL::ResourceOptionCPUCacheModeWriteCombined,
+                                                MemTrack::Category::Vertex);
+        auto*       dst   = static_cast<uint8_t*>(buff->contents());
+        batch.vertices.copyTo(reinterpret_cast<Prim3DList::Vertex*>(dst));
+        list_.sortTriangles(reinterpret_cast<uint32_t*>(dst + batch.getVertexBytes()));
+        uploadBytes_ += batch.getBytes();
+        return buff;
+    }
+    // 転送を済ませて描画の単位を作る
+    void prepare()
+    {
+        releaseFrame();
+        uploadBytes_ = 0;
+        list_.flushTransform();
+        prepareGeometries();
+        prepareShapes();
+        const auto& lines     = list_.getLines();
+        const auto& triangles = list_.getTriangles();
+        if (!lines.empty())
+        {
+            lineBuffer_ = uploadBatch(lines);
+            items_.push_back({DrawKind::Lines, 0, list_.getNearestDepth(lines), false});
+        }
+        if (!triangles.empty())
+        {
+            const bool sort = list_.getSortTranslucent();
+            triangleBuffer_ = sort ? uploadSortedTriangles() : uploadBatch(triangles);
+            items_.push_back({DrawKind::Triangles, 0, list_.getNearestDepth(triangles), sort});
+        }
+    }
     //
-    void clear()
+    void draw(MTL::RenderCommandEncoder* enc, const DrawItem& item, bool setup)
     {
-        primitiveList_.resize(0);
-        triangleList_.resize(0);
+        switch (item.kind)
+        {
+        case DrawKind::Geometry:
+            drawGeometry(enc, list_.getGeometryDraws()[item.index], setup);
+            break;
+        case DrawKind::Shape:
+            drawShape(enc, item.index, setup);
+            break;
+        case DrawKind::Lines:
+            drawBatch(enc, lineBuffer_, list_.getLines(), MTL::PrimitiveType::PrimitiveTypeLine, setup);
+            break;
+        case DrawKind::Triangles:
+            drawBatch(enc, triangleBuffer_, list_.getTriangles(), MTL::PrimitiveType::PrimitiveTypeTriangle, setup);
+            break;
+        }
     }
     //
-    void render(MTL::RenderCommandEncoder* enc)
+    void drawBatch(MTL::RenderCommandEncoder* enc, MTL::Buffer* buff, const Prim3DList::Batch& batch, MTL::PrimitiveType type,
+                   bool setup)
     {
-        bool setupShader = false;
-        if (!primitiveList_.empty())
+        if (setup)
         {
             enc->setRenderPipelineState(shader_.getRenderPipelineState());
-            setupShader = true;
-
-            auto* buff = device_->newBuffer(primitiveList_.data(), primitiveList_.size() * sizeof(PrimData3D),
-                                            MTL::ResourceOptionCPUCacheModeDefault);
-            enc->setVertexBuffer(buff, 0, 0);
-            enc->drawPrimitives(MTL::PrimitiveType::PrimitiveTypeLine, 0, primitiveList_.size(), 1);
-            buff->release();
         }
-        if (!triangleList_.empty())
+        enc->setVertexBuffer(buff, 0, 0);
+        enc->drawIndexedPrimitives(type, batch.getIndexCount(), MTL::IndexTypeUInt32, buff, batch.getVertexBytes());
+        PerfStats::addDraw(batch.getVertexCount(), batch.getIndexCount());
+    }
+    // 変更があった時だけ新しいバッファを作る(前のフレームが使用中でも壊さない)
+    void upload(Prim3DList::Geometry& geom)
+    {
+        GpuTrack::release(geom.buffer, MemTrack::Category::Vertex);
+        geom.buffer = nullptr;
+        if (geom.bytes > 0)
+        {
+            geom.buffer = GpuTrack::newBuffer(device_, geom.bytes, MTL::ResourceStorageModeManaged, MemTrack::Category::Vertex);
+            auto* dst   = static_cast<uint8_t*>(geom.buffer->contents());
+            geom.lines.copyTo(dst);
+            geom.triangles.copyTo(dst + geom.triangleOffset);
+            geom.buffer->didModifyRange(NS::Range::Make(0, geom.bytes));
+        }
+    }
+    // 描くジオメトリ毎に1つ(中身が空なら描かない)
+    void prepareGeometries()
+    {
+        const auto* first   = list_.getGeometryDraws().data();
+        auto        prepare = [&](const Prim3DList::GeometryDraw& draw, Prim3DList::Geometry& geom, bool dirty)
         {
-            if (!setupShader)
+            if (dirty)
             {
-                enc->setRenderPipelineState(shader_.getRenderPipelineState());
+                upload(geom);
             }
+            if (geom.buffer != nullptr)
+            {
+                items_.push_back({DrawKind::Geometry, uint32_t(&draw - first), list_.getDrawDepth(draw), false});
+            }
+        };
+        uploadBytes_ += list_.forEachGeometryDraw(prepare);
+    }
+    //
+    void drawGeometry(MTL::RenderCommandEncoder* enc, const Prim3DList::GeometryDraw& draw, bool setup)
+    {
+        constexpr NS::UInteger ModelId = 3;
 
-            auto* buff = device_->newBuffer(triangleList_.data(), triangleList_.size() * sizeof(PrimData3D),
-                                            MTL::ResourceOptionCPUCacheModeDefault);
-            enc->setVertexBuffer(buff, 0, 0);
-            enc->drawPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, 0, triangleList_.size(), 1);
-            buff->release();
+        const auto& geom = *list_.findGeometry(draw.handle);
+        if (setup)
+        {
+            enc->setRenderPipelineState(modelShader_.getRenderPipelineState());
+        }
+        enc->setVertexBytes(&draw.transform, sizeof(draw.transform), ModelId);
+        if (!geom.lines.empty())
+        {
+            enc->setVertexBuffer(geom.buffer, 0, 0);
+            enc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeLine, geom.lines.getIndexCount(), MTL::IndexTypeUInt32,
+                                       geom.buffer, geom.lines.getVertexBytes());
+            PerfStats::addDraw(geom.lines.getVertexCount(), geom.lines.getIndexCount());
+        }
+        if (!geom.triangles.empty())
+        {
+            enc->setVertexBuffer(geom.buffer, geom.triangleOffset, 0);
+            enc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, geom.triangles.getIndexCount(),
+                                       MTL::IndexTypeUInt32, geom.buffer, geom.triangleOffset + geom.triangles.getVertexBytes());
+            PerfStats::addDraw(geom.triangles.getVertexCount(), geom.triangles.getIndexCount());
         }
     }
-    //
-    void drawLine(simd::float3 from, simd::float3 to)
+    // インスタンスは1つのバッファに形状毎に続けて置き、形状毎に1回の instanced draw
+    void prepareShapes()
     {
-        PrimData3D p3d_f;
-        PrimData3D p3d_t;
-        p3d_f.position = from;
-        p3d_f.color    = drawColor_;
-        p3d_t.position = to;
-        p3d_t.color    = drawColor_;
-        primitiveList_.emplace_back(p3d_f);
-        primitiveList_.emplace_back(p3d_t);
+        const size_t total = list_.getShapeCount();
+        if (total == 0)
+        {
+            return;
+        }
+        const size_t bytes = total * sizeof(DebugShape::Instance);
+        uploadBytes_ += bytes;
+
+        shapeBuffer_ = GpuTrack::newBuffer(device_, bytes, MTL::ResourceOptionCPUCacheModeWriteCombined,
+                                           MemTrack::Category::Instance);
+        auto*  dst   = static_cast<DebugShape::Instance*>(shapeBuffer_->contents());
+        size_t base  = 0;
+        for (size_t shape = 0; shape < DebugShape::ShapeCount; shape++)
+        {
+            const auto& list  = list_.getShapes(DebugShape::Shape(shape));
+            shapeBase_[shape] = base;
+            if (list.empty())
+            {
+                continue;
+            }
+            const bool sort = list_.getSortTranslucent();
+            if (sort)
+            {
+                list_.sortShapes(DebugShape::Shape(shape), dst + base);
+            }
+            else
+            {
+                list.copyTo(dst + base);
+            }
+            items_.push_back({DrawKind::Shape, uint32_t(shape), list_.getNearestDepth(DebugShape::Shape(shape)), sort});
+            base += list.size();
+        }
     }
     //
-    void drawTriangle(simd::float3 v0, simd::float3 v1, simd::float3 v2)
+    void drawShape(MTL::RenderCommandEncoder* enc, size_t shape, bool setup)
     {
-        PrimData3D p3d0;
-        PrimData3D p3d1;
-        PrimData3D p3d2;
-        p3d0.position = v0;
-        p3d0.color    = drawColor_;
-        p3d1.position = v1;
-        p3d1.color    = drawColor_;
-        p3d2.position = v2;
-        p3d2.color    = drawColor_;
-        triangleList_.emplace_back(p3d0);
-        triangleList_.emplace_back(p3d1);
-        triangleList_.emplace_back(p3d2);
+        if (setup)
+        {
+            enc->setRenderPipelineState(shapeShader_.getRenderPipelineState());
+            enc->setVertexBuffer(shapeMesh_, 0, 0);
+            enc->setVertexBuffer(shapeBuffer_, 0, 1);
+        }
+        const auto& range = shapeRange_[shape];
+        const auto  count = list_.getShapes(DebugShape::Shape(shape)).size();
+        enc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeLine, range.indexCount, MTL::IndexTypeUInt32, shapeMesh_,
+                                   shapeIndexOffset_ + range.firstIndex * sizeof(uint32_t), count, 0, shapeBase_[shape]);
+        PerfStats::addDraw(range.indexCount, range.indexCount, count);
     }
 };
 
@@ -147,53 +307,204 @@ Simple3D::finalize()
 void
 Simple3D::setDrawColor(float red, float green, float blue, float alpha)
 {
-    impl_->setDrawColor(red, green, blue, alpha);
+    impl_->list_.setDrawColor(red, green, blue, alpha);
 }
 
 //
 void
 Simple3D::clearDraw()
 {
-    impl_->clear();
+    impl_->releaseFrame();
+    impl_->list_.clear();
+}
+
+//
+void
+Simple3D::prepare()
+{
+    impl_->prepare();
+}
+
+//
+const std::vector<Simple3D::DrawItem>&
+Simple3D::getDrawItems() const
+{
+    return impl_->items_;
 }
 
 //
 void
-Simple3D::render(MTL::RenderCommandEncoder* enc)
+Simple3D::draw(MTL::RenderCommandEncoder* enc, size_t item, bool setup)
 {
-    impl_->render(enc);
+    impl_->draw(enc, impl_->items_[item], setup);
 }
 
 //
 void
 Simple3D::drawLine(simd::float3 from, simd::float3 to)
 {
-    impl_->drawLine(from, to);
+    impl_->list_.drawLine(from, to);
 }
 
 //
 void
 Simple3D::drawRect(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3)
 {
-    impl_->drawLine(p0, p1);
-    impl_->drawLine(p1, p2);
-    impl_->drawLine(p2, p3);
-    impl_->drawLine(p3, p0);
+    impl_->list_.drawRect(p0, p1, p2, p3);
 }
 
 //
 void
 Simple3D::drawTriangle(simd::float3 v0, simd::float3 v1, simd::float3 v2)
 {
-    impl_->drawTriangle(v0, v1, v2);
+    impl_->list_.drawTriangle(v0, v1, v2);
 }
 
 //
 void
 Simple3D::drawPlane(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3)
 {
-    impl_->drawTriangle(v0, v1, v2);
-    impl_->drawTriangle(v0, v2, v3);
+    impl_->list_.drawPlane(v0, v1, v2, v3);
+}
+
+//
+void
+Simple3D::drawLines(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    impl_->list_.drawLines(points, count, colors);
+}
+
+//
+void
+Simple3D::drawLineStrip(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    impl_->list_.drawLineStrip(points, count, colors, false);
+}
+
+//
+void
+Simple3D::drawTriangles(const simd::float3* points, size_t count, const simd::float4* colors)
+{
+    impl_->list_.drawTriangles(points, count, colors);
+}
+
+//
+size_t
+Simple3D::getUploadBytes() const
+{
+    return impl_->uploadBytes_;
+}
+
+//
+Simple3D::GeometryHandle
+Simple3D::createGeometry()
+{
+    return impl_->list_.createGeometry();
+}
+
+//
+bool
+Simple3D::beginGeometry(GeometryHandle handle)
+{
+    return impl_->list_.beginGeometry(handle);
+}
+
+//
+void
+Simple3D::endGeometry()
+{
+    impl_->list_.endGeometry();
+}
+
+//
+void
+Simple3D::drawGeometry(GeometryHandle handle, const simd::float4x4& transform)
+{
+    impl_->list_.drawGeometry(handle, transform);
+}
+
+//
+void
+Simple3D::destroyGeometry(GeometryHandle handle)
+{
+    GpuTrack::release(impl_->list_.destroyGeometry(handle), MemTrack::Category::Vertex);
+}
+
+//
+void
+Simple3D::drawShape(Shape shape, const simd::float4x4& transform)
+{
+    impl_->list_.drawShape(shape, transform);
+}
+
+//
+void
+Simple3D::drawBox(simd::float3 center, simd::float3 size)
+{
+    impl_->list_.drawBox(center, size);
+}
+
+//
+void
+Simple3D::drawSphere(simd::float3 center, float radius)
+{
+    impl_->list_.drawSphere(center, radius);
+}
+
+//
+void
+Simple3D::drawArrow(simd::float3 from, simd::float3 to)
+{
+    impl_->list_.drawArrow(from, to);
+}
+
+//
+void
+Simple3D::drawGrid(simd::float3 center, float size, int divisions)
+{
+    impl_->list_.drawGrid(center, size, divisions);
+}
+
+//
+void
+Simple3D::drawAxes(const simd::float4x4& transform, float length)
+{
+    impl_->list_.drawAxes(transform, length);
+}
+
+//
+void
+Simple3D::setTransform(const simd::float4x4& transform)
+{
+    impl_->list_.setTransform(transform);
+}
+
+//
+void
+Simple3D::pushTransform(const simd::float4x4& transform)
+{
+    impl_->list_.pushTransform(transform);
+}
+
+//
+void
+Simple3D::popTransform()
+{
+    impl_->list_.popTransform();
+}
+
+//
+void
+Simple3D::setSortTranslucent(bool enable)
+{
+    impl_->list_.setSortTranslucent(enable);
+}
+
+//
+void
+Simple3D::setViewMatrix(const simd::float4x4& view)
+{
+    impl_->list_.setViewMatrix(view);
 }
 
 //
@@ -3,9 +3,12 @@
 //
 #pragma once
 
+#include "debugshape.h"
 #include <cinttypes>
 #include <memory>
+#include <simd/matrix_types.h>
 #include <simd/vector_types.h>
+#include <vector>
 
 namespace MTL
 {
@@ -22,17 +25,75 @@ class Simple3D
     std::unique_ptr<Impl> impl_;
 
   public:
+    using GeometryHandle = uint32_t;
+
+    static constexpr GeometryHandle InvalidGeometry = 0;
+
     Simple3D();
     virtual ~Simple3D();
 
     void initialize(MTL::Device* dev);
     void finalize();
 
-    void render(MTL::RenderCommandEncoder* enc);
+    // RenderQueue に積む描画の単位(prepare で転送まで済ませ、draw で1つずつ描く)
+    enum class DrawKind : uint8_t
+    {
+        Geometry, // index は描いたジオメトリの番号
+        Shape,    // index は DebugShape::Shape
+        Lines,
+        Triangles,
+    };
+    struct DrawItem
+    {
+        DrawKind kind;
+        uint32_t index;
+        float    depth;       // 手前からの距離(ビュー空間の -z)
+        bool     translucent; // 奥から並べ替えた半透明を含む
+    };
+    void                                       prepare();
+    [[nodiscard]] const std::vector<DrawItem>& getDrawItems() const;
+    // setup は直前に別のシェーダで描いた時(シェーダとバッファを設定し直す)
+    void draw(MTL::RenderCommandEncoder* enc, size_t item, bool setup);
     void clearDraw();
     void setDrawColor(float red, float green, float blue, float alpha);
     void drawLine(simd::float3 from, simd::float3 to);
     void drawRect(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3);
     void drawTriangle(simd::float3 v0, simd::float3 v1, simd::float3 v2);
     void drawPlane(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3);
+
+    // 配列でまとめて追加(colors が nullptr なら描画色)
+    void drawLines(const simd::float3* points, size_t count, const simd::float4* colors);
+    void drawLineStrip(const simd::float3* points, size_t count, const simd::float4* colors);
+    void drawTriangles(const simd::float3* points, size_t count, const simd::float4* colors);
+
+    // 保持するジオメトリ: begin/end の間の描画を記録して、以降はハンドルで描く
+    // (記録し直した時だけ転送する)
+    GeometryHandle createGeometry();
+    bool           beginGeometry(GeometryHandle handle);
+    void           endGeometry();
+    void           drawGeometry(GeometryHandle handle, const simd::float4x4& transform);
+    void           destroyGeometry(GeometryHandle handle);
+
+    // 以降に追加する3D描画に掛ける行列(頂点はまとめて変換する、clearDraw で単位行列に戻る)
+    void setTransform(const simd::float4x4& transform);
+    // 今の行列を積んで右に transform を掛ける、pop で積んだ行列に戻す
+    void pushTransform(const simd::float4x4& transform);
+    void popTransform();
+
+    // デバッグ形状(単位形状のインスタンス描画、描画色を使う)
+    using Shape = DebugShape::Shape;
+    void drawShape(Shape shape, const simd::float4x4& transform);
+    void drawBox(simd::float3 center, simd::float3 size);
+    void drawSphere(simd::float3 center, float radius);
+    void drawArrow(simd::float3 from, simd::float3 to);
+    void drawGrid(simd::float3 center, float size, int divisions);
+    void drawAxes(const simd::float4x4& transform, float length);
+
+    // 半透明(頂点色のαが1未満)の三角形とデバッグ形状をビュー行列での奥から順に並べ替えて描く
+    // (不透明なものは追加した順のまま先に描く)
+    void setSortTranslucent(bool enable);
+    void setViewMatrix(const simd::float4x4& view);
+
+    // 直前の prepare で転送したバイト数
+    [[nodiscard]] size_t getUploadBytes() const;
 };
@@ -0,0 +1,120 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//
+// 世代付きハンドルで要素を引くテーブル
+// 削除したハンドルは世代が合わなくなるので、再利用された番号を誤って引かない
+// (0 は無効なハンドル)
+//
+template <class T>
+class SlotMap
+{
+  public:
+    using Handle = uint32_t;
+
+    static constexpr Handle   InvalidHandle = 0;
+    static constexpr uint32_t IndexBits     = 20;
+    static constexpr uint32_t IndexMask     = (1u << IndexBits) - 1;
+    static constexpr uint32_t MaxGeneration = (1u << (32 - IndexBits)) - 1;
+
+  private:
+    struct Slot
+    {
+        T        value{};
+        uint32_t generation = 1;
+        bool     alive      = false;
+    };
+
+    std::vector<Slot>     slots_;
+    std::vector<uint32_t> freeList_;
+    size_t                count_ = 0;
+
+    static Handle makeHandle(uint32_t index, uint32_t generation) { return generation << IndexBits | index; }
+
+    //
+    Slot* find(Handle handle)
+    {
+        const uint32_t index = handle & IndexMask;
+        if (handle == InvalidHandle || index >= slots_.size())
+        {
+            return nullptr;
+        }
+        auto& slot = slots_[index];
+        return slot.alive && slot.generation == handle >> IndexBits ? &slot : nullptr;
+    }
+
+  public:
+    // 容量を超えたら InvalidHandle
+    Handle create(T value = {})
+    {
+        uint32_t index;
+        if (!freeList_.empty())
+        {
+            index = freeList_.back();
+            freeList_.pop_back();
+        }
+        else
+        {
+            if (slots_.size() > IndexMask)
+            {
+                return InvalidHandle;
+            }
+            index = uint32_t(slots_.size());
+            slots_.emplace_back();
+        }
+        auto& slot = slots_[index];
+        slot.value = std::move(value);
+        slot.alive = true;
+        count_++;
+        return makeHandle(index, slot.generation);
+    }
+
+    // 古いハンドルなら false
+    bool destroy(Handle handle)
+    {
+        auto* slot = find(handle);
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        slot->value = T{};
+        slot->alive = false;
+        count_--;
+        // 世代を使い切った番号は捨てる(0 にはしない)
+        if (++slot->generation <= MaxGeneration)
+        {
+            freeList_.push_back(handle & IndexMask);
+        }
+        return true;
+    }
+
+    //
+    T* get(Handle handle)
+    {
+        auto* slot = find(handle);
+        return slot ? &slot->value : nullptr;
+    }
+    const T* get(Handle handle) const { return const_cast<SlotMap*>(this)->get(handle); }
+    bool   contains(Handle handle) const { return get(handle) != nullptr; }
+    size_t size() const { return count_; }
+
+    // 生きている要素毎に fn(Handle, T&)
+    template <class Fn>
+    void forEach(Fn&& fn)
+    {
+        for (size_t i = 0; i < slots_.size(); i++)
+        {
+            if (slots_[i].alive)
+            {
+                fn(makeHandle(uint32_t(i), slots_[i].generation), slots_[i].value);
+            }
+        }
+    }
+};
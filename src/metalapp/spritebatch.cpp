@@ -0,0 +1,122 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "spritebatch.h"
+#include "packing.h"
+#include <algorithm>
+
+namespace
+{
+// キー: layer(16) | blend(1) | texture(15) | 追加順(32)
+constexpr uint32_t textureBits = 15;
+constexpr uint32_t textureMask = (1u << textureBits) - 1;
+
+} // namespace
+
+//
+//
+//
+void
+SpriteBatch::setViewport(float width, float height)
+{
+    width_  = width;
+    height_ = height;
+}
+
+//
+//
+//
+void
+SpriteBatch::clear()
+{
+    quads_.clear();
+    keys_.clear();
+    textures_.clear();
+    vertices_.clear();
+    runs_.clear();
+    lastTexture_ = nullptr;
+    culled_      = 0;
+}
+
+//
+// テクスチャは最初に使われた順に番号を振る(直前と同じなら探さない)
+//
+uint32_t
+SpriteBatch::getTextureIndex(MTL::Texture* texture)
+{
+    if (texture == lastTexture_ && !textures_.empty())
+    {
+        return lastIndex_;
+    }
+    auto it = std::find(textures_.begin(), textures_.end(), texture);
+    if (it == textures_.end())
+    {
+        textures_.push_back(texture);
+        it = textures_.end() - 1;
+    }
+    lastTexture_ = texture;
+    lastIndex_   = uint32_t(it - textures_.begin());
+    return lastIndex_;
+}
+
+//
+//
+//
+bool
+SpriteBatch::add(MTL::Texture* texture, const Quad& quad, int16_t layer, Blend blend)
+{
+    const float minX = std::min(quad.x1, quad.x2);
+    const float maxX = std::max(quad.x1, quad.x2);
+    const float minY = std::min(quad.y1, quad.y2);
+    const float maxY = std::max(quad.y1, quad.y2);
+    if (maxX <= 0.0f || maxY <= 0.0f || minX >= width_ || minY >= height_)
+    {
+        culled_++;
+        return false;
+    }
+
+    const uint32_t texIndex = getTextureIndex(texture) & textureMask;
+    const uint64_t order    = uint64_t(uint16_t(layer) ^ 0x8000) << 16 | uint64_t(blend) << textureBits | texIndex;
+
+    keys_.push_back(order << 32 | quads_.size());
+    quads_.push_back({quad, texIndex});
+    return true;
+}
+
+//
+//
+//
+void
+SpriteBatch::build()
+{
+    // 追加順が下位にあるので、キーは全て異なり結果は安定
+    std::sort(keys_.begin(), keys_.end());
+
+    vertices_.resize(quads_.size() * 4);
+    runs_.clear();
+    auto* dst = vertices_.data();
+    for (size_t i = 0; i < keys_.size(); i++, dst += 4)
+    {
+        const auto& entry = quads_[keys_[i] & 0xffffffff];
+        const auto& q     = entry.quad;
+        const auto  u1    = Packing::packHalf(q.u1);
+        const auto  v1    = Packing::packHalf(q.v1);
+        const auto  u2    = Packing::packHalf(q.u2);
+        const auto  v2    = Packing::packHalf(q.v2);
+
+        dst[0] = {{q.x1, q.y1}, {u1, v1}, q.color};
+        dst[1] = {{q.x2, q.y1}, {u2, v1}, q.color};
+        dst[2] = {{q.x1, q.y2}, {u1, v2}, q.color};
+        dst[3] = {{q.x2, q.y2}, {u2, v2}, q.color};
+
+        auto* texture = textures_[entry.texture];
+        auto  blend   = Blend((keys_[i] >> (32 + textureBits)) & 1);
+        if (runs_.empty() || runs_.back().texture != texture || runs_.back().blend != blend)
+        {
+            runs_.push_back({texture, blend, uint32_t(i), 0, entry.texture});
+        }
+        runs_.back().quadCount++;
+    }
+}
+
+//
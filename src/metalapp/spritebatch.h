@@ -0,0 +1,87 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace MTL
+{
+class Texture;
+} // namespace MTL
+
+//
+// 2D の矩形(スプライト)をまとめて、(レイヤー, ブレンド, テクスチャ)順に並べ替える
+// 同じレイヤー内の描画順は保証しない(同じテクスチャ同士は追加順)
+//
+class SpriteBatch
+{
+  public:
+    enum class Blend : uint8_t
+    {
+        Alpha,
+        Add,
+    };
+
+    // shader/simple2d.metal の SpriteVertex と同じ並び
+    struct Vertex
+    {
+        float    position[2];
+        uint16_t texcoord[2]; // half (繰り返しのテクスチャで 0..1 の外も使える)
+        uint32_t color;       // RGBA8
+    };
+
+    // 画面座標の矩形とUV
+    struct Quad
+    {
+        float    x1, y1, x2, y2;
+        float    u1, v1, u2, v2;
+        uint32_t color;
+    };
+
+    // 同じテクスチャ/ブレンドで続けて描ける範囲(単位は矩形)
+    struct Run
+    {
+        MTL::Texture* texture;
+        Blend         blend;
+        uint32_t      firstQuad;
+        uint32_t      quadCount;
+        uint32_t      textureIndex; // テクスチャを最初に使った順の番号
+    };
+
+    void setViewport(float width, float height);
+    void clear();
+
+    // 画面外なら追加せずに false
+    bool add(MTL::Texture* texture, const Quad& quad, int16_t layer, Blend blend);
+
+    // 並べ替えて頂点と Run を作る
+    void build();
+
+    [[nodiscard]] const std::vector<Vertex>& getVertices() const { return vertices_; }
+    [[nodiscard]] const std::vector<Run>&    getRuns() const { return runs_; }
+    [[nodiscard]] size_t                     getQuadCount() const { return quads_.size(); }
+    [[nodiscard]] size_t                     getCulledCount() const { return culled_; }
+
+  private:
+    struct Entry
+    {
+        Quad     quad;
+        uint32_t texture;
+    };
+
+    std::vector<Entry>         quads_;
+    std::vector<uint64_t>      keys_;
+    std::vector<MTL::Texture*> textures_;
+    std::vector<Vertex>        vertices_;
+    std::vector<Run>           runs_;
+    MTL::Texture*              lastTexture_ = nullptr;
+    uint32_t                   lastIndex_   = 0;
+    float                      width_       = 0.0f;
+    float                      height_      = 0.0f;
+    size_t                     culled_      = 0;
+
+    uint32_t getTextureIndex(MTL::Texture* texture);
+};
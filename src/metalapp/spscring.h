@@ -0,0 +1,59 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+//
+// 書き込み 1 スレッド、読み出し 1 スレッドのリングバッファ(ロック無し)
+// 満杯の時 push は失敗する(古いものを上書きしない)
+//
+template <class T, size_t Capacity>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0);
+
+    static constexpr size_t Mask = Capacity - 1;
+
+    // 書く側と読む側でキャッシュラインを分ける
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    T items_[Capacity];
+
+  public:
+    // 書き込みスレッド
+    bool push(const T& value)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        items_[head & Mask] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 読み出しスレッド
+    bool pop(T& value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = items_[tail & Mask];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] static constexpr size_t capacity() { return Capacity; }
+};
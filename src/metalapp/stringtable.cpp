@@ -0,0 +1,56 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "stringtable.h"
+#include <utility>
+
+//
+//
+//
+std::string_view
+StringTable::intern(std::string_view str)
+{
+    auto it = table_.find(str);
+    if (it != table_.end())
+    {
+        it->second = frame_;
+        return it->first;
+    }
+    return table_.emplace(storage_.copy(str), frame_).first->first;
+}
+
+//
+// 残す文字列は node ごと spareTable_ へ移すので、詰め直しでヒープ確保は起きない
+//
+void
+StringTable::endFrame()
+{
+    if (++frame_ % keepFrames != 0)
+    {
+        return;
+    }
+    spare_.reset();
+    while (!table_.empty())
+    {
+        auto node = table_.extract(table_.begin());
+        if (frame_ - node.mapped() <= keepFrames)
+        {
+            node.key() = spare_.copy(node.key());
+            spareTable_.insert(std::move(node));
+        }
+    }
+    std::swap(storage_, spare_);
+    std::swap(table_, spareTable_);
+}
+
+//
+//
+//
+void
+StringTable::clear()
+{
+    table_.clear();
+    storage_.reset();
+}
+
+//
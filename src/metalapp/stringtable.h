@@ -0,0 +1,44 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include "framearena.h"
+#include <cinttypes>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+//
+// 文字列の重複を除いて保持する(同じ内容なら同じ領域を返す)
+// 登録済みの文字列の検索ではヒープ確保しない
+// keepFrames フレーム毎に、その間使われなかった文字列を捨てて残りを詰め直す
+// (毎フレーム変わる文字列を渡されても使用量は増え続けない)
+//
+class StringTable
+{
+  public:
+    static constexpr uint32_t keepFrames = 120;
+
+    StringTable() = default;
+
+    // 返す文字列は NUL 終端していて、次の endFrame まで有効(フレームを跨いで持たないこと)
+    std::string_view intern(std::string_view str);
+    [[nodiscard]] bool contains(std::string_view str) const { return table_.count(str) != 0; }
+
+    // フレームの終わりに呼ぶ
+    void endFrame();
+    void clear();
+
+    [[nodiscard]] size_t size() const { return table_.size(); }
+    [[nodiscard]] size_t getBytes() const { return storage_.getUsedBytes(); }
+
+  private:
+    using Table = std::unordered_map<std::string_view, uint32_t>; // 文字列 -> 最後に使ったフレーム
+
+    FrameArena storage_{16 * 1024};
+    FrameArena spare_{16 * 1024}; // 詰め直す先(ブロックは使い回す)
+    Table      table_;
+    Table      spareTable_;
+    uint32_t   frame_ = 0;
+};
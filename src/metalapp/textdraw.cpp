@@ -7,44 +7,100 @@
 #include <Metal/Metal.hpp>
 #include <MetalKit/MetalKit.hpp>
 
+#include "perfstats.h"
 #include "textdraw.h"
 #include "texture.h"
 #include <array>
+#include <cstring>
 #include <iostream>
-#include <list>
 #include <simd/simd.h>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace
 {
+// 使われなくなってから捨てるまでのフレーム数
+constexpr uint32_t keepFrames = 120;
+
+// 文字列毎に作ったテクスチャ(色は頂点色で掛けるので白で作る)
+struct CacheEntry
+{
+    std::string text;
+    std::string fontName;
+    float       size = 0.0f;
+    Texture     tex;
+    uint32_t    lastUsed = 0;
+};
 
 //
 struct DrawBuffer
 {
-    Texture      tex;
+    Texture*     tex;
     float        x;
     float        y;
     simd::float4 col;
 };
 
+// FNV-1a
+uint64_t
+hashText(std::string_view text, float size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (auto c : text)
+    {
+        hash = (hash ^ uint8_t(c)) * 1099511628211ull;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &size, sizeof(bits));
+    return (hash ^ bits) * 1099511628211ull;
+}
+
 } // namespace
 
 struct TextDraw::Impl
 {
-    MTL::Device*          device_ = nullptr;
-    Texture::StringDesc   strdesc_{};
-    simd::float4          color_{1.0f, 1.0f, 1.0f, 1.0f};
-    std::list<DrawBuffer> drawList_{};
-
+    MTL::Device*                                  device_ = nullptr;
+    Texture::StringDesc                           strdesc_{};
+    simd::float4                                  color_{1.0f, 1.0f, 1.0f, 1.0f};
+    std::vector<DrawBuffer>                       drawList_{};
+    std::unordered_multimap<uint64_t, CacheEntry> cache_;
+    uint32_t                                      frame_ = 0;
+
+    // 無ければ作る(検索だけならヒープ確保しない)
+    Texture* getTexture(std::string_view msg)
+    {
+        const auto key   = hashText(msg, strdesc_.size);
+        auto       range = cache_.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            auto& entry = it->second;
+            if (entry.text == msg && entry.size == strdesc_.size && entry.fontName == strdesc_.fontName)
+            {
+                entry.lastUsed = frame_;
+                return &entry.tex;
+            }
+        }
+        auto& entry    = cache_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple())->second;
+        entry.text     = msg;
+        entry.fontName = strdesc_.fontName;
+        entry.size     = strdesc_.size;
+        entry.lastUsed = frame_;
+        strdesc_.message.assign(msg);
+        entry.tex.buildByString(device_, strdesc_);
+        return &entry.tex;
+    }
+    //
+    void print(float x, float y, std::string_view msg) { drawList_.push_back({getTexture(msg), x, y, color_}); }
     //
-    void print(float x, float y, const char* msg)
+    void clear()
     {
-        drawList_.push_back({});
-        auto& tdb        = drawList_.back();
-        strdesc_.message = msg;
-        tdb.tex.buildByString(device_, strdesc_);
-        tdb.x   = x;
-        tdb.y   = y;
-        tdb.col = color_;
+        drawList_.clear();
+        frame_++;
+        for (auto it = cache_.begin(); it != cache_.end();)
+        {
+            it = frame_ - it->second.lastUsed > keepFrames ? cache_.erase(it) : std::next(it);
+        }
     }
 };
 
@@ -111,8 +167,8 @@ TextDraw::render(MTL::RenderCommandEncoder* enc)
     {
         float lx = tdb.x;
         float ty = tdb.y;
-        float rx = lx + tdb.tex.getWidth();
-        float by = ty + tdb.tex.getHeight();
+        float rx = lx + tdb.tex->getWidth();
+        float by = ty + tdb.tex->getHeight();
 
         std::array<V2D, 4> varray;
         varray[0].c = varray[1].c = varray[2].c = varray[3].c = tdb.col;
@@ -129,13 +185,12 @@ TextDraw::render(MTL::RenderCommandEncoder* enc)
         varray[3].p[0] = rx;
         varray[3].p[1] = by;
         varray[3].t    = {1.0, 1.0};
-        auto* buff     = impl_->device_->newBuffer(varray.data(), sizeof(varray), MTL::ResourceOptionCPUCacheModeDefault);
 
-        enc->setVertexBuffer(buff, 0, 0);
-        enc->setFragmentTexture(tdb.tex.get(), 0);
+        // 4頂点だけなのでバッファは作らずに直接渡す
+        enc->setVertexBytes(varray.data(), sizeof(varray), 0);
+        enc->setFragmentTexture(tdb.tex->get(), 0);
         enc->drawPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangleStrip, 0, 4, 1);
-
-        buff->release();
+        PerfStats::addDraw(4, 0);
     }
 }
 
@@ -145,16 +200,25 @@ TextDraw::render(MTL::RenderCommandEncoder* enc)
 void
 TextDraw::clear()
 {
-    impl_->drawList_.clear();
+    impl_->clear();
 }
 
 //
 //
 //
 void
-TextDraw::print(float x, float y, const char* msg)
+TextDraw::print(float x, float y, std::string_view msg)
 {
     impl_->print(x, y, msg);
 }
 
 //
+//
+//
+size_t
+TextDraw::getCacheCount() const
+{
+    return impl_->cache_.size();
+}
+
+//
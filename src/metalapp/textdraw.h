@@ -3,9 +3,12 @@
 //
 #pragma once
 
+#include <array>
 #include <cinttypes>
+#include <cstdio>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace MTL
 {
@@ -31,7 +34,8 @@ class TextDraw
     void render(MTL::RenderCommandEncoder* enc);
     void clear();
 
-    void print(float x, float y, const char* msg);
+    // 同じ文字列/サイズのテクスチャは使い回す(しばらく使われなければ捨てる)
+    void print(float x, float y, std::string_view msg);
 
     template <class... Args>
     void printf(float x, float y, const char* fmt, Args&&... args)
@@ -40,6 +44,9 @@ class TextDraw
         snprintf(msg.data(), msg.size(), fmt, std::forward<Args>(args)...);
         print(x, y, msg.data());
     }
+
+    // キャッシュしているテクスチャの数
+    [[nodiscard]] size_t getCacheCount() const;
 };
 
 //
@@ -12,6 +12,8 @@
 #include <Metal/Metal.hpp>
 #include <MetalKit/MetalKit.hpp>
 
+#include "gputrack.h"
+#include "perfstats.h"
 #include "texture.h"
 #include <array>
 #include <fstream>
@@ -37,12 +39,14 @@ Texture::loadFromMemory(MTL::Device* dev, uint8_t* buffer, uint32_t width, uint3
     pTextureDesc->setStorageMode(MTL::StorageModeManaged);
     pTextureDesc->setUsage(MTL::ResourceUsageSample | MTL::ResourceUsageRead);
 
-    auto* pTexture = dev->newTexture(pTextureDesc);
+    auto* pTexture = GpuTrack::newTexture(dev, pTextureDesc, category_);
     tex_           = pTexture;
     width_         = width;
     height_        = height;
 
     tex_->replaceRegion(MTL::Region(0, 0, 0, width, height, 1), 0, buffer, width * 4);
+    PerfStats::add(PerfStats::Counter::TexturesCreated);
+    PerfStats::add(PerfStats::Counter::UploadBytes, uint64_t(width) * height * 4);
 
     pTextureDesc->release();
 
@@ -129,6 +133,9 @@ Texture::loadFromPNG(MTL::Device* dev, std::string path, uint32_t toW, uint32_t
 bool
 Texture::buildByString(MTL::Device* dev, const StringDesc& strdesc)
 {
+    category_ = MemTrack::Category::Text;
+    PerfStats::add(PerfStats::Counter::TextRasterized);
+
     auto fSize      = strdesc.size;
     auto fontName   = CFStringCreateWithCString(kCFAllocatorDefault, strdesc.fontName.c_str(), kCFStringEncodingUTF8);
     auto font       = CTFontCreateWithName(fontName, fSize, nullptr);
@@ -173,11 +180,8 @@ Texture::buildByString(MTL::Device* dev, const StringDesc& strdesc)
 void
 Texture::release()
 {
-    if (tex_)
-    {
-        tex_->release();
-        tex_ = nullptr;
-    }
+    GpuTrack::release(tex_, category_);
+    tex_ = nullptr;
 }
 
 //
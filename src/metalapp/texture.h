@@ -3,6 +3,7 @@
 //
 #pragma once
 
+#include "memtrack.h"
 #include <cinttypes>
 #include <string>
 
@@ -17,9 +18,10 @@ class Texture;
 //
 class Texture
 {
-    MTL::Texture* tex_    = nullptr;
-    uint16_t      width_  = 0;
-    uint16_t      height_ = 0;
+    MTL::Texture*      tex_      = nullptr;
+    uint16_t           width_    = 0;
+    uint16_t           height_   = 0;
+    MemTrack::Category category_ = MemTrack::Category::Texture; // 文字列から作ったものは Text
 
   public:
     Texture() = default;
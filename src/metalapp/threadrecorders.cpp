@@ -0,0 +1,167 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "threadrecorders.h"
+#include "framerecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <matrix.h>
+
+namespace
+{
+// clear の度に新しい番号にする(インスタンスの間でも重ならない)
+std::atomic<uint64_t> nextGeneration{1};
+
+// スレッド毎に最後に使ったスロット
+struct SlotCache
+{
+    uint64_t generation;
+    uint32_t slot;
+};
+thread_local SlotCache slotCache{0, 0};
+
+} // namespace
+
+//
+//
+//
+ThreadRecorders::ThreadRecorders(GeometryHandleMap* handles)
+    : handles_(handles), generation_(nextGeneration.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+//
+//
+//
+ThreadRecorders::~ThreadRecorders() = default;
+
+//
+// 別の ThreadRecorders を挟んで戻って来た時は、確保済みのスロットを探してから新しく取る
+// owner は自分で書いた値しか一致しないので、他のスレッドと順番を揃える必要は無い
+//
+uint32_t
+ThreadRecorders::findSlot()
+{
+    if (slotCache.generation == generation_)
+    {
+        return slotCache.slot;
+    }
+    const auto     self  = std::this_thread::get_id();
+    const uint32_t count = std::min<uint32_t>(slotCount_.load(std::memory_order_relaxed), MaxThreads);
+    uint32_t       slot  = 0;
+    while (slot < count && slots_[slot].owner.load(std::memory_order_relaxed) != self)
+    {
+        slot++;
+    }
+    if (slot == count)
+    {
+        slot = slotCount_.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= MaxThreads)
+        {
+            std::fprintf(stderr, "GetThreadContext: more than %zu threads in one frame\n", MaxThreads);
+            std::abort();
+        }
+        slots_[slot].owner.store(self, std::memory_order_relaxed);
+    }
+    slotCache = {generation_, slot};
+    return slot;
+}
+
+//
+// 前と同じキーなら続けて記録し、違えば新しい区切りにする
+//
+Context&
+ThreadRecorders::get(uint32_t sortKey)
+{
+    auto& slot = slots_[findSlot()];
+    if (slot.used > 0 && slot.keys[slot.used - 1] == sortKey)
+    {
+        return *slot.pool[slot.used - 1];
+    }
+    if (slot.used == slot.pool.size())
+    {
+        slot.pool.push_back(std::make_unique<FrameRecorder>(handles_));
+        slot.keys.push_back(0);
+    }
+    slot.keys[slot.used] = sortKey;
+    return *slot.pool[slot.used++];
+}
+
+//
+// スロット順、呼んだ順に集めてからキーで安定ソートする
+//
+void
+ThreadRecorders::replay(Context& target)
+{
+    merge_.clear();
+    const uint32_t count = std::min<uint32_t>(slotCount_.load(std::memory_order_relaxed), MaxThreads);
+    for (uint32_t s = 0; s < count; s++)
+    {
+        const auto& slot = slots_[s];
+        for (size_t i = 0; i < slot.used; i++)
+        {
+            merge_.push_back({slot.keys[i], slot.pool[i].get()});
+        }
+    }
+    std::stable_sort(merge_.begin(), merge_.end(), [](const Segment& a, const Segment& b) { return a.key < b.key; });
+
+    const auto identity = math::makeIdentity();
+    for (const auto& segment : merge_)
+    {
+        // 他のスレッドの描画色や変換を引き継がない
+        target.SetDrawColor(1.0f, 1.0f, 1.0f, 1.0f);
+        target.SetTransform(identity);
+        segment.recorder->replay(target);
+    }
+}
+
+//
+// 記録用のバッファは残しておく
+//
+void
+ThreadRecorders::clear()
+{
+    const uint32_t count = std::min<uint32_t>(slotCount_.load(std::memory_order_relaxed), MaxThreads);
+    for (uint32_t s = 0; s < count; s++)
+    {
+        auto& slot = slots_[s];
+        for (size_t i = 0; i < slot.used; i++)
+        {
+            slot.pool[i]->clear();
+        }
+        slot.used = 0;
+        slot.owner.store(std::thread::id{}, std::memory_order_relaxed);
+    }
+    slotCount_.store(0, std::memory_order_relaxed);
+    generation_ = nextGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+//
+//
+//
+size_t
+ThreadRecorders::getThreadCount() const
+{
+    return std::min<uint32_t>(slotCount_.load(std::memory_order_relaxed), MaxThreads);
+}
+
+//
+//
+//
+size_t
+ThreadRecorders::getCommandCount() const
+{
+    size_t total = 0;
+    for (size_t s = 0; s < getThreadCount(); s++)
+    {
+        const auto& slot = slots_[s];
+        for (size_t i = 0; i < slot.used; i++)
+        {
+            total += slot.pool[i]->getCommandCount();
+        }
+    }
+    return total;
+}
+
+//
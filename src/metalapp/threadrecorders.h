@@ -0,0 +1,69 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <context.h>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class FrameRecorder;
+class GeometryHandleMap;
+
+//
+// Context::GetThreadContext の実装
+// スレッド毎にスロットを1つ持ち、そこの FrameRecorder に記録する(ロックは取らない)
+// スロットは最初に呼んだ時に atomic のカウンタで確保して、thread_local に覚えておく
+// replay で (sortKey, スロットの確保順, 呼んだ順) に並べて再生する
+// 同じ sortKey を複数のスレッドで使うとスレッドの間の順番は確保順(実行毎に変わり得る)になる
+// replay と clear は記録するスレッドが全て終わってから呼ぶ
+// 1フレームに MaxThreads を超えるスレッドから呼ぶと abort する(共有の Context に落とすと競合になる)
+//
+class ThreadRecorders
+{
+  public:
+    static constexpr size_t MaxThreads = 64;
+
+    // handles はジオメトリハンドルの変換用(nullptr ならそのまま渡す)
+    explicit ThreadRecorders(GeometryHandleMap* handles = nullptr);
+    ~ThreadRecorders();
+    ThreadRecorders(const ThreadRecorders&)            = delete;
+    ThreadRecorders& operator=(const ThreadRecorders&) = delete;
+
+    // 呼んだスレッド用の Context
+    Context& get(uint32_t sortKey);
+    // 全スレッドの記録を並べて target に再生する(各スレッドの分は白、単位行列から始める)
+    void replay(Context& target);
+    // 記録を捨てて、スロットを空ける(次のフレームは確保し直す)
+    void clear();
+
+    [[nodiscard]] size_t getThreadCount() const;
+    [[nodiscard]] size_t getCommandCount() const;
+
+  private:
+    struct Segment
+    {
+        uint32_t       key;
+        FrameRecorder* recorder;
+    };
+    // 別のスレッドが書くので、スロット同士はキャッシュラインを分ける
+    struct alignas(64) Slot
+    {
+        std::atomic<std::thread::id>                owner{};
+        std::vector<std::unique_ptr<FrameRecorder>> pool;
+        std::vector<uint32_t>                       keys;
+        size_t                                      used = 0;
+    };
+
+    uint32_t findSlot();
+
+    GeometryHandleMap*    handles_;
+    Slot                  slots_[MaxThreads];
+    std::atomic<uint32_t> slotCount_{0};
+    uint64_t              generation_;
+    std::vector<Segment>  merge_;
+};
@@ -0,0 +1,54 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <simd/simd.h>
+
+//
+// 頂点列への変換行列の一括適用(アフィン変換のみ)
+//
+namespace TransformBatch
+{
+
+//
+inline bool
+isIdentity(const simd::float4x4& m)
+{
+    return simd_equal(m, matrix_identity_float4x4);
+}
+
+// stride バイト毎に並んだ float[3] の位置を変換する
+// (simd_mul は列の積和なので1頂点が4幅の積和3回になる)
+inline void
+apply(const simd::float4x4& m, void* positions, size_t stride, size_t count)
+{
+    auto* p = static_cast<uint8_t*>(positions);
+    for (size_t i = 0; i < count; i++, p += stride)
+    {
+        auto*              v   = reinterpret_cast<float*>(p);
+        const simd::float4 out = simd_mul(m, simd_make_float4(v[0], v[1], v[2], 1.0f));
+        v[0]                   = out.x;
+        v[1]                   = out.y;
+        v[2]                   = out.z;
+    }
+}
+
+// 行優先 3x4 のアフィン変換(rows)の前に m を掛ける
+inline void
+applyRows(const simd::float4x4& m, float (&rows)[12])
+{
+    const auto row = [&rows](int r) { return simd_make_float4(rows[r * 4], rows[r * 4 + 1], rows[r * 4 + 2], rows[r * 4 + 3]); };
+    const auto out = simd_transpose(simd_mul(m, simd_matrix_from_rows(row(0), row(1), row(2), simd_make_float4(0, 0, 0, 1))));
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            rows[r * 4 + c] = out.columns[r][c];
+        }
+    }
+}
+
+} // namespace TransformBatch
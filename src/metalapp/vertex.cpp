@@ -7,8 +7,13 @@
 #include <Metal/Metal.hpp>
 #include <MetalKit/MetalKit.hpp>
 
+#include "gputrack.h"
+#include "meshsimplify.h"
+#include "packing.h"
 #include "vertex.h"
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <simd/simd.h>
@@ -49,6 +54,27 @@ struct VertexData
     }
 };
 
+static_assert(sizeof(VertexData) == sizeof(PrimitiveMesh::MeshVertex));
+static_assert(offsetof(VertexData, normal) == offsetof(PrimitiveMesh::MeshVertex, normal));
+static_assert(offsetof(VertexData, texcoord) == offsetof(PrimitiveMesh::MeshVertex, texcoord));
+
+// 座標データ描画用(Compact)
+struct CompactVertexData
+{
+    uint16_t position[4];
+    int16_t  normal[2];
+    uint16_t texcoord[2];
+};
+static_assert(sizeof(CompactVertexData) == 16);
+
+// LOD毎のインデックス
+struct LODData
+{
+    std::vector<uint16_t> indices;
+    std::uintptr_t        offset = 0;
+    float                 error  = 0.0f;
+};
+
 } // namespace
 
 struct Vertex::Impl
@@ -56,9 +82,14 @@ struct Vertex::Impl
     std::vector<PointData>  pointList_;
     std::vector<VertexData> vertexList_;
     std::vector<uint16_t>   indices_;
+    std::vector<LODData>    lodList_;
     MTL::Buffer*            vertexBuffer_ = nullptr;
     MTL::Buffer*            indexBuffer_  = nullptr;
     std::uintptr_t          nbIndices_    = 0;
+    float                   radius_       = 0.0f;
+    Format                  format_       = Format::Standard;
+    Bounds                  bounds_{};
+    PackInfo                packInfo_{};
 
     //
     void searchAndPush(VertexData vd)
@@ -92,16 +123,131 @@ struct Vertex::Impl
         searchAndPush({pd2.pos, norm, pd2.uv});
     }
 
+    // 1段ずつ前のLODから簡略化していく
+    int buildLOD(int levels, float ratio, float maxError)
+    {
+        lodList_.resize(1);
+        lodList_[0].indices = indices_;
+        if (vertexList_.empty())
+        {
+            return 1;
+        }
+
+        MeshSimplify::VertexStream vs;
+        vs.position = reinterpret_cast<const float*>(&vertexList_[0].position);
+        vs.normal   = reinterpret_cast<const float*>(&vertexList_[0].normal);
+        vs.texcoord = reinterpret_cast<const float*>(&vertexList_[0].texcoord);
+        vs.stride   = sizeof(VertexData);
+        vs.count    = vertexList_.size();
+
+        MeshSimplify::Option opt;
+        opt.targetRatio = ratio;
+        opt.maxError    = maxError;
+        for (int i = 1; i < levels; i++)
+        {
+            LODData lod;
+            lod.error = MeshSimplify::simplify(vs, lodList_.back().indices, lod.indices, opt);
+            if (lod.indices.empty() || lod.indices.size() >= lodList_.back().indices.size())
+            {
+                // これ以上減らない
+                break;
+            }
+            lodList_.emplace_back(std::move(lod));
+        }
+        return static_cast<int>(lodList_.size());
+    }
+
+    //
+    void updateRadius()
+    {
+        radius_ = 0.0f;
+        for (auto& vd : vertexList_)
+        {
+            radius_ = std::max(radius_, simd::length(vd.position));
+        }
+    }
+
+    // AABB基準で量子化し、誤差を記録する
+    void compress(std::vector<CompactVertexData>& out)
+    {
+        simd::float3 bmin = vertexList_.empty() ? simd::float3{} : vertexList_[0].position;
+        simd::float3 bmax = bmin;
+        for (auto& vd : vertexList_)
+        {
+            bmin = simd::min(bmin, vd.position);
+            bmax = simd::max(bmax, vd.position);
+        }
+        bounds_.origin = bmin;
+        bounds_.extent = bmax - bmin;
+
+        packInfo_ = {};
+        out.resize(vertexList_.size());
+        for (size_t i = 0; i < vertexList_.size(); i++)
+        {
+            auto& vd = vertexList_[i];
+            auto& cv = out[i];
+            for (int e = 0; e < 3; e++)
+            {
+                cv.position[e] = Packing::packPosition(vd.position[e], bmin[e], bounds_.extent[e]);
+                auto decoded   = Packing::unpackPosition(cv.position[e], bmin[e], bounds_.extent[e]);
+
+                packInfo_.maxPositionError = std::max(packInfo_.maxPositionError, std::abs(decoded - vd.position[e]));
+            }
+            cv.position[3] = 0;
+
+            Packing::packOctNormal(vd.normal[0], vd.normal[1], vd.normal[2], cv.normal);
+            float n[3];
+            Packing::unpackOctNormal(cv.normal, n);
+            auto cosA = std::clamp(simd::dot(vd.normal, simd::float3{n[0], n[1], n[2]}), -1.0f, 1.0f);
+
+            packInfo_.maxNormalError = std::max(packInfo_.maxNormalError, std::acos(cosA) * 180.0f / float(M_PI));
+
+            for (int e = 0; e < 2; e++)
+            {
+                cv.texcoord[e] = Packing::packHalf(vd.texcoord[e]);
+                auto err       = std::abs(Packing::unpackHalf(cv.texcoord[e]) - vd.texcoord[e]);
+
+                packInfo_.maxTexcoordError = std::max(packInfo_.maxTexcoordError, err);
+            }
+        }
+    }
+
     // バッファ生成
     void build(MTL::Device* dev)
     {
-        auto vsize    = vertexList_.size() * sizeof(VertexData);
-        auto isize    = indices_.size() * sizeof(uint16_t);
-        vertexBuffer_ = dev->newBuffer(vsize, MTL::ResourceStorageModeManaged);
-        indexBuffer_  = dev->newBuffer(isize, MTL::ResourceStorageModeManaged);
+        if (lodList_.empty())
+        {
+            lodList_.resize(1);
+            lodList_[0].indices = indices_;
+        }
+        // LODのインデックスは1本のバッファに4バイト境界で並べる
+        std::vector<uint16_t> allIndices;
+        for (auto& lod : lodList_)
+        {
+            lod.offset = allIndices.size() * sizeof(uint16_t);
+            allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+            allIndices.resize((allIndices.size() + 1) & ~size_t(1), 0);
+        }
+
+        updateRadius();
 
-        std::memcpy(vertexBuffer_->contents(), vertexList_.data(), vsize);
-        std::memcpy(indexBuffer_->contents(), indices_.data(), isize);
+        std::vector<CompactVertexData> compactList;
+        const void*                    vdata = vertexList_.data();
+        auto                           vsize = vertexList_.size() * sizeof(VertexData);
+        if (format_ == Format::Compact)
+        {
+            compress(compactList);
+            vdata = compactList.data();
+            vsize = compactList.size() * sizeof(CompactVertexData);
+        }
+        packInfo_.vertexBytes = vsize;
+
+        auto isize    = allIndices.size() * sizeof(uint16_t);
+        vertexBuffer_ = GpuTrack::newBuffer(dev, vsize, MTL::ResourceStorageModeManaged, MemTrack::Category::Vertex);
+        indexBuffer_  = GpuTrack::newBuffer(dev, isize, MTL::ResourceStorageModeManaged, MemTrack::Category::Index);
+
+        std::memcpy(vertexBuffer_->contents(), vdata, vsize);
+        std::memcpy(indexBuffer_->contents(), allIndices.data(), isize);
         nbIndices_ = indices_.size();
 
         vertexBuffer_->didModifyRange(NS::Range::Make(0, vertexBuffer_->length()));
@@ -111,16 +257,10 @@ struct Vertex::Impl
     //
     void release()
     {
-        if (vertexBuffer_)
-        {
-            vertexBuffer_->release();
-            vertexBuffer_ = nullptr;
-        }
-        if (indexBuffer_)
-        {
-            indexBuffer_->release();
-            vertexBuffer_ = nullptr;
-        }
+        GpuTrack::release(vertexBuffer_, MemTrack::Category::Vertex);
+        GpuTrack::release(indexBuffer_, MemTrack::Category::Index);
+        vertexBuffer_ = nullptr;
+        indexBuffer_  = nullptr;
     }
 };
 
@@ -146,8 +286,26 @@ Vertex::release()
 
 //
 void
-Vertex::build(MTL::Device* dev)
+Vertex::assign(const PrimitiveMesh::MeshVertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount)
+{
+    auto& vlist = impl_->vertexList_;
+    vlist.resize(vertexCount);
+    std::memcpy(vlist.data(), vertices, vertexCount * sizeof(VertexData));
+    impl_->indices_.assign(indices, indices + indexCount);
+}
+
+//
+int
+Vertex::buildLOD(int levels, float ratio, float maxError)
+{
+    return impl_->buildLOD(levels, ratio, maxError);
+}
+
+//
+void
+Vertex::build(MTL::Device* dev, Format format)
 {
+    impl_->format_ = format;
     impl_->build(dev);
 }
 
@@ -181,11 +339,119 @@ Vertex::getIndexBuffer()
     return impl_->indexBuffer_;
 }
 
+//
+// LOD 毎に使う頂点だけを番号順に詰め直して格納する
+//
+GeometryPool::Handle
+Vertex::store(GeometryPool& pool, int lod)
+{
+    auto& impl = *impl_;
+    if (impl.lodList_.empty())
+    {
+        impl.lodList_.resize(1);
+        impl.lodList_[0].indices = impl.indices_;
+    }
+    const size_t stride  = pool.getVertexStride();
+    const bool   compact = stride == sizeof(CompactVertexData);
+    if (!compact && stride != sizeof(VertexData))
+    {
+        std::cerr << "geometry pool stride mismatch: " << stride << std::endl;
+        return GeometryPool::InvalidHandle;
+    }
+    if (lod < 0 || lod >= static_cast<int>(impl.lodList_.size()))
+    {
+        return GeometryPool::InvalidHandle;
+    }
+
+    std::vector<CompactVertexData> compactList;
+    const uint8_t*                 src = reinterpret_cast<const uint8_t*>(impl.vertexList_.data());
+    if (compact)
+    {
+        impl.compress(compactList);
+        src = reinterpret_cast<const uint8_t*>(compactList.data());
+    }
+    impl.format_ = compact ? Format::Compact : Format::Standard;
+    impl.updateRadius();
+
+    const auto&           lodIndices = impl.lodList_[lod].indices;
+    std::vector<uint32_t> remap(impl.vertexList_.size(), UINT32_MAX);
+    std::vector<uint8_t>  vertices;
+    std::vector<uint16_t> indices(lodIndices.size());
+    uint32_t              vertexCount = 0;
+    for (size_t i = 0; i < lodIndices.size(); i++)
+    {
+        const auto v = lodIndices[i];
+        if (remap[v] == UINT32_MAX)
+        {
+            remap[v] = vertexCount++;
+            vertices.insert(vertices.end(), src + v * stride, src + (v + 1) * stride);
+        }
+        indices[i] = static_cast<uint16_t>(remap[v]);
+    }
+    return pool.allocate(vertices.data(), vertexCount, indices.data(), indices.size());
+}
+
+//
+size_t
+Vertex::getStride(Format format)
+{
+    return format == Format::Compact ? sizeof(CompactVertexData) : sizeof(VertexData);
+}
+
+//
+Vertex::Format
+Vertex::getFormat() const
+{
+    return impl_->format_;
+}
+
+//
+const Vertex::Bounds&
+Vertex::getBounds() const
+{
+    return impl_->bounds_;
+}
+
+//
+const Vertex::PackInfo&
+Vertex::getPackInfo() const
+{
+    return impl_->packInfo_;
+}
+
 //
 std::uintptr_t
-Vertex::getIndexCount() const
+Vertex::getIndexCount(int lod) const
+{
+    return lod == 0 ? impl_->nbIndices_ : impl_->lodList_[lod].indices.size();
+}
+
+//
+std::uintptr_t
+Vertex::getIndexOffset(int lod) const
+{
+    return impl_->lodList_.empty() ? 0 : impl_->lodList_[lod].offset;
+}
+
+//
+int
+Vertex::getLODCount() const
+{
+    return std::max(1, static_cast<int>(impl_->lodList_.size()));
+}
+
+//
+float
+Vertex::getLODError(int lod) const
+{
+    return impl_->lodList_.empty() ? 0.0f : impl_->lodList_[lod].error;
+}
+
+//
+float
+Vertex::getBoundingRadius() const
 {
-    return impl_->nbIndices_;
+    return impl_->radius_;
 }
 
 //
@@ -3,8 +3,11 @@
 //
 #pragma once
 
+#include "geometrypool.h"
+#include "primitivemesh.h"
 #include <cinttypes>
 #include <memory>
+#include <simd/vector_types.h>
 
 namespace MTL
 {
@@ -21,6 +24,27 @@ class Vertex
     std::unique_ptr<Impl> impl_;
 
   public:
+    // 頂点フォーマット
+    enum class Format
+    {
+        Standard, // float3 position / float3 normal / float2 texcoord (48byte)
+        Compact,  // unorm16x3 position / oct snorm16x2 normal / half2 texcoord (16byte)
+    };
+    // Compact のデコード用(シェーダの MeshBounds と同じ並び)
+    struct Bounds
+    {
+        simd::float3 origin;
+        simd::float3 extent;
+    };
+    // 量子化による誤差と転送サイズ
+    struct PackInfo
+    {
+        size_t vertexBytes      = 0;
+        float  maxPositionError = 0.0f;
+        float  maxNormalError   = 0.0f; // degree
+        float  maxTexcoordError = 0.0f;
+    };
+
     Vertex();
     virtual ~Vertex();
 
@@ -39,8 +63,22 @@ class Vertex
         pushTriangle(p2, p3, p0);
     }
 
+    // 生成済みの頂点/インデックスをそのまま設定
+    void assign(const PrimitiveMesh::MeshVertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount);
+    template <size_t NV, size_t NI>
+    void assign(const PrimitiveMesh::Mesh<NV, NI>& mesh)
+    {
+        assign(mesh.vertices.data(), NV, mesh.indices.data(), NI);
+    }
+
+    // 簡略化したLODを生成(build前に呼ぶ) @return 生成されたLOD数(元メッシュを含む)
+    int buildLOD(int levels, float ratio = 0.5f, float maxError = 0.02f);
+
     //
-    void build(MTL::Device* dev);
+    void build(MTL::Device* dev, Format format = Format::Standard);
+    // LOD を共有バッファへ格納(その LOD が使う頂点だけを詰める)
+    // 頂点の形式はプールの stride で決まる(getStride(Format) のどちらか)
+    GeometryPool::Handle store(GeometryPool& pool, int lod = 0);
 
     //
     void release();
@@ -48,7 +86,17 @@ class Vertex
     MTL::Buffer* getVertexBuffer();
     MTL::Buffer* getIndexBuffer();
 
-    [[nodiscard]] std::uintptr_t getIndexCount() const;
+    [[nodiscard]] static size_t getStride(Format format);
+
+    [[nodiscard]] Format          getFormat() const;
+    [[nodiscard]] const Bounds&   getBounds() const;
+    [[nodiscard]] const PackInfo& getPackInfo() const;
+
+    [[nodiscard]] std::uintptr_t getIndexCount(int lod = 0) const;
+    [[nodiscard]] std::uintptr_t getIndexOffset(int lod = 0) const;
+    [[nodiscard]] int            getLODCount() const;
+    [[nodiscard]] float          getLODError(int lod) const;
+    [[nodiscard]] float          getBoundingRadius() const;
 };
 
 //
@@ -1,10 +1,11 @@
 //
 // Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
 //
+#include <array>
+#include <cameracontroller.h>
 #include <cmath>
 #include <gamepad.h>
-#include <simd/geometry.h>
-#include <simd/quaternion.h>
+#include <matrix.h>
 #include <simd/vector_make.h>
 #include <simd/vector_types.h>
 #include <testloop.h>
@@ -12,12 +13,29 @@
 namespace TestLoop
 {
 
+namespace
+{
+CameraController cameraController{{{0.0f, 0.0f, -10.0f}, {0.0f, 0.0f, 10.0f}, {0.0f, 1.0f, 0.0f}}};
+// このフレームの Update でカメラを動かした(LateLatch で評価し直せる)
+bool cameraUpdated = false;
+
+//
+CameraController::Input
+makeCameraInput(const GamePad::PadState& pad)
+{
+    return {pad.leftX, pad.leftY, pad.rightX};
+}
+
+} // namespace
+
 //
 //
 //
 void
 Update(Context& context)
 {
+    context.SetDrawColor(0.0f, 0.2f, 0.0f, 0.5f);
+    context.FillRect2D({100, 100}, {600, 300});
     context.SetDrawColor(0.0f, 1.0f, 0.0f, 1.0f);
     context.DrawRect2D({100, 100}, {600, 300});
     context.SetDrawColor(1.0f, 1.0f, 1.0f);
@@ -26,29 +44,11 @@ Update(Context& context)
     context.Print(150, 80, "TestLoop");
 
     GamePad::PadState padState;
-    if (GamePad::GetPadState(0, padState))
+    cameraUpdated = GamePad::GetPadState(0, padState);
+    if (cameraUpdated)
     {
-        static simd::float3 eye{0.0f, 0.0f, -10.0f};
-        static simd::float3 tgt{0.0f, 0.0f, 10.0f};
-        static simd::float3 upv{0.0f, 1.0f, 0.0f};
-
-        auto tvec = tgt - eye;
-        auto len  = simd_length(tvec);
-        tvec      = simd_normalize(tvec);
-
-        auto rad  = padState.rightX * M_PI / 200.0f;
-        auto rotY = simd_quaternion(rad, upv);
-        tvec      = simd_act(rotY, tvec);
-
-        auto sideV = simd_normalize(simd::cross(upv, tvec));
-        eye -= sideV * padState.leftX * 0.2f;
-        eye += tvec * padState.leftY * 0.2f;
-        tvec *= len;
-        tgt = eye + tvec;
-
-        auto& cam = context.GetCamera();
-        cam.setEyePosition(eye);
-        cam.setTargetPosition(tgt);
+        cameraController.update(makeCameraInput(padState));
+        cameraController.apply(context.GetCamera());
     }
     else
     {
@@ -84,28 +84,71 @@ Update(Context& context)
     // 縦回転する線
     auto lx = simd_make_float3(-15, 0, 0);
     auto rx = simd_make_float3(15, 0, 0);
-    context.SetDrawColor(1.0f, 0.8f, 0.0f);
+    std::array<simd::float3, 8> lines;
     for (int i = 0; i < 4; i++)
     {
-        auto p1 = lx + rotPosYZ[i];
-        auto p2 = rx + rotPosYZ[i];
-        context.DrawLine3D(p1, p2);
+        lines[i * 2 + 0] = lx + rotPosYZ[i];
+        lines[i * 2 + 1] = rx + rotPosYZ[i];
     }
+    context.SetDrawColor(1.0f, 0.8f, 0.0f);
+    context.DrawLines3D(lines.data(), lines.size());
     // 線の蓋になる左右の四角形
     context.SetDrawColor(1.0f, 0.0f, 0.0f);
     auto drawSquare = [&](simd::float3 xv)
     {
         auto& pos = rotPosYZ;
-        context.DrawRect3D(pos[0] + xv, pos[1] + xv, pos[2] + xv, pos[3] + xv);
+        context.PushTransform(math::makeTranslate(xv));
+        context.DrawRect3D(pos[0], pos[1], pos[2], pos[3]);
+        context.PopTransform();
     };
     drawSquare(lx);
     drawSquare(rx);
 
-    // 回転する床
-    context.SetDrawColor(0.0f, 0.2f, 0.3f);
-    std::array<simd::float3, 4> rotPosXZ;
-    buildRotPos([&](int i, float s, float c) { rotPosXZ[i] = simd_make_float3(s, -0.5f, c) * 20.0f; });
-    context.DrawPlane3D(rotPosXZ[0], rotPosXZ[1], rotPosXZ[2], rotPosXZ[3]);
+    // 重なった半透明の板(奥から順に並べ替えて描く)
+    context.SetTranslucentSort3D(true);
+    for (int i = 0; i < 3; i++)
+    {
+        const float z = float(i) * 2.0f - 2.0f;
+        context.SetDrawColor(float(i == 0), float(i == 1), float(i == 2), 0.4f);
+        context.DrawPlane3D({-2.0f, 1.0f, z}, {2.0f, 1.0f, z}, {2.0f, 4.0f, z}, {-2.0f, 4.0f, z});
+    }
+
+    // 原点の座標軸
+    context.DrawAxes3D(math::makeIdentity(), 3.0f);
+
+    // 回転する床(最初に1度だけ作って、回転は行列で与える)
+    static Context::GeometryHandle floor = 0;
+    if (floor == 0)
+    {
+        floor = context.CreateGeometry();
+        context.BeginGeometry(floor);
+        context.SetDrawColor(0.0f, 0.2f, 0.3f);
+        std::array<simd::float3, 4> posXZ;
+        for (int i = 0; i < 4; i++)
+        {
+            float rad = i * M_PI * 0.5f;
+            posXZ[i]  = simd_make_float3(sinf(rad), -0.5f, cosf(rad)) * 20.0f;
+        }
+        context.DrawPlane3D(posXZ[0], posXZ[1], posXZ[2], posXZ[3]);
+        context.EndGeometry();
+    }
+    context.DrawGeometry(floor, math::makeYRotate(rotRad[0]));
+}
+
+//
+// Update で使った入力を読み直した入力に置き換えて、同じフレームのカメラを作り直す
+//
+bool
+LateLatch(CameraInterface& camera)
+{
+    GamePad::PadState padState;
+    if (!cameraUpdated || !GamePad::GetLatestPadState(0, padState))
+    {
+        return false;
+    }
+    cameraController.relatch(makeCameraInput(padState));
+    cameraController.apply(camera);
+    return true;
 }
 
 } // namespace TestLoop
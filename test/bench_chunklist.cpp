@@ -0,0 +1,115 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// ChunkList への追加の時間(1k から 10M プリミティブまで)
+// 再確保とコピーが無いので1個あたりはほぼ一定(大きい所はキャッシュに乗らない分だけ増える)
+// 比較に std::vector (reserve 無し) への push_back も測る
+//   bench_chunklist [max]
+//
+#include "check.h"
+#include "chunklist.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Prim3DList::Vertex と同じ大きさ
+struct Vertex
+{
+    float    position[3];
+    uint32_t color;
+};
+
+using List = ChunkList<Vertex, 4096>;
+
+//
+Vertex
+makeVertex(size_t i)
+{
+    const float f = float(i);
+    return {{f, f * 0.5f, -f}, uint32_t(i)};
+}
+
+//
+double
+perItemNs(double ms, size_t count)
+{
+    return ms * 1e6 / double(count);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t maxCount = argc > 1 ? size_t(std::atol(argv[1])) : 10000000;
+
+    std::printf("%10s %14s %14s %14s %14s\n", "count", "first ns/item", "reuse ns/item", "append ns/item",
+                "vector ns/item");
+    double minReuse = 1e30;
+    double maxReuse = 0.0;
+    for (size_t count = 1000; count <= maxCount; count *= 10)
+    {
+        // 10M でも合計が同じくらいの時間になるように回数を決める
+        const int reps = int(std::max<size_t>(3, 10000000 / count));
+
+        // clear してから count 個
+        const auto fill = [count](List& list)
+        {
+            list.clear();
+            for (size_t i = 0; i < count; i++)
+            {
+                list.push_back(makeVertex(i));
+            }
+        };
+        // チャンク毎にまとめて確保
+        const auto fillBulk = [count](List& list)
+        {
+            list.clear();
+            for (size_t done = 0; done < count;)
+            {
+                size_t got;
+                auto*  dst = list.append(count - done, got);
+                for (size_t i = 0; i < got; i++)
+                {
+                    dst[i] = makeVertex(done + i);
+                }
+                done += got;
+            }
+        };
+        // 毎回作り直す std::vector (再確保とコピーが起きる)
+        const auto fillVector = [count]
+        {
+            std::vector<Vertex> v;
+            for (size_t i = 0; i < count; i++)
+            {
+                v.push_back(makeVertex(i));
+            }
+            CHECK(v.size() == count);
+        };
+
+        // 初回(チャンクの確保込み)
+        double first = 1e30;
+        for (int r = 0; r < std::min(reps, 5); r++)
+        {
+            List fresh;
+            first = std::min(first, Bench::measureMs(1, [&] { fill(fresh); }));
+        }
+        // clear して再利用する毎フレームの使い方
+        List         list;
+        const double reuse = Bench::measureMs(reps, [&] { fill(list); });
+        CHECK(list.size() == count && list[count - 1].color == uint32_t(count - 1));
+        const double bulk = Bench::measureMs(reps, [&] { fillBulk(list); });
+        CHECK(list.size() == count && list[count - 1].color == uint32_t(count - 1));
+        const double vec = Bench::measureMs(std::min(reps, 5), fillVector);
+
+        std::printf("%10zu %14.2f %14.2f %14.2f %14.2f\n", count, perItemNs(first, count), perItemNs(reuse, count),
+                    perItemNs(bulk, count), perItemNs(vec, count));
+        minReuse = std::min(minReuse, perItemNs(reuse, count));
+        maxReuse = std::max(maxReuse, perItemNs(reuse, count));
+    }
+    std::printf("reuse: max/min %.2f\n", maxReuse / minReuse);
+    return 0;
+}
+
+//
@@ -0,0 +1,111 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// デバッグ形状の記録の時間と転送量
+// Prim3DList の drawBox/drawSphere/drawArrow/drawAxes (52 バイトのインスタンス)と、
+// 同じ箱を線で展開して drawLines で積む場合の比較
+//   bench_debugshape [count]
+//
+#include "check.h"
+#include "prim3dlist.h"
+#include <matrix.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+//
+void
+report(const char* name, double ms, size_t count, size_t bytes)
+{
+    std::printf("%-28s %8.3f ms %6.2f ns/shape %8.1f bytes/shape\n", name, ms, ms * 1e6 / double(count),
+                double(bytes) / double(count));
+}
+
+// 箱の 12 辺を線リストにする
+void
+boxLines(simd::float3 c, simd::float3 s, simd::float3* out)
+{
+    simd::float3 v[8];
+    for (int i = 0; i < 8; i++)
+    {
+        v[i] = c + simd_make_float3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f) * s;
+    }
+    for (int axis = 1; axis < 8; axis <<= 1)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            if ((i & axis) == 0)
+            {
+                *out++ = v[i];
+                *out++ = v[i | axis];
+            }
+        }
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 100000;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> unit(-50.0f, 50.0f);
+    std::vector<simd::float3>             centers(count);
+    std::vector<simd::float3>             ends(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        centers[i] = simd_make_float3(unit(rng), unit(rng), unit(rng));
+        ends[i]    = centers[i] + simd_make_float3(unit(rng), unit(rng), unit(rng)) * 0.1f;
+    }
+    const auto size   = simd_make_float3(1.0f, 2.0f, 0.5f);
+    const auto parent = simd_mul(math::makeTranslate(simd_make_float3(0, 0, -20)), math::makeYRotate(0.5f));
+    const int  reps   = 10;
+
+    std::printf("%zu shapes\n", count);
+    Prim3DList list;
+    // 1 フレーム分: clear して count 個を積み、変換まで済ませる
+    const auto record = [&](const char* name, bool transformed, auto&& draw)
+    {
+        const auto frame = [&]
+        {
+            list.clear();
+            list.setTransform(transformed ? parent : math::makeIdentity());
+            for (size_t i = 0; i < count; i++)
+            {
+                draw(i);
+            }
+            list.flushTransform();
+        };
+        const double ms = Bench::measureMs(reps, frame);
+        report(name, ms, count, list.getImmediateBytes());
+    };
+    record("box", false, [&](size_t i) { list.drawBox(centers[i], size); });
+    CHECK(list.getShapes(DebugShape::Shape::Box).size() == count);
+    record("box (transform)", true, [&](size_t i) { list.drawBox(centers[i], size); });
+    record("sphere", false, [&](size_t i) { list.drawSphere(centers[i], 0.5f); });
+    record("arrow", false, [&](size_t i) { list.drawArrow(centers[i], ends[i]); });
+    record("axes", false, [&](size_t i) { list.drawAxes(math::makeTranslate(centers[i]), 1.0f); });
+    CHECK(list.getImmediateBytes() == count * sizeof(DebugShape::Instance));
+
+    // 箱を 12 本の線で積む(24 頂点 + 24 インデックス)
+    simd::float3 lines[24];
+    record("box as drawLines", false,
+           [&](size_t i)
+           {
+               boxLines(centers[i], size, lines);
+               list.drawLines(lines, 24, nullptr);
+           });
+    record("box as drawLines (transform)", true,
+           [&](size_t i)
+           {
+               boxLines(centers[i], size, lines);
+               list.drawLines(lines, 24, nullptr);
+           });
+    CHECK(list.getLines().getVertexCount() == count * 24);
+    return 0;
+}
+
+//
@@ -0,0 +1,160 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// インスタンスデータを書く時間と量(128 バイトの行列のレイアウトと 32 バイトの CompactInstanceData)
+//   bench_instancepack [count]
+//
+#include "check.h"
+#include "instancepack.h"
+#include "packing.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+// shader_types::InstanceData と同じ大きさと並び(float4x4、float3x3、float4)
+struct InstanceData
+{
+    float transform[16];
+    float normalTransform[12]; // float3 x 3 (各列 16 バイト)
+    float color[4];
+};
+static_assert(sizeof(InstanceData) == 128);
+
+// 四元数、移動、拡大から行列を作る(renderer の行列パスと同じ量の計算)
+void
+buildMatrix(const float* q, const float* t, const float* s, const float* color, InstanceData& out)
+{
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    const float r[9] = {1 - 2 * (y * y + z * z), 2 * (x * y + z * w),     2 * (x * z - y * w),
+                        2 * (x * y - z * w),     1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+                        2 * (x * z + y * w),     2 * (y * z - x * w),     1 - 2 * (x * x + y * y)};
+    for (int c = 0; c < 3; c++)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            out.transform[c * 4 + e]       = r[c * 3 + e] * s[c];
+            out.normalTransform[c * 4 + e] = r[c * 3 + e] / s[c];
+        }
+        out.transform[c * 4 + 3]       = 0.0f;
+        out.normalTransform[c * 4 + 3] = 0.0f;
+    }
+    std::memcpy(&out.transform[12], t, sizeof(float) * 3);
+    out.transform[15] = 1.0f;
+    std::memcpy(out.color, color, sizeof(out.color));
+}
+
+// 要素毎に変換する書き方(以前の InstancePack::pack と同じ)
+void
+packScalar(const float* rotation, const float* translation, const float* scale, const float* color, const uint32_t* order,
+           size_t count, CompactInstanceData* dst)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t src = order[i];
+        auto&        out = dst[i];
+        for (int e = 0; e < 4; e++)
+        {
+            out.rotation[e] = Packing::packSNorm16(rotation[src * 4 + e]);
+        }
+        const float* c = &color[src * 4];
+        out.color      = Packing::packUNorm4x8(c[0], c[1], c[2], c[3]);
+        std::memcpy(out.translation, &translation[src * 4], sizeof(out.translation));
+        for (int e = 0; e < 3; e++)
+        {
+            out.scale[e] = Packing::packHalf(scale[src * 4 + e]);
+        }
+        out.padding = 0;
+    }
+}
+
+//
+void
+report(const char* name, double ms, size_t count, size_t bytes)
+{
+    std::printf("%-34s %8.3f ms %6.2f ns/instance %7.2f MB/frame\n", name, ms, ms * 1e6 / double(count),
+                double(bytes) / (1024.0 * 1024.0));
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 100000;
+
+    std::vector<float>                    rotation(count * 4), translation(count * 4), scale(count * 4), color(count * 4);
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = 0; i < count * 4; i++)
+    {
+        rotation[i]    = unit(rng) * 0.5f;
+        translation[i] = unit(rng) * 100.0f;
+        scale[i]       = 1.0f + unit(rng) * 0.5f;
+        color[i]       = unit(rng) * 0.5f + 0.5f;
+    }
+    // LOD 毎にまとめた順(4 段に振り分ける)
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t lod = 0; lod < 4; lod++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if ((i * 2654435761u >> 7) % 4 == lod)
+            {
+                order.push_back(uint32_t(i));
+            }
+        }
+    }
+
+    std::vector<InstanceData>        scratch(count);
+    std::vector<InstanceData>        full(count);
+    std::vector<CompactInstanceData> compact(count);
+    std::vector<CompactInstanceData> reference(count);
+    const int                        reps = 20;
+
+    std::printf("%zu instances\n", count);
+    const double build = Bench::measureMs(reps,
+                                          [&]
+                                          {
+                                              for (size_t i = 0; i < count; i++)
+                                              {
+                                                  buildMatrix(&rotation[i * 4], &translation[i * 4], &scale[i * 4],
+                                                              &color[i * 4], scratch[i]);
+                                              }
+                                              for (size_t i = 0; i < count; i++)
+                                              {
+                                                  full[i] = scratch[order[i]];
+                                              }
+                                          });
+    report("128 bytes: build matrices + copy", build, count, count * sizeof(InstanceData));
+    const double copy = Bench::measureMs(reps,
+                                         [&]
+                                         {
+                                             for (size_t i = 0; i < count; i++)
+                                             {
+                                                 full[i] = scratch[order[i]];
+                                             }
+                                         });
+    report("128 bytes: copy only", copy, count, count * sizeof(InstanceData));
+    const double scalar = Bench::measureMs(reps,
+                                           [&]
+                                           {
+                                               packScalar(rotation.data(), translation.data(), scale.data(), color.data(),
+                                                          order.data(), count, reference.data());
+                                           });
+    report("32 bytes: per-element pack", scalar, count, count * sizeof(CompactInstanceData));
+    const double packed = Bench::measureMs(reps,
+                                           [&]
+                                           {
+                                               InstancePack::pack(rotation.data(), translation.data(), scale.data(),
+                                                                  color.data(), order.data(), count, compact.data());
+                                           });
+    report("32 bytes: InstancePack::pack", packed, count, count * sizeof(CompactInstanceData));
+
+    CHECK(std::memcmp(compact.data(), reference.data(), count * sizeof(CompactInstanceData)) == 0);
+    return 0;
+}
+
+//
@@ -0,0 +1,88 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 入力のサンプルから表示までの時間を仮想の時計で測る(CameraController::relatch の効果)
+// 入力は 1ms 毎、フレームは 60Hz の vsync で始まり、CPU の処理が終わったら commit して次の vsync で表示する
+// 表示された状態から使われたサンプルの時刻を逆算する(GPU の時間は入れていない)
+//   bench_latelatch [frames]
+//
+#include "check.h"
+#include <algorithm>
+#include <cameracontroller.h>
+
+namespace
+{
+constexpr double VsyncMs = 1000.0 / 60.0;
+
+// 原点から +Z を向く(進んだ量の誤差を小さくするため)
+const CameraController::State Start{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 20.0f}, {0.0f, 1.0f, 0.0f}};
+
+// 時刻 nowMs に読める最新のサンプル(前に進む量に時刻を入れておく)
+CameraController::Input
+sample(double nowMs, double periodMs)
+{
+    const double time = std::floor(nowMs / periodMs) * periodMs;
+    return {0.0f, float(time / 1000.0), 0.0f};
+}
+
+// 1フレームで進んだ量から、使われたサンプルの時刻を戻す(サンプルは 1ms 毎なので丸める)
+double
+sampleTime(const CameraController::State& state)
+{
+    const double time = double(state.eye.z) / CameraController::MoveSpeed * 1000.0;
+    CHECK_NEAR(time, std::round(time), 0.01);
+    return std::round(time);
+}
+
+//
+struct Latency
+{
+    double average;
+    double max;
+};
+
+//
+Latency
+run(int frames, double cpuMs, bool lateLatch)
+{
+    double total = 0.0;
+    double max   = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // 毎フレーム同じ位置から始めて、進んだ量だけを見る
+        CameraController controller{Start};
+        const double     start  = frame * VsyncMs;
+        const double     commit = start + cpuMs;
+        controller.update(sample(start, 1.0));
+        if (lateLatch)
+        {
+            controller.relatch(sample(commit, 1.0));
+        }
+        const double photon  = std::ceil(commit / VsyncMs) * VsyncMs;
+        const double used    = sampleTime(controller.getState());
+        const double latency = photon - used;
+        CHECK(used <= commit);
+        total += latency;
+        max = std::max(max, latency);
+    }
+    return {total / frames, max};
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 60;
+    std::printf("sample to photon, %d frames at 60Hz, 1ms input (average / max ms)\n", frames);
+    std::printf("%-8s %18s %18s\n", "cpu", "update only", "late latch");
+    for (double cpuMs : {2.0, 6.0, 10.0, 14.0})
+    {
+        const auto early = run(frames, cpuMs, false);
+        const auto late  = run(frames, cpuMs, true);
+        std::printf("%5.1f ms %9.2f / %5.2f %9.2f / %5.2f\n", cpuMs, early.average, early.max, late.average, late.max);
+    }
+    return 0;
+}
+
+//
@@ -0,0 +1,70 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// UV 球の LOD チェーンを作る時間と誤差
+//   bench_meshsimplify
+//
+#include "check.h"
+#include "meshsimplify.h"
+#include "primitivemesh.h"
+#include <algorithm>
+
+namespace
+{
+//
+template <size_t Slices, size_t Stacks>
+void
+run(float maxError)
+{
+    static const auto sphere = PrimitiveMesh::makeSphere<Slices, Stacks>();
+
+    MeshSimplify::VertexStream vs;
+    vs.position = sphere.vertices[0].position;
+    vs.normal   = sphere.vertices[0].normal;
+    vs.texcoord = sphere.vertices[0].texcoord;
+    vs.stride   = sizeof(PrimitiveMesh::MeshVertex);
+    vs.count    = sphere.vertices.size();
+
+    MeshSimplify::Option opt;
+    opt.maxError = maxError;
+
+    const std::vector<uint16_t> src(sphere.indices.begin(), sphere.indices.end());
+    std::vector<uint16_t>       result;
+    float                       error = 0.0f;
+    const double                ms    = Bench::measureMs(5, [&] { error = MeshSimplify::simplify(vs, src, result, opt); });
+
+    // 面の重心が球面からどれだけ沈んだか(形の誤差の目安)
+    double depth = 0.0;
+    for (size_t t = 0; t < result.size(); t += 3)
+    {
+        double c[3] = {};
+        for (int k = 0; k < 3; k++)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                c[e] += sphere.vertices[result[t + k]].position[e] / 3.0;
+            }
+        }
+        depth = std::max(depth, 0.5 - std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]));
+    }
+    const size_t tris = src.size() / 3;
+    std::printf("sphere %3zux%-3zu maxError %.2f: %6zu -> %6zu triangles %8.2f ms (%5.2f Mtri/s) error %.4f depth %.4f\n",
+                Slices, Stacks, maxError, tris, result.size() / 3, ms, double(tris) / ms / 1000.0, error, depth);
+}
+
+} // namespace
+
+int
+main()
+{
+    for (float maxError : {0.02f, 0.1f})
+    {
+        run<32, 16>(maxError);
+        run<64, 32>(maxError);
+        run<128, 64>(maxError);
+        run<256, 128>(maxError);
+    }
+    return 0;
+}
+
+//
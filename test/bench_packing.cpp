@@ -0,0 +1,143 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// Compact 頂点のエンコードの時間と転送量(48 バイトの VertexData と 16 バイトの CompactVertexData)
+//   bench_packing [count]
+//
+#include "check.h"
+#include "packing.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+// vertex.cpp の VertexData と同じ大きさと並び(simd::float3 は 16 バイト)
+struct alignas(16) VertexData
+{
+    float position[4];
+    float normal[4];
+    float texcoord[2];
+};
+static_assert(sizeof(VertexData) == 48);
+
+// vertex.cpp の CompactVertexData と同じ
+struct CompactVertexData
+{
+    uint16_t position[4];
+    int16_t  normal[2];
+    uint16_t texcoord[2];
+};
+static_assert(sizeof(CompactVertexData) == 16);
+
+// Vertex::Impl::compress と同じ順に詰める(誤差の記録は除く)
+void
+encode(const VertexData* src, size_t count, const float (&origin)[3], const float (&extent)[3], CompactVertexData* dst)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto& vd = src[i];
+        auto&       cv = dst[i];
+        for (int e = 0; e < 3; e++)
+        {
+            cv.position[e] = Packing::packPosition(vd.position[e], origin[e], extent[e]);
+        }
+        cv.position[3] = 0;
+        Packing::packOctNormal(vd.normal[0], vd.normal[1], vd.normal[2], cv.normal);
+        cv.texcoord[0] = Packing::packHalf(vd.texcoord[0]);
+        cv.texcoord[1] = Packing::packHalf(vd.texcoord[1]);
+    }
+}
+
+//
+void
+report(const char* name, double ms, size_t count, size_t bytes)
+{
+    std::printf("%-26s %8.3f ms %6.2f ns/vertex %7.2f MB %7.2f GB/s\n", name, ms, ms * 1e6 / double(count),
+                double(bytes) / (1024.0 * 1024.0), double(bytes) / (ms * 1e6));
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 1000000;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<VertexData>               vertices(count);
+    float                                 bmin[3] = {1e30f, 1e30f, 1e30f};
+    float                                 bmax[3] = {-1e30f, -1e30f, -1e30f};
+    for (auto& vd : vertices)
+    {
+        float n[3] = {unit(rng), unit(rng), unit(rng) + 0.01f};
+        float l    = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int e = 0; e < 3; e++)
+        {
+            vd.position[e] = unit(rng) * 20.0f + float(e);
+            vd.normal[e]   = n[e] / l;
+            bmin[e]        = std::min(bmin[e], vd.position[e]);
+            bmax[e]        = std::max(bmax[e], vd.position[e]);
+        }
+        vd.texcoord[0] = unit(rng) * 0.5f + 0.5f;
+        vd.texcoord[1] = unit(rng) * 0.5f + 0.5f;
+    }
+    float extent[3];
+    for (int e = 0; e < 3; e++)
+    {
+        extent[e] = bmax[e] - bmin[e];
+    }
+
+    std::vector<VertexData>        upload(count);
+    std::vector<CompactVertexData> compact(count);
+    std::vector<CompactVertexData> compactUpload(count);
+    const int                      reps = 20;
+
+    std::printf("%zu vertices\n", count);
+    // アップロード(バッファへの memcpy)は頂点の大きさに比例する
+    const double copyStandard =
+        Bench::measureMs(reps, [&] { std::memcpy(upload.data(), vertices.data(), count * sizeof(VertexData)); });
+    report("48 bytes: upload", copyStandard, count, count * sizeof(VertexData));
+    const double packMs = Bench::measureMs(reps, [&] { encode(vertices.data(), count, bmin, extent, compact.data()); });
+    report("16 bytes: encode", packMs, count, count * sizeof(CompactVertexData));
+    const double copyCompact = Bench::measureMs(
+        reps, [&] { std::memcpy(compactUpload.data(), compact.data(), count * sizeof(CompactVertexData)); });
+    report("16 bytes: upload", copyCompact, count, count * sizeof(CompactVertexData));
+
+    // 誤差(Vertex::getPackInfo と同じ量)
+    double posError = 0.0;
+    double nrmError = 0.0;
+    double uvError  = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto& vd = vertices[i];
+        const auto& cv = compact[i];
+        for (int e = 0; e < 3; e++)
+        {
+            const float decoded = Packing::unpackPosition(cv.position[e], bmin[e], extent[e]);
+            posError            = std::max(posError, double(std::abs(decoded - vd.position[e])));
+        }
+        float n[3];
+        Packing::unpackOctNormal(cv.normal, n);
+        // acos は 1 の近くで丸めを拡大するので atan2(|a x b|, a . b) で測る(test_packing と同じ)
+        const double cx = double(vd.normal[1]) * n[2] - double(vd.normal[2]) * n[1];
+        const double cy = double(vd.normal[2]) * n[0] - double(vd.normal[0]) * n[2];
+        const double cz = double(vd.normal[0]) * n[1] - double(vd.normal[1]) * n[0];
+        const double c  = double(vd.normal[0]) * n[0] + double(vd.normal[1]) * n[1] + double(vd.normal[2]) * n[2];
+        nrmError        = std::max(nrmError, std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), c) * 180.0 / M_PI);
+        for (int e = 0; e < 2; e++)
+        {
+            uvError = std::max(uvError, double(std::abs(Packing::unpackHalf(cv.texcoord[e]) - vd.texcoord[e])));
+        }
+    }
+    std::printf("max error: position %.3g (extent %.1f) normal %.4f deg texcoord %.3g\n", posError,
+                std::max({extent[0], extent[1], extent[2]}), nrmError, uvError);
+    CHECK(posError <= std::max({extent[0], extent[1], extent[2]}) / 131070.0 * 1.01);
+    CHECK(nrmError < 0.01);
+    CHECK(uvError <= std::ldexp(1.0, -12));
+    return 0;
+}
+
+//
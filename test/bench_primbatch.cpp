@@ -0,0 +1,150 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// PrimBatch への1頂点ずつの追加と、配列でまとめた追加の比較
+// (PrimBatch 直接と、Simple3D と同じ Prim3DList の drawLine/drawLines、drawTriangle/drawTriangles)
+//   bench_primbatch [count]
+//
+#include "check.h"
+#include "prim3dlist.h"
+#include "primbatch.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+using Vertex = Prim3DList::Vertex;
+
+//
+void
+report(const char* name, double ms, size_t count)
+{
+    std::printf("%-34s %8.3f ms %6.2f ns/vertex\n", name, ms, ms * 1e6 / double(count));
+}
+
+// 2つのバッチの頂点とインデックスが同じ
+bool
+sameContents(const Prim3DList::Batch& a, const Prim3DList::Batch& b)
+{
+    if (a.getBytes() != b.getBytes())
+    {
+        return false;
+    }
+    std::vector<uint8_t> da(a.getBytes());
+    std::vector<uint8_t> db(b.getBytes());
+    a.copyTo(da.data());
+    b.copyTo(db.data());
+    return da == db;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    // 線にも三角形にも割り切れるように 6 の倍数
+    const size_t count = (argc > 1 ? size_t(std::atol(argv[1])) : 1200000) / 6 * 6;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> unit(-10.0f, 10.0f);
+    std::vector<simd::float3>             points(count);
+    std::vector<simd::float4>             colors(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        points[i] = simd_make_float3(unit(rng), unit(rng), unit(rng));
+        colors[i] = simd_make_float4(0.5f, 0.25f, 1.0f, 1.0f);
+    }
+    const int reps = 10;
+
+    std::printf("%zu vertices\n", count);
+
+    // PrimBatch 直接: addVertex/addIndex と appendVertices/appendIndices
+    Prim3DList::Batch perVertex;
+    Prim3DList::Batch bulk;
+    auto              addEach = [&]
+    {
+        perVertex.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto& p = points[i];
+            perVertex.addVertex({{p.x, p.y, p.z}, 0xffffffff});
+            perVertex.addIndex(uint32_t(i));
+        }
+    };
+    auto appendAll = [&]
+    {
+        bulk.clear();
+        bulk.appendVertices(count,
+                            [&](Vertex* dst, size_t first, size_t n)
+                            {
+                                for (size_t i = 0; i < n; i++)
+                                {
+                                    const auto& p = points[first + i];
+                                    dst[i]        = {{p.x, p.y, p.z}, 0xffffffff};
+                                }
+                            });
+        bulk.appendIndices(count,
+                           [&](uint32_t* dst, size_t first, size_t n)
+                           {
+                               for (size_t i = 0; i < n; i++)
+                               {
+                                   dst[i] = uint32_t(first + i);
+                               }
+                           });
+    };
+    report("PrimBatch addVertex/addIndex", Bench::measureMs(reps, addEach), count);
+    report("PrimBatch appendVertices/Indices", Bench::measureMs(reps, appendAll), count);
+    CHECK(sameContents(perVertex, bulk));
+
+    // Prim3DList (Simple3D の CPU 側): 1本ずつと配列
+    Prim3DList perCall;
+    Prim3DList arrays;
+    auto       drawLineEach = [&]
+    {
+        perCall.clear();
+        for (size_t i = 0; i < count; i += 2)
+        {
+            perCall.drawLine(points[i], points[i + 1]);
+        }
+    };
+    auto drawTriangleEach = [&]
+    {
+        perCall.clear();
+        for (size_t i = 0; i < count; i += 3)
+        {
+            perCall.drawTriangle(points[i], points[i + 1], points[i + 2]);
+        }
+    };
+    auto drawLinesAll = [&](const simd::float4* lineColors)
+    {
+        arrays.clear();
+        arrays.drawLines(points.data(), count, lineColors);
+    };
+    auto drawTrianglesAll = [&]
+    {
+        arrays.clear();
+        arrays.drawTriangles(points.data(), count, nullptr);
+    };
+    report("Prim3DList drawLine", Bench::measureMs(reps, drawLineEach), count);
+    report("Prim3DList drawLines", Bench::measureMs(reps, [&] { drawLinesAll(nullptr); }), count);
+    CHECK(sameContents(perCall.getLines(), arrays.getLines()));
+    report("Prim3DList drawLines (colors)", Bench::measureMs(reps, [&] { drawLinesAll(colors.data()); }), count);
+    report("Prim3DList drawTriangle", Bench::measureMs(reps, drawTriangleEach), count);
+    report("Prim3DList drawTriangles", Bench::measureMs(reps, drawTrianglesAll), count);
+    CHECK(sameContents(perCall.getTriangles(), arrays.getTriangles()));
+
+    // 行列付き: 追加した後にまとめて変換する
+    const auto transform = simd_matrix(simd_make_float4(0, 1, 0, 0), simd_make_float4(-1, 0, 0, 0),
+                                       simd_make_float4(0, 0, 1, 0), simd_make_float4(1, 2, 3, 1));
+    auto       drawMoved = [&]
+    {
+        arrays.clear();
+        arrays.setTransform(transform);
+        arrays.drawLines(points.data(), count, nullptr);
+        arrays.flushTransform();
+    };
+    report("Prim3DList drawLines (transform)", Bench::measureMs(reps, drawMoved), count);
+    return 0;
+}
+
+//
@@ -0,0 +1,72 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 32bit キー + 32bit 値の並べ替えの時間(std::sort、RadixSort::sort、RadixSort::sortParallel をスレッド数毎)
+//   bench_radixsort [count]
+//
+#include "check.h"
+#include "radixsort.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+int
+main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 1000000;
+
+    std::mt19937          rng{1};
+    std::vector<uint32_t> sourceKeys(count);
+    for (auto& k : sourceKeys)
+    {
+        k = rng() >> 8; // Simple3D の深度キーと同じ 24bit
+    }
+
+    std::vector<uint32_t> keys(count);
+    std::vector<uint32_t> values(count);
+    std::vector<uint32_t> tmpKeys(count);
+    std::vector<uint32_t> tmpValues(count);
+    std::vector<uint64_t> pairs(count);
+
+    auto reset = [&]
+    {
+        std::copy(sourceKeys.begin(), sourceKeys.end(), keys.begin());
+        for (size_t i = 0; i < count; i++)
+        {
+            values[i] = uint32_t(i);
+        }
+    };
+    auto runStd = [&]
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pairs[i] = uint64_t(sourceKeys[i]) << 32 | i;
+        }
+        std::sort(pairs.begin(), pairs.end());
+    };
+    auto runSort = [&]
+    {
+        reset();
+        RadixSort::sort(keys.data(), values.data(), count, tmpKeys.data(), tmpValues.data());
+    };
+    unsigned threads     = 1;
+    auto     runParallel = [&]
+    {
+        reset();
+        RadixSort::sortParallel(keys.data(), values.data(), count, tmpKeys.data(), tmpValues.data(), threads);
+    };
+
+    std::printf("%zu keys (reset %.3f ms included in radix)\n", count, Bench::measureMs(10, reset));
+    std::printf("%-26s %8.3f ms\n", "std::sort (key << 32 | i)", Bench::measureMs(10, runStd));
+    std::printf("%-26s %8.3f ms\n", "RadixSort::sort", Bench::measureMs(10, runSort));
+    CHECK(std::is_sorted(keys.begin(), keys.end()));
+    for (threads = 2; threads <= RadixSort::MaxThreads; threads *= 2)
+    {
+        const double ms = Bench::measureMs(10, runParallel);
+        CHECK(std::is_sorted(keys.begin(), keys.end()));
+        std::printf("sortParallel x%-12u %8.3f ms\n", threads, ms);
+    }
+    return 0;
+}
+
+//
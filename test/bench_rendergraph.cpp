@@ -0,0 +1,74 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 毎フレーム組み直すグラフの clear + 宣言 + compile の時間
+//   bench_rendergraph [passes]
+//
+#include "check.h"
+#include "rendergraph.h"
+#include <vector>
+
+namespace
+{
+//
+// パス i は2つ前までの出力を読んで1つ書く(4つ毎に読まれない出力があり、そのパスは消える)
+//
+void
+build(RenderGraph& graph, size_t passes, std::vector<RenderGraph::ResourceId>& outputs)
+{
+    graph.clear();
+    outputs.resize(passes);
+    const auto backbuffer = graph.importResource("backbuffer");
+    for (size_t i = 0; i < passes; i++)
+    {
+        const uint32_t size = 256u << (i % 3);
+        outputs[i]          = graph.createTransient("target", {size, size});
+        const auto pass     = graph.addPass("pass", nullptr, nullptr);
+        for (size_t back = 1; back <= 2 && back <= i; back++)
+        {
+            if ((i - back) % 4 != 3)
+            {
+                graph.read(pass, outputs[i - back]);
+            }
+        }
+        graph.write(pass, outputs[i]);
+    }
+    const auto present = graph.addPass("present", nullptr, nullptr);
+    graph.read(present, outputs[passes - 1]);
+    graph.write(present, backbuffer);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const size_t passes = argc > 1 ? size_t(std::atol(argv[1])) : 64;
+
+    RenderGraph                          graph;
+    std::vector<RenderGraph::ResourceId> outputs;
+    bool                                 ok = true;
+
+    auto compile = [&]
+    {
+        build(graph, passes, outputs);
+        ok &= graph.compile();
+    };
+    const double buildMs   = Bench::measureMs(100, [&] { build(graph, passes, outputs); });
+    const double compileMs = Bench::measureMs(100, compile);
+    CHECK(ok);
+
+    size_t culled = 0;
+    for (RenderGraph::PassId p = 0; p < graph.getPassCount(); p++)
+    {
+        culled += graph.isCulled(p) ? 1 : 0;
+    }
+    std::printf("%zu passes: %zu culled, %zu physical slots, %.1f MB of %.1f MB requested\n", passes + 1, culled,
+                graph.getPhysicalCount(), double(graph.getTransientBytes()) / (1024.0 * 1024.0),
+                double(graph.getRequestedBytes()) / (1024.0 * 1024.0));
+    std::printf("%-20s %8.4f ms\n", "clear + declare", buildMs);
+    std::printf("%-20s %8.4f ms\n", "... + compile", compileMs);
+    return 0;
+}
+
+//
@@ -0,0 +1,141 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// RenderQueue に毎フレーム積み直す描画の submit + sort + execute の時間
+// レイヤー 3 / パイプライン 8 / テクスチャ 64 / 1 割が半透明の描画をばらばらの順に積む
+// 比較に (key, 番号) を std::sort した場合も測る
+//   bench_renderqueue [count]
+//
+#include "check.h"
+#include "renderqueue.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+//
+struct Draw
+{
+    uint8_t  layer;
+    uint32_t pipeline;
+    uint32_t texture;
+    float    depth;
+    bool     translucent;
+};
+
+// 実行された順に param を残す
+struct Recorder
+{
+    std::vector<uint32_t> order;
+};
+
+void
+record(void* user, void*, uint32_t param)
+{
+    static_cast<Recorder*>(user)->order.push_back(param);
+}
+
+//
+void
+report(const char* name, double ms, size_t count)
+{
+    std::printf("%-22s %8.3f ms %6.2f ns/draw\n", name, ms, ms * 1e6 / double(count));
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 100000;
+
+    std::mt19937                          rng(1);
+    std::uniform_int_distribution<>       layer(0, 2);
+    std::uniform_int_distribution<>       pipeline(1, 8);
+    std::uniform_int_distribution<>       texture(0, 63);
+    std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+    std::vector<Draw>                     draws(count);
+    std::vector<uint64_t>                 keys(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        draws[i] = {uint8_t(layer(rng)), uint32_t(pipeline(rng)), uint32_t(texture(rng)), depth(rng), i % 10 == 0};
+    }
+
+    RenderQueue queue;
+    Recorder    recorder;
+    recorder.order.reserve(count);
+    const int reps = 10;
+
+    const auto submit = [&]
+    {
+        queue.clear();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto& d = draws[i];
+            keys[i]       = RenderQueue::makeKey(d.layer, d.pipeline, d.texture, d.depth, d.translucent);
+            queue.submit(keys[i], record, &recorder, i);
+        }
+    };
+    const auto sort = [&]
+    {
+        submit();
+        queue.sort();
+    };
+    const auto execute = [&]
+    {
+        recorder.order.clear();
+        queue.execute(nullptr);
+    };
+    const double submitMs  = Bench::measureMs(reps, submit);
+    const double sortMs    = Bench::measureMs(reps, sort);
+    const double executeMs = Bench::measureMs(reps, execute);
+
+    // キー順で、同じキーは積んだ順
+    CHECK(recorder.order.size() == count);
+    for (size_t i = 1; i < count; i++)
+    {
+        const uint32_t a = recorder.order[i - 1];
+        const uint32_t b = recorder.order[i];
+        CHECK(keys[a] < keys[b] || (keys[a] == keys[b] && a < b));
+    }
+    const size_t sortedChanges = queue.getStateChanges();
+
+    // 積んだ順のままなら何回切り替わるか
+    size_t   unsortedChanges = 0;
+    uint32_t state           = ~0u;
+    for (const auto& d : draws)
+    {
+        const uint32_t s = d.pipeline << 12 | d.texture;
+        unsortedChanges += s != state ? 1 : 0;
+        state = s;
+    }
+
+    // 比較: (key, 番号) を std::sort
+    std::vector<std::pair<uint64_t, uint32_t>> pairs(count);
+
+    const auto stdSort = [&]
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pairs[i] = {keys[i], i};
+        }
+        std::sort(pairs.begin(), pairs.end());
+    };
+    const double stdSortMs = Bench::measureMs(reps, stdSort);
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(pairs[i].second == recorder.order[i]);
+    }
+
+    std::printf("%zu draws: state changes %zu in submit order, %zu sorted\n", count, unsortedChanges, sortedChanges);
+    report("clear + submit", submitMs, count);
+    report("... + sort", sortMs, count);
+    report("sort only", sortMs - submitMs, count);
+    report("execute", executeMs, count);
+    report("std::sort (key, index)", stdSortMs, count);
+    return 0;
+}
+
+//
@@ -0,0 +1,169 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 更新と描画を1スレッドで順に行う場合と SimPipeline で並行させた場合のフレーム時間と遅延
+// 更新と描画(エンコード)の重さは sleep で与え、記録と再生は実際に行う(GPU は使わない)
+//   bench_simpipeline [update ms] [encode ms] [frames]
+//
+#include "check.h"
+#include "framerecorder.h"
+#include "logcontext.h"
+#include "simpipeline.h"
+#include <algorithm>
+#include <matrix.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr int MaxFrames = 1000;
+
+double                    updateMs    = 4.0;
+double                    encodeMs    = 6.0;
+int                       updateFrame = 0;
+Clock::time_point         updateStart[MaxFrames];
+std::vector<simd::float3> points(256);
+
+//
+void
+sleepMs(double ms)
+{
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+}
+
+// 記録される呼び出しは1フレーム 500 程
+void
+update(Context& context)
+{
+    const int frame    = updateFrame++;
+    updateStart[frame] = Clock::now();
+    sleepMs(updateMs);
+    for (int i = 0; i < 256; i++)
+    {
+        const float x = float(i % 16);
+        const float z = float(i / 16);
+        context.SetDrawColor(x / 16.0f, 0.5f, z / 16.0f);
+        context.DrawBox3D(simd::float3{x, float(frame % 8), z}, simd::float3{0.5f, 0.5f, 0.5f});
+    }
+    context.DrawLines3D(points.data(), points.size());
+    context.Printf(10.0f, 10.0f, "frame %d", frame);
+}
+
+//
+struct Result
+{
+    double frameMs;
+    double latencyMs;
+    double maxLatencyMs;
+    double waitMs;
+};
+
+// フレームの終わり(エンコードした後)までの遅延を集計する
+struct Latency
+{
+    double total = 0.0;
+    double max   = 0.0;
+
+    void add(int frame)
+    {
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - updateStart[frame]).count();
+        total += ms;
+        max = std::max(max, ms);
+    }
+};
+
+//
+Result
+runSerial(int frames)
+{
+    LogContext target;
+    target.keepLog = false;
+    Latency    latency;
+    updateFrame      = 0;
+    const auto start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        update(target);
+        sleepMs(encodeMs);
+        latency.add(frame);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return {ms / frames, latency.total / frames, latency.max, 0.0};
+}
+
+// 描画側は再生してエンコードが終わってからスロットを返す(main.cpp と同じ)
+Result
+runPipelined(int frames)
+{
+    LogContext target;
+    target.keepLog = false;
+    Latency     latency;
+    SimPipeline pipeline;
+    double      waitTotal = 0.0;
+    updateFrame           = 0;
+    pipeline.start(update);
+    const auto start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        pipeline.acquire().replay(target);
+        waitTotal += pipeline.getWaitMs();
+        sleepMs(encodeMs);
+        latency.add(frame);
+        pipeline.release();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    pipeline.stop();
+    return {ms / frames, latency.total / frames, latency.max, waitTotal / frames};
+}
+
+//
+void
+print(const char* name, const Result& r)
+{
+    std::printf("%-10s %7.2f ms/frame  latency avg %6.2f max %6.2f ms  wait %5.2f ms\n", name, r.frameMs, r.latencyMs,
+                r.maxLatencyMs, r.waitMs);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    updateMs         = argc > 1 ? std::atof(argv[1]) : 4.0;
+    encodeMs         = argc > 2 ? std::atof(argv[2]) : 6.0;
+    const int frames = argc > 3 ? std::clamp(std::atoi(argv[3]), 1, MaxFrames - SimPipeline::Depth - 1) : 120;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        points[i] = simd::float3{float(i), 0.0f, float(i % 7)};
+    }
+
+    // 記録と再生だけの重さ(sleep 無し)
+    const double saveUpdate = updateMs;
+    updateMs                = 0.0;
+    GeometryHandleMap handles;
+    FrameRecorder     recorder{handles};
+    LogContext        target;
+    target.keepLog = false;
+
+    auto recordOnly = [&]
+    {
+        recorder.clear();
+        updateFrame = 0;
+        update(recorder);
+    };
+    auto replayOnly = [&] { recorder.replay(target); };
+    const double recordMs = Bench::measureMs(200, recordOnly);
+    const double replayMs = Bench::measureMs(200, replayOnly);
+    updateMs              = saveUpdate;
+    std::printf("%zu commands %zu bytes: record %.4f ms replay %.4f ms\n", recorder.getCommandCount(), recorder.getBytes(),
+                recordMs, replayMs);
+
+    std::printf("update %.1f ms encode %.1f ms, %d frames\n", updateMs, encodeMs, frames);
+    print("serial", runSerial(frames));
+    print("pipelined", runPipelined(frames));
+    return 0;
+}
+
+//
@@ -0,0 +1,92 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// SpriteBatch の add (カリング + キー作成) と build (並べ替え + 頂点作成) の時間
+// レイヤー/テクスチャ/ブレンドが混ざった場合と、全て同じ場合
+//   bench_spritebatch [count]
+//
+#include "check.h"
+#include "spritebatch.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+// 中身は見ないので番号だけのテクスチャ
+constexpr int Textures = 64;
+char          textureStorage[Textures];
+
+MTL::Texture*
+texture(int i)
+{
+    return reinterpret_cast<MTL::Texture*>(&textureStorage[i]);
+}
+
+//
+struct Sprite
+{
+    SpriteBatch::Quad  quad;
+    MTL::Texture*      texture;
+    int16_t            layer;
+    SpriteBatch::Blend blend;
+};
+
+//
+void
+report(const char* name, double ms, size_t count)
+{
+    std::printf("%-24s %8.3f ms %6.2f ns/quad\n", name, ms, ms * 1e6 / double(count));
+}
+
+//
+void
+run(const char* name, const std::vector<Sprite>& sprites)
+{
+    SpriteBatch batch;
+    batch.setViewport(1920.0f, 1080.0f);
+    const int reps = 10;
+    auto      add  = [&]
+    {
+        batch.clear();
+        for (const auto& s : sprites)
+        {
+            batch.add(s.texture, s.quad, s.layer, s.blend);
+        }
+    };
+    const double addMs   = Bench::measureMs(reps, add);
+    const double buildMs = Bench::measureMs(reps, [&] { batch.build(); });
+    std::printf("%s: %zu quads, %zu culled, %zu runs\n", name, batch.getQuadCount(), batch.getCulledCount(),
+                batch.getRuns().size());
+    report("  add", addMs, sprites.size());
+    report("  build", buildMs, sprites.size());
+    CHECK(batch.getVertices().size() == batch.getQuadCount() * 4);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 100000;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> x(-100.0f, 2000.0f);
+    std::uniform_real_distribution<float> y(-100.0f, 1160.0f);
+    std::uniform_int_distribution<>       layer(-8, 8);
+    std::uniform_int_distribution<>       tex(0, Textures - 1);
+    std::vector<Sprite>                   mixed(count);
+    std::vector<Sprite>                   uniform(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const float             px   = x(rng);
+        const float             py   = y(rng);
+        const SpriteBatch::Quad quad = {px, py, px + 32.0f, py + 32.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0xffffffff};
+        mixed[i]                     = {quad, texture(tex(rng)), int16_t(layer(rng)), SpriteBatch::Blend(i & 1)};
+        uniform[i]                   = {quad, texture(0), 0, SpriteBatch::Blend::Alpha};
+    }
+    run("mixed (17 layers, 64 textures, 2 blends)", mixed);
+    run("uniform", uniform);
+    return 0;
+}
+
+//
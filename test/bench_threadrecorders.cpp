@@ -0,0 +1,101 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 同じ数の描画呼び出しを 1/2/4/8 スレッドに分けた時の時間
+// GetThreadContext(スレッド毎の記録)と、1つの記録をロックで共有した場合を比べる
+//   bench_threadrecorders [emits]
+//
+#include "check.h"
+#include "framerecorder.h"
+#include "logcontext.h"
+#include "threadrecorders.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+//
+void
+emit(Context& context, size_t i)
+{
+    const float x = float(i & 1023);
+    context.DrawLine3D(simd::float3{x, 0.0f, 0.0f}, simd::float3{x, 1.0f, 0.0f});
+}
+
+// count 回の呼び出しを threadCount 個のスレッドに分けて f(thread, first, last) を呼ぶ
+template <class F>
+void
+split(unsigned threadCount, size_t count, F&& f)
+{
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back(f, t, count * t / threadCount, count * (t + 1) / threadCount);
+    }
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 400000;
+
+    ThreadRecorders threads;
+    FrameRecorder   shared{nullptr};
+    std::mutex      mutex;
+    LogContext      target;
+    target.keepLog = false;
+
+    std::printf("%zu emits, %u hardware threads\n", count, std::thread::hardware_concurrency());
+    std::printf("%-8s %12s %12s %12s\n", "threads", "per-thread", "shared+lock", "merge");
+    for (unsigned threadCount : {1u, 2u, 4u, 8u})
+    {
+        auto perThread = [&](unsigned t, size_t first, size_t last)
+        {
+            auto& context = threads.get(t);
+            for (size_t i = first; i < last; i++)
+            {
+                emit(context, i);
+            }
+        };
+        auto locked = [&](unsigned, size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                std::lock_guard lock(mutex);
+                emit(shared, i);
+            }
+        };
+        auto runPerThread = [&]
+        {
+            threads.clear();
+            split(threadCount, count, perThread);
+        };
+        auto runLocked = [&]
+        {
+            shared.clear();
+            split(threadCount, count, locked);
+        };
+        auto merge = [&]
+        {
+            target.calls = 0;
+            threads.replay(target);
+        };
+        const double perThreadMs = Bench::measureMs(10, runPerThread);
+        const double mergeMs     = Bench::measureMs(10, merge);
+        const double lockedMs    = Bench::measureMs(10, runLocked);
+        CHECK(threads.getCommandCount() == count);
+        CHECK(target.calls == count + threadCount * 2);
+        CHECK(shared.getCommandCount() == count);
+        std::printf("%-8u %9.3f ms %9.3f ms %9.3f ms\n", threadCount, perThreadMs, lockedMs, mergeMs);
+    }
+    return 0;
+}
+
+//
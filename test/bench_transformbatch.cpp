@@ -0,0 +1,93 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// Simple3D の頂点変換の速さ(TransformBatch::apply と要素毎に書いた行列の積)
+//   bench_transformbatch [count]
+//
+#include "check.h"
+#include "transformbatch.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Prim3DList::Vertex と同じ並び
+struct PrimData3D
+{
+    float    position[3];
+    uint32_t color;
+};
+
+// 列優先の float[16] を添字で掛ける書き方(以前の TransformBatch::apply と同じ)
+void
+applyScalar(const float (&m)[16], PrimData3D* data, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* v = data[i].position;
+        float        out[3];
+        for (int c = 0; c < 3; c++)
+        {
+            out[c] = m[c] * v[0] + m[4 + c] * v[1] + m[8 + c] * v[2] + m[12 + c];
+        }
+        std::memcpy(data[i].position, out, sizeof(out));
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? size_t(std::atol(argv[1])) : 1000000;
+
+    std::mt19937                          rng{1};
+    std::uniform_real_distribution<float> dist{-10.0f, 10.0f};
+    std::vector<PrimData3D>               source(count);
+    for (auto& v : source)
+    {
+        v = {{dist(rng), dist(rng), dist(rng)}, 0xffffffff};
+    }
+
+    // 回転 + 拡大 + 移動(誤差が積もらないよう毎回元の頂点から変換する)
+    const float    c = std::cos(0.3f);
+    const float    s = std::sin(0.3f);
+    simd::float4x4 m = matrix_identity_float4x4;
+    m.columns[0]     = simd_make_float4(c * 1.5f, 0.0f, -s * 1.5f, 0.0f);
+    m.columns[2]     = simd_make_float4(s * 1.5f, 0.0f, c * 1.5f, 0.0f);
+    m.columns[3]     = simd_make_float4(1.0f, 2.0f, 3.0f, 1.0f);
+    float mf[16];
+    std::memcpy(mf, &m, sizeof(mf));
+
+    std::vector<PrimData3D> scalar = source;
+    std::vector<PrimData3D> batch  = source;
+
+    auto runScalar = [&]
+    {
+        std::memcpy(scalar.data(), source.data(), count * sizeof(PrimData3D));
+        applyScalar(mf, scalar.data(), count);
+    };
+    auto runBatch = [&]
+    {
+        std::memcpy(batch.data(), source.data(), count * sizeof(PrimData3D));
+        TransformBatch::apply(m, batch.data(), sizeof(PrimData3D), count);
+    };
+    const double scalarMs = Bench::measureMs(20, runScalar);
+    const double batchMs  = Bench::measureMs(20, runBatch);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            CHECK_NEAR(batch[i].position[e], scalar[i].position[e], 1e-4);
+        }
+    }
+
+    const double copyMs = Bench::measureMs(20, [&] { std::memcpy(batch.data(), source.data(), count * sizeof(PrimData3D)); });
+    std::printf("%zu vertices (copy %.3f ms included)\n", count, copyMs);
+    std::printf("%-22s %8.3f ms %7.2f Mvertex/s\n", "scalar float[16]", scalarMs, double(count) / scalarMs * 1e-3);
+    std::printf("%-22s %8.3f ms %7.2f Mvertex/s\n", "TransformBatch::apply", batchMs, double(count) / batchMs * 1e-3);
+    return 0;
+}
+
+//
@@ -0,0 +1,57 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+//
+// テスト用の最小限のチェック(失敗したら場所を出して終わる)
+//
+#define CHECK(expr)                                                                       \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(expr))                                                                      \
+        {                                                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            std::exit(1);                                                                 \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_NEAR(a, b, eps)                                                                                          \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        const double check_a_ = double(a);                                                                             \
+        const double check_b_ = double(b);                                                                             \
+        if (!(std::abs(check_a_ - check_b_) <= double(eps)))                                                           \
+        {                                                                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, check_a_, \
+                         check_b_);                                                                                    \
+            std::exit(1);                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+namespace Bench
+{
+using Clock = std::chrono::steady_clock;
+
+// f を reps 回実行した1回あたりの時間(ミリ秒、一番速かった回)
+template <class F>
+double
+measureMs(int reps, F&& f)
+{
+    double best = 1e30;
+    for (int i = 0; i < reps; i++)
+    {
+        const auto start = Clock::now();
+        f();
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        best            = ms < best ? ms : best;
+    }
+    return best;
+}
+
+} // namespace Bench
@@ -0,0 +1,343 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <cmath>
+
+//
+// macOS 以外でテストをビルドするための <simd/simd.h> の代わり
+// テストから使う範囲だけを、同じ大きさと並びで用意する(float3 は 16 バイト)
+// 計算はスカラーで、ベクトル命令にはしない
+//
+
+//
+struct simd_float2
+{
+    float x, y;
+
+    float&       operator[](int i) { return (&x)[i]; }
+    const float& operator[](int i) const { return (&x)[i]; }
+};
+
+//
+struct alignas(16) simd_float3
+{
+    float x, y, z;
+    float pad_;
+
+    float&       operator[](int i) { return (&x)[i]; }
+    const float& operator[](int i) const { return (&x)[i]; }
+};
+
+// xyz は Apple の swizzle の代わり(x, y, z と同じ場所)
+struct alignas(16) simd_float4
+{
+    union
+    {
+        struct
+        {
+            float x, y, z, w;
+        };
+        simd_float3 xyz;
+    };
+
+    float&       operator[](int i) { return (&x)[i]; }
+    const float& operator[](int i) const { return (&x)[i]; }
+};
+static_assert(sizeof(simd_float2) == 8 && sizeof(simd_float3) == 16 && sizeof(simd_float4) == 16);
+
+// 列優先
+struct simd_float3x3
+{
+    simd_float3 columns[3];
+};
+struct simd_float4x4
+{
+    simd_float4 columns[4];
+};
+static_assert(sizeof(simd_float3x3) == 48 && sizeof(simd_float4x4) == 64);
+
+// (x, y, z) が虚部、w が実部
+struct simd_quatf
+{
+    simd_float4 vector;
+};
+
+#define SIMD_COMPAT_OPERATORS(T, N)                                                                                        \
+    inline T operator+(T a, T b)                                                                                          \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] += b[i];                                                                                                  \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T operator-(T a, T b)                                                                                          \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] -= b[i];                                                                                                  \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T operator*(T a, T b)                                                                                          \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] *= b[i];                                                                                                  \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T operator/(T a, T b)                                                                                          \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] /= b[i];                                                                                                  \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T operator*(T a, float s)                                                                                      \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] *= s;                                                                                                     \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T operator/(T a, float s)                                                                                      \
+    {                                                                                                                      \
+        for (int i = 0; i < N; i++)                                                                                        \
+            a[i] /= s;                                                                                                     \
+        return a;                                                                                                          \
+    }                                                                                                                      \
+    inline T  operator*(float s, T a) { return a * s; }                                                                    \
+    inline T  operator-(T a) { return a * -1.0f; }                                                                         \
+    inline T& operator+=(T& a, T b) { return a = a + b; }                                                                  \
+    inline T& operator-=(T& a, T b) { return a = a - b; }                                                                  \
+    inline T& operator*=(T& a, T b) { return a = a * b; }                                                                  \
+    inline T& operator*=(T& a, float s) { return a = a * s; }                                                              \
+    inline T& operator/=(T& a, float s) { return a = a / s; }
+
+SIMD_COMPAT_OPERATORS(simd_float2, 2)
+SIMD_COMPAT_OPERATORS(simd_float3, 3)
+SIMD_COMPAT_OPERATORS(simd_float4, 4)
+#undef SIMD_COMPAT_OPERATORS
+
+static const simd_float3x3 matrix_identity_float3x3 = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+static const simd_float4x4 matrix_identity_float4x4 = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+
+//
+inline simd_float2
+simd_make_float2(float x, float y)
+{
+    return {x, y};
+}
+inline simd_float3
+simd_make_float3(float x, float y, float z)
+{
+    return {x, y, z, 0.0f};
+}
+inline simd_float4
+simd_make_float4(float x, float y, float z, float w)
+{
+    return {x, y, z, w};
+}
+inline simd_float4
+simd_make_float4(simd_float3 v, float w)
+{
+    return {v.x, v.y, v.z, w};
+}
+inline simd_float4
+simd_make_float4(simd_float2 a, simd_float2 b)
+{
+    return {a.x, a.y, b.x, b.y};
+}
+
+//
+inline float
+simd_dot(simd_float3 a, simd_float3 b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+inline float
+simd_length(simd_float3 a)
+{
+    return std::sqrt(simd_dot(a, a));
+}
+inline float
+simd_distance(simd_float3 a, simd_float3 b)
+{
+    return simd_length(a - b);
+}
+inline simd_float3
+simd_normalize(simd_float3 a)
+{
+    return a / simd_length(a);
+}
+inline simd_float3
+simd_cross(simd_float3 a, simd_float3 b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.0f};
+}
+
+//
+inline simd_float3x3
+simd_matrix(simd_float3 c0, simd_float3 c1, simd_float3 c2)
+{
+    return {{c0, c1, c2}};
+}
+inline simd_float4x4
+simd_matrix(simd_float4 c0, simd_float4 c1, simd_float4 c2, simd_float4 c3)
+{
+    return {{c0, c1, c2, c3}};
+}
+inline simd_float4x4
+simd_transpose(const simd_float4x4& m)
+{
+    simd_float4x4 r;
+    for (int c = 0; c < 4; c++)
+    {
+        for (int e = 0; e < 4; e++)
+        {
+            r.columns[c][e] = m.columns[e][c];
+        }
+    }
+    return r;
+}
+inline simd_float4x4
+simd_matrix_from_rows(simd_float4 r0, simd_float4 r1, simd_float4 r2, simd_float4 r3)
+{
+    return simd_transpose({{r0, r1, r2, r3}});
+}
+inline simd_float4
+simd_mul(const simd_float4x4& m, simd_float4 v)
+{
+    return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+}
+inline simd_float4x4
+simd_mul(const simd_float4x4& a, const simd_float4x4& b)
+{
+    simd_float4x4 r;
+    for (int c = 0; c < 4; c++)
+    {
+        r.columns[c] = simd_mul(a, b.columns[c]);
+    }
+    return r;
+}
+inline bool
+simd_equal(const simd_float4x4& a, const simd_float4x4& b)
+{
+    for (int c = 0; c < 4; c++)
+    {
+        for (int e = 0; e < 4; e++)
+        {
+            if (a.columns[c][e] != b.columns[c][e])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+inline simd_float4x4
+operator*(const simd_float4x4& a, const simd_float4x4& b)
+{
+    return simd_mul(a, b);
+}
+inline simd_float4
+operator*(const simd_float4x4& m, simd_float4 v)
+{
+    return simd_mul(m, v);
+}
+
+// axis は単位ベクトル
+inline simd_quatf
+simd_quaternion(float angle, simd_float3 axis)
+{
+    const float s = std::sin(angle * 0.5f);
+    return {{axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f)}};
+}
+inline simd_quatf
+simd_quaternion(float ix, float iy, float iz, float r)
+{
+    return {{ix, iy, iz, r}};
+}
+inline simd_quatf
+simd_mul(simd_quatf p, simd_quatf q)
+{
+    const simd_float4 a = p.vector;
+    const simd_float4 b = q.vector;
+    return {{a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z}};
+}
+// q v q^-1 (q は単位 quaternion)
+inline simd_float3
+simd_act(simd_quatf q, simd_float3 v)
+{
+    const simd_float3 u = q.vector.xyz;
+    const simd_float3 t = simd_cross(u, v) * 2.0f;
+    return v + t * q.vector.w + simd_cross(u, t);
+}
+inline simd_float4x4
+simd_matrix4x4(simd_quatf q)
+{
+    const simd_float3 x = simd_act(q, simd_make_float3(1, 0, 0));
+    const simd_float3 y = simd_act(q, simd_make_float3(0, 1, 0));
+    const simd_float3 z = simd_act(q, simd_make_float3(0, 0, 1));
+    return {{simd_make_float4(x, 0), simd_make_float4(y, 0), simd_make_float4(z, 0), {0, 0, 0, 1}}};
+}
+
+//
+namespace simd
+{
+using float2   = simd_float2;
+using float3   = simd_float3;
+using float4   = simd_float4;
+using float3x3 = simd_float3x3;
+using float4x4 = simd_float4x4;
+using quatf    = simd_quatf;
+
+inline float
+dot(float3 a, float3 b)
+{
+    return simd_dot(a, b);
+}
+inline float
+length(float3 a)
+{
+    return simd_length(a);
+}
+inline float
+length(float2 a)
+{
+    return std::sqrt(a.x * a.x + a.y * a.y);
+}
+inline float
+distance(float3 a, float3 b)
+{
+    return simd_distance(a, b);
+}
+inline float3
+normalize(float3 a)
+{
+    return simd_normalize(a);
+}
+inline float3
+cross(float3 a, float3 b)
+{
+    return simd_cross(a, b);
+}
+inline float3
+min(float3 a, float3 b)
+{
+    return {std::fmin(a.x, b.x), std::fmin(a.y, b.y), std::fmin(a.z, b.z), 0.0f};
+}
+inline float3
+max(float3 a, float3 b)
+{
+    return {std::fmax(a.x, b.x), std::fmax(a.y, b.y), std::fmax(a.z, b.z), 0.0f};
+}
+inline float
+clamp(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+template <class T>
+inline T
+mix(T a, T b, float t)
+{
+    return a + (b - a) * t;
+}
+
+} // namespace simd
@@ -0,0 +1,208 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#pragma once
+
+#include <context.h>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+
+//
+// 呼ばれた Context の関数と引数を文字列に並べる(再生の結果を比べる用)
+// keepLog が false なら数えるだけ(ベンチマークの再生先)
+// GetThreadContext は自分を返す(その場で描く Context と同じ)
+//
+class LogContext : public Context
+{
+  public:
+    std::string log;
+    size_t      calls   = 0;
+    bool        keepLog = true;
+
+    Context&         GetThreadContext(uint32_t) override { return *this; }
+    CameraInterface& GetCamera() override { return camera_; }
+    void SetDrawColor(float r, float g, float b, float a) override { add("color", {r, g, b, a}); }
+    void Print(float x, float y, std::string_view msg) override
+    {
+        add("print", {x, y});
+        append(msg);
+    }
+    void PrintV(float x, float y, const char* fmt, va_list args) override
+    {
+        char buffer[256];
+        std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+        add("printf", {x, y});
+        append(buffer);
+    }
+    void DrawLine2D(simd::float2 from, simd::float2 to) override { add("line2d", {from.x, from.y, to.x, to.y}); }
+    void DrawRect2D(simd::float2 pos, simd::float2 size) override { add("rect2d", {pos.x, pos.y, size.x, size.y}); }
+    void FillRect2D(simd::float2 pos, simd::float2 size) override { add("fill2d", {pos.x, pos.y, size.x, size.y}); }
+    void DrawLine3D(simd::float3 from, simd::float3 to) override
+    {
+        add("line3d", {from.x, from.y, from.z, to.x, to.y, to.z});
+    }
+    void DrawRect3D(simd::float3 p0, simd::float3 p1, simd::float3 p2, simd::float3 p3) override
+    {
+        add("rect3d", {p0.x, p0.y, p0.z, p1.x, p1.y, p1.z, p2.x, p2.y, p2.z, p3.x, p3.y, p3.z});
+    }
+    void DrawTriangle3D(simd::float3 v0, simd::float3 v1, simd::float3 v2) override
+    {
+        add("triangle3d", {v0.x, v0.y, v0.z, v1.x, v1.y, v1.z, v2.x, v2.y, v2.z});
+    }
+    void DrawPlane3D(simd::float3 v0, simd::float3 v1, simd::float3 v2, simd::float3 v3) override
+    {
+        add("plane3d", {v0.x, v0.y, v0.z, v1.x, v1.y, v1.z, v2.x, v2.y, v2.z, v3.x, v3.y, v3.z});
+    }
+    void DrawLines3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        addArray("lines3d", points, count, colors);
+    }
+    void DrawTriangles3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        addArray("triangles3d", points, count, colors);
+    }
+    void DrawLineStrip2D(const simd::float2* points, size_t count, const simd::float4* colors) override
+    {
+        addArray("strip2d", points, count, colors);
+    }
+    void DrawLineStrip3D(const simd::float3* points, size_t count, const simd::float4* colors) override
+    {
+        addArray("strip3d", points, count, colors);
+    }
+    void DrawRects2D(const simd::float2* pos, const simd::float2* size, size_t count) override
+    {
+        addArray("rects2d", pos, count, nullptr);
+        for (size_t i = 0; keepLog && i < count; i++)
+        {
+            appendValues({size[i][0], size[i][1]});
+        }
+    }
+    void PushTransform(const simd::float4x4& transform) override
+    {
+        add("push", {});
+        appendMatrix(transform);
+    }
+    void PopTransform() override { add("pop", {}); }
+    void SetTransform(const simd::float4x4& transform) override
+    {
+        add("transform", {});
+        appendMatrix(transform);
+    }
+    void SetTranslucentSort3D(bool enable) override { add("sort", {float(enable)}); }
+    void DrawBox3D(simd::float3 center, simd::float3 size) override
+    {
+        add("box", {center.x, center.y, center.z, size.x, size.y, size.z});
+    }
+    void DrawSphere3D(simd::float3 center, float radius) override { add("sphere", {center.x, center.y, center.z, radius}); }
+    void DrawArrow3D(simd::float3 from, simd::float3 to) override
+    {
+        add("arrow", {from.x, from.y, from.z, to.x, to.y, to.z});
+    }
+    void DrawGrid3D(simd::float3 center, float size, int divisions) override
+    {
+        add("grid", {center.x, center.y, center.z, size, float(divisions)});
+    }
+    void DrawAxes3D(const simd::float4x4& transform, float length) override
+    {
+        add("axes", {length});
+        appendMatrix(transform);
+    }
+    GeometryHandle CreateGeometry() override
+    {
+        add("create", {float(nextHandle_)});
+        return nextHandle_++;
+    }
+    bool BeginGeometry(GeometryHandle handle) override
+    {
+        add("begin", {float(handle)});
+        return handle != 0;
+    }
+    void EndGeometry() override { add("end", {}); }
+    void DrawGeometry(GeometryHandle handle, const simd::float4x4& transform) override
+    {
+        add("geometry", {float(handle)});
+        appendMatrix(transform);
+    }
+    void DestroyGeometry(GeometryHandle handle) override { add("destroy", {float(handle)}); }
+
+  private:
+    class Camera : public CameraInterface
+    {
+        LogContext& owner_;
+
+      public:
+        explicit Camera(LogContext& owner) : owner_(owner) {}
+        void setEyePosition(simd::float3 eye) override { owner_.add("eye", {eye.x, eye.y, eye.z}); }
+        void setTargetPosition(simd::float3 tgt) override { owner_.add("target", {tgt.x, tgt.y, tgt.z}); }
+        void setUpVector(simd::float3 up) override { owner_.add("up", {up.x, up.y, up.z}); }
+        void setIdentity() override { owner_.add("identity", {}); }
+        void setViewport(float fovy, float aspect, float znear, float zfar) override
+        {
+            owner_.add("viewport", {fovy, aspect, znear, zfar});
+        }
+    };
+
+    void append(std::string_view text)
+    {
+        if (keepLog)
+        {
+            log.append(text);
+            log.push_back('\n');
+        }
+    }
+    void add(const char* name, std::initializer_list<float> values)
+    {
+        calls++;
+        if (keepLog)
+        {
+            log.append(name);
+        }
+        appendValues(values);
+    }
+    void appendValues(std::initializer_list<float> values)
+    {
+        if (!keepLog)
+        {
+            return;
+        }
+        char buffer[32];
+        for (float v : values)
+        {
+            std::snprintf(buffer, sizeof(buffer), " %g", double(v));
+            log.append(buffer);
+        }
+        log.push_back('\n');
+    }
+    void appendMatrix(const simd::float4x4& m)
+    {
+        for (const auto& c : m.columns)
+        {
+            appendValues({c[0], c[1], c[2], c[3]});
+        }
+    }
+    template <class T>
+    void addArray(const char* name, const T* points, size_t count, const simd::float4* colors)
+    {
+        add(name, {float(count), float(colors != nullptr)});
+        for (size_t i = 0; keepLog && i < count; i++)
+        {
+            const T& p = points[i];
+            if constexpr (sizeof(T) == sizeof(simd::float2))
+            {
+                appendValues({p[0], p[1]});
+            }
+            else
+            {
+                appendValues({p[0], p[1], p[2]});
+            }
+            if (colors)
+            {
+                appendValues({colors[i][0], colors[i][1], colors[i][2], colors[i][3]});
+            }
+        }
+    }
+
+    Camera         camera_{*this};
+    GeometryHandle nextHandle_ = 1;
+};
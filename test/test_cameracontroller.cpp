@@ -0,0 +1,133 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include <cameracontroller.h>
+#include <simd/geometry.h>
+
+namespace
+{
+using State = CameraController::State;
+using Input = CameraController::Input;
+
+const State Start{{0.0f, 0.0f, -10.0f}, {0.0f, 0.0f, 10.0f}, {0.0f, 1.0f, 0.0f}};
+
+//
+void
+checkNear(simd::float3 a, simd::float3 b)
+{
+    CHECK_NEAR(a.x, b.x, 1e-4);
+    CHECK_NEAR(a.y, b.y, 1e-4);
+    CHECK_NEAR(a.z, b.z, 1e-4);
+}
+
+//
+void
+checkSame(const State& a, const State& b)
+{
+    checkNear(a.eye, b.eye);
+    checkNear(a.target, b.target);
+    checkNear(a.up, b.up);
+}
+
+//
+// 前後と左右は MoveSpeed、回転は TurnSpeed で、注視点までの距離は変わらない
+//
+void
+testStep()
+{
+    checkSame(CameraController::step(Start, {0.0f, 0.0f, 0.0f}), Start);
+
+    const auto forward = CameraController::step(Start, {0.0f, 1.0f, 0.0f});
+    checkNear(forward.eye, simd::float3{0.0f, 0.0f, -10.0f + CameraController::MoveSpeed});
+    checkNear(forward.target, simd::float3{0.0f, 0.0f, 10.0f + CameraController::MoveSpeed});
+
+    // moveX が正なら up x 前 (+X) の逆に動く
+    const auto strafe = CameraController::step(Start, {0.5f, 0.0f, 0.0f});
+    checkNear(strafe.eye, simd::float3{-0.5f * CameraController::MoveSpeed, 0.0f, -10.0f});
+    checkNear(strafe.target - strafe.eye, Start.target - Start.eye);
+
+    const auto turned = CameraController::step(Start, {0.0f, 0.0f, 1.0f});
+    checkNear(turned.eye, Start.eye);
+    const auto dir = turned.target - turned.eye;
+    CHECK_NEAR(simd_length(dir), 20.0f, 1e-4);
+    CHECK_NEAR(std::atan2(dir.x, dir.z), CameraController::TurnSpeed, 1e-5);
+    CHECK_NEAR(dir.y, 0.0f, 1e-5);
+}
+
+//
+// relatch は同じ開始状態から計算し直すので、何度呼んでも1フレーム分しか動かない
+//
+void
+testRelatch()
+{
+    CameraController controller{Start};
+    const Input      early{0.0f, 0.2f, 0.1f};
+    const Input      late{0.3f, 1.0f, -0.5f};
+
+    controller.update(early);
+    checkSame(controller.getState(), CameraController::step(Start, early));
+    for (int i = 0; i < 5; i++)
+    {
+        controller.relatch(late);
+    }
+    const State latched = CameraController::step(Start, late);
+    checkSame(controller.getState(), latched);
+
+    // 次のフレームは relatch した結果から始まる
+    controller.update(early);
+    checkSame(controller.getState(), CameraController::step(latched, early));
+    controller.relatch(early);
+    checkSame(controller.getState(), CameraController::step(latched, early));
+}
+
+//
+class RecordingCamera : public CameraInterface
+{
+  public:
+    simd::float3 eye{};
+    simd::float3 target{};
+    int          calls = 0;
+
+    void setEyePosition(simd::float3 v) override
+    {
+        eye = v;
+        calls++;
+    }
+    void setTargetPosition(simd::float3 v) override
+    {
+        target = v;
+        calls++;
+    }
+    void setUpVector(simd::float3) override { calls++; }
+    void setIdentity() override { calls++; }
+    void setViewport(float, float, float, float) override { calls++; }
+};
+
+//
+// apply は位置と注視点だけを渡す
+//
+void
+testApply()
+{
+    CameraController controller{Start};
+    controller.update({0.0f, 1.0f, 0.0f});
+    RecordingCamera camera;
+    controller.apply(camera);
+    CHECK(camera.calls == 2);
+    checkNear(camera.eye, controller.getState().eye);
+    checkNear(camera.target, controller.getState().target);
+}
+
+} // namespace
+
+int
+main()
+{
+    testStep();
+    testRelatch();
+    testApply();
+    return 0;
+}
+
+//
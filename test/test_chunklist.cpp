@@ -0,0 +1,172 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "chunklist.h"
+#include <vector>
+
+namespace
+{
+using List = ChunkList<uint32_t, 16>;
+
+// 0, 1, 2, ... が入っている
+void
+checkSequence(const List& list, size_t count)
+{
+    CHECK(list.size() == count);
+    size_t next = 0;
+    list.forEachChunk(
+        [&](const uint32_t* data, size_t n)
+        {
+            CHECK(n > 0 && n <= List::chunkSize);
+            for (size_t i = 0; i < n; i++)
+            {
+                CHECK(data[i] == next++);
+            }
+        });
+    CHECK(next == count);
+    std::vector<uint32_t> copy(count);
+    list.copyTo(copy.data());
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(copy[i] == i && list[i] == i);
+    }
+}
+
+// chunks 個分を使ってから clear
+void
+useChunks(List& list, size_t chunks)
+{
+    for (size_t i = 0; i < chunks * List::chunkSize; i++)
+    {
+        list.push_back(uint32_t(i));
+    }
+    list.clear();
+}
+
+//
+// 追加はチャンクを足すだけで、追加済みの要素は動かない
+//
+void
+testGrowth()
+{
+    List list;
+    CHECK(list.empty() && list.getChunkCount() == 0);
+    list.push_back(0);
+    const uint32_t* first = &list[0];
+    for (uint32_t i = 1; i < 100; i++)
+    {
+        list.push_back(i);
+    }
+    CHECK(&list[0] == first);
+    CHECK(list.getChunkCount() == 7);
+    checkSequence(list, 100);
+
+    // append はチャンクの残りまでを返す
+    size_t got  = 0;
+    auto*  span = list.append(50, got);
+    CHECK(got == 12);
+    for (size_t i = 0; i < got; i++)
+    {
+        span[i] = uint32_t(100 + i);
+    }
+    span = list.append(50 - got, got);
+    CHECK(got == 16 && span == &list[112]);
+    for (size_t i = 0; i < got; i++)
+    {
+        span[i] = uint32_t(112 + i);
+    }
+    checkSequence(list, 128);
+
+    // 範囲はチャンク毎に分けて渡す
+    std::vector<size_t> counts;
+    uint32_t            expect = 10;
+    list.forEachRange(10, 40,
+                      [&](uint32_t* data, size_t n)
+                      {
+                          CHECK(data[0] == expect);
+                          expect += uint32_t(n);
+                          counts.push_back(n);
+                      });
+    CHECK((counts == std::vector<size_t>{6, 16, 8}));
+}
+
+//
+// clear したチャンクは再利用する(確保し直さない)
+//
+void
+testReuse()
+{
+    List list;
+    useChunks(list, 4);
+    CHECK(list.empty() && list.getChunkCount() == 4 && list.getHighWater() == 4);
+    list.push_back(1);
+    const uint32_t* reused = &list[0];
+    list.clear();
+    list.push_back(2);
+    CHECK(&list[0] == reused);
+    CHECK(list.getChunkCount() == 4);
+
+    // reserve はプールに用意して high-water も上げる
+    List reserved;
+    reserved.reserve(List::chunkSize * 3 + 1);
+    CHECK(reserved.getChunkCount() == 4 && reserved.getHighWater() == 4 && reserved.empty());
+    useChunks(reserved, 4);
+    CHECK(reserved.getChunkCount() == 4);
+}
+
+//
+// 使用量が high-water の半分以下の clear が shrinkDelay 回続いたら、その間の最大まで縮める
+// 途中で半分を超えたり増えたりしたら数え直す
+//
+void
+testShrink()
+{
+    static_assert(List::shrinkDelay == 120);
+    List list;
+    useChunks(list, 8);
+    CHECK(list.getHighWater() == 8 && list.getChunkCount() == 8);
+
+    // 119 回までは縮めない(間の最大は 3)
+    for (size_t i = 0; i + 1 < List::shrinkDelay; i++)
+    {
+        useChunks(list, i % 4);
+        CHECK(list.getHighWater() == 8 && list.getChunkCount() == 8);
+    }
+    useChunks(list, 2);
+    CHECK(list.getHighWater() == 3 && list.getChunkCount() == 3);
+
+    // 半分を超える使用量があると数え直し
+    useChunks(list, 8);
+    CHECK(list.getHighWater() == 8);
+    for (size_t i = 0; i < List::shrinkDelay - 1; i++)
+    {
+        useChunks(list, 1);
+    }
+    useChunks(list, 5);
+    CHECK(list.getHighWater() == 8);
+    for (size_t i = 0; i < List::shrinkDelay - 1; i++)
+    {
+        useChunks(list, 1);
+    }
+    CHECK(list.getHighWater() == 8 && list.getChunkCount() == 8);
+    useChunks(list, 1);
+    CHECK(list.getHighWater() == 1 && list.getChunkCount() == 1);
+
+    // 縮めた後に増えたら high-water も上がる
+    useChunks(list, 6);
+    CHECK(list.getHighWater() == 6 && list.getChunkCount() == 6);
+}
+
+} // namespace
+
+int
+main()
+{
+    testGrowth();
+    testReuse();
+    testShrink();
+    return 0;
+}
+
+//
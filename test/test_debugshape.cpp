@@ -0,0 +1,225 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "debugshape.h"
+#include "prim3dlist.h"
+#include <cstddef>
+#include <cstring>
+#include <matrix.h>
+#include <vector>
+
+namespace
+{
+using DebugShape::Instance;
+using DebugShape::Shape;
+using DebugShape::ShapeCount;
+
+// shader/prim3d.metal の primVert3dInstanced と同じ計算(dot(row, float4(p, 1)))
+void
+transform(const Instance& inst, const float (&p)[3], float (&out)[3])
+{
+    for (int r = 0; r < 3; r++)
+    {
+        const float* row = &inst.rows[r * 4];
+        out[r]           = row[0] * p[0] + row[1] * p[1] + row[2] * p[2] + row[3];
+    }
+}
+
+//
+void
+checkPoint(const Instance& inst, const float (&p)[3], float x, float y, float z)
+{
+    float out[3];
+    transform(inst, p, out);
+    CHECK_NEAR(out[0], x, 1e-5);
+    CHECK_NEAR(out[1], y, 1e-5);
+    CHECK_NEAR(out[2], z, 1e-5);
+}
+
+//
+struct Meshes
+{
+    std::vector<DebugShape::Vertex> vertices;
+    std::vector<uint32_t>           indices;
+    DebugShape::Range               ranges[ShapeCount];
+
+    Meshes() { DebugShape::buildMeshes(vertices, indices, ranges); }
+
+    // shape の線が使う頂点毎に fn(const float (&)[3])
+    template <class Fn>
+    void forEachVertex(Shape shape, Fn&& fn) const
+    {
+        const auto& range = ranges[size_t(shape)];
+        for (uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++)
+        {
+            fn(vertices[indices[i]].position);
+        }
+    }
+};
+
+//
+// shader/prim3d.metal の ShapeInstance (packed_float4 x3 + uint) と同じ 52 バイト
+//
+void
+testLayout()
+{
+    static_assert(sizeof(Instance) == 52);
+    static_assert(alignof(Instance) == 4);
+    static_assert(offsetof(Instance, rows) == 0 && offsetof(Instance, color) == 48);
+    static_assert(sizeof(DebugShape::Vertex) == 16);
+    Instance pair[2];
+    CHECK(reinterpret_cast<char*>(&pair[1]) - reinterpret_cast<char*>(&pair[0]) == 52);
+}
+
+//
+// 形状毎のインデックス範囲は隙間無く並ぶ線リスト
+//
+void
+testMeshes()
+{
+    const Meshes m;
+    uint32_t     next = 0;
+    for (size_t s = 0; s < ShapeCount; s++)
+    {
+        CHECK(m.ranges[s].firstIndex == next);
+        CHECK(m.ranges[s].indexCount > 0 && m.ranges[s].indexCount % 2 == 0);
+        next += m.ranges[s].indexCount;
+    }
+    CHECK(next == m.indices.size());
+    for (auto idx : m.indices)
+    {
+        CHECK(idx < m.vertices.size());
+    }
+    // 箱は 12 本、球は 32 分割の大円 3 つ、矢印は軸と矢じり 4 本、座標軸は 3 本
+    CHECK(m.ranges[size_t(Shape::Box)].indexCount == 24);
+    CHECK(m.ranges[size_t(Shape::Sphere)].indexCount == 3 * 32 * 2);
+    CHECK(m.ranges[size_t(Shape::Line)].indexCount == 2);
+    CHECK(m.ranges[size_t(Shape::Arrow)].indexCount == 10);
+    CHECK(m.ranges[size_t(Shape::Axes)].indexCount == 6);
+}
+
+//
+// 箱: 中心 + 各軸 size/2、球: 中心から半径
+//
+void
+testBoxSphere()
+{
+    const Meshes m;
+    const float  center[3] = {1.0f, -2.0f, 3.0f};
+    const float  size[3]   = {2.0f, 4.0f, 6.0f};
+    const auto   box       = DebugShape::makeInstance(center, size, 0x12345678);
+    CHECK(box.color == 0x12345678);
+    m.forEachVertex(Shape::Box,
+                    [&](const float (&p)[3])
+                    {
+                        float out[3];
+                        transform(box, p, out);
+                        for (int e = 0; e < 3; e++)
+                        {
+                            CHECK_NEAR(std::abs(out[e] - center[e]), size[e] * 0.5f, 1e-6);
+                        }
+                    });
+
+    const float radius[3] = {2.5f, 2.5f, 2.5f};
+    const auto  sphere    = DebugShape::makeInstance(center, radius, 0xffffffff);
+    m.forEachVertex(Shape::Sphere,
+                    [&](const float (&p)[3])
+                    {
+                        float out[3];
+                        transform(sphere, p, out);
+                        const float d[3] = {out[0] - center[0], out[1] - center[1], out[2] - center[2]};
+                        CHECK_NEAR(std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]), 2.5, 1e-5);
+                    });
+}
+
+//
+// 線と矢印: 根元が from、先端が to に来る
+//
+void
+testLineArrow()
+{
+    const float origin[3] = {0.0f, 0.0f, 0.0f};
+    const float unitX[3]  = {1.0f, 0.0f, 0.0f};
+    const float unitZ[3]  = {0.0f, 0.0f, 1.0f};
+    const float from[3]   = {1.0f, 2.0f, 3.0f};
+
+    const float to[3] = {-4.0f, 5.0f, 0.5f};
+    const auto  line  = DebugShape::makeLineInstance(from, to, 0xffffffff);
+    checkPoint(line, origin, from[0], from[1], from[2]);
+    checkPoint(line, unitX, to[0], to[1], to[2]);
+
+    // Y と平行な向きでも基底が作れる
+    const float targets[][3] = {{-4.0f, 5.0f, 0.5f}, {1.0f, 7.0f, 3.0f}, {1.0f, -1.0f, 3.0f}, {1.0f, 2.0f, -3.0f}};
+    for (const auto& t : targets)
+    {
+        const auto arrow = DebugShape::makeArrowInstance(from, t, 0xff0000ff);
+        checkPoint(arrow, origin, from[0], from[1], from[2]);
+        checkPoint(arrow, unitZ, t[0], t[1], t[2]);
+        // 3 列は直交して長さは from - to
+        const float len = std::sqrt((t[0] - from[0]) * (t[0] - from[0]) + (t[1] - from[1]) * (t[1] - from[1]) +
+                                    (t[2] - from[2]) * (t[2] - from[2]));
+        for (int a = 0; a < 3; a++)
+        {
+            for (int b = 0; b < 3; b++)
+            {
+                double dot = 0.0;
+                for (int r = 0; r < 3; r++)
+                {
+                    dot += double(arrow.rows[r * 4 + a]) * arrow.rows[r * 4 + b];
+                }
+                CHECK_NEAR(dot, a == b ? len * len : 0.0, 1e-4);
+            }
+        }
+    }
+
+    // 長さ 0 なら from に潰れる
+    const auto zero = DebugShape::makeArrowInstance(from, from, 0xffffffff);
+    checkPoint(zero, unitZ, from[0], from[1], from[2]);
+}
+
+//
+// 座標軸: 列優先の行列をそのまま行優先の 3x4 に、Prim3DList は長さを掛けて、行列は前から掛ける
+//
+void
+testAxes()
+{
+    const auto m = simd_mul(math::makeTranslate(simd_make_float3(5, 6, 7)), math::makeZRotate(0.3f));
+    float      matrix[16];
+    std::memcpy(matrix, &m, sizeof(matrix));
+    const auto  axes   = DebugShape::makeInstance(matrix, 0xffffffff);
+    const float ex[3]  = {1.0f, 0.0f, 0.0f};
+    const auto  expect = simd_mul(m, simd_make_float4(1, 0, 0, 1));
+    checkPoint(axes, ex, expect.x, expect.y, expect.z);
+
+    Prim3DList list;
+    const auto parent = math::makeTranslate(simd_make_float3(0, 0, -10));
+    list.setTransform(parent);
+    list.drawAxes(m, 2.0f);
+    list.drawBox(simd_make_float3(1, 1, 1), simd_make_float3(2, 2, 2));
+    const auto& axesList = list.getShapes(Shape::Axes);
+    const auto& boxList  = list.getShapes(Shape::Box);
+    CHECK(axesList.size() == 1 && boxList.size() == 1);
+    // 軸の先端は parent * m * (2, 0, 0)
+    const auto tip = simd_mul(parent, simd_mul(m, simd_make_float4(2, 0, 0, 1)));
+    checkPoint(axesList[0], ex, tip.x, tip.y, tip.z);
+    CHECK(axesList[0].color == 0xffffffff);
+    // 箱の角 (0.5, 0.5, 0.5) は (2, 2, 2) - (0, 0, 10)
+    const float corner[3] = {0.5f, 0.5f, 0.5f};
+    checkPoint(boxList[0], corner, 2.0f, 2.0f, -8.0f);
+}
+
+} // namespace
+
+int
+main()
+{
+    testLayout();
+    testMeshes();
+    testBoxSphere();
+    testLineArrow();
+    testAxes();
+    return 0;
+}
+
+//
@@ -0,0 +1,149 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "evdevinput.h"
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+constexpr uint64_t Ms = 1000000; // ns
+
+// 記録した input_event の列(時刻は ms)
+struct Event
+{
+    uint64_t timeMs;
+    uint16_t type;
+    uint16_t code;
+    int32_t  value;
+};
+const Event Recording[] = {
+    {1000, EV_ABS, ABS_X, 0},
+    {1000, EV_ABS, ABS_Z, 0},
+    {1000, EV_SYN, SYN_REPORT, 0},
+    // 1 秒止まってから倒す
+    {2000, EV_ABS, ABS_X, 32767},
+    {2000, EV_KEY, BTN_SOUTH, 1},
+    {2000, EV_SYN, SYN_REPORT, 0},
+    {2004, EV_KEY, BTN_SOUTH, 0},
+    {2004, EV_SYN, SYN_REPORT, 0},
+    // 取りこぼし: 次の SYN_REPORT までは使わない
+    {2010, EV_SYN, SYN_DROPPED, 0},
+    {2010, EV_ABS, ABS_Y, -32768},
+    {2012, EV_SYN, SYN_REPORT, 0},
+    {2020, EV_ABS, ABS_HAT0X, -1},
+    {2020, EV_ABS, ABS_Y, 32767},
+    {2020, EV_SYN, SYN_REPORT, 0},
+};
+
+// Recording を一時ファイルに書く
+std::string
+writeRecording()
+{
+    char      path[] = "/tmp/test_evdevinput.XXXXXX";
+    const int fd     = mkstemp(path);
+    CHECK(fd >= 0);
+    std::vector<input_event> events;
+    for (const auto& e : Recording)
+    {
+        input_event event{};
+        event.input_event_sec  = decltype(event.input_event_sec)(e.timeMs / 1000);
+        event.input_event_usec = decltype(event.input_event_usec)(e.timeMs % 1000 * 1000);
+        event.type             = e.type;
+        event.code             = e.code;
+        event.value            = e.value;
+        events.push_back(event);
+    }
+    const auto bytes = ssize_t(events.size() * sizeof(input_event));
+    CHECK(write(fd, events.data(), size_t(bytes)) == bytes);
+    close(fd);
+    return path;
+}
+
+//
+// SYN_REPORT 毎に1つ、時刻はイベントの時刻、取りこぼした間の変化は入らない
+//
+void
+testRead(const char* path)
+{
+    EvdevInput input{path};
+    CHECK(input.isOpen());
+
+    PadSample sample;
+    CHECK(input.read(sample, 1));
+    CHECK(sample.connected && sample.timeNs == 1000 * Ms);
+    CHECK_NEAR(sample.axes[PadSample::LeftX], 0.0f, 1e-4);
+    CHECK(sample.buttons == 0);
+
+    CHECK(input.read(sample, 1));
+    CHECK(sample.timeNs == 2000 * Ms);
+    CHECK_NEAR(sample.axes[PadSample::LeftX], 1.0f, 1e-6);
+    CHECK(sample.buttons == 1u << PadSample::A);
+
+    CHECK(input.read(sample, 1));
+    CHECK(sample.timeNs == 2004 * Ms && sample.buttons == 0);
+
+    // 2012 の SYN_REPORT はファイルでは読み直せないので飛ばす
+    CHECK(input.read(sample, 1));
+    CHECK(sample.timeNs == 2020 * Ms);
+    CHECK(sample.buttons == 1u << PadSample::Left);
+    CHECK_NEAR(sample.axes[PadSample::LeftY], -1.0f, 1e-6);
+
+    CHECK(!input.read(sample, 1));
+}
+
+//
+// 記録したファイルを InputSampler に通す
+// 変化した時しか積まれないので、止まっていた間は補間せず前の値のまま
+//
+void
+testSampler(const char* path)
+{
+    InputSampler sampler;
+    sampler.start(std::make_unique<EvdevInput>(path), 8 * Ms);
+    // ファイルはすぐに読み終わる
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    GamePad::PadState state{};
+    CHECK(sampler.peek(state, 1500 * Ms));
+    CHECK_NEAR(state.leftX, 0.0f, 1e-4);
+    CHECK(sampler.peek(state, 1992 * Ms));
+    CHECK_NEAR(state.leftX, 0.0f, 1e-4);
+    // 2000 の直前の 1 周期(8ms)だけ補間する
+    CHECK(sampler.peek(state, 1996 * Ms));
+    CHECK_NEAR(state.leftX, 0.5f, 1e-3);
+    CHECK(sampler.peek(state, 2000 * Ms));
+    CHECK_NEAR(state.leftX, 1.0f, 1e-6);
+
+    // 4ms だけ押した A も押した扱い
+    CHECK(sampler.update(state, 2030 * Ms));
+    CHECK(sampler.getEvents().size() == 4);
+    CHECK(state.buttonA.Pressed() && state.buttonA.On());
+    CHECK(state.buttonLeft.Pressed() && state.buttonLeft.On());
+    CHECK_NEAR(state.leftY, -1.0f, 1e-6);
+    CHECK(sampler.getDroppedCount() == 0);
+
+    CHECK(sampler.update(state, 3000 * Ms));
+    CHECK(sampler.getEvents().empty());
+    CHECK(!state.buttonA.Pressed() && state.buttonA.Release());
+    CHECK(state.buttonLeft.Pressed() && !state.buttonLeft.On());
+    sampler.stop();
+}
+
+} // namespace
+
+int
+main()
+{
+    const auto path = writeRecording();
+    testRead(path.c_str());
+    testSampler(path.c_str());
+    unlink(path.c_str());
+    return 0;
+}
+
+//
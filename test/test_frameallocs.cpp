@@ -0,0 +1,127 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// renderer のフレーム毎の処理のうち Metal に依存しない部分を回して、
+// 使う量が落ち着いた後のフレームでヒープ確保が起きないことを memtrack_new.cpp の記録で確かめる
+//
+#include "check.h"
+#include "framearena.h"
+#include "memtrack.h"
+#include "radixsort.h"
+#include "rendergraph.h"
+#include "renderqueue.h"
+#include "stringtable.h"
+#include <string_view>
+#include <vector>
+
+namespace
+{
+//
+struct Frame
+{
+    FrameArena            arena;
+    StringTable           strings;
+    RenderGraph           graph;
+    RenderQueue           queue;
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> values;
+    std::vector<uint32_t> tmpKeys;
+    std::vector<uint32_t> tmpValues;
+    size_t                executed = 0;
+};
+
+//
+void
+executePass(void* user, void*)
+{
+    static_cast<Frame*>(user)->executed++;
+}
+//
+void
+executeDraw(void* user, void*, uint32_t)
+{
+    static_cast<Frame*>(user)->executed++;
+}
+
+// Renderer::draw と ContextImpl のテキストの流れに合わせる
+void
+runFrame(Frame& f, uint32_t frame)
+{
+    MemTrack::beginFrame();
+    f.arena.reset();
+
+    // Print と Printf
+    CHECK(f.strings.intern("fps").data() != nullptr);
+    CHECK(f.strings.intern("camera").data() != nullptr);
+    if (frame % 2 == 0)
+    {
+        CHECK(f.strings.intern("blink").data() != nullptr);
+    }
+    CHECK(!f.arena.format("frame %u", frame).empty());
+
+    // 描画を積んで並べ替える
+    f.queue.clear();
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        f.queue.submit(RenderQueue::makeKey(uint8_t(i % 3), i % 5, 0, float(i % 7) / 7.0f), executeDraw, &f, i);
+    }
+    f.queue.sort();
+
+    // Simple3D の半透明の並べ替えと同じ大きさ
+    for (size_t i = 0; i < f.keys.size(); i++)
+    {
+        f.keys[i]   = uint32_t(i * 2654435761u + frame) >> 8;
+        f.values[i] = uint32_t(i);
+    }
+    RadixSort::sortParallel(f.keys.data(), f.values.data(), f.keys.size(), f.tmpKeys.data(), f.tmpValues.data(), 2);
+
+    // RenderGraph を組み直す
+    f.graph.clear();
+    const auto drawable   = f.graph.importResource("drawable");
+    const auto shadow     = f.graph.createTransient("shadow", {1024, 1024});
+    const auto shadowPass = f.graph.addPass("shadow", executePass, &f);
+    const auto mainPass   = f.graph.addPass("main", executePass, &f);
+    f.graph.write(shadowPass, shadow);
+    f.graph.read(mainPass, shadow);
+    f.graph.write(mainPass, drawable);
+    CHECK(f.graph.compile());
+    f.graph.execute(nullptr);
+    f.queue.execute(nullptr);
+
+    f.strings.endFrame();
+}
+
+} // namespace
+
+int
+main()
+{
+    Frame f;
+    f.keys.resize(RadixSort::MinCountPerThread * 2);
+    f.values.resize(f.keys.size());
+    f.tmpKeys.resize(f.keys.size());
+    f.tmpValues.resize(f.keys.size());
+
+    // StringTable の詰め直しを一度通るまで回してから数える(数える間にもう一度詰め直す)
+    uint32_t frame = 0;
+    for (; frame < StringTable::keepFrames; frame++)
+    {
+        runFrame(f, frame);
+    }
+    const auto before = MemTrack::getTotal(MemTrack::Kind::Heap);
+    for (; frame < StringTable::keepFrames * 2; frame++)
+    {
+        const uint64_t start = MemTrack::getTotal(MemTrack::Kind::Heap).allocCount;
+        runFrame(f, frame);
+        CHECK(MemTrack::getTotal(MemTrack::Kind::Heap).allocCount == start);
+    }
+    const auto after = MemTrack::getTotal(MemTrack::Kind::Heap);
+    std::printf("heap allocations: %llu during warm-up, %llu in %u steady frames\n", (unsigned long long)before.allocCount,
+                (unsigned long long)(after.allocCount - before.allocCount), StringTable::keepFrames);
+    CHECK(before.allocCount > 0); // 置き換えた operator new を通っている
+    CHECK(after.allocCount == before.allocCount);
+    CHECK(f.executed > 0);
+    return 0;
+}
+
+//
@@ -0,0 +1,126 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "framepacer.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+using namespace std::chrono_literals;
+
+//
+// framesInFlight 個積んだら、どれかが完了するまで acquire は返らない
+//
+void
+testAcquireBlocks()
+{
+    FramePacer pacer{2};
+    const int  s0 = pacer.acquire();
+    pacer.submit(s0);
+    const int s1 = pacer.acquire();
+    pacer.submit(s1);
+    CHECK(pacer.getInFlightCount() == 2);
+
+    std::atomic<int> slot{-1};
+    std::thread      thread{[&] { slot.store(pacer.acquire()); }};
+    std::this_thread::sleep_for(50ms);
+    CHECK(slot.load() == -1);
+
+    pacer.complete(s0);
+    thread.join();
+    CHECK(slot.load() == s0);
+    CHECK(pacer.getWaitMs() >= 40.0f);
+    CHECK(pacer.getInFlightCount() == 2);
+
+    pacer.submit(slot.load());
+    pacer.complete(s1);
+    pacer.complete(slot.load());
+    pacer.waitIdle();
+    CHECK(pacer.getInFlightCount() == 0);
+    CHECK(pacer.getCompletedCount() == 3);
+}
+
+//
+// スロットは 0..framesInFlight-1 を順に回る(範囲外の指定は丸める)
+//
+void
+testSlotRotation()
+{
+    FramePacer pacer{3};
+    for (int frame = 0; frame < 10; frame++)
+    {
+        const int slot = pacer.acquire();
+        CHECK(slot == frame % 3);
+        pacer.submit(slot);
+        pacer.complete(slot);
+    }
+    CHECK(pacer.getWaitMs() < 10.0f);
+
+    CHECK(FramePacer{0}.getFramesInFlight() == FramePacer::MinFramesInFlight);
+    CHECK(FramePacer{100}.getFramesInFlight() == FramePacer::MaxFramesInFlight);
+}
+
+//
+// submit から complete までを最後、平均、最大として数える
+//
+void
+testLatency()
+{
+    FramePacer pacer{2};
+    CHECK(pacer.getLatencyMs() == 0.0f && pacer.getAverageLatencyMs() == 0.0f);
+
+    const int fast = pacer.acquire();
+    pacer.submit(fast);
+    pacer.complete(fast);
+    const float fastMs = pacer.getLatencyMs();
+    CHECK(fastMs < 10.0f);
+
+    const int slow = pacer.acquire();
+    pacer.submit(slow);
+    std::this_thread::sleep_for(30ms);
+    pacer.complete(slow);
+    const float slowMs = pacer.getLatencyMs();
+    CHECK(slowMs >= 30.0f);
+    CHECK(pacer.getMaxLatencyMs() == slowMs);
+    CHECK_NEAR(pacer.getAverageLatencyMs(), (fastMs + slowMs) * 0.5f, 1e-3);
+    CHECK(pacer.getCompletedCount() == 2);
+}
+
+//
+// 積んでいる間は数を変えられない(変えたらスロットは 0 から数え直す)
+//
+void
+testSetFramesInFlight()
+{
+    FramePacer pacer{3};
+    const int  slot = pacer.acquire();
+    CHECK(!pacer.setFramesInFlight(1));
+    CHECK(pacer.getFramesInFlight() == 3);
+    pacer.submit(slot);
+    pacer.complete(slot);
+
+    CHECK(pacer.setFramesInFlight(1));
+    CHECK(pacer.getFramesInFlight() == 1);
+    CHECK(pacer.acquire() == 0);
+    CHECK(!pacer.setFramesInFlight(2));
+    pacer.submit(0);
+    pacer.complete(0);
+    CHECK(pacer.setFramesInFlight(9));
+    CHECK(pacer.getFramesInFlight() == FramePacer::MaxFramesInFlight);
+}
+
+} // namespace
+
+int
+main()
+{
+    testAcquireBlocks();
+    testSlotRotation();
+    testLatency();
+    testSetFramesInFlight();
+    return 0;
+}
+
+//
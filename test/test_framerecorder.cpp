@@ -0,0 +1,187 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "framerecorder.h"
+#include "logcontext.h"
+#include "simpipeline.h"
+#include <matrix.h>
+
+namespace
+{
+// frame によって中身の変わる、Context の関数を一通り使う更新
+void
+drawScene(Context& context, int frame)
+{
+    using simd::float2;
+    using simd::float3;
+    using simd::float4;
+
+    const float t = float(frame) * 0.25f;
+    auto&       camera = context.GetCamera();
+    camera.setIdentity();
+    camera.setEyePosition(float3{0.0f, 2.0f, -5.0f - t});
+    camera.setTargetPosition(float3{0.0f, 0.0f, 0.0f});
+    camera.setUpVector(float3{0.0f, 1.0f, 0.0f});
+    camera.setViewport(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+    context.SetDrawColor(1.0f, 0.5f, 0.25f);
+    context.Print(10.0f, 20.0f, "fixed text");
+    context.Printf(10.0f, 40.0f, "frame %d t=%.2f", frame, t);
+    context.DrawLine2D(float2{0.0f, 0.0f}, float2{t, 100.0f});
+    context.DrawRect2D(float2{5.0f, 5.0f}, float2{50.0f, 20.0f});
+    context.FillRect2D(float2{6.0f, 6.0f}, float2{48.0f, 18.0f});
+
+    const float3 a{0.0f, 0.0f, 0.0f};
+    const float3 b{1.0f, t, 0.0f};
+    const float3 c{0.0f, 1.0f, 1.0f};
+    const float3 d{1.0f, 1.0f, 1.0f};
+    context.DrawLine3D(a, b);
+    context.DrawRect3D(a, b, d, c);
+    context.DrawTriangle3D(a, b, c);
+    context.DrawPlane3D(a, b, d, c);
+
+    const float3 points[] = {a, b, c, d, b, c};
+    const float4 colors[] = {{1, 0, 0, 1}, {0, 1, 0, 1}, {0, 0, 1, 1}, {1, 1, 0, 1}, {0, 1, 1, 1}, {1, 0, 1, 0.5f}};
+    const float2 strip[]  = {{0, 0}, {10, t}, {20, 0}};
+    const float2 sizes[]  = {{1, 1}, {2, 2}, {3, 3}};
+    context.DrawLines3D(points, 4);
+    context.DrawTriangles3D(points, 6, colors);
+    context.DrawLineStrip2D(strip, 3, colors);
+    context.DrawLineStrip3D(points, 5);
+    context.DrawRects2D(strip, sizes, 3);
+
+    context.SetTranslucentSort3D(frame % 2 == 0);
+    context.PushTransform(math::makeTranslate(float3{t, 0.0f, 0.0f}));
+    context.DrawBox3D(a, d);
+    context.DrawSphere3D(b, 0.5f + t);
+    context.PopTransform();
+    context.SetTransform(math::makeYRotate(t));
+    context.DrawArrow3D(a, c);
+    context.DrawGrid3D(a, 10.0f, 4 + frame);
+    context.DrawAxes3D(math::makeTranslate(d), 2.0f);
+
+    // 作って、描いて、消す(ハンドルは再生先のものに置き換わる)
+    const auto geometry = context.CreateGeometry();
+    if (context.BeginGeometry(geometry))
+    {
+        context.DrawTriangle3D(a, b, c);
+        context.EndGeometry();
+    }
+    context.DrawGeometry(geometry, math::makeScale(float3{2.0f, 2.0f, 2.0f}));
+    context.DestroyGeometry(geometry);
+}
+
+//
+// 記録して再生したものは、直接呼んだものと同じ
+//
+void
+testReplayMatchesDirect()
+{
+    LogContext direct;
+    drawScene(direct, 3);
+
+    GeometryHandleMap handles;
+    FrameRecorder     recorder{handles};
+    drawScene(recorder, 3);
+    CHECK(!recorder.empty());
+    CHECK(recorder.getCommandCount() == direct.calls);
+
+    LogContext replayed;
+    recorder.replay(replayed);
+    CHECK(replayed.log == direct.log);
+    CHECK(replayed.calls == direct.calls);
+
+    // 記録は残るので2回目も同じ(ジオメトリは作り直すのでハンドルだけ変わる)
+    LogContext again;
+    recorder.replay(again);
+    CHECK(again.calls == direct.calls);
+
+    // clear した後に記録し直しても同じ
+    recorder.clear();
+    CHECK(recorder.empty() && recorder.getBytes() == 0);
+    drawScene(recorder, 3);
+    LogContext cleared;
+    recorder.replay(cleared);
+    CHECK(cleared.log == direct.log);
+}
+
+//
+// 前のフレームで作ったジオメトリは、別のフレームの記録からも使える
+//
+void
+testGeometryAcrossFrames()
+{
+    GeometryHandleMap handles;
+    FrameRecorder     first{handles};
+    FrameRecorder     second{handles};
+    LogContext        target;
+
+    const auto handle = first.CreateGeometry();
+    CHECK(handle != 0 && handles.isAlive(handle));
+    CHECK(first.BeginGeometry(handle));
+    first.DrawLine3D(simd::float3{0, 0, 0}, simd::float3{1, 1, 1});
+    first.EndGeometry();
+    first.replay(target);
+
+    second.DrawGeometry(handle, math::makeIdentity());
+    second.DestroyGeometry(handle);
+    CHECK(!handles.isAlive(handle));
+    CHECK(!second.BeginGeometry(handle));
+    target.log.clear();
+    second.replay(target);
+    CHECK(target.log.find("geometry 1\n") == 0);
+    CHECK(target.log.find("destroy 1\n") != std::string::npos);
+    CHECK(handles.resolve(handle) == 0);
+}
+
+//
+int pipelineFrame = 0;
+
+//
+void
+updatePipeline(Context& context)
+{
+    drawScene(context, pipelineFrame++);
+}
+
+//
+// SimPipeline を通しても、フレーム k の再生は k 番目の更新を直接呼んだものと同じ
+//
+void
+testPipeline()
+{
+    constexpr int FrameCount = 20;
+    SimPipeline   pipeline;
+    pipelineFrame = 0;
+    pipeline.start(updatePipeline);
+    CHECK(pipeline.isRunning());
+    for (int frame = 0; frame < FrameCount; frame++)
+    {
+        const auto& recorded = pipeline.acquire();
+        CHECK(pipeline.getFrameIndex() == uint64_t(frame));
+        LogContext replayed;
+        LogContext direct;
+        recorded.replay(replayed);
+        drawScene(direct, frame);
+        CHECK(replayed.log == direct.log);
+        pipeline.release();
+    }
+    pipeline.stop();
+    CHECK(!pipeline.isRunning());
+    // 記録側は Depth フレームより先には進まない
+    CHECK(pipelineFrame <= FrameCount + SimPipeline::Depth);
+}
+
+} // namespace
+
+int
+main()
+{
+    testReplayMatchesDirect();
+    testGeometryAcrossFrames();
+    testPipeline();
+    return 0;
+}
+
+//
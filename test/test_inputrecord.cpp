@@ -0,0 +1,231 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "inputrecord.h"
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+using GamePad::PadState;
+
+// frame と pad から決まる状態(ボタンは途中で押して離す)
+void
+makeState(int frame, int pad, PadState& state)
+{
+    const bool on  = (frame + pad) % 5 < 2;
+    const bool was = (frame + pad + 4) % 5 < 2;
+    const PadState::Button buttonA{on, was};
+    const PadState::Button buttonUp{frame % 7 == 0, false};
+    state.enabled_ = pad != 3;
+    state.buttonA  = buttonA;
+    state.buttonUp = buttonUp;
+    state.leftX    = frame < 10 ? 0.0f : float(frame) * 0.01f;
+    state.leftY    = -0.5f;
+    state.rightX   = 0.0f;
+    state.rightY   = float(pad) * 0.25f;
+    state.triggerL = frame % 3 == 0 ? 1.0f : 0.0f;
+    state.triggerR = 0.0f;
+}
+
+//
+bool
+sameButton(const PadState::Button& a, const PadState::Button& b)
+{
+    return a.Pressed() == b.Pressed() && a.On() == b.On() && a.Release() == b.Release();
+}
+
+//
+void
+checkSame(const PadState& a, const PadState& b)
+{
+    CHECK(a.enabled_ == b.enabled_);
+    CHECK(sameButton(a.buttonA, b.buttonA));
+    CHECK(sameButton(a.buttonUp, b.buttonUp));
+    CHECK(sameButton(a.buttonOptions, b.buttonOptions));
+    CHECK(a.leftX == b.leftX && a.leftY == b.leftY && a.rightX == b.rightX && a.rightY == b.rightY);
+    CHECK(a.triggerL == b.triggerL && a.triggerR == b.triggerR);
+}
+
+//
+std::string
+tempPath(const char* name)
+{
+    return std::string{"/tmp/"} + name + "." + std::to_string(getpid());
+}
+
+constexpr int FrameCount = 40;
+
+// 記録と同じ呼び出しの並び(パッド 0 と 2、GetLatestPadState は 1 フレームおき)
+void
+recordFrames()
+{
+    for (int frame = 0; frame < FrameCount; frame++)
+    {
+        InputRecord::beginFrame();
+        for (int pad : {0, 2})
+        {
+            PadState state{};
+            makeState(frame, pad, state);
+            InputRecord::record(InputRecord::Call::Pad, pad, state, state.enabled_);
+        }
+        if (frame % 2 == 0)
+        {
+            PadState state{};
+            makeState(frame + 100, 0, state);
+            InputRecord::record(InputRecord::Call::LatestPad, 0, state, state.enabled_);
+        }
+    }
+}
+
+//
+// 記録したものが同じ順に同じ値で返る
+//
+void
+testRoundTrip()
+{
+    const auto path = tempPath("test_inputrecord");
+    CHECK(InputRecord::startRecording(path.c_str()));
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Record);
+    recordFrames();
+    CHECK(InputRecord::getFrameCount() == FrameCount);
+    InputRecord::stop();
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Off);
+
+    CHECK(InputRecord::startReplay(path.c_str()));
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Replay);
+    for (int frame = 0; frame < FrameCount; frame++)
+    {
+        InputRecord::beginFrame();
+        for (int pad : {0, 2})
+        {
+            PadState expect{};
+            PadState state{};
+            bool     result = false;
+            makeState(frame, pad, expect);
+            CHECK(InputRecord::replay(InputRecord::Call::Pad, pad, state, result));
+            CHECK(result == expect.enabled_);
+            checkSame(state, expect);
+        }
+        if (frame % 2 == 0)
+        {
+            PadState expect{};
+            PadState state{};
+            bool     result = false;
+            makeState(frame + 100, 0, expect);
+            CHECK(InputRecord::replay(InputRecord::Call::LatestPad, 0, state, result));
+            checkSame(state, expect);
+        }
+        CHECK(!InputRecord::isFinished());
+    }
+    CHECK(InputRecord::getFrameCount() == FrameCount);
+    // 最後まで読んだら終わり
+    InputRecord::beginFrame();
+    CHECK(InputRecord::isFinished());
+    CHECK(InputRecord::getFrameCount() == FrameCount);
+    InputRecord::stop();
+    std::remove(path.c_str());
+}
+
+//
+// 呼び出しの並びが記録と違ったらそこで終わり、以降はパッドが無い扱い
+//
+void
+testDivergence()
+{
+    const auto path = tempPath("test_inputrecord");
+    CHECK(InputRecord::startRecording(path.c_str()));
+    recordFrames();
+    InputRecord::stop();
+
+    CHECK(InputRecord::startReplay(path.c_str()));
+    InputRecord::beginFrame();
+    PadState state{};
+    bool     result = true;
+    CHECK(InputRecord::replay(InputRecord::Call::Pad, 0, state, result));
+    CHECK(result && !InputRecord::isFinished());
+    // 記録ではパッド 2 を読んでいる
+    CHECK(InputRecord::replay(InputRecord::Call::Pad, 1, state, result));
+    CHECK(InputRecord::isFinished());
+    CHECK(!result && !state.enabled_);
+    // 以降は読み進めない
+    CHECK(InputRecord::replay(InputRecord::Call::Pad, 2, state, result));
+    CHECK(!result);
+    InputRecord::stop();
+    CHECK(!InputRecord::isFinished());
+
+    // 記録していない時と再生していない時は何もしない
+    CHECK(!InputRecord::replay(InputRecord::Call::Pad, 0, state, result));
+    std::remove(path.c_str());
+}
+
+//
+// ヘッダが違うか短いファイルは再生しない
+//
+void
+testBadHeader()
+{
+    const auto path  = tempPath("test_inputrecord_bad");
+    auto       write = [&](const void* data, size_t bytes)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        CHECK(file != nullptr);
+        CHECK(std::fwrite(data, 1, bytes, file) == bytes);
+        std::fclose(file);
+    };
+
+    const InputRecord::FileHeader wrongMagic{InputRecord::Magic + 1, InputRecord::Version};
+    write(&wrongMagic, sizeof(wrongMagic));
+    CHECK(!InputRecord::startReplay(path.c_str()));
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Off);
+
+    const InputRecord::FileHeader wrongVersion{InputRecord::Magic, InputRecord::Version + 1};
+    write(&wrongVersion, sizeof(wrongVersion));
+    CHECK(!InputRecord::startReplay(path.c_str()));
+
+    write(&InputRecord::Magic, 2);
+    CHECK(!InputRecord::startReplay(path.c_str()));
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Off);
+
+    CHECK(!InputRecord::startReplay("/nonexistent/input.rec"));
+    std::remove(path.c_str());
+}
+
+//
+// 書けなくなったら記録をやめる
+//
+void
+testWriteFailure()
+{
+    if (access("/dev/full", W_OK) != 0)
+    {
+        return;
+    }
+    CHECK(InputRecord::startRecording("/dev/full"));
+    PadState state{};
+    makeState(11, 0, state);
+    for (int frame = 0; frame < 10000 && InputRecord::getMode() == InputRecord::Mode::Record; frame++)
+    {
+        InputRecord::beginFrame();
+        state.leftX = float(frame);
+        InputRecord::record(InputRecord::Call::Pad, 0, state, true);
+    }
+    CHECK(InputRecord::getMode() == InputRecord::Mode::Off);
+    InputRecord::stop();
+}
+
+} // namespace
+
+int
+main()
+{
+    testRoundTrip();
+    testDivergence();
+    testBadHeader();
+    testWriteFailure();
+    return 0;
+}
+
+//
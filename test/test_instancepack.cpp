@@ -0,0 +1,139 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "instancepack.h"
+#include "packing.h"
+#include <cfenv>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+//
+struct Input
+{
+    std::vector<float> rotation;
+    std::vector<float> translation;
+    std::vector<float> scale;
+    std::vector<float> color;
+
+    explicit Input(size_t count) : rotation(count * 4), translation(count * 4), scale(count * 4), color(count * 4)
+    {
+        std::mt19937                          rng{uint32_t(count)};
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (size_t i = 0; i < count; i++)
+        {
+            float q[4];
+            float len = 0.0f;
+            for (auto& e : q)
+            {
+                e = unit(rng);
+                len += e * e;
+            }
+            for (int e = 0; e < 4; e++)
+            {
+                rotation[i * 4 + e]    = q[e] / std::sqrt(len);
+                translation[i * 4 + e] = unit(rng) * 1000.0f;
+                scale[i * 4 + e]       = std::abs(unit(rng)) * 8.0f;
+                color[i * 4 + e]       = unit(rng) * 0.75f + 0.5f; // 範囲外も混ぜる
+            }
+        }
+    }
+};
+
+//
+void
+checkInstance(const Input& in, size_t src, const CompactInstanceData& out)
+{
+    for (int e = 0; e < 4; e++)
+    {
+        CHECK(out.rotation[e] == Packing::packSNorm16(in.rotation[src * 4 + e]));
+        CHECK(uint8_t(out.color >> (e * 8)) == uint8_t(Packing::packUNorm4x8(in.color[src * 4 + e], 0, 0, 0)));
+    }
+    for (int e = 0; e < 3; e++)
+    {
+        CHECK(out.translation[e] == in.translation[src * 4 + e]);
+        CHECK(out.scale[e] == Packing::packHalf(in.scale[src * 4 + e]));
+    }
+    CHECK(out.padding == 0);
+}
+
+//
+// ブロックの大きさで割り切れない数でも、order の順に全て詰める
+//
+void
+testPackOrder()
+{
+    for (size_t count : {1, 63, 64, 65, 1000})
+    {
+        const Input           in(count);
+        std::vector<uint32_t> order(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            order[i] = uint32_t((i * 7919) % count);
+        }
+        std::vector<CompactInstanceData> out(count + 1);
+        out[count].padding = 0xabcd; // 後ろは書かない
+        InstancePack::pack(in.rotation.data(), in.translation.data(), in.scale.data(), in.color.data(), order.data(), count,
+                           out.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            checkInstance(in, order[i], out[i]);
+        }
+        CHECK(out[count].padding == 0xabcd);
+
+        InstancePack::pack(in.rotation.data(), in.translation.data(), in.scale.data(), in.color.data(), nullptr, count,
+                           out.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            checkInstance(in, i, out[i]);
+        }
+    }
+}
+
+// スタックを NaN で埋める(pack の作業領域が前の値を読んでいたら FE_INVALID が立つ)
+__attribute__((noinline)) void
+dirtyStack()
+{
+    volatile float fill[16384];
+    for (auto& f : fill)
+    {
+        f = std::numeric_limits<float>::quiet_NaN();
+    }
+}
+
+//
+// 最後の半端なブロックは書いた分だけ変換する
+//
+void
+testPartialBlock()
+{
+    for (size_t count : {1, 37, 64 + 5, 64 * 3 - 1})
+    {
+        const Input                      in(count);
+        std::vector<CompactInstanceData> out(count);
+        dirtyStack();
+        std::feclearexcept(FE_ALL_EXCEPT);
+        InstancePack::pack(in.rotation.data(), in.translation.data(), in.scale.data(), in.color.data(), nullptr, count,
+                           out.data());
+        CHECK(!std::fetestexcept(FE_INVALID));
+        for (size_t i = 0; i < count; i++)
+        {
+            checkInstance(in, i, out[i]);
+        }
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    testPackOrder();
+    testPartialBlock();
+    return 0;
+}
+
+//
@@ -0,0 +1,189 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// memtrack.cpp の集計と memtrack_new.cpp の operator new の置き換え
+//
+#include "check.h"
+#include "memtrack.h"
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using MemTrack::Category;
+using MemTrack::Kind;
+
+//
+MemTrack::Stats
+heap(Category category)
+{
+    return MemTrack::getStats(Kind::Heap, category);
+}
+
+//
+// 確保したカテゴリに記録され、解放で使用中が戻る(Scope は入れ子にできる)
+//
+void
+testScope()
+{
+    const auto general = heap(Category::General);
+    const auto vertex  = heap(Category::Vertex);
+    void*      a       = nullptr;
+    void*      b       = nullptr;
+    {
+        MemTrack::Scope scope(Category::Vertex);
+        a = ::operator new(1000);
+        {
+            MemTrack::Scope inner(Category::Text);
+            CHECK(MemTrack::getScope() == Category::Text);
+        }
+        CHECK(MemTrack::getScope() == Category::Vertex);
+    }
+    b = ::operator new(24);
+    CHECK(heap(Category::Vertex).liveBytes == vertex.liveBytes + 1000);
+    CHECK(heap(Category::Vertex).allocCount == vertex.allocCount + 1);
+    CHECK(heap(Category::General).liveBytes == general.liveBytes + 24);
+
+    // 解放はスコープに関係なく確保したカテゴリから引く
+    ::operator delete(a);
+    ::operator delete(b);
+    CHECK(heap(Category::Vertex).liveBytes == vertex.liveBytes);
+    CHECK(heap(Category::Vertex).freeCount == vertex.freeCount + 1);
+    CHECK(heap(Category::Vertex).peakBytes >= vertex.liveBytes + 1000);
+    CHECK(heap(Category::General).liveBytes == general.liveBytes);
+}
+
+//
+// 境界を指定した確保
+//
+void
+testAligned()
+{
+    const auto before = heap(Category::General);
+    for (size_t align : {32, 64, 256, 4096})
+    {
+        void* p = ::operator new(100, std::align_val_t(align));
+        CHECK(reinterpret_cast<uintptr_t>(p) % align == 0);
+        CHECK(heap(Category::General).liveBytes == before.liveBytes + 100);
+        ::operator delete(p, std::align_val_t(align));
+    }
+    CHECK(heap(Category::General).liveBytes == before.liveBytes);
+}
+
+//
+// ヘッダを足すと溢れる大きさは確保できない(サイズが回り込まない)
+//
+void
+testOverflow()
+{
+    volatile size_t huge   = SIZE_MAX; // 定数だとコンパイラが警告する
+    const auto      before = MemTrack::getTotal(Kind::Heap);
+    bool            thrown = false;
+    try
+    {
+        void* p = ::operator new(huge);
+        ::operator delete(p);
+    }
+    catch (const std::bad_alloc&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(::operator new(huge - 8, std::nothrow) == nullptr);
+    CHECK(::operator new(huge, std::align_val_t(4096), std::nothrow) == nullptr);
+    CHECK(MemTrack::getTotal(Kind::Heap).allocCount == before.allocCount);
+}
+
+//
+// beginFrame で直前のフレームの確保回数が決まる
+//
+void
+testFrame()
+{
+    MemTrack::beginFrame();
+    std::vector<void*> blocks;
+    blocks.reserve(10);
+    MemTrack::beginFrame();
+    for (int i = 0; i < 10; i++)
+    {
+        blocks.push_back(::operator new(16));
+    }
+    MemTrack::beginFrame();
+    CHECK(MemTrack::getTotal(Kind::Heap).frameAllocCount == 10);
+    for (auto* p : blocks)
+    {
+        ::operator delete(p);
+    }
+    MemTrack::beginFrame();
+    CHECK(MemTrack::getTotal(Kind::Heap).frameAllocCount == 0);
+}
+
+//
+// 複数スレッドから確保/解放しても数が合う
+//
+void
+testThreads()
+{
+    constexpr int Threads = 4;
+    constexpr int Count   = 20000;
+
+    std::vector<std::thread> threads;
+    threads.reserve(Threads);
+    const auto before = heap(Category::Instance);
+    for (int t = 0; t < Threads; t++)
+    {
+        threads.emplace_back(
+            []
+            {
+                MemTrack::Scope scope(Category::Instance);
+                for (int i = 0; i < Count; i++)
+                {
+                    ::operator delete(::operator new(size_t(8 + i % 64)));
+                }
+            });
+    }
+    for (auto& th : threads)
+    {
+        th.join();
+    }
+    const auto after = heap(Category::Instance);
+    CHECK(after.allocCount == before.allocCount + Threads * Count);
+    CHECK(after.freeCount == before.freeCount + Threads * Count);
+    CHECK(after.liveBytes == before.liveBytes);
+}
+
+//
+// GPU は呼び出し側が記録する(ヒープとは別に集計)
+//
+void
+testGpu()
+{
+    MemTrack::recordAlloc(Kind::Gpu, Category::Texture, 4096);
+    CHECK(MemTrack::getStats(Kind::Gpu, Category::Texture).liveBytes == 4096);
+    CHECK(MemTrack::getTotal(Kind::Gpu).liveBytes == 4096);
+    MemTrack::recordFree(Kind::Gpu, Category::Texture, 4096);
+    CHECK(MemTrack::getTotal(Kind::Gpu).liveBytes == 0);
+    CHECK(MemTrack::getTotal(Kind::Gpu).peakBytes == 4096);
+    CHECK(MemTrack::getStats(Kind::Heap, Category::Texture).liveBytes == 0);
+
+    MemTrack::reset();
+    CHECK(MemTrack::getTotal(Kind::Gpu).peakBytes == 0);
+}
+
+} // namespace
+
+int
+main()
+{
+    testScope();
+    testAligned();
+    testOverflow();
+    testFrame();
+    testThreads();
+    testGpu();
+    return 0;
+}
+
+//
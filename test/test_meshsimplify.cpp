@@ -0,0 +1,242 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "meshsimplify.h"
+#include "primitivemesh.h"
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace
+{
+//
+template <size_t NV, size_t NI>
+MeshSimplify::VertexStream
+makeStream(const PrimitiveMesh::Mesh<NV, NI>& mesh)
+{
+    MeshSimplify::VertexStream vs;
+    vs.position = mesh.vertices[0].position;
+    vs.normal   = mesh.vertices[0].normal;
+    vs.texcoord = mesh.vertices[0].texcoord;
+    vs.stride   = sizeof(PrimitiveMesh::MeshVertex);
+    vs.count    = NV;
+    return vs;
+}
+
+//
+template <size_t NV, size_t NI>
+std::vector<uint16_t>
+indicesOf(const PrimitiveMesh::Mesh<NV, NI>& mesh)
+{
+    return {mesh.indices.begin(), mesh.indices.end()};
+}
+
+// 1つの三角形にしか使われていない辺
+std::set<std::pair<uint16_t, uint16_t>>
+borderEdges(const std::vector<uint16_t>& indices)
+{
+    std::multiset<std::pair<uint16_t, uint16_t>> edges;
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            auto a = indices[t + e];
+            auto b = indices[t + (e + 1) % 3];
+            edges.insert({std::min(a, b), std::max(a, b)});
+        }
+    }
+    std::set<std::pair<uint16_t, uint16_t>> result;
+    for (auto& e : edges)
+    {
+        if (edges.count(e) == 1)
+        {
+            result.insert(e);
+        }
+    }
+    return result;
+}
+
+//
+void
+cross(const float* a, const float* b, const float* c, float* n)
+{
+    const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0]             = u[1] * v[2] - u[2] * v[1];
+    n[1]             = u[2] * v[0] - u[0] * v[2];
+    n[2]             = u[0] * v[1] - u[1] * v[0];
+}
+
+//
+// 平らなグリッドは誤差なしで目標まで減り、外周は残る
+//
+void
+testFlatGrid()
+{
+    static const auto grid = PrimitiveMesh::makeGrid<16, 16>();
+    const auto        vs   = makeStream(grid);
+    const auto        src  = indicesOf(grid);
+
+    MeshSimplify::Option opt;
+    opt.normalWeight = 0.0f;
+    opt.uvWeight     = 0.0f;
+    std::vector<uint16_t> result;
+    const float           error = MeshSimplify::simplify(vs, src, result, opt);
+
+    CHECK(result.size() % 3 == 0);
+    CHECK(result.size() / 3 <= src.size() / 3 / 2);
+    CHECK(result.size() / 3 >= 16 * 4); // 外周の 64 頂点は残るので
+    CHECK(error < 1e-4f);
+
+    // 外周の辺は全て残る(内側の頂点だけを寄せる)
+    CHECK(borderEdges(result) == borderEdges(src));
+    for (size_t t = 0; t < result.size(); t += 3)
+    {
+        CHECK(result[t] < grid.vertices.size() && result[t + 1] < grid.vertices.size() && result[t + 2] < grid.vertices.size());
+        float n[3];
+        cross(grid.vertices[result[t]].position, grid.vertices[result[t + 1]].position, grid.vertices[result[t + 2]].position,
+              n);
+        CHECK(n[1] > 0.0f); // 裏返った三角形は無い
+    }
+}
+
+//
+// lockBorder を外せば外周も減らせる
+//
+void
+testUnlockedBorder()
+{
+    static const auto grid = PrimitiveMesh::makeGrid<16, 16>();
+    const auto        vs   = makeStream(grid);
+    const auto        src  = indicesOf(grid);
+
+    MeshSimplify::Option opt;
+    opt.normalWeight = 0.0f;
+    opt.uvWeight     = 0.0f;
+    opt.lockBorder   = false;
+    opt.targetRatio  = 0.1f;
+    std::vector<uint16_t> locked;
+    std::vector<uint16_t> unlocked;
+    MeshSimplify::simplify(vs, src, unlocked, opt);
+    opt.lockBorder = true;
+    MeshSimplify::simplify(vs, src, locked, opt);
+    CHECK(unlocked.size() < locked.size());
+}
+
+//
+// 曲面では許容誤差で止まり、返す誤差は許容誤差を超えない
+//
+void
+testErrorBound()
+{
+    static const auto sphere = PrimitiveMesh::makeSphere<32, 16>();
+    const auto        vs     = makeStream(sphere);
+    auto              src    = indicesOf(sphere);
+
+    MeshSimplify::Option opt;
+    opt.normalWeight = 0.0f;
+    opt.uvWeight     = 0.0f;
+    opt.targetRatio  = 0.01f;
+    for (float maxError : {0.005f, 0.02f, 0.05f})
+    {
+        opt.maxError = maxError;
+        std::vector<uint16_t> result;
+        const float           error = MeshSimplify::simplify(vs, src, result, opt);
+        CHECK(error <= maxError);
+        CHECK(result.size() < src.size());
+        CHECK(result.size() / 3 > src.size() / 3 / 100); // 誤差で止まっている
+    }
+
+    // 誤差を大きく許すほど減る
+    std::vector<uint16_t> tight;
+    std::vector<uint16_t> loose;
+    opt.maxError = 0.005f;
+    MeshSimplify::simplify(vs, src, tight, opt);
+    opt.maxError = 0.05f;
+    MeshSimplify::simplify(vs, src, loose, opt);
+    CHECK(loose.size() < tight.size());
+}
+
+//
+// 何段も簡略化しても、寄せた先の Quadric にそれまでの誤差が残るので形は大きく崩れない
+//
+void
+testChainKeepsShape()
+{
+    static const auto sphere = PrimitiveMesh::makeSphere<32, 16>();
+    const auto        vs     = makeStream(sphere);
+    auto              lod    = indicesOf(sphere);
+
+    MeshSimplify::Option opt;
+    opt.normalWeight = 0.0f;
+    opt.uvWeight     = 0.0f;
+    opt.maxError     = 0.02f;
+    for (int level = 0; level < 8; level++)
+    {
+        std::vector<uint16_t> next;
+        const float           error = MeshSimplify::simplify(vs, lod, next, opt);
+        CHECK(error <= opt.maxError);
+        if (next.size() >= lod.size())
+        {
+            break;
+        }
+        lod.swap(next);
+    }
+
+    // 残った三角形の面は元の球面(半径 0.5)から大きく離れない
+    double worst = 0.0;
+    for (size_t t = 0; t < lod.size(); t += 3)
+    {
+        const float* p[3] = {sphere.vertices[lod[t]].position, sphere.vertices[lod[t + 1]].position,
+                             sphere.vertices[lod[t + 2]].position};
+        float        c[3] = {};
+        for (auto* v : p)
+        {
+            c[0] += v[0] / 3.0f;
+            c[1] += v[1] / 3.0f;
+            c[2] += v[2] / 3.0f;
+        }
+        worst = std::max(worst, 0.5 - std::sqrt(double(c[0]) * c[0] + double(c[1]) * c[1] + double(c[2]) * c[2]));
+    }
+    std::printf("sphere 32x16: %zu -> %zu triangles, worst centroid depth %.4f\n", sphere.indices.size() / 3, lod.size() / 3,
+                worst);
+    CHECK(worst < 0.06);
+}
+
+//
+// 法線の重みがあると、形が同じでも法線の違う頂点は寄せない
+//
+void
+testAttributeWeight()
+{
+    static const auto sphere = PrimitiveMesh::makeSphere<32, 16>();
+    const auto        vs     = makeStream(sphere);
+    const auto        src    = indicesOf(sphere);
+
+    MeshSimplify::Option opt;
+    opt.maxError     = 0.05f;
+    opt.uvWeight     = 0.0f;
+    opt.normalWeight = 0.0f;
+    std::vector<uint16_t> plain;
+    MeshSimplify::simplify(vs, src, plain, opt);
+    opt.normalWeight = 1.0f;
+    std::vector<uint16_t> weighted;
+    MeshSimplify::simplify(vs, src, weighted, opt);
+    CHECK(weighted.size() > plain.size());
+}
+
+} // namespace
+
+int
+main()
+{
+    testFlatGrid();
+    testUnlockedBorder();
+    testErrorBound();
+    testChainKeepsShape();
+    testAttributeWeight();
+    return 0;
+}
+
+//
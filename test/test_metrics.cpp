@@ -0,0 +1,164 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "metricspublisher.h"
+#include <atomic>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+//
+// 書く側が止まらずに更新し続けても、読めた内容は必ずどれか1回分の書き込み
+//
+void
+testSeqlock()
+{
+    static LiveMetrics::Segment segment{};
+    constexpr uint64_t          WriteCount = 200000;
+
+    std::atomic<bool> done{false};
+    auto              writer = [&]
+    {
+        LiveMetrics::Payload payload{};
+        for (uint64_t n = 1; n <= WriteCount; n++)
+        {
+            payload.frameIndex  = n;
+            payload.timestampNs = n * 3;
+            payload.cpuUs       = n;
+            payload.drawUs      = n;
+            for (auto& c : payload.counters)
+            {
+                c = n;
+            }
+            for (auto& h : payload.histogram)
+            {
+                h = n;
+            }
+            LiveMetrics::write(segment, payload);
+        }
+        done.store(true, std::memory_order_release);
+    };
+    std::thread thread{writer};
+
+    uint64_t             reads = 0;
+    uint64_t             last  = 0;
+    LiveMetrics::Payload out;
+    while (!done.load(std::memory_order_acquire))
+    {
+        if (!LiveMetrics::read(segment, out))
+        {
+            continue;
+        }
+        const uint64_t n = out.frameIndex;
+        CHECK(n >= last);
+        CHECK(out.timestampNs == n * 3 && out.cpuUs == n && out.drawUs == n);
+        for (auto c : out.counters)
+        {
+            CHECK(c == n);
+        }
+        for (auto h : out.histogram)
+        {
+            CHECK(h == n);
+        }
+        last = n;
+        reads++;
+    }
+    thread.join();
+    CHECK(LiveMetrics::read(segment, out));
+    CHECK(out.frameIndex == WriteCount);
+    CHECK(segment.sequence.load() == WriteCount * 2);
+    std::printf("seqlock: %llu consistent reads\n", (unsigned long long)reads);
+}
+
+//
+// 書いているプロセスが生きている間は同じ名前で開けない
+//
+void
+testOpenInUse()
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "/metaltest.test.%d", int(getpid()));
+
+    MetricsPublisher first;
+    MetricsPublisher second;
+    CHECK(first.open(name));
+    CHECK(!second.open(name));
+    CHECK(first.isOpen() && !second.isOpen());
+
+    // 奪われていないので最初の方の書き込みがそのまま読める
+    first.publish(1.0f);
+    const int fd = shm_open(name, O_RDONLY, 0);
+    CHECK(fd >= 0);
+    void* addr = mmap(nullptr, sizeof(LiveMetrics::Segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    CHECK(addr != MAP_FAILED);
+    const auto&          segment = *static_cast<const LiveMetrics::Segment*>(addr);
+    LiveMetrics::Payload payload;
+    CHECK(LiveMetrics::isValid(segment));
+    CHECK(segment.writerPid == uint64_t(getpid()));
+    CHECK(LiveMetrics::read(segment, payload));
+    CHECK(payload.drawUs == 1000);
+    munmap(addr, sizeof(LiveMetrics::Segment));
+
+    first.close();
+    CHECK(second.open(name));
+    second.close();
+    CHECK(shm_open(name, O_RDONLY, 0) < 0);
+}
+
+//
+// 終了したプロセスが残したものは作り直す
+//
+void
+testOpenStale()
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "/metaltest.stale.%d", int(getpid()));
+
+    // 終わったプロセスの pid
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        _exit(0);
+    }
+    CHECK(child > 0);
+    CHECK(waitpid(child, nullptr, 0) == child);
+
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    CHECK(fd >= 0);
+    CHECK(ftruncate(fd, sizeof(LiveMetrics::Segment)) == 0);
+    void* addr = mmap(nullptr, sizeof(LiveMetrics::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    CHECK(addr != MAP_FAILED);
+    auto* stale          = new (addr) LiveMetrics::Segment;
+    stale->version       = LiveMetrics::Version;
+    stale->size          = sizeof(LiveMetrics::Segment);
+    stale->bucketCount   = LiveMetrics::BucketCount;
+    stale->writerPid     = uint64_t(child);
+    stale->magic.store(LiveMetrics::Magic);
+    CHECK(LiveMetrics::isValid(*stale));
+    munmap(addr, sizeof(LiveMetrics::Segment));
+
+    MetricsPublisher publisher;
+    CHECK(publisher.open(name));
+    publisher.close();
+}
+
+} // namespace
+
+int
+main()
+{
+    testSeqlock();
+    testOpenInUse();
+    testOpenStale();
+    return 0;
+}
+
+//
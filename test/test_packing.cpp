@@ -0,0 +1,211 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "packing.h"
+#include <random>
+
+namespace
+{
+//
+bool
+isNaNHalf(uint16_t h)
+{
+    return (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0;
+}
+
+//
+// half の全ての値は float を経由しても同じビットに戻る
+//
+void
+testHalfRoundTrip()
+{
+    for (uint32_t h = 0; h < 0x10000; h++)
+    {
+        const float f = Packing::unpackHalf(uint16_t(h));
+        if (isNaNHalf(uint16_t(h)))
+        {
+            CHECK(std::isnan(f));
+            CHECK(isNaNHalf(Packing::packHalf(f)));
+            continue;
+        }
+        CHECK(Packing::packHalf(f) == h);
+    }
+}
+
+//
+// 一番近い half に丸める(等距離なら仮数が偶数の方)
+//
+void
+testHalfRounding()
+{
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> expDist(-26.0f, 17.0f);
+    std::uniform_real_distribution<float> mantDist(1.0f, 2.0f);
+    double                                worstRel = 0.0;
+    for (int i = 0; i < 200000; i++)
+    {
+        const float    f = std::ldexp(mantDist(rng), int(expDist(rng))) * (i & 1 ? -1.0f : 1.0f);
+        const uint16_t h = Packing::packHalf(f);
+        const double   d = std::abs(double(Packing::unpackHalf(h)) - f);
+        if ((h & 0x7c00) == 0x7c00)
+        {
+            CHECK(std::abs(f) >= 65520.0f); // 65504 + 半分の刻みから inf
+            continue;
+        }
+        // 隣の値の方が近いことは無い
+        for (int step : {-1, 1})
+        {
+            const uint16_t n = uint16_t(h + step);
+            if ((n & 0x7fff) != 0x7c00 && ((n ^ h) & 0x8000) == 0 && !isNaNHalf(n))
+            {
+                const double dn = std::abs(double(Packing::unpackHalf(n)) - f);
+                CHECK(d < dn || (d == dn && (h & 1) == 0));
+            }
+        }
+        if (std::abs(f) >= 6.103515625e-05f) // 正規化数の範囲
+        {
+            worstRel = std::max(worstRel, d / std::abs(f));
+        }
+    }
+    std::printf("half: worst relative error %.3g\n", worstRel);
+    CHECK(worstRel <= std::ldexp(1.0, -11));
+
+    // 境界
+    CHECK(Packing::packHalf(0.0f) == 0x0000);
+    CHECK(Packing::packHalf(-0.0f) == 0x8000);
+    CHECK(Packing::packHalf(1.0f) == 0x3c00);
+    CHECK(Packing::packHalf(65504.0f) == 0x7bff);
+    CHECK(Packing::packHalf(1e6f) == 0x7c00);
+    CHECK(Packing::packHalf(-1e6f) == 0xfc00);
+    CHECK(Packing::packHalf(std::ldexp(1.0f, -24)) == 0x0001); // 最小の非正規化数
+    CHECK(Packing::packHalf(std::ldexp(1.0f, -26)) == 0x0000);
+    CHECK(Packing::packHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00); // 等距離は偶数へ
+    CHECK(Packing::packHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+}
+
+//
+// unorm16 / snorm16 の誤差は半刻みまで、範囲外は端に寄せる
+//
+void
+testNorm16()
+{
+    for (int i = 0; i <= 100000; i++)
+    {
+        const float u = float(i) / 100000.0f;
+        CHECK_NEAR(Packing::packUNorm16(u) / 65535.0f, u, 0.5 / 65535.0 + 1e-7);
+        const float s = u * 2.0f - 1.0f;
+        CHECK_NEAR(Packing::packSNorm16(s) / 32767.0f, s, 0.5 / 32767.0 + 1e-7);
+    }
+    CHECK(Packing::packUNorm16(-1.0f) == 0);
+    CHECK(Packing::packUNorm16(2.0f) == 65535);
+    CHECK(Packing::packSNorm16(-2.0f) == -32767);
+    CHECK(Packing::packSNorm16(2.0f) == 32767);
+    CHECK(Packing::packSNorm16(0.0f) == 0);
+}
+
+//
+// AABB に対する位置の量子化(Vertex::build の Compact)は extent / 131070 以内、端はそのまま戻る
+//
+void
+testPositionQuantize()
+{
+    std::mt19937                          rng(2);
+    std::uniform_real_distribution<float> dist(-37.0f, 91.0f);
+    const float                           bmin  = -37.0f;
+    const float                           ext   = 128.0f;
+    double                                worst = 0.0;
+    for (int i = 0; i < 100000; i++)
+    {
+        const float    p = dist(rng);
+        const uint16_t q = Packing::packPosition(p, bmin, ext);
+        worst            = std::max(worst, std::abs(double(Packing::unpackPosition(q, bmin, ext)) - p));
+    }
+    std::printf("position: worst error %.3g (extent %g)\n", worst, ext);
+    CHECK(worst <= ext / 131070.0 * 1.01);
+
+    CHECK(Packing::packPosition(bmin, bmin, ext) == 0);
+    CHECK(Packing::packPosition(bmin + ext, bmin, ext) == 65535);
+    CHECK(Packing::unpackPosition(0, bmin, ext) == bmin);
+    CHECK(Packing::unpackPosition(65535, bmin, ext) == bmin + ext);
+    // AABB の外は端に寄せる
+    CHECK(Packing::packPosition(bmin - 1.0f, bmin, ext) == 0);
+    CHECK(Packing::packPosition(bmin + ext + 1.0f, bmin, ext) == 65535);
+    // 平らなメッシュの厚みの無い軸
+    CHECK(Packing::packPosition(3.0f, 3.0f, 0.0f) == 0);
+    CHECK(Packing::unpackPosition(0, 3.0f, 0.0f) == 3.0f);
+}
+
+//
+// 八面体の法線は全方向で 0.01 度以内、軸はそのまま戻る
+//
+void
+testOctNormal()
+{
+    auto roundTrip = [](float x, float y, float z, float out[3])
+    {
+        int16_t e[2];
+        Packing::packOctNormal(x, y, z, e);
+        Packing::unpackOctNormal(e, out);
+    };
+
+    const float axes[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (auto& a : axes)
+    {
+        float n[3];
+        roundTrip(a[0], a[1], a[2], n);
+        CHECK_NEAR(n[0], a[0], 1e-4);
+        CHECK_NEAR(n[1], a[1], 1e-4);
+        CHECK_NEAR(n[2], a[2], 1e-4);
+    }
+
+    std::mt19937                    rng(3);
+    std::normal_distribution<float> dist;
+    double                          worst = 0.0;
+    for (int i = 0; i < 200000; i++)
+    {
+        float       x = dist(rng), y = dist(rng), z = dist(rng);
+        const float l = std::sqrt(x * x + y * y + z * z);
+        x /= l;
+        y /= l;
+        z /= l;
+        float n[3];
+        roundTrip(x, y, z, n);
+        CHECK_NEAR(n[0] * n[0] + n[1] * n[1] + n[2] * n[2], 1.0, 1e-5);
+        // acos は 1 の近くで float の丸めを拡大するので atan2(|a x b|, a . b) で測る
+        const double cx = double(y) * n[2] - double(z) * n[1];
+        const double cy = double(z) * n[0] - double(x) * n[2];
+        const double cz = double(x) * n[1] - double(y) * n[0];
+        const double c  = double(x) * n[0] + double(y) * n[1] + double(z) * n[2];
+        worst           = std::max(worst, std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), c) * 180.0 / M_PI);
+    }
+    std::printf("oct normal: worst error %.4f deg\n", worst);
+    CHECK(worst < 0.01);
+}
+
+//
+// RGBA8 は r が下位バイト
+//
+void
+testUNorm4x8()
+{
+    CHECK(Packing::packUNorm4x8(1.0f, 0.0f, 0.0f, 0.0f) == 0x000000ffu);
+    CHECK(Packing::packUNorm4x8(0.0f, 0.0f, 0.0f, 1.0f) == 0xff000000u);
+    CHECK(Packing::packUNorm4x8(0.5f, 2.0f, -1.0f, 0.25f) == 0x4000ff80u);
+}
+
+} // namespace
+
+int
+main()
+{
+    testHalfRoundTrip();
+    testHalfRounding();
+    testNorm16();
+    testPositionQuantize();
+    testOctNormal();
+    testUNorm4x8();
+    return 0;
+}
+
+//
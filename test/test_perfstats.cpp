@@ -0,0 +1,144 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "perfstats.h"
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+//
+// nearest-rank: 小さい方から ceil(p * count) 番目
+//
+void
+testPercentile()
+{
+    float values[100];
+    for (int i = 0; i < 100; i++)
+    {
+        values[i] = float(100 - i);
+    }
+    CHECK(PerfStats::percentile(values, 100, 0.50f) == 50.0f);
+    CHECK(PerfStats::percentile(values, 100, 0.95f) == 95.0f);
+    // 0.99f * 100 は 99.0000... なので 100 番目にならない
+    CHECK(PerfStats::percentile(values, 100, 0.99f) == 99.0f);
+    CHECK(PerfStats::percentile(values, 100, 1.0f) == 100.0f);
+    CHECK(PerfStats::percentile(values, 100, 0.0f) == 1.0f);
+    CHECK(PerfStats::percentile(values, 100, 2.0f) == 100.0f);
+    CHECK(PerfStats::percentile(values, 0, 0.5f) == 0.0f);
+
+    float three[] = {3.0f, 1.0f, 2.0f};
+    CHECK(PerfStats::percentile(three, 3, 0.5f) == 2.0f);
+    CHECK(PerfStats::percentile(three, 3, 0.34f) == 2.0f);
+    CHECK(PerfStats::percentile(three, 3, 0.33f) == 1.0f);
+}
+
+//
+// 履歴は HistorySize で一周して古いものから上書きされる
+//
+void
+testRingWrap()
+{
+    PerfStats::reset();
+    CHECK(PerfStats::getSummary().frameCount == 0);
+    CHECK(PerfStats::getFrame(0).cpuMs == 0.0f);
+
+    const size_t total = PerfStats::HistorySize + 10;
+    for (size_t i = 0; i < total; i++)
+    {
+        PerfStats::add(PerfStats::Counter::DrawCalls, i);
+        PerfStats::endFrame(float(i), 1.0f, 2.0f);
+    }
+    CHECK(PerfStats::getFrameIndex() == total);
+    CHECK(PerfStats::getFrame(0).cpuMs == float(total - 1));
+    CHECK(PerfStats::getFrame(0).counters[size_t(PerfStats::Counter::DrawCalls)] == total - 1);
+    CHECK(PerfStats::getFrame(PerfStats::HistorySize - 1).cpuMs == 10.0f);
+    CHECK(PerfStats::getFrame(PerfStats::HistorySize).cpuMs == 0.0f);
+
+    float  times[PerfStats::HistorySize + 1];
+    size_t count = PerfStats::copyFrameTimes(times, PerfStats::HistorySize + 1);
+    CHECK(count == PerfStats::HistorySize);
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(times[i] == float(10 + i));
+    }
+    count = PerfStats::copyFrameTimes(times, 4);
+    CHECK(count == 4 && times[0] == float(total - 4) && times[3] == float(total - 1));
+
+    // 集計は残っている HistorySize フレーム分(10..249)
+    const auto summary = PerfStats::getSummary();
+    CHECK(summary.frameCount == PerfStats::HistorySize);
+    CHECK(summary.cpuMin == 10.0f);
+    CHECK(summary.cpuMax == float(total - 1));
+    CHECK_NEAR(summary.cpuAvg, (10.0 + double(total - 1)) * 0.5, 1e-3);
+    CHECK(summary.cpuP50 == 10.0f + 119.0f);
+    CHECK(summary.waitMax == 1.0f && summary.latencyAvg == 2.0f);
+    CHECK(summary.last.cpuMs == float(total - 1));
+
+    PerfStats::reset();
+    CHECK(PerfStats::getFrameIndex() == 0);
+    CHECK(PerfStats::getFrame(0).cpuMs == 0.0f);
+}
+
+//
+// 加算は複数のスレッドから同時にしても落ちない
+//
+void
+testConcurrentAdd()
+{
+    PerfStats::reset();
+    constexpr int ThreadCount = 4;
+    constexpr int DrawCount   = 100000;
+
+    auto worker = []
+    {
+        for (int i = 0; i < DrawCount; i++)
+        {
+            PerfStats::addDraw(3, 6, 2);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < ThreadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    const uint64_t draws = uint64_t(ThreadCount) * DrawCount;
+    CHECK(PerfStats::getCurrent(PerfStats::Counter::DrawCalls) == draws);
+    CHECK(PerfStats::getCurrent(PerfStats::Counter::Vertices) == draws * 6);
+    CHECK(PerfStats::getCurrent(PerfStats::Counter::Indices) == draws * 12);
+    CHECK(PerfStats::getCurrent(PerfStats::Counter::Instances) == draws * 2);
+
+    PerfStats::endFrame(1.0f, 0.0f);
+    const auto frame = PerfStats::getFrame(0);
+    CHECK(frame.counters[size_t(PerfStats::Counter::DrawCalls)] == draws);
+    CHECK(PerfStats::getCurrent(PerfStats::Counter::DrawCalls) == 0);
+}
+
+//
+void
+testCounterName()
+{
+    CHECK(std::string_view{PerfStats::getCounterName(PerfStats::Counter::DrawCalls)} == "draw calls");
+    CHECK(std::string_view{PerfStats::getCounterName(PerfStats::Counter::TextRasterized)} == "text");
+    CHECK(std::string_view{PerfStats::getCounterName(PerfStats::Counter::Count)} == "unknown");
+}
+
+} // namespace
+
+int
+main()
+{
+    testPercentile();
+    testRingWrap();
+    testConcurrentAdd();
+    testCounterName();
+    return 0;
+}
+
+//
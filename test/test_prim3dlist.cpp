@@ -0,0 +1,315 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "prim3dlist.h"
+#include <matrix.h>
+#include <vector>
+
+namespace
+{
+using Geometry     = Prim3DList::Geometry;
+using GeometryDraw = Prim3DList::GeometryDraw;
+
+// Simple3D::render と同じ順に1フレーム分を数える(転送したバイト数を返す)
+struct Frame
+{
+    size_t                                  immediate = 0;
+    size_t                                  retained  = 0;
+    std::vector<Prim3DList::GeometryHandle> uploaded;
+    std::vector<Prim3DList::GeometryHandle> drawn;
+
+    size_t total() const { return immediate + retained; }
+};
+
+Frame
+render(Prim3DList& list)
+{
+    Frame frame;
+    list.flushTransform();
+    frame.retained = list.forEachGeometryDraw(
+        [&](const GeometryDraw& draw, Geometry& geom, bool upload)
+        {
+            if (upload)
+            {
+                frame.uploaded.push_back(draw.handle);
+            }
+            frame.drawn.push_back(draw.handle);
+            CHECK(!geom.dirty);
+        });
+    frame.immediate = list.getImmediateBytes();
+    return frame;
+}
+
+// 1 x 1 の四角を n x n 並べた床(線)と、その上の板(三角形)
+void
+drawScenery(Prim3DList& list, int n)
+{
+    for (int z = 0; z < n; z++)
+    {
+        for (int x = 0; x < n; x++)
+        {
+            const float fx = float(x);
+            const float fz = float(z);
+            list.drawRect(simd_make_float3(fx, 0, fz), simd_make_float3(fx + 1, 0, fz), simd_make_float3(fx + 1, 0, fz + 1),
+                          simd_make_float3(fx, 0, fz + 1));
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        const float y = float(i) * 0.1f;
+        list.drawPlane(simd_make_float3(0, y, 0), simd_make_float3(1, y, 0), simd_make_float3(1, y, 1),
+                       simd_make_float3(0, y, 1));
+    }
+}
+
+//
+// 記録し直した時だけ転送が要る
+// (記録中の描画、破棄したハンドル、同じフレームの2回目は転送しない)
+//
+void
+testDirtyTracking()
+{
+    Prim3DList list;
+    const auto floor = list.createGeometry();
+    const auto other = list.createGeometry();
+    CHECK(list.beginGeometry(floor));
+    drawScenery(list, 2);
+    list.endGeometry();
+
+    // 最初のフレームだけ転送、2回描いても1回
+    list.drawGeometry(floor, math::makeIdentity());
+    list.drawGeometry(floor, math::makeTranslate(simd_make_float3(5, 0, 0)));
+    auto frame = render(list);
+    CHECK(frame.uploaded.size() == 1 && frame.uploaded[0] == floor);
+    CHECK(frame.drawn.size() == 2);
+    const size_t floorBytes = frame.retained;
+    CHECK(floorBytes > 0);
+
+    // 変更が無ければ転送しない
+    for (int i = 0; i < 3; i++)
+    {
+        list.clear();
+        list.drawGeometry(floor, math::makeIdentity());
+        frame = render(list);
+        CHECK(frame.uploaded.empty() && frame.drawn.size() == 1 && frame.retained == 0);
+    }
+
+    // 記録し直すと転送、記録中のハンドルは描かない
+    list.clear();
+    CHECK(list.beginGeometry(other));
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0));
+    list.drawGeometry(other, math::makeIdentity());
+    list.drawGeometry(floor, math::makeIdentity());
+    frame = render(list);
+    CHECK(frame.drawn.size() == 1 && frame.drawn[0] == floor && frame.uploaded.empty());
+    list.endGeometry();
+    list.clear();
+    list.drawGeometry(other, math::makeIdentity());
+    frame = render(list);
+    CHECK(frame.uploaded.size() == 1 && frame.uploaded[0] == other);
+    CHECK(frame.retained == 2 * sizeof(Prim3DList::Vertex) + 2 * sizeof(uint32_t));
+
+    // 中身を変えても同じ量なら同じバイト数を転送し直す
+    CHECK(list.beginGeometry(floor));
+    drawScenery(list, 2);
+    list.endGeometry();
+    list.clear();
+    list.drawGeometry(floor, math::makeIdentity());
+    frame = render(list);
+    CHECK(frame.uploaded.size() == 1 && frame.retained == floorBytes);
+
+    // 破棄したハンドルは飛ばす
+    list.clear();
+    CHECK(list.destroyGeometry(floor) == nullptr);
+    list.drawGeometry(floor, math::makeIdentity());
+    frame = render(list);
+    CHECK(frame.drawn.empty() && frame.retained == 0);
+}
+
+//
+// 破棄したハンドルは記録にも描画にも使えない
+// 同じ番号を再利用したハンドルは世代が上がっていて、古いハンドルでは引けない
+//
+void
+testHandleLifecycle()
+{
+    using Slots = SlotMap<std::unique_ptr<Geometry>>;
+
+    Prim3DList list;
+    CHECK(!list.beginGeometry(Prim3DList::InvalidGeometry));
+    const auto stale = list.createGeometry();
+    CHECK(stale != Prim3DList::InvalidGeometry);
+    CHECK(list.beginGeometry(stale));
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0));
+    list.endGeometry();
+
+    // 破棄すると作ったバッファを返す(解放は Simple3D)
+    auto* fakeBuffer                 = reinterpret_cast<MTL::Buffer*>(&list);
+    list.findGeometry(stale)->buffer = fakeBuffer;
+    CHECK(list.destroyGeometry(stale) == fakeBuffer);
+    CHECK(list.destroyGeometry(stale) == nullptr);
+    CHECK(list.findGeometry(stale) == nullptr);
+    CHECK(!list.beginGeometry(stale));
+    list.drawGeometry(stale, math::makeIdentity());
+    CHECK(render(list).drawn.empty());
+
+    // 再利用: 番号は同じで世代が 1 つ上
+    const auto reused = list.createGeometry();
+    CHECK(reused != stale);
+    CHECK((reused & Slots::IndexMask) == (stale & Slots::IndexMask));
+    CHECK((reused >> Slots::IndexBits) == (stale >> Slots::IndexBits) + 1);
+    CHECK(list.findGeometry(stale) == nullptr);
+    CHECK(!list.beginGeometry(stale));
+    CHECK(list.destroyGeometry(stale) == nullptr);
+
+    // 新しいハンドルは空の状態から使える(古い中身は残っていない)
+    auto* geom = list.findGeometry(reused);
+    CHECK(geom != nullptr && geom->dirty && geom->lines.empty() && geom->buffer == nullptr);
+    list.clear();
+    list.drawGeometry(stale, math::makeIdentity());
+    list.drawGeometry(reused, math::makeIdentity());
+    const auto frame = render(list);
+    CHECK(frame.drawn.size() == 1 && frame.drawn[0] == reused);
+
+    // 記録中に破棄すると記録は終わり、以降の描画は毎フレームのバッチに入る
+    CHECK(list.beginGeometry(reused));
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0));
+    CHECK(list.getLines().empty());
+    CHECK(list.destroyGeometry(reused) == nullptr);
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0));
+    CHECK(list.getLines().getVertexCount() == 2);
+    CHECK(!list.beginGeometry(reused));
+
+    // 別のハンドルを破棄しても記録は続く
+    const auto a = list.createGeometry();
+    const auto b = list.createGeometry();
+    CHECK((a >> Slots::IndexBits) == (reused >> Slots::IndexBits) + 1);
+    CHECK(list.beginGeometry(a));
+    list.destroyGeometry(b);
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0));
+    list.endGeometry();
+    CHECK(list.getLines().getVertexCount() == 2);
+    CHECK(list.findGeometry(a)->lines.getVertexCount() == 2);
+}
+
+//
+// バッファの配置: 線の後ろの 16 バイト境界から三角形
+//
+void
+testLayout()
+{
+    Prim3DList list;
+    const auto handle = list.createGeometry();
+    CHECK(list.beginGeometry(handle));
+    // 線 3 本(6頂点 + 6インデックス = 120 バイト)と三角形 1 枚(3頂点 + 3インデックス = 60 バイト)
+    for (int i = 0; i < 3; i++)
+    {
+        list.drawLine(simd_make_float3(0, float(i), 0), simd_make_float3(1, float(i), 0));
+    }
+    list.drawTriangle(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0), simd_make_float3(0, 1, 0));
+    list.endGeometry();
+    list.drawGeometry(handle, math::makeIdentity());
+    render(list);
+    const auto* geom = list.findGeometry(handle);
+    CHECK(geom != nullptr);
+    CHECK(geom->lines.getBytes() == 120 && geom->triangles.getBytes() == 60);
+    CHECK(geom->triangleOffset == 128 && geom->bytes == 188);
+
+    // 三角形だけなら先頭から
+    CHECK(list.beginGeometry(handle));
+    list.drawTriangle(simd_make_float3(0, 0, 0), simd_make_float3(1, 0, 0), simd_make_float3(0, 1, 0));
+    list.endGeometry();
+    CHECK(geom->dirty);
+    list.clear();
+    list.drawGeometry(handle, math::makeIdentity());
+    CHECK(render(list).retained == 60);
+    CHECK(geom->triangleOffset == 0 && geom->bytes == 60);
+}
+
+//
+// 毎フレーム追加し直す場合と保持する場合の転送量
+//
+void
+testUploadBytes()
+{
+    constexpr int Frames = 60;
+    constexpr int Size   = 32;
+
+    Prim3DList immediate;
+    size_t     immediateBytes = 0;
+    for (int i = 0; i < Frames; i++)
+    {
+        immediate.clear();
+        drawScenery(immediate, Size);
+        immediateBytes += render(immediate).total();
+    }
+
+    Prim3DList retained;
+    const auto handle = retained.createGeometry();
+    CHECK(retained.beginGeometry(handle));
+    drawScenery(retained, Size);
+    retained.endGeometry();
+    size_t firstBytes    = 0;
+    size_t retainedBytes = 0;
+    for (int i = 0; i < Frames; i++)
+    {
+        retained.clear();
+        retained.drawGeometry(handle, math::makeYRotate(float(i) * 0.01f));
+        const size_t bytes = render(retained).total();
+        firstBytes         = i == 0 ? bytes : firstBytes;
+        retainedBytes += bytes;
+    }
+    std::printf("%d frames of %d rects + %d planes: immediate %zu bytes/frame, retained %zu bytes once then 0\n", Frames,
+                Size * Size, Size, immediateBytes / Frames, firstBytes);
+    CHECK(immediateBytes == firstBytes * Frames);
+    CHECK(retainedBytes == firstBytes);
+}
+
+//
+// RenderQueue のキーに使う距離: 視点(z = 10 から -z 向き)からの -z で、一番手前のもの
+//
+void
+testDrawDepth()
+{
+    Prim3DList list;
+    list.setViewMatrix(math::makeTranslate(simd_make_float3(0, 0, -10)));
+    CHECK(list.getNearestDepth(list.getLines()) == 0.0f);
+    CHECK(list.getNearestDepth(DebugShape::Shape::Box) == 0.0f);
+
+    list.drawLine(simd_make_float3(0, 0, 0), simd_make_float3(5, 0, -20));
+    list.drawLine(simd_make_float3(1, 2, 2), simd_make_float3(0, 0, -3));
+    list.drawTriangle(simd_make_float3(0, 0, 12), simd_make_float3(1, 0, 12), simd_make_float3(0, 1, 12));
+    // 変換は flush してから測る
+    list.setTransform(math::makeTranslate(simd_make_float3(0, 0, -5)));
+    list.drawLine(simd_make_float3(0, 0, 8), simd_make_float3(0, 0, 0));
+    list.flushTransform();
+    CHECK_NEAR(list.getNearestDepth(list.getLines()), 7.0, 1e-5);
+    // 視点の後ろは負
+    CHECK_NEAR(list.getNearestDepth(list.getTriangles()), -2.0, 1e-5);
+
+    // 形状は原点で、大きさは見ない
+    list.setTransform(math::makeIdentity());
+    list.drawSphere(simd_make_float3(0, 0, -30), 25.0f);
+    list.drawSphere(simd_make_float3(3, 3, 1), 0.5f);
+    CHECK_NEAR(list.getNearestDepth(DebugShape::Shape::Sphere), 9.0, 1e-5);
+    CHECK(list.getNearestDepth(DebugShape::Shape::Box) == 0.0f);
+
+    const Prim3DList::GeometryDraw draw = {1, math::makeTranslate(simd_make_float3(4, 0, -6))};
+    CHECK_NEAR(list.getDrawDepth(draw), 16.0, 1e-5);
+}
+
+} // namespace
+
+int
+main()
+{
+    testDirtyTracking();
+    testHandleLifecycle();
+    testLayout();
+    testUploadBytes();
+    testDrawDepth();
+    return 0;
+}
+
+//
@@ -0,0 +1,206 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "primitivemesh.h"
+#include <utility>
+
+namespace
+{
+using PrimitiveMesh::MeshVertex;
+
+constexpr double Pi = 3.14159265358979323846;
+
+//
+double
+length(const float* v)
+{
+    return std::sqrt(double(v[0]) * v[0] + double(v[1]) * v[1] + double(v[2]) * v[2]);
+}
+
+//
+// 全ての形に共通: 法線は単位長、UV は [0,1] の中、インデックスは範囲内
+// 三角形は潰れていなくて、反時計回りの面法線が頂点法線と同じ側を向く
+// @return 符号付き体積(閉じた形なら表が外向きの時に正)
+//
+template <size_t NV, size_t NI>
+double
+checkMesh(const PrimitiveMesh::Mesh<NV, NI>& mesh)
+{
+    static_assert(NI % 3 == 0);
+    for (const auto& v : mesh.vertices)
+    {
+        CHECK_NEAR(length(v.normal), 1.0, 1e-6);
+        CHECK(v.position[3] == 0.0f && v.normal[3] == 0.0f);
+        // constexpr の cos の誤差で蓋の端は 0 をわずかに下回る
+        CHECK(v.texcoord[0] >= -1e-6f && v.texcoord[0] <= 1.0f + 1e-6f);
+        CHECK(v.texcoord[1] >= -1e-6f && v.texcoord[1] <= 1.0f + 1e-6f);
+    }
+
+    double volume = 0.0;
+    for (size_t t = 0; t < NI; t += 3)
+    {
+        const MeshVertex* v[3];
+        for (size_t k = 0; k < 3; k++)
+        {
+            CHECK(mesh.indices[t + k] < NV);
+            v[k] = &mesh.vertices[mesh.indices[t + k]];
+        }
+        double d0[3], d1[3];
+        for (int e = 0; e < 3; e++)
+        {
+            d0[e] = double(v[1]->position[e]) - v[0]->position[e];
+            d1[e] = double(v[2]->position[e]) - v[0]->position[e];
+        }
+        const double n[3] = {d0[1] * d1[2] - d0[2] * d1[1], d0[2] * d1[0] - d0[0] * d1[2], d0[0] * d1[1] - d0[1] * d1[0]};
+        const double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+        CHECK(area > 1e-6);
+        for (const auto* p : v)
+        {
+            const double facing = (n[0] * p->normal[0] + n[1] * p->normal[1] + n[2] * p->normal[2]) / (area * 2.0);
+            CHECK(facing > 0.0);
+        }
+        // 原点と三角形が作る四面体の体積
+        const auto* a = v[0]->position;
+        volume += (a[0] * n[0] + a[1] * n[1] + a[2] * n[2]) / 6.0;
+    }
+    return volume;
+}
+
+//
+// 立方体: 面毎に同じ法線の 4 頂点、外向きで体積は size^3
+//
+void
+testCube()
+{
+    for (float size : {1.0f, 2.5f})
+    {
+        const auto mesh = PrimitiveMesh::makeCube(size);
+        CHECK_NEAR(checkMesh(mesh), double(size) * size * size, 1e-5);
+        for (size_t f = 0; f < 6; f++)
+        {
+            const auto& n = mesh.vertices[f * 4].normal;
+            for (size_t c = 0; c < 4; c++)
+            {
+                const auto& v = mesh.vertices[f * 4 + c];
+                for (int e = 0; e < 3; e++)
+                {
+                    CHECK(v.normal[e] == n[e]);
+                    CHECK(std::abs(v.position[e]) == size * 0.5f);
+                }
+                // 法線の向きの座標は面の上
+                const double along = v.position[0] * n[0] + v.position[1] * n[1] + v.position[2] * n[2];
+                CHECK_NEAR(along, size * 0.5, 1e-6);
+            }
+        }
+    }
+}
+
+//
+// 球: 頂点は半径 0.5 で法線は位置の向き、体積は分割が細かいほど pi/6 に近づく
+//
+void
+testSphere()
+{
+    const auto   coarse = PrimitiveMesh::makeSphere<16, 8>();
+    const auto   fine   = PrimitiveMesh::makeSphere<64, 32>();
+    const double exact  = Pi / 6.0;
+    const double vc     = checkMesh(coarse);
+    const double vf     = checkMesh(fine);
+    CHECK(vc > 0.0 && vc < vf && vf < exact);
+    CHECK_NEAR(vf, exact, exact * 0.01);
+    for (const auto& v : fine.vertices)
+    {
+        CHECK_NEAR(length(v.position), 0.5, 1e-6);
+        for (int e = 0; e < 3; e++)
+        {
+            CHECK_NEAR(v.normal[e], v.position[e] * 2.0f, 1e-6);
+        }
+    }
+    // 極の縮退三角形は無いので Slices * (Stacks - 1) * 2 枚
+    CHECK(coarse.indexCount == 16 * 7 * 6);
+}
+
+//
+// 円柱: 側面の法線は水平、蓋は上下を向き、体積は pi/4 に近づく
+//
+void
+testCylinder()
+{
+    constexpr size_t Slices = 48;
+    const auto       mesh   = PrimitiveMesh::makeCylinder<Slices>();
+    const double     exact  = Pi / 4.0;
+    const double     volume = checkMesh(mesh);
+    CHECK(volume < exact);
+    CHECK_NEAR(volume, exact, exact * 0.01);
+    for (size_t i = 0; i < (Slices + 1) * 2; i++)
+    {
+        const auto& v = mesh.vertices[i];
+        CHECK(v.normal[1] == 0.0f);
+        CHECK_NEAR(std::sqrt(double(v.position[0]) * v.position[0] + double(v.position[2]) * v.position[2]), 0.5, 1e-6);
+        CHECK(std::abs(v.position[1]) == 0.5f);
+    }
+    for (size_t i = (Slices + 1) * 2; i < mesh.vertexCount; i++)
+    {
+        const auto& v = mesh.vertices[i];
+        CHECK(v.normal[1] == (v.position[1] > 0.0f ? 1.0f : -1.0f));
+        CHECK(std::abs(v.position[1]) == 0.5f);
+    }
+}
+
+//
+// グリッド: XZ 平面の 1x1、全て +Y
+//
+void
+testGrid()
+{
+    const auto mesh = PrimitiveMesh::makeGrid<4, 3>();
+    CHECK_NEAR(checkMesh(mesh), 0.0, 1e-9);
+    double area = 0.0;
+    for (size_t t = 0; t < mesh.indexCount; t += 3)
+    {
+        const auto& a = mesh.vertices[mesh.indices[t]].position;
+        const auto& b = mesh.vertices[mesh.indices[t + 1]].position;
+        const auto& c = mesh.vertices[mesh.indices[t + 2]].position;
+        // +Y から見て反時計回りなら y 成分(z x x の向き)が正
+        area += ((double(b[2]) - a[2]) * (double(c[0]) - a[0]) - (double(b[0]) - a[0]) * (double(c[2]) - a[2])) * 0.5;
+    }
+    CHECK_NEAR(area, 1.0, 1e-6);
+    for (const auto& v : mesh.vertices)
+    {
+        CHECK(v.position[1] == 0.0f && v.normal[1] == 1.0f);
+        CHECK(std::abs(v.position[0]) <= 0.5f && std::abs(v.position[2]) <= 0.5f);
+        CHECK_NEAR(v.texcoord[0], v.position[0] + 0.5, 1e-6);
+        CHECK_NEAR(v.texcoord[1], v.position[2] + 0.5, 1e-6);
+    }
+}
+
+//
+// isValid は裏返った三角形と範囲外のインデックスを見つける
+//
+void
+testIsValid()
+{
+    auto mesh = PrimitiveMesh::makeCube();
+    CHECK(PrimitiveMesh::isValid(mesh));
+    std::swap(mesh.indices[1], mesh.indices[2]);
+    CHECK(!PrimitiveMesh::isValid(mesh));
+    std::swap(mesh.indices[1], mesh.indices[2]);
+    mesh.indices[5] = uint16_t(mesh.vertexCount);
+    CHECK(!PrimitiveMesh::isValid(mesh));
+}
+
+} // namespace
+
+int
+main()
+{
+    testCube();
+    testSphere();
+    testCylinder();
+    testGrid();
+    testIsValid();
+    return 0;
+}
+
+//
@@ -0,0 +1,111 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "radixsort.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+//
+// std::stable_sort と同じ並びになること(mask で使う桁を絞ると飛ばすパスができる)
+//
+template <class Key>
+void
+checkSort(size_t count, Key mask, unsigned threadCount, uint32_t seed)
+{
+    std::mt19937_64     rng{seed};
+    std::vector<Key>    keys(count);
+    std::vector<Key>    tmpKeys(count);
+    std::vector<size_t> values(count);
+    std::vector<size_t> tmpValues(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        keys[i]   = Key(rng()) & mask;
+        values[i] = i;
+    }
+    std::vector<size_t> expect(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        expect[i] = i;
+    }
+    std::stable_sort(expect.begin(), expect.end(), [&](size_t l, size_t r) { return keys[l] < keys[r]; });
+
+    if (threadCount == 1)
+    {
+        RadixSort::sort(keys.data(), values.data(), count, tmpKeys.data(), tmpValues.data());
+    }
+    else
+    {
+        RadixSort::sortParallel(keys.data(), values.data(), count, tmpKeys.data(), tmpValues.data(), threadCount);
+    }
+    CHECK(values == expect);
+    CHECK(std::is_sorted(keys.begin(), keys.end()));
+}
+
+//
+void
+testSort()
+{
+    checkSort<uint32_t>(0, ~0u, 1, 1);
+    checkSort<uint32_t>(1000, ~0u, 1, 2);
+    checkSort<uint32_t>(1000, 0xff00u, 1, 3);
+    checkSort<uint64_t>(1000, ~0ull, 1, 4);
+}
+
+//
+// スレッド数を変えても、続けて呼んでも同じ結果
+//
+void
+testSortParallel()
+{
+    const size_t count = RadixSort::MinCountPerThread * 3 + 123;
+    for (unsigned threads : {2u, 3u, 0u})
+    {
+        checkSort<uint32_t>(count, ~0u, threads, threads);
+        checkSort<uint32_t>(count, 0x00ff00ffu, threads, threads + 100);
+    }
+    checkSort<uint64_t>(count, ~0ull, 3, 5);
+    checkSort<uint32_t>(RadixSort::MinCountPerThread * 8, ~0u, 64, 7); // MaxThreads まで
+    checkSort<uint32_t>(RadixSort::MinCountPerThread, ~0u, 4, 6); // 1スレッド分しか無い
+}
+
+//
+// 別のスレッドから同時に呼んでもプールを順番に使う
+//
+void
+testConcurrentCallers()
+{
+    std::vector<std::thread> callers;
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        callers.emplace_back(
+            [c]
+            {
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    checkSort<uint32_t>(RadixSort::MinCountPerThread * 2, ~0u, 2, c * 10 + i);
+                }
+            });
+    }
+    for (auto& th : callers)
+    {
+        th.join();
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    testSort();
+    testSortParallel();
+    testConcurrentCallers();
+    return 0;
+}
+
+//
@@ -0,0 +1,161 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "rangealloc.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+//
+// 確保、解放と隣接領域の結合
+//
+void
+testAllocateFree()
+{
+    RangeAllocator alloc{100, 4};
+    CHECK(alloc.getCapacity() == 100);
+
+    const size_t a = alloc.allocate(10); // 12
+    const size_t b = alloc.allocate(4);
+    const size_t c = alloc.allocate(1); // 4
+    CHECK(a == 0 && b == 12 && c == 16);
+    CHECK(alloc.getUsed() == 20);
+
+    alloc.free(b, 4);
+    CHECK(alloc.getFreeBlockCount() == 2);
+    CHECK(alloc.allocate(8) == 20); // first fit でも 4 の隙間には入らない
+    alloc.free(a, 10);
+    CHECK(alloc.getFreeBlockCount() == 2); // 先頭の 12 と 4 が結合
+    CHECK(alloc.getLargestFree() == 72);
+    CHECK(alloc.allocate(100) == RangeAllocator::npos);
+}
+
+//
+// 詰め直し: 前方にしか動かず、空きは末尾の1つになる
+//
+void
+testCompact()
+{
+    RangeAllocator      alloc{256, 4};
+    std::vector<size_t> offset(16);
+    for (size_t i = 0; i < offset.size(); i++)
+    {
+        offset[i] = alloc.allocate(i + 1);
+    }
+    std::vector<RangeAllocator::Move> moves;
+    for (size_t i = 0; i < offset.size(); i++)
+    {
+        if (i % 3 == 0)
+        {
+            alloc.free(offset[i], i + 1);
+        }
+        else
+        {
+            moves.push_back({offset[i], 0, i + 1, uint32_t(i)});
+        }
+    }
+    // 渡す順は問わない
+    std::reverse(moves.begin(), moves.end());
+
+    const size_t used = alloc.getUsed();
+    const size_t end  = alloc.compact(moves);
+    CHECK(end == used);
+    CHECK(alloc.getFreeBlockCount() == 1);
+    CHECK(alloc.getLargestFree() == alloc.getCapacity() - end);
+
+    size_t expect = 0;
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        CHECK(moves[i].to == expect);
+        CHECK(moves[i].to <= moves[i].from);
+        CHECK(i == 0 || moves[i - 1].from < moves[i].from);
+        expect += alloc.alignedSize(moves[i].size);
+    }
+    CHECK(alloc.allocate(4) == end);
+}
+
+//
+// ランダムに確保と解放を繰り返してから詰め、返った順に memmove して中身が壊れないこと
+//
+void
+testCompactData()
+{
+    std::mt19937         rng{7};
+    RangeAllocator       alloc{4096, 2};
+    std::vector<uint8_t> memory(alloc.getCapacity());
+
+    struct Range
+    {
+        size_t offset;
+        size_t size;
+        bool   alive;
+    };
+    std::vector<Range> ranges;
+    for (int step = 0; step < 2000; step++)
+    {
+        if (!ranges.empty() && rng() % 3 == 0)
+        {
+            auto& r = ranges[rng() % ranges.size()];
+            if (r.alive)
+            {
+                alloc.free(r.offset, r.size);
+                r.alive = false;
+            }
+            continue;
+        }
+        const size_t size   = 1 + rng() % 40;
+        const size_t offset = alloc.allocate(size);
+        if (offset == RangeAllocator::npos)
+        {
+            continue;
+        }
+        const auto id = uint8_t(ranges.size());
+        std::memset(memory.data() + offset, id, size);
+        ranges.push_back({offset, size, true});
+    }
+
+    std::vector<RangeAllocator::Move> moves;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        if (ranges[i].alive)
+        {
+            moves.push_back({ranges[i].offset, 0, ranges[i].size, uint32_t(i)});
+        }
+    }
+    CHECK(alloc.getFreeBlockCount() > 1);
+    alloc.compact(moves);
+    for (const auto& m : moves)
+    {
+        std::memmove(memory.data() + m.to, memory.data() + m.from, m.size);
+        ranges[m.id].offset = m.to;
+    }
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        if (!ranges[i].alive)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < ranges[i].size; j++)
+        {
+            CHECK(memory[ranges[i].offset + j] == uint8_t(i));
+        }
+    }
+    CHECK(alloc.getFreeBlockCount() == 1);
+}
+
+} // namespace
+
+int
+main()
+{
+    testAllocateFree();
+    testCompact();
+    testCompactData();
+    return 0;
+}
+
+//
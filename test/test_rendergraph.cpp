@@ -0,0 +1,253 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "rendergraph.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+//
+size_t
+position(const RenderGraph& graph, RenderGraph::PassId pass)
+{
+    const auto& order = graph.getOrder();
+    return size_t(std::find(order.begin(), order.end(), pass) - order.begin());
+}
+
+//
+// 出力が読まれないパスは消える(外部への書き込みと setSideEffect は残る)
+//
+void
+testCull()
+{
+    RenderGraph graph;
+    auto        backbuffer = graph.importResource("backbuffer");
+    auto        unused     = graph.createTransient("unused", {64, 64});
+    auto        shadow     = graph.createTransient("shadow", {64, 64});
+
+    auto dead       = graph.addPass("dead", nullptr, nullptr);
+    auto shadowPass = graph.addPass("shadow", nullptr, nullptr);
+    auto mainPass   = graph.addPass("main", nullptr, nullptr);
+    auto query      = graph.addPass("query", nullptr, nullptr);
+    graph.write(dead, unused);
+    graph.write(shadowPass, shadow);
+    graph.read(mainPass, shadow);
+    graph.write(mainPass, backbuffer);
+    graph.setSideEffect(query);
+
+    CHECK(graph.compile());
+    CHECK(graph.isCulled(dead));
+    CHECK(!graph.isCulled(shadowPass));
+    CHECK(!graph.isCulled(mainPass));
+    CHECK(!graph.isCulled(query));
+    CHECK(graph.getOrder().size() == 3);
+    CHECK(position(graph, shadowPass) < position(graph, mainPass));
+    // 消えたパスのリソースは割り当てない
+    CHECK(graph.getLifetime(unused).first == RenderGraph::Invalid);
+    CHECK(graph.getPhysicalIndex(unused) == RenderGraph::Invalid);
+    CHECK(graph.getPhysicalIndex(backbuffer) == RenderGraph::Invalid);
+}
+
+//
+// 互いの出力を読み合うと順番が決まらない
+//
+void
+testCycle()
+{
+    RenderGraph graph;
+    auto        x = graph.createTransient("x", {16, 16});
+    auto        y = graph.createTransient("y", {16, 16});
+    auto        a = graph.addPass("a", nullptr, nullptr);
+    auto        b = graph.addPass("b", nullptr, nullptr);
+    graph.read(a, x);
+    graph.write(a, y);
+    graph.read(b, y);
+    graph.write(b, x);
+    graph.setSideEffect(a);
+    graph.setSideEffect(b);
+
+    CHECK(!graph.compile());
+    CHECK(graph.getOrder().empty());
+}
+
+//
+// 前の書き込みを読んだパスは、同じリソースへの後の書き込みより先(write-after-read)
+// reader は後で宣言した lighting も読むので、制約が無ければ overwrite が先に実行できてしまう
+//
+void
+testWriteAfterRead()
+{
+    RenderGraph graph;
+    auto        backbuffer = graph.importResource("backbuffer");
+    auto        history    = graph.importResource("history");
+    auto        color      = graph.createTransient("color", {128, 128});
+    auto        lighting   = graph.createTransient("lighting", {128, 128});
+
+    auto first     = graph.addPass("first", nullptr, nullptr);
+    auto reader    = graph.addPass("reader", nullptr, nullptr);
+    auto overwrite = graph.addPass("overwrite", nullptr, nullptr);
+    auto light     = graph.addPass("light", nullptr, nullptr);
+    auto present   = graph.addPass("present", nullptr, nullptr);
+    graph.write(first, color);
+    graph.read(reader, color);
+    graph.read(reader, lighting);
+    graph.write(reader, history);
+    graph.write(overwrite, color);
+    graph.write(light, lighting);
+    graph.read(present, color);
+    graph.write(present, backbuffer);
+
+    CHECK(graph.compile());
+    CHECK(graph.getOrder().size() == 5);
+    CHECK(position(graph, first) < position(graph, reader));
+    CHECK(position(graph, light) < position(graph, reader));
+    CHECK(position(graph, reader) < position(graph, overwrite));
+    CHECK(position(graph, overwrite) < position(graph, present));
+}
+
+//
+// 寿命が重ならない一時リソースは同じスロットを使う
+//
+void
+testAliasing()
+{
+    RenderGraph graph;
+    auto        backbuffer = graph.importResource("backbuffer");
+    auto        t0         = graph.createTransient("t0", {256, 256});
+    auto        t1         = graph.createTransient("t1", {256, 256});
+    auto        t2         = graph.createTransient("t2", {256, 256});
+
+    auto p0 = graph.addPass("p0", nullptr, nullptr);
+    auto p1 = graph.addPass("p1", nullptr, nullptr);
+    auto p2 = graph.addPass("p2", nullptr, nullptr);
+    auto p3 = graph.addPass("p3", nullptr, nullptr);
+    graph.write(p0, t0);
+    graph.read(p1, t0);
+    graph.write(p1, t1);
+    graph.read(p2, t1);
+    graph.write(p2, t2);
+    graph.read(p3, t2);
+    graph.write(p3, backbuffer);
+
+    CHECK(graph.compile());
+    CHECK(graph.getLifetime(t0).first == 0 && graph.getLifetime(t0).last == 1);
+    CHECK(graph.getLifetime(t2).first == 2 && graph.getLifetime(t2).last == 3);
+    CHECK(graph.getPhysicalCount() == 2);
+    CHECK(graph.getPhysicalIndex(t0) == graph.getPhysicalIndex(t2));
+    CHECK(graph.getPhysicalIndex(t0) != graph.getPhysicalIndex(t1));
+    CHECK(graph.getRequestedBytes() == 3 * 256 * 256 * 4);
+    CHECK(graph.getTransientBytes() == 2 * 256 * 256 * 4);
+}
+
+//
+// 空きスロットに入らない時は一番大きい空きを広げる(新しいスロットを足すより合計は小さい)
+// 入る空きがあれば、そのうち一番小さいもの
+//
+void
+testPhysicalFallback()
+{
+    RenderGraph graph;
+    auto        backbuffer = graph.importResource("backbuffer");
+    auto        small      = graph.createTransient("small", {64, 64});
+    auto        tiny       = graph.createTransient("tiny", {16, 16});
+    auto        temp       = graph.createTransient("temp", {32, 32});
+    auto        big        = graph.createTransient("big", {1024, 1024});
+    auto        mid        = graph.createTransient("mid", {16, 16});
+
+    auto p0 = graph.addPass("p0", nullptr, nullptr);
+    auto p1 = graph.addPass("p1", nullptr, nullptr);
+    auto p2 = graph.addPass("p2", nullptr, nullptr);
+    auto p3 = graph.addPass("p3", nullptr, nullptr);
+    auto p4 = graph.addPass("p4", nullptr, nullptr);
+    graph.write(p0, small);
+    graph.write(p0, tiny);
+    graph.read(p1, small);
+    graph.read(p1, tiny);
+    graph.write(p1, temp);
+    graph.read(p2, temp);
+    graph.write(p2, big);
+    graph.read(p3, big);
+    graph.write(p3, mid);
+    graph.read(p4, mid);
+    graph.write(p4, backbuffer);
+
+    CHECK(graph.compile());
+    CHECK(graph.getPhysicalCount() == 3);
+    // big の開始時点で空いているのは small と tiny のスロットで、どちらにも入らない
+    CHECK(graph.getPhysicalIndex(big) == graph.getPhysicalIndex(small));
+    CHECK(graph.getPhysicalSize(graph.getPhysicalIndex(big)) == 1024 * 1024 * 4);
+    // mid は tiny と temp のスロットに入るので小さい方
+    CHECK(graph.getPhysicalIndex(mid) == graph.getPhysicalIndex(tiny));
+    CHECK(graph.getTransientBytes() == (1024 * 1024 + 32 * 32 + 16 * 16) * 4);
+    CHECK(graph.getRequestedBytes() == (64 * 64 + 16 * 16 + 32 * 32 + 1024 * 1024 + 16 * 16) * 4);
+}
+
+//
+// clear すると宣言は全て消えて、同じグラフを組み直せる
+//
+void
+testClear()
+{
+    RenderGraph graph;
+    for (int frame = 0; frame < 3; frame++)
+    {
+        graph.clear();
+        auto backbuffer = graph.importResource("backbuffer");
+        auto t          = graph.createTransient("t", {8, 8});
+        auto p0         = graph.addPass("p0", nullptr, nullptr);
+        auto p1         = graph.addPass("p1", nullptr, nullptr);
+        graph.write(p0, t);
+        graph.read(p1, t);
+        graph.write(p1, backbuffer);
+        CHECK(graph.compile());
+        CHECK(graph.getPassCount() == 2 && graph.getResourceCount() == 2);
+        CHECK(graph.getOrder().size() == 2);
+        CHECK(graph.getPhysicalCount() == 1);
+    }
+}
+
+//
+void
+record(void* user, void* context)
+{
+    static_cast<std::vector<int>*>(context)->push_back(int(reinterpret_cast<intptr_t>(user)));
+}
+
+//
+// 実行は compile した順
+//
+void
+testExecute()
+{
+    RenderGraph      graph;
+    std::vector<int> log;
+    auto backbuffer = graph.importResource("backbuffer");
+    auto t          = graph.createTransient("t", {8, 8});
+    auto late       = graph.addPass("late", record, reinterpret_cast<void*>(intptr_t(2)));
+    auto early      = graph.addPass("early", record, reinterpret_cast<void*>(intptr_t(1)));
+    graph.read(late, t);
+    graph.write(late, backbuffer);
+    graph.write(early, t);
+    CHECK(graph.compile());
+    graph.execute(&log);
+    CHECK((log == std::vector<int>{1, 2}));
+}
+
+} // namespace
+
+int
+main()
+{
+    testCull();
+    testCycle();
+    testWriteAfterRead();
+    testAliasing();
+    testPhysicalFallback();
+    testClear();
+    testExecute();
+    return 0;
+}
+
+//
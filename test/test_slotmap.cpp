@@ -0,0 +1,87 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "slotmap.h"
+
+namespace
+{
+//
+// 削除したハンドルは番号が再利用されても引けない
+//
+void
+testGeneration()
+{
+    SlotMap<int> map;
+    const auto   a = map.create(1);
+    const auto   b = map.create(2);
+    CHECK(a != SlotMap<int>::InvalidHandle && b != SlotMap<int>::InvalidHandle);
+    CHECK(*map.get(a) == 1 && *map.get(b) == 2);
+
+    CHECK(map.destroy(a));
+    CHECK(!map.destroy(a));
+    CHECK(map.get(a) == nullptr);
+
+    const auto c = map.create(3);
+    CHECK((c & SlotMap<int>::IndexMask) == (a & SlotMap<int>::IndexMask));
+    CHECK(c != a);
+    CHECK(map.get(a) == nullptr);
+    CHECK(*map.get(c) == 3);
+    CHECK(map.size() == 2);
+    CHECK(!map.contains(SlotMap<int>::InvalidHandle));
+}
+
+//
+// 世代を使い切った番号は再利用しない
+//
+void
+testGenerationExhausted()
+{
+    SlotMap<int> map;
+    auto         first = map.create();
+    auto         h     = first;
+    for (uint32_t i = 1; i < SlotMap<int>::MaxGeneration; i++)
+    {
+        map.destroy(h);
+        h = map.create();
+        CHECK((h & SlotMap<int>::IndexMask) == 0);
+    }
+    map.destroy(h);
+    h = map.create();
+    CHECK((h & SlotMap<int>::IndexMask) == 1);
+    CHECK(map.get(first) == nullptr);
+}
+
+//
+void
+testForEach()
+{
+    SlotMap<int> map;
+    auto         a = map.create(10);
+    map.create(20);
+    map.create(30);
+    map.destroy(a);
+    int sum   = 0;
+    int count = 0;
+    map.forEach(
+        [&](SlotMap<int>::Handle h, int& v)
+        {
+            CHECK(map.get(h) == &v);
+            sum += v;
+            count++;
+        });
+    CHECK(sum == 50 && count == 2);
+}
+
+} // namespace
+
+int
+main()
+{
+    testGeneration();
+    testGenerationExhausted();
+    testForEach();
+    return 0;
+}
+
+//
@@ -0,0 +1,201 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "packing.h"
+#include "spritebatch.h"
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+using Blend  = SpriteBatch::Blend;
+using Vertex = SpriteBatch::Vertex;
+static_assert(sizeof(Vertex) == 16);
+
+// 中身は見ないので番号だけのテクスチャ
+char textureStorage[8];
+
+MTL::Texture*
+texture(int i)
+{
+    return reinterpret_cast<MTL::Texture*>(&textureStorage[i]);
+}
+
+// color に追加順を入れた画面内の矩形
+SpriteBatch::Quad
+makeQuad(uint32_t order)
+{
+    const float x = float(order % 10) * 10.0f;
+    return {x, 0.0f, x + 8.0f, 8.0f, 0.0f, 0.0f, 1.0f, 1.0f, order};
+}
+
+//
+// レイヤー(負も含めて昇順) | ブレンド | テクスチャ(最初に使った順) | 追加順 で並ぶ
+//
+void
+testOrdering()
+{
+    struct Added
+    {
+        int16_t  layer;
+        Blend    blend;
+        int      texture;
+        uint32_t order;
+    };
+    std::mt19937                    rng(3);
+    std::uniform_int_distribution<> layerDist(-3, 3);
+    std::uniform_int_distribution<> texDist(0, 5);
+    std::uniform_int_distribution<> blendDist(0, 1);
+
+    SpriteBatch batch;
+    batch.setViewport(100.0f, 100.0f);
+    std::vector<Added> added;
+    std::vector<int>   firstUse; // テクスチャ -> 最初に使った順番
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        const Added a = {int16_t(i == 0 ? INT16_MIN : (i == 1 ? INT16_MAX : layerDist(rng))), Blend(blendDist(rng)),
+                         texDist(rng), i};
+        CHECK(batch.add(texture(a.texture), makeQuad(i), a.layer, a.blend));
+        if (std::find(firstUse.begin(), firstUse.end(), a.texture) == firstUse.end())
+        {
+            firstUse.push_back(a.texture);
+        }
+        added.push_back(a);
+    }
+    batch.build();
+
+    const auto rank = [&](int tex) { return std::find(firstUse.begin(), firstUse.end(), tex) - firstUse.begin(); };
+    std::vector<Added> expect = added;
+    std::sort(expect.begin(), expect.end(),
+              [&](const Added& a, const Added& b)
+              {
+                  return std::make_tuple(a.layer, a.blend, rank(a.texture), a.order) <
+                         std::make_tuple(b.layer, b.blend, rank(b.texture), b.order);
+              });
+    const auto& vertices = batch.getVertices();
+    CHECK(vertices.size() == added.size() * 4);
+    CHECK(expect.front().layer == INT16_MIN && expect.back().layer == INT16_MAX);
+    for (size_t i = 0; i < expect.size(); i++)
+    {
+        for (size_t k = 0; k < 4; k++)
+        {
+            CHECK(vertices[i * 4 + k].color == expect[i].order);
+        }
+    }
+
+    // Run は同じテクスチャ/ブレンドが続く範囲で、全ての矩形を順に覆う
+    uint32_t next = 0;
+    for (size_t r = 0; r < batch.getRuns().size(); r++)
+    {
+        const auto& run = batch.getRuns()[r];
+        CHECK(run.firstQuad == next && run.quadCount > 0);
+        for (uint32_t q = run.firstQuad; q < run.firstQuad + run.quadCount; q++)
+        {
+            CHECK(texture(expect[q].texture) == run.texture && expect[q].blend == run.blend);
+        }
+        CHECK(run.textureIndex == uint32_t(rank(expect[run.firstQuad].texture)));
+        if (r > 0)
+        {
+            const auto& prev = batch.getRuns()[r - 1];
+            CHECK(prev.texture != run.texture || prev.blend != run.blend);
+        }
+        next += run.quadCount;
+    }
+    CHECK(next == added.size());
+}
+
+//
+// 同じレイヤーでテクスチャが交互なら、テクスチャ毎にまとまって Run は 2 つ
+//
+void
+testBatching()
+{
+    SpriteBatch batch;
+    batch.setViewport(100.0f, 100.0f);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        batch.add(texture(int(i & 1)), makeQuad(i), 0, Blend::Alpha);
+    }
+    batch.build();
+    CHECK(batch.getRuns().size() == 2);
+    CHECK(batch.getRuns()[0].texture == texture(0) && batch.getRuns()[0].quadCount == 5);
+    CHECK(batch.getRuns()[1].texture == texture(1) && batch.getRuns()[1].firstQuad == 5);
+    // 同じテクスチャの中は追加順
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        CHECK(batch.getVertices()[i * 4].color == i * 2);
+        CHECK(batch.getVertices()[(i + 5) * 4].color == i * 2 + 1);
+    }
+
+    // レイヤーが上なら同じテクスチャでも後ろ
+    batch.clear();
+    batch.add(texture(0), makeQuad(0), 1, Blend::Alpha);
+    batch.add(texture(1), makeQuad(1), 0, Blend::Alpha);
+    batch.add(texture(0), makeQuad(2), 0, Blend::Add);
+    batch.build();
+    CHECK(batch.getRuns().size() == 3);
+    CHECK(batch.getVertices()[0].color == 1 && batch.getVertices()[4].color == 2 && batch.getVertices()[8].color == 0);
+    CHECK(batch.getRuns()[1].blend == Blend::Add);
+}
+
+//
+// 画面外(辺が接するだけのものも)は追加しない、裏返った矩形も判定できる
+//
+void
+testCulling()
+{
+    SpriteBatch batch;
+    batch.setViewport(100.0f, 50.0f);
+    const auto quad = [](float x1, float y1, float x2, float y2)
+    { return SpriteBatch::Quad{x1, y1, x2, y2, 0.0f, 0.0f, 1.0f, 1.0f, 0xffffffff}; };
+    CHECK(!batch.add(texture(0), quad(-10, 0, 0, 10), 0, Blend::Alpha));
+    CHECK(!batch.add(texture(0), quad(100, 0, 110, 10), 0, Blend::Alpha));
+    CHECK(!batch.add(texture(0), quad(0, 50, 10, 60), 0, Blend::Alpha));
+    CHECK(!batch.add(texture(0), quad(0, -5, 10, -1), 0, Blend::Alpha));
+    CHECK(!batch.add(texture(0), quad(0, 10, -10, 0), 0, Blend::Alpha));
+    CHECK(batch.add(texture(0), quad(-10, -10, 1, 1), 0, Blend::Alpha));
+    CHECK(batch.add(texture(0), quad(99, 49, 200, 200), 0, Blend::Alpha));
+    CHECK(batch.add(texture(0), quad(60, 40, 40, 10), 0, Blend::Alpha));
+    CHECK(batch.getQuadCount() == 3 && batch.getCulledCount() == 5);
+    batch.clear();
+    CHECK(batch.getQuadCount() == 0 && batch.getCulledCount() == 0);
+}
+
+//
+// 頂点は (x1,y1) (x2,y1) (x1,y2) (x2,y2) の順、UV は half なので 1 を超えても残る
+//
+void
+testVertices()
+{
+    SpriteBatch batch;
+    batch.setViewport(100.0f, 100.0f);
+    batch.add(texture(0), {10, 20, 30, 40, -0.5f, 0.25f, 3.5f, 2.0f, 0x80ff00ff}, 0, Blend::Alpha);
+    batch.build();
+    const auto& v = batch.getVertices();
+    CHECK(v.size() == 4);
+    const float expect[4][4] = {{10, 20, -0.5f, 0.25f}, {30, 20, 3.5f, 0.25f}, {10, 40, -0.5f, 2.0f}, {30, 40, 3.5f, 2.0f}};
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(v[i].position[0] == expect[i][0] && v[i].position[1] == expect[i][1]);
+        CHECK(Packing::unpackHalf(v[i].texcoord[0]) == expect[i][2]);
+        CHECK(Packing::unpackHalf(v[i].texcoord[1]) == expect[i][3]);
+        CHECK(v[i].color == 0x80ff00ff);
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    testOrdering();
+    testBatching();
+    testCulling();
+    testVertices();
+    return 0;
+}
+
+//
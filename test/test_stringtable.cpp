@@ -0,0 +1,82 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "stringtable.h"
+#include <string>
+
+namespace
+{
+//
+// 同じ内容なら同じ領域、NUL 終端
+//
+void
+testIntern()
+{
+    StringTable table;
+    std::string text = "hello";
+    const auto  a    = table.intern(text);
+    text[0]          = 'j';
+    const auto b     = table.intern("hello");
+    CHECK(a.data() == b.data());
+    CHECK(a == "hello" && a.data()[a.size()] == '\0');
+    CHECK(table.intern("jello") != a);
+    CHECK(table.size() == 2);
+}
+
+//
+// 使われ続ける文字列は残り、使われなくなった文字列は keepFrames の区切りで消える
+//
+void
+testEvict()
+{
+    StringTable table;
+    table.intern("old");
+    for (uint32_t frame = 0; frame < StringTable::keepFrames * 2; frame++)
+    {
+        CHECK(table.intern("kept") == "kept");
+        table.endFrame();
+    }
+    CHECK(table.contains("kept"));
+    CHECK(!table.contains("old"));
+    CHECK(table.size() == 1);
+    // 詰め直した後も内容は同じ
+    CHECK(table.intern("kept").data()[4] == '\0');
+}
+
+//
+// 毎フレーム違う文字列を渡しても使用量は増え続けない
+//
+void
+testBounded()
+{
+    StringTable table;
+    size_t      maxSize  = 0;
+    size_t      maxBytes = 0;
+    for (uint32_t frame = 0; frame < StringTable::keepFrames * 20; frame++)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "frame %u", frame);
+        table.intern(buf);
+        table.intern("fixed");
+        table.endFrame();
+        maxSize  = std::max(maxSize, table.size());
+        maxBytes = std::max(maxBytes, table.getBytes());
+    }
+    CHECK(maxSize <= StringTable::keepFrames * 2 + 1);
+    CHECK(maxBytes <= (StringTable::keepFrames * 2 + 1) * 32);
+    CHECK(table.contains("fixed"));
+}
+
+} // namespace
+
+int
+main()
+{
+    testIntern();
+    testEvict();
+    testBounded();
+    return 0;
+}
+
+//
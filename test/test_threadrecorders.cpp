@@ -0,0 +1,175 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "logcontext.h"
+#include "threadrecorders.h"
+#include <atomic>
+#include <csignal>
+#include <matrix.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+// 区切り毎に replay が先に入れる呼び出し
+void
+beginSegment(LogContext& context)
+{
+    context.SetDrawColor(1.0f, 1.0f, 1.0f, 1.0f);
+    context.SetTransform(math::makeIdentity());
+}
+
+//
+// (sortKey, スロットの確保順, 呼んだ順) に並び、各区切りは白と単位行列から始まる
+// 同じキーで続けて呼んだ分は1つの区切りになる
+//
+void
+testMergeOrder()
+{
+    ThreadRecorders  threads;
+    std::atomic<int> turn{0};
+    auto             worker = [&](int id)
+    {
+        // 確保順を決めるため id の順に呼ぶ(スレッドの id が使い回されないよう、全員が終わるまで待つ)
+        while (turn.load() != id)
+        {
+            std::this_thread::yield();
+        }
+        threads.get(uint32_t(10 - id)).DrawSphere3D(simd::float3{float(id), 0, 0}, 1.0f);
+        threads.get(0).DrawSphere3D(simd::float3{float(id), 1, 0}, 1.0f);
+        threads.get(0).DrawSphere3D(simd::float3{float(id), 2, 0}, 1.0f);
+        turn++;
+        while (turn.load() != 3)
+        {
+            std::this_thread::yield();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int id = 0; id < 3; id++)
+    {
+        workers.emplace_back(worker, id);
+    }
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+    CHECK(threads.getThreadCount() == 3);
+    CHECK(threads.getCommandCount() == 9);
+
+    LogContext expect;
+    for (int id = 0; id < 3; id++)
+    {
+        beginSegment(expect);
+        expect.DrawSphere3D(simd::float3{float(id), 1, 0}, 1.0f);
+        expect.DrawSphere3D(simd::float3{float(id), 2, 0}, 1.0f);
+    }
+    for (int id = 2; id >= 0; id--)
+    {
+        beginSegment(expect);
+        expect.DrawSphere3D(simd::float3{float(id), 0, 0}, 1.0f);
+    }
+    LogContext target;
+    threads.replay(target);
+    CHECK(target.log == expect.log);
+
+    // clear すると次のフレームはスロットを取り直す
+    threads.clear();
+    CHECK(threads.getThreadCount() == 0 && threads.getCommandCount() == 0);
+    threads.get(3).DrawLine2D(simd::float2{0, 0}, simd::float2{1, 1});
+    CHECK(threads.getThreadCount() == 1 && threads.getCommandCount() == 1);
+}
+
+//
+// 別の ThreadRecorders を挟んで戻って来たスレッドは、確保済みのスロットを探して使う
+//
+void
+testSlotReuse()
+{
+    ThreadRecorders a;
+    ThreadRecorders b;
+    a.get(0).DrawLine2D(simd::float2{0, 0}, simd::float2{1, 0});
+    b.get(0).DrawLine2D(simd::float2{0, 0}, simd::float2{2, 0});
+    a.get(0).DrawLine2D(simd::float2{0, 0}, simd::float2{3, 0});
+    b.get(1).DrawLine2D(simd::float2{0, 0}, simd::float2{4, 0});
+    CHECK(a.getThreadCount() == 1 && a.getCommandCount() == 2);
+    CHECK(b.getThreadCount() == 1 && b.getCommandCount() == 2);
+
+    // 同じキーで続けた分は1つの区切り
+    LogContext expect;
+    beginSegment(expect);
+    expect.DrawLine2D(simd::float2{0, 0}, simd::float2{1, 0});
+    expect.DrawLine2D(simd::float2{0, 0}, simd::float2{3, 0});
+    LogContext target;
+    a.replay(target);
+    CHECK(target.log == expect.log);
+
+    // 別のスレッドは新しいスロット
+    std::thread([&] { a.get(0).PopTransform(); }).join();
+    CHECK(a.getThreadCount() == 2 && a.getCommandCount() == 3);
+}
+
+// count 個のスレッドから1回ずつ記録する
+// 終わったスレッドの id は使い回されるので、全員が記録し終わるまでどのスレッドも終わらせない
+void
+recordFromThreads(ThreadRecorders& threads, size_t count)
+{
+    std::atomic<size_t> arrived{0};
+    auto                worker = [&]
+    {
+        threads.get(0).PopTransform();
+        arrived++;
+        while (arrived.load() < count)
+        {
+            std::this_thread::yield();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < count; i++)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+}
+
+//
+// 同時に MaxThreads を超えるスレッドが使うと、共有の Context に落とさずに abort する
+//
+void
+testTooManyThreads()
+{
+    ThreadRecorders threads;
+    recordFromThreads(threads, ThreadRecorders::MaxThreads);
+    CHECK(threads.getThreadCount() == ThreadRecorders::MaxThreads);
+    CHECK(threads.getCommandCount() == ThreadRecorders::MaxThreads);
+    threads.clear();
+
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        recordFromThreads(threads, ThreadRecorders::MaxThreads + 1);
+        _exit(0);
+    }
+    CHECK(child > 0);
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+}
+
+} // namespace
+
+int
+main()
+{
+    testMergeOrder();
+    testSlotReuse();
+    testTooManyThreads();
+    return 0;
+}
+
+//
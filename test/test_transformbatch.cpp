@@ -0,0 +1,218 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+#include "check.h"
+#include "prim3dlist.h"
+#include "transformbatch.h"
+#include <cmath>
+#include <matrix.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+using Vertex = Prim3DList::Vertex;
+
+// 回転 + 拡大 + 移動
+simd::float4x4
+makeAffine(float angle, simd::float3 scale, simd::float3 offset)
+{
+    return simd_mul(math::makeTranslate(offset), simd_mul(math::makeYRotate(angle), math::makeScale(scale)));
+}
+
+// 1頂点ずつ simd_mul した結果
+simd::float3
+expectPoint(const simd::float4x4& m, simd::float3 p)
+{
+    return simd_mul(m, simd_make_float4(p, 1.0f)).xyz;
+}
+
+//
+void
+checkVertex(const Vertex& v, simd::float3 p)
+{
+    CHECK_NEAR(v.position[0], p.x, 1e-4);
+    CHECK_NEAR(v.position[1], p.y, 1e-4);
+    CHECK_NEAR(v.position[2], p.z, 1e-4);
+}
+
+//
+// apply は1頂点ずつの simd_mul と同じ、stride の残り(色など)は触らない
+//
+void
+testApply()
+{
+    struct Wide
+    {
+        float    position[3];
+        uint32_t color;
+        float    extra[2];
+    };
+    static_assert(sizeof(Wide) == 24);
+
+    std::mt19937                          rng(7);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    const auto m = makeAffine(0.7f, simd_make_float3(1.5f, 0.5f, 2.0f), simd_make_float3(3, -4, 5));
+
+    std::vector<Wide> data(257);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = {{dist(rng), dist(rng), dist(rng)}, uint32_t(i), {-1.0f, 2.0f}};
+    }
+    const auto source = data;
+    TransformBatch::apply(m, data.data(), sizeof(Wide), data.size());
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const auto& s = source[i].position;
+        const auto  e = expectPoint(m, simd_make_float3(s[0], s[1], s[2]));
+        CHECK_NEAR(data[i].position[0], e.x, 1e-4);
+        CHECK_NEAR(data[i].position[1], e.y, 1e-4);
+        CHECK_NEAR(data[i].position[2], e.z, 1e-4);
+        CHECK(data[i].color == uint32_t(i) && data[i].extra[0] == -1.0f && data[i].extra[1] == 2.0f);
+    }
+
+    // count 0 は何もしない
+    TransformBatch::apply(m, nullptr, sizeof(Wide), 0);
+}
+
+//
+// applyRows は行優先 3x4 の前に行列を掛ける(m * rows)
+//
+void
+testApplyRows()
+{
+    const auto inner = makeAffine(-0.4f, simd_make_float3(2, 3, 4), simd_make_float3(1, 2, 3));
+    const auto outer = makeAffine(1.1f, simd_make_float3(0.5f, 0.5f, 0.5f), simd_make_float3(-7, 0, 9));
+    float      rows[12];
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            rows[r * 4 + c] = inner.columns[c][r];
+        }
+    }
+    TransformBatch::applyRows(outer, rows);
+    const auto expect = simd_mul(outer, inner);
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            CHECK_NEAR(rows[r * 4 + c], expect.columns[c][r], 1e-5);
+        }
+    }
+}
+
+//
+// 単位行列は isIdentity で判定して頂点に触らない
+// (掛けると -0 が +0 に、無限大は他の成分を NaN にするので、掛けていないことが分かる)
+//
+void
+testIdentity()
+{
+    CHECK(TransformBatch::isIdentity(math::makeIdentity()));
+    CHECK(!TransformBatch::isIdentity(math::makeTranslate(simd_make_float3(0, 0, 1e-6f))));
+    CHECK(!TransformBatch::isIdentity(math::makeScale(simd_make_float3(1, 1, -1))));
+
+    Prim3DList list;
+    list.setTransform(math::makeIdentity());
+    list.drawLine(simd_make_float3(-0.0f, 1, 2), simd_make_float3(INFINITY, 3, 4));
+    list.flushTransform();
+    const auto& v = list.getLines().vertices;
+    CHECK(std::signbit(v[0].position[0]) && v[0].position[0] == 0.0f);
+    CHECK(std::isinf(v[1].position[0]) && v[1].position[1] == 3.0f && v[1].position[2] == 4.0f);
+
+    // 単位行列以外なら掛ける
+    list.clear();
+    list.setTransform(math::makeTranslate(simd_make_float3(1, 0, 0)));
+    list.drawLine(simd_make_float3(-0.0f, 1, 2), simd_make_float3(5, 3, 4));
+    list.flushTransform();
+    checkVertex(list.getLines().vertices[0], simd_make_float3(1, 1, 2));
+}
+
+//
+// 入れ子の push/pop: 範囲毎にその時の行列が掛かる(チャンクを跨ぐ量でも)
+//
+void
+testNested()
+{
+    const auto a = makeAffine(0.3f, simd_make_float3(2, 2, 2), simd_make_float3(10, 0, 0));
+    const auto b = makeAffine(-1.2f, simd_make_float3(1, 0.5f, 1), simd_make_float3(0, 5, 0));
+    const auto c = math::makeTranslate(simd_make_float3(0, 0, -3));
+    const auto s = math::makeScale(simd_make_float3(3, 3, 3));
+
+    // 範囲毎に掛かっているはずの行列
+    struct Range
+    {
+        size_t         first;
+        size_t         count;
+        simd::float4x4 m;
+    };
+    std::vector<Range> ranges;
+    Prim3DList         list;
+    const auto         draw = [&](size_t count, const simd::float4x4& expect)
+    {
+        ranges.push_back({list.getLines().getVertexCount(), count * 2, expect});
+        for (size_t i = 0; i < count; i++)
+        {
+            const float f = float(i) * 0.01f;
+            list.drawLine(simd_make_float3(f, 1, -f), simd_make_float3(-f, f, 2));
+        }
+    };
+
+    const auto id = math::makeIdentity();
+    draw(10, id);
+    list.pushTransform(a);
+    CHECK(list.getTransformDepth() == 1);
+    draw(3000, a);
+    list.pushTransform(b);
+    draw(5, simd_mul(a, b));
+    list.pushTransform(c);
+    CHECK(list.getTransformDepth() == 3);
+    draw(2100, simd_mul(simd_mul(a, b), c));
+    list.popTransform();
+    draw(7, simd_mul(a, b));
+    // set は一番上だけを置き換えて、pop で積んだ行列に戻る
+    list.setTransform(s);
+    draw(4, s);
+    list.popTransform();
+    draw(6, a);
+    list.popTransform();
+    draw(8, id);
+    // 一番下より先には戻らない
+    list.popTransform();
+    CHECK(list.getTransformDepth() == 0);
+    draw(2, id);
+    list.flushTransform();
+
+    const auto& vertices = list.getLines().vertices;
+    CHECK(vertices.size() == ranges.back().first + ranges.back().count);
+    for (const auto& range : ranges)
+    {
+        for (size_t i = 0; i < range.count; i++)
+        {
+            const float f = float(i / 2) * 0.01f;
+            const auto  p = (i & 1) == 0 ? simd_make_float3(f, 1, -f) : simd_make_float3(-f, f, 2);
+            checkVertex(vertices[range.first + i], expectPoint(range.m, p));
+        }
+    }
+
+    // clear で積んだ分も捨てて単位行列に戻る
+    list.pushTransform(a);
+    list.pushTransform(b);
+    list.clear();
+    CHECK(list.getTransformDepth() == 0 && TransformBatch::isIdentity(list.getTransform()));
+}
+
+} // namespace
+
+int
+main()
+{
+    testApply();
+    testApplyRows();
+    testIdentity();
+    testNested();
+    return 0;
+}
+
+//
@@ -0,0 +1,208 @@
+//
+// Copyright 2023 Suzuki Yoshinori(wave.suzuki.z@gmail.com)
+//
+// 描画プロセスが書き出す共有メモリ(include/livemetrics.h)を読んで表示する
+//   metricsreader [-n name] [-i interval(ms)] [-c count] [-H]
+// 表示する間隔の間に増えた分のヒストグラムから Renderer::draw のパーセンタイルを出す
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <livemetrics.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+//
+struct Options
+{
+    const char* name       = LiveMetrics::DefaultName;
+    int         intervalMs = 1000;
+    int         count      = 0; // 0 なら止めるまで
+    bool        histogram  = false;
+};
+
+//
+void
+usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [-n name] [-i interval_ms] [-c count] [-H]\n", prog);
+}
+
+//
+bool
+parseOptions(int argc, char* argv[], Options& opts)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "n:i:c:H")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            opts.name = optarg;
+            break;
+        case 'i':
+            opts.intervalMs = std::max(1, atoi(optarg));
+            break;
+        case 'c':
+            opts.count = atoi(optarg);
+            break;
+        case 'H':
+            opts.histogram = true;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// 共有メモリを読み取り専用で開く
+const LiveMetrics::Segment*
+openSegment(const char* name)
+{
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st;
+    void*       addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(LiveMetrics::Segment))
+    {
+        addr = mmap(nullptr, sizeof(LiveMetrics::Segment), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return addr == MAP_FAILED ? nullptr : static_cast<const LiveMetrics::Segment*>(addr);
+}
+
+// 小さい方から ceil(p * total) 番目が入っているバケツの上端(ms)
+float
+percentile(const uint64_t* histogram, uint64_t total, double p, uint32_t bucketWidthUs)
+{
+    if (total == 0)
+    {
+        return 0.0f;
+    }
+    const auto rank = std::max<uint64_t>(1, uint64_t(p * double(total) + 0.999999));
+    uint64_t   sum  = 0;
+    for (size_t i = 0; i < LiveMetrics::BucketCount; i++)
+    {
+        sum += histogram[i];
+        if (sum >= rank)
+        {
+            return float((i + 1) * bucketWidthUs) / 1000.0f;
+        }
+    }
+    return float(LiveMetrics::BucketCount * bucketWidthUs) / 1000.0f;
+}
+
+//
+void
+printHistogram(const uint64_t* histogram, uint64_t total, uint32_t bucketWidthUs)
+{
+    constexpr int BarWidth = 50;
+    for (size_t i = 0; i < LiveMetrics::BucketCount; i++)
+    {
+        if (histogram[i] == 0)
+        {
+            continue;
+        }
+        const int  bar  = int(histogram[i] * BarWidth / total);
+        const bool last = i + 1 == LiveMetrics::BucketCount;
+        printf("  %6.2f%s ms %8llu |%.*s\n", float((i + 1) * bucketWidthUs) / 1000.0f, last ? "+" : " ",
+               (unsigned long long)histogram[i], bar, "##################################################");
+    }
+}
+
+//
+void
+printSnapshot(const LiveMetrics::Segment& segment, const LiveMetrics::Payload& now, const LiveMetrics::Payload& prev,
+              bool histogram)
+{
+    uint64_t delta[LiveMetrics::BucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < LiveMetrics::BucketCount; i++)
+    {
+        delta[i] = now.histogram[i] - prev.histogram[i];
+        total += delta[i];
+    }
+    const auto width = segment.bucketWidthUs;
+    printf("frame %llu (+%llu) draw %.2fms cpu %.2fms wait %.2fms | draw p50 %.2f p95 %.2f p99 %.2f ms\n",
+           (unsigned long long)now.frameIndex, (unsigned long long)total, now.drawUs / 1000.0, now.cpuUs / 1000.0,
+           now.waitUs / 1000.0, percentile(delta, total, 0.50, width), percentile(delta, total, 0.95, width),
+           percentile(delta, total, 0.99, width));
+    for (uint32_t i = 0; i < segment.counterCount; i++)
+    {
+        printf("%s%.*s %llu", i == 0 ? "  " : ", ", int(LiveMetrics::NameLength), segment.counterNames[i],
+               (unsigned long long)now.counters[i]);
+    }
+    printf("\n");
+    if (histogram && total > 0)
+    {
+        printHistogram(delta, total, width);
+    }
+    fflush(stdout);
+}
+
+} // namespace
+
+//
+//
+//
+int
+main(int argc, char* argv[])
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const auto* segment = openSegment(opts.name);
+    if (segment == nullptr)
+    {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], opts.name);
+        return 1;
+    }
+    if (!LiveMetrics::isValid(*segment))
+    {
+        fprintf(stderr, "%s: %s is not a version %u metrics segment\n", argv[0], opts.name, LiveMetrics::Version);
+        return 1;
+    }
+
+    LiveMetrics::Payload prev{};
+    LiveMetrics::Payload now{};
+    if (!LiveMetrics::read(*segment, prev))
+    {
+        fprintf(stderr, "%s: writer is too busy\n", argv[0]);
+        return 1;
+    }
+    for (int n = 0; opts.count == 0 || n < opts.count; n++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(opts.intervalMs));
+        if (!LiveMetrics::read(*segment, now))
+        {
+            continue;
+        }
+        if (now.frameIndex == prev.frameIndex)
+        {
+            printf("frame %llu (no update, writer pid %llu)\n", (unsigned long long)now.frameIndex,
+                   (unsigned long long)segment->writerPid);
+            fflush(stdout);
+            continue;
+        }
+        printSnapshot(*segment, now, prev, opts.histogram);
+        prev = now;
+    }
+    return 0;
+}
+
+//